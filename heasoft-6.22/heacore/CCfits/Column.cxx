@@ -28,6 +28,7 @@ using std::ostringstream;
 #include "Column.h"
 
 #include "FITS.h"
+#include "FITSBase.h"
 #include "fitsio.h"
 #include "ColumnData.h"
 #include "ColumnVectorData.h"
@@ -277,6 +278,16 @@ namespace CCfits {
   return m_parent->rows();   
   }
 
+  bool Column::directRead () const
+  {
+    return m_parent->parent()->directRead();
+  }
+
+  bool Column::directWrite () const
+  {
+    return m_parent->parent()->directWrite();
+  }
+
   void Column::setDisplay ()
   {
 #ifdef SSTREAM_DEFECT
@@ -999,7 +1010,7 @@ namespace CCfits {
                   // conversion request to deal with.
 
                   if (!isRead()) col->readRow(row);
-                  FITSUtil::fill(vals,col->data(row));
+                  FITSUtil::fill(vals,col->dataView(row));
           }
           else
           {
@@ -1019,7 +1030,7 @@ namespace CCfits {
                             ColumnVectorData<std::complex<double> >& col 
                                  = dynamic_cast<ColumnVectorData<std::complex<double> >&>(*this);
                             if (!isRead()) col.readRow(row);                                  
-                            FITSUtil::fill(vals,col.data(row));
+                            FITSUtil::fill(vals,col.dataView(row));
 
                        }
                        catch (std::bad_cast)
@@ -1053,7 +1064,7 @@ namespace CCfits {
                   // conversion request to deal with.
 
                   if (!isRead()) col->readRow(row);
-                  FITSUtil::fill(vals,col->data(row));
+                  FITSUtil::fill(vals,col->dataView(row));
           }
           else
           {
@@ -1073,7 +1084,7 @@ namespace CCfits {
                             ColumnVectorData<std::complex<float> >& col 
                                  = dynamic_cast<ColumnVectorData<std::complex<float> >&>(*this);
                             if (!isRead()) col.readRow(row);                                  
-                            FITSUtil::fill(vals,col.data(row));
+                            FITSUtil::fill(vals,col.dataView(row));
 
                        }
                        catch (std::bad_cast)
@@ -1097,7 +1108,7 @@ namespace CCfits {
                   // fails if user requested outputType different from input type.
 
                   if (!isRead()) col->readRow(row);
-                  FITSUtil::fill(vals,col->data(row));
+                  FITSUtil::fill(vals,col->dataView(row));
           }
           else
           {
@@ -1117,7 +1128,7 @@ namespace CCfits {
                             ColumnVectorData<std::complex<double> >& col 
                                  = dynamic_cast<ColumnVectorData<std::complex<double> >&>(*this);
                             if (!isRead()) col.readRow(row);                                  
-                            FITSUtil::fill(vals,col.data(row));
+                            FITSUtil::fill(vals,col.dataView(row));
 
                        }
                        catch (std::bad_cast)
@@ -1143,7 +1154,7 @@ namespace CCfits {
                   // fails if user requested outputType different from input type.
 
                   if (!isRead()) col->readRow(row);
-                  FITSUtil::fill(vals,col->data(row));
+                  FITSUtil::fill(vals,col->dataView(row));
           }
           else
           {
@@ -1163,7 +1174,7 @@ namespace CCfits {
                             ColumnVectorData<std::complex<float> >& col 
                                  = dynamic_cast<ColumnVectorData<std::complex<float> >&>(*this);
                             if (!isRead()) col.readRow(row);                                  
-                            FITSUtil::fill(vals,col.data(row));
+                            FITSUtil::fill(vals,col.dataView(row));
 
                        }
                        catch (std::bad_cast)
@@ -1195,7 +1206,7 @@ namespace CCfits {
                         for (int j = 0; j < range; ++j) 
                         {
                                 if (!isRead()) col->readRow(j + first);                             
-                                FITSUtil::fill(vals[j],col->data(j+first));
+                                FITSUtil::fill(vals[j],col->dataView(j+first));
                         }
                 }
                 else
@@ -1215,7 +1226,7 @@ namespace CCfits {
                                  for (int j = 0; j < range; ++j) 
                                  {
                                      if (!isRead()) col.readRow(j + first); 
-                                     FITSUtil::fill(vals[j],col.data(j+first));
+                                     FITSUtil::fill(vals[j],col.dataView(j+first));
                                  }
 
                         }
@@ -1249,7 +1260,7 @@ namespace CCfits {
                         for (int j = 0; j < range; ++j) 
                         {
                                 if (!isRead()) col->readRow(j + first);                             
-                                FITSUtil::fill(vals[j],col->data(j+first));
+                                FITSUtil::fill(vals[j],col->dataView(j+first));
                         }
                 }
                 else
@@ -1269,7 +1280,7 @@ namespace CCfits {
                                  for (int j = 0; j < range; ++j) 
                                  {
                                      if (!isRead()) col.readRow(j + first); 
-                                     FITSUtil::fill(vals[j],col.data(j+first));
+                                     FITSUtil::fill(vals[j],col.dataView(j+first));
                                  }
 
                         }
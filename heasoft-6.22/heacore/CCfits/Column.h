@@ -318,6 +318,30 @@ namespace CCfits {
 
 */
 
+/*!  \fn  template <typename S> void Column::read(S* vals, long first, long last) ;
+
+        \brief Retrieve data from a scalar column directly into an array
+
+        The data are converted by cfitsio straight into <i>vals</i>, bypassing
+        the Column object's internal data: nothing is cached, so this is the
+        cheapest way to read a very large column in pieces. See also
+        FITS::setDirectRead.
+
+        \param vals The output array, which must hold at least last - first + 1
+        values.
+        \param first,last the span of row numbers to read.
+*/
+
+/*!  \fn  template <typename S> void Column::read(S* vals, long first, long last, S* nullValue) ;
+
+        \brief Retrieve data from a scalar column directly into an array, applying nullValue when relevant.
+
+        \param vals The output array, which must hold at least last - first + 1
+        values.
+        \param first,last the span of row numbers to read.
+        \param nullValue pointer to value to be applied to undefined elements.
+*/
+
 /*!  \fn    template <typename S> void Column::readArrays(std::vector<std::valarray<S> >& vals, long first,long last);
 
         \brief return a set of rows of a vector column into a vector of valarrays
@@ -395,7 +419,7 @@ namespace CCfits {
 
 
 
-/*!   \fn  template <typename S> void Column::write(S* indata, long nRows, long firstRow);
+/*!   \fn  template <typename S> void Column::write(const S* indata, long nRows, long firstRow);
 
       \brief write a C array of size nRows into a scalar Column starting with row firstRow.
 
@@ -403,12 +427,15 @@ namespace CCfits {
       \param nRows    The size of the data array to be written
       \param firstRow The first row to be written
 
+      If S is the type of the column, or the file has direct writes set (see
+      FITS::setDirectWrite), indata is passed to cfitsio without being copied.
+
 
 */
 
 
 
-/*!   \fn  template <typename S> void Column::write(S* indata, long nRows, long firstRow,  S* nullValue);
+/*!   \fn  template <typename S> void Column::write(const S* indata, long nRows, long firstRow,  S* nullValue);
 
       \brief write a C array into a scalar Column, processing undefined values.
 
@@ -470,11 +497,13 @@ namespace CCfits {
 
 */
 
-/*!   \fn   template <typename S>  void Column::write (S* indata, long nElements, long nRows, long firstRow);
+/*!   \fn   template <typename S>  void Column::write (const S* indata, long nElements, long nRows, long firstRow);
 
         \brief write a C array of values into a range of rows of a vector column
 
         Details are as for vector input; only difference is the need to supply the size of the C-array. 
+        For a fixed width column, indata is passed to cfitsio without being copied if S is the type
+        of the column, or if the file has direct writes set (see FITS::setDirectWrite).
 
       \param indata    The data to be written.
       \param nElements The size of indata
@@ -483,7 +512,7 @@ namespace CCfits {
 
 */
 
-/*!   \fn   template <typename S> void Column::write (S* indata, long nElements, long nRows, long firstRow, S* nullValue);
+/*!   \fn   template <typename S> void Column::write (const S* indata, long nElements, long nRows, long firstRow, S* nullValue);
 
         \brief write a C array of values into a range of rows of a vector column, processing undefined values.
 
@@ -526,7 +555,7 @@ namespace CCfits {
 
 */
 
-/*!   \fn   template <typename S>  void Column::write (S* indata, long nElements,  
+/*!   \fn   template <typename S>  void Column::write (const S* indata, long nElements,  
                         const std::vector<long>& vectorLengths, 
                         long firstRow);
 
@@ -1025,7 +1054,7 @@ namespace CCfits {
         void write (const std::valarray<std::complex<double> >& indata, long firstRow);
 
         template <typename S>                   
-        void write (S* indata, long nRows, long firstRow);
+        void write (const S* indata, long nRows, long firstRow);
 
 
         template <typename S>                   
@@ -1035,7 +1064,7 @@ namespace CCfits {
         void write (const std::valarray<S>& indata, long firstRow, S* nullValue);
 
         template <typename S>                   
-        void write (S* indata, long nRows, long firstRow, S* nullValue);        
+        void write (const S* indata, long nRows, long firstRow, S* nullValue);        
         // vector column interface. We provide an interface that allows input of a vector, valarray and C-array.
 	// there are versions that write variable numbers of elements per row as specified
         // in the vectorLengths argument. The user also can directly write a vector<valarray<T> >
@@ -1063,7 +1092,7 @@ namespace CCfits {
 
 
         template <typename S>
-        void write (S* indata, long nElements, long nRows, long firstRow);
+        void write (const S* indata, long nElements, long nRows, long firstRow);
 
 
         template <typename S>
@@ -1074,7 +1103,7 @@ namespace CCfits {
         void write (const std::vector<S>& indata, long nRows, long firstRow, S* nullValue);
 
         template <typename S>
-        void write (S* indata, long nElements, long nRows, long firstRow, S* nullValue);
+        void write (const S* indata, long nElements, long nRows, long firstRow, S* nullValue);
 
         // variable-length write to vector column from valarray or vector.
 
@@ -1107,7 +1136,7 @@ namespace CCfits {
                         long firstRow);
 
         template <typename S>
-        void write (S* indata, long nElements,  
+        void write (const S* indata, long nElements,  
                         const std::vector<long>& vectorLengths, 
                         long firstRow);
 
@@ -1153,6 +1182,14 @@ namespace CCfits {
         void read(std::vector<std::complex<float> >& vals, long rows) ;
         void read(std::vector<std::complex<double> >& vals, long rows) ;
 
+        // get a set of rows from a scalar column straight into an array
+        // of last - first + 1 values, without using the column's data.
+        template <typename S>
+        void read(S* vals, long first, long last) ;
+
+        template <typename S>
+        void read(S* vals, long first, long last, S* nullValue) ;
+
         // get a set of rows from a vector column.
         template <typename S>
         void readArrays(std::vector<std::valarray<S> >& vals, long first, long last) ;
@@ -1240,6 +1277,31 @@ namespace CCfits {
         virtual void insertRows (long first, long number = 1) = 0;
         virtual void deleteRows (long first, long number = 1) = 0;
         static void loadColumnKeys ();
+        // read rows of a scalar column from the file straight into the
+        // caller's storage, leaving the column's data unfilled.
+        template <typename S>
+        void readDirect (S* vals, long first, long nelements, S* nullValue);
+        template <typename S>
+        void readDirect (std::vector<S>& vals, long first, long nelements, S* nullValue);
+        void readDirect (std::vector<bool>& vals, long first, long nelements, bool* nullValue);
+        template <typename S>
+        void readDirect (std::valarray<S>& vals, long first, long nelements, S* nullValue);
+        bool directRead () const;
+        // write nRows whole rows of a scalar or fixed width column straight
+        // from the caller's storage, leaving the column's data alone. Does
+        // nothing and returns false unless direct writes are set and the
+        // column's data have not been read.
+        template <typename S>
+        bool writeDirect (const S* indata, long nelements, long nRows, long firstRow, S* nullValue);
+        template <typename S>
+        bool writeDirect (const std::vector<S>& indata, long nRows, long firstRow, S* nullValue);
+        bool writeDirect (const std::vector<bool>& indata, long nRows, long firstRow, bool* nullValue);
+        // write whole rows of a fixed width column from a C array without
+        // copying it, either directly or through a column of type S.
+        // Returns false if neither applies.
+        template <typename S>
+        bool writeFixedRows (const S* indata, long nelements, long nRows, long firstRow, S* nullValue);
+        bool directWrite () const;
         void name (const String& value);
         void format (const String& value);
         long numberOfElements (long& first, long& last);
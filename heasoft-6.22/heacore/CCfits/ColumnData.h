@@ -290,8 +290,11 @@ namespace CCfits {
           // rows() in the parent after the fitsio call.
           int status(0);
           long elementsToWrite(nRows + firstRow -1);
-          // get a copy for restorative action.   
-          std::vector<T> __tmp(m_data);
+          // get a copy of the overwritten rows for restorative action.   
+          const size_t oldSize(m_data.size());
+          const size_t first(firstRow - 1);
+          std::vector<T> __tmp(m_data.begin() + std::min(first,oldSize),
+                          m_data.begin() + std::min(first + nRows,oldSize));
 
 
           if (elementsToWrite > static_cast<long>(m_data.size())) 
@@ -323,7 +326,8 @@ namespace CCfits {
           catch (FitsError) // the only thing that can throw here.
           {
                   // reset to original content and rethrow the exception.
-                  m_data = __tmp;
+                  std::copy(__tmp.begin(),__tmp.end(),m_data.begin()+first);
+                  m_data.resize(oldSize);
                   if (status == NO_NULL) throw NoNullValue(name());
                   else throw;
           }      
@@ -53,6 +53,12 @@ namespace CCfits
            parent()->makeThisCurrent();
            long nelements = numberOfElements(first,last);
 
+           if (!isRead() && directRead())
+           {
+                   readDirect(vals,first,nelements,nullValue);
+                   return;
+           }
+
            if  (ColumnData<S>* col = dynamic_cast<ColumnData<S>*>(this))
            {
                    // fails if user requested outputType different from input type.
@@ -192,6 +198,66 @@ namespace CCfits
 
    }
 
+   template <typename S>
+   void Column::read(S* vals, long first, long last) 
+   {
+           read(vals,first,last,static_cast<S*>(0));
+   }
+
+
+   template <typename S>
+   void Column::read(S* vals, long first, long last, S* nullValue) 
+   {
+           parent()->makeThisCurrent();
+           long nelements = numberOfElements(first,last);
+           readDirect(vals,first,nelements,nullValue);
+   }
+
+
+   template <typename S>
+   void Column::readDirect(S* vals, long first, long nelements, S* nullValue) 
+   {
+           // cfitsio converts from the column's type to S, so neither the
+           // column's data nor a temporary copy is needed. Only scalar
+           // columns qualify, as in the reads through the cached data.
+           if (type() == Tstring) throw InvalidDataType(name());
+           if (varLength() || repeat() != 1) throw WrongColumnType(name());
+
+           FITSUtil::MatchType<S> outputType;
+           int status(0);
+           int anynul(0);
+
+           makeHDUCurrent();
+           if (fits_read_col(fitsPointer(), outputType(), index(), first, 1,
+                   nelements, nullValue, vals, &anynul, &status)) throw FitsError(status);
+   }
+
+
+   template <typename S>
+   void Column::readDirect(std::vector<S>& vals, long first, long nelements, S* nullValue) 
+   {
+           vals.resize(nelements);
+           readDirect(&vals[0],first,nelements,nullValue);
+   }
+
+
+   inline void Column::readDirect(std::vector<bool>& vals, long first, long nelements, bool* nullValue) 
+   {
+           // std::vector<bool> has no contiguous storage to read into.
+           FITSUtil::auto_array_ptr<bool> array(new bool[nelements]);
+           readDirect(array.get(),first,nelements,nullValue);
+           vals.assign(&array[0],&array[nelements]);
+   }
+
+
+   template <typename S>
+   void Column::readDirect(std::valarray<S>& vals, long first, long nelements, S* nullValue) 
+   {
+           if (vals.size() != static_cast<size_t>(nelements)) vals.resize(nelements);
+           readDirect(&vals[0],first,nelements,nullValue);
+   }
+
+
    template <typename S>
    void Column::read(std::valarray<S>& vals, long first, long last) 
    {
@@ -207,6 +273,12 @@ namespace CCfits
 
            long nelements = numberOfElements(first,last);
            parent()->makeThisCurrent();                
+           if (!isRead() && directRead())
+           {
+                   readDirect(vals,first,nelements,nullValue);
+                   return;
+           }
+
            if ( ColumnData<S>* col = dynamic_cast<ColumnData<S>*>(this))
            {
                    // fails if user requested outputType different from input type.
@@ -376,7 +448,7 @@ namespace CCfits
 
 
                    if (!isRead()) col->readRow(row,nullValue);
-                   FITSUtil::fill(vals,col->data(row));
+                   FITSUtil::fill(vals,col->dataView(row));
            }
            else
            {
@@ -405,7 +477,7 @@ namespace CCfits
                                ColumnVectorData<double>& col 
                                          = dynamic_cast<ColumnVectorData<double>&>(*this);
                                if (!isRead()) col.readRow(row);                                  
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 
                        }
 		       else if (type() == Tfloat  || type() == VTfloat )
@@ -413,7 +485,7 @@ namespace CCfits
                                ColumnVectorData<float>& col 
                                      = dynamic_cast<ColumnVectorData<float>&>(*this);
                                if (!isRead()) col.readRow(row); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tint  || type() == VTint )
 		       {
@@ -422,7 +494,7 @@ namespace CCfits
                                ColumnVectorData<int>& col  
                                        = dynamic_cast<ColumnVectorData<int>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 		       }
 		       else if (type() == Tshort  || type() == VTshort  )
                        {
@@ -431,7 +503,7 @@ namespace CCfits
                                ColumnVectorData<short>& col 
                                        = dynamic_cast<ColumnVectorData<short>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tlong  || type() == VTlong )
 		       {	
@@ -440,7 +512,7 @@ namespace CCfits
                                ColumnVectorData<long>& col 
                                        = dynamic_cast<ColumnVectorData<long>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tlonglong  || type() == VTlonglong )
 		       {	
@@ -449,7 +521,7 @@ namespace CCfits
                                ColumnVectorData<LONGLONG>& col 
                                        = dynamic_cast<ColumnVectorData<LONGLONG>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tlogical  || type() == VTlogical )
 		       {	
@@ -458,7 +530,7 @@ namespace CCfits
                                ColumnVectorData<bool>& col 
                                        = dynamic_cast<ColumnVectorData<bool>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 		       }
 		       else if (type() == Tbit || type() == Tbyte ||  
                                type() == VTbit || type() == VTbyte )
@@ -469,7 +541,7 @@ namespace CCfits
                                ColumnVectorData<unsigned char>& col 
                                      = dynamic_cast<ColumnVectorData<unsigned char>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tushort || type() == VTushort)
                        {
@@ -479,7 +551,7 @@ namespace CCfits
                                ColumnVectorData<unsigned short>& col 
                                      = dynamic_cast<ColumnVectorData<unsigned short>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tuint || type() == VTuint)
                        {
@@ -489,7 +561,7 @@ namespace CCfits
                                ColumnVectorData<unsigned int>& col 
                                      = dynamic_cast<ColumnVectorData<unsigned int>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 		       }
 		       else if (type() == Tulong || type() == VTulong)
                        {
@@ -499,7 +571,7 @@ namespace CCfits
                                ColumnVectorData<unsigned long>& col 
                                        = dynamic_cast<ColumnVectorData<unsigned long>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else
                        {
@@ -537,7 +609,7 @@ namespace CCfits
                    // conversion request to deal with.
 
                    if (!isRead()) col->readRow(row,nullValue);
-                   FITSUtil::fill(vals,col->data(row));
+                   FITSUtil::fill(vals,col->dataView(row));
            }
            else
            {
@@ -566,7 +638,7 @@ namespace CCfits
                                ColumnVectorData<double>& col 
                                          = dynamic_cast<ColumnVectorData<double>&>(*this);
                                if (!isRead()) col.readRow(row);                                  
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 
                        }
 		       else if (type() == Tfloat  || type() == VTfloat )
@@ -574,7 +646,7 @@ namespace CCfits
                                ColumnVectorData<float>& col 
                                      = dynamic_cast<ColumnVectorData<float>&>(*this);
                                if (!isRead()) col.readRow(row); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tint  || type() == VTint )
 		       {
@@ -583,7 +655,7 @@ namespace CCfits
                                ColumnVectorData<int>& col  
                                        = dynamic_cast<ColumnVectorData<int>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 		       }
 		       else if (type() == Tshort  || type() == VTshort  )
                        {
@@ -592,7 +664,7 @@ namespace CCfits
                                ColumnVectorData<short>& col 
                                        = dynamic_cast<ColumnVectorData<short>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tlong  || type() == VTlong )
 		       {	
@@ -601,7 +673,7 @@ namespace CCfits
                                ColumnVectorData<long>& col 
                                        = dynamic_cast<ColumnVectorData<long>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tlonglong  || type() == VTlonglong )
 		       {	
@@ -610,7 +682,7 @@ namespace CCfits
                                ColumnVectorData<LONGLONG>& col 
                                        = dynamic_cast<ColumnVectorData<LONGLONG>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tlogical  || type() == VTlogical )
 		       {	
@@ -619,7 +691,7 @@ namespace CCfits
                                ColumnVectorData<bool>& col 
                                        = dynamic_cast<ColumnVectorData<bool>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 		       }
 		       else if (type() == Tbit || type() == Tbyte ||  
                                type() == VTbit || type() == VTbyte )
@@ -630,7 +702,7 @@ namespace CCfits
                                ColumnVectorData<unsigned char>& col 
                                      = dynamic_cast<ColumnVectorData<unsigned char>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tushort || type() == VTushort)
                        {
@@ -640,7 +712,7 @@ namespace CCfits
                                ColumnVectorData<unsigned short>& col 
                                      = dynamic_cast<ColumnVectorData<unsigned short>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else if (type() == Tuint || type() == VTuint)
                        {
@@ -650,7 +722,7 @@ namespace CCfits
                                ColumnVectorData<unsigned int>& col 
                                      = dynamic_cast<ColumnVectorData<unsigned int>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
 		       }
 		       else if (type() == Tulong || type() == VTulong)
                        {
@@ -660,7 +732,7 @@ namespace CCfits
                                ColumnVectorData<unsigned long>& col 
                                        = dynamic_cast<ColumnVectorData<unsigned long>&>(*this);
                                if (!isRead()) col.readRow(row,&nullVal); 
-                               FITSUtil::fill(vals,col.data(row));
+                               FITSUtil::fill(vals,col.dataView(row));
                        }
 		       else
                        {
@@ -701,7 +773,7 @@ namespace CCfits
                    for (int j = 0; j < range; ++j) 
                    {
                            if (!isRead()) col->readRow(j + first,nullValue);                             
-                           FITSUtil::fill(vals[j],col->data(j+first));
+                           FITSUtil::fill(vals[j],col->dataView(j+first));
                    }
            }
            else
@@ -724,7 +796,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tfloat || type() == VTfloat  )
@@ -734,7 +806,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tint   || type() == VTint )
@@ -746,7 +818,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tshort  || type() == VTshort )
@@ -758,7 +830,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tlong   || type() == VTlong )
@@ -770,7 +842,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tlonglong   || type() == VTlonglong )
@@ -782,7 +854,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tlogical   || type() == VTlogical )
@@ -794,7 +866,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
 		       else if (type() == Tbit || type() == Tbyte ||  
@@ -808,7 +880,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
 			       }
                        }                            
                        else if  ( type() == Tushort   || type() == VTushort )
@@ -821,7 +893,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tuint   || type() == VTuint )
@@ -834,7 +906,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        }
                        else if  ( type() == Tulong   || type() == VTulong  )
@@ -847,7 +919,7 @@ namespace CCfits
                                for (int j = 0; j < range; ++j) 
                                {
                                    if (!isRead()) col.readRow(j + first,&nullVal); 
-                                   FITSUtil::fill(vals[j],col.data(j+first));
+                                   FITSUtil::fill(vals[j],col.dataView(j+first));
                                }
                        } 
                        else
@@ -884,7 +956,7 @@ namespace CCfits
    }
 
    template <typename S>                   
-   void Column::write (S* indata, long nRows, long firstRow)
+   void Column::write (const S* indata, long nRows, long firstRow)
    {
       write(indata,nRows,firstRow,static_cast<S*>(0));                
    }
@@ -902,6 +974,7 @@ namespace CCfits
 
       parent()->makeThisCurrent();
       firstRow = std::max(firstRow,static_cast<long>(1));
+      if (writeDirect(indata,static_cast<long>(indata.size()),firstRow,nullValue)) return;
       if (ColumnData<S>* col = dynamic_cast<ColumnData<S>*>(this))
       {
          col->writeData(indata,firstRow,nullValue);
@@ -1085,16 +1158,29 @@ namespace CCfits
    void Column::write (const std::valarray<S>& indata, long firstRow, S* nullValue)
    {
       // for scalar columns.        
+      const long n = static_cast<long>(indata.size());
+      if (n > 0 && writeDirect(&const_cast<std::valarray<S>&>(indata)[0],n,n,firstRow,nullValue))
+         return;
       std::vector<S> __tmp;
       FITSUtil::fill(__tmp,indata);    
       write(__tmp,firstRow,nullValue);          
    }
 
    template <typename S>                   
-   void Column::write (S* indata, long nRows, long firstRow, S* nullValue)
+   void Column::write (const S* indata, long nRows, long firstRow, S* nullValue)
    {
       // for scalar columns, data specified with C array
       if (nRows <= 0) throw InvalidNumberOfRows(nRows);
+      if (writeDirect(indata,nRows,nRows,firstRow,nullValue)) return;
+      ColumnData<S>* col = dynamic_cast<ColumnData<S>*>(this);
+      if (col && type() != Tstring && type() != Tcomplex && type() != Tdblcomplex)
+      {
+         // the column is of type S: write the array as it is.
+         parent()->makeThisCurrent();
+         firstRow = std::max(firstRow,static_cast<long>(1));
+         col->writeData(const_cast<S*>(indata),nRows,firstRow,nullValue);
+         return;
+      }
       std::vector<S> __tmp(nRows);
       std::copy(&indata[0],&indata[nRows],__tmp.begin());
       write(__tmp,firstRow, nullValue);
@@ -1159,7 +1245,7 @@ void Column::write (const std::vector<S>& indata,const std::vector<long>& vector
    }
 
    template <typename S>
-   void Column::write (S* indata, long nelements, const std::vector<long>& vectorLengths,
+   void Column::write (const S* indata, long nelements, const std::vector<long>& vectorLengths,
                                    long firstRow)
    {
       // implement as valarray version, which will also check array size.
@@ -1180,7 +1266,7 @@ void Column::write (const std::vector<S>& indata,const std::vector<long>& vector
    }
 
    template <typename S>
-   void Column::write (S* indata, long nelements, long nRows, long firstRow)
+   void Column::write (const S* indata, long nelements, long nRows, long firstRow)
    {
       write(indata,nelements,nRows,firstRow,static_cast<S*>(0));              
    }        
@@ -1198,6 +1284,9 @@ void Column::write (const std::vector<S>& indata,const std::vector<long>& vector
       if (nRows <= 0)
          throw InvalidNumberOfRows(nRows);
       firstRow = std::max(firstRow,static_cast<long>(1));
+      if (indata.size() && writeFixedRows(&const_cast<std::valarray<S>&>(indata)[0],
+                static_cast<long>(indata.size()),nRows,firstRow,nullValue))
+         return;
 #ifdef SSTREAM_DEFECT
       std::ostrstream msgStr;
 #else
@@ -1237,22 +1326,85 @@ void Column::write (const std::vector<S>& indata,const std::vector<long>& vector
       // fixed length write of vector
       // implement as valarray version
       if (nRows <= 0) throw InvalidNumberOfRows(nRows);
+      if (writeDirect(indata,nRows,firstRow,nullValue)) return;
       std::valarray<S> __tmp(indata.size());
       std::copy(indata.begin(),indata.end(),&__tmp[0]);
       write(__tmp,nRows,firstRow, nullValue);  
    }
 
    template <typename S>
-   void Column::write (S* indata, long nelements, long nRows, long firstRow, S* nullValue)
+   void Column::write (const S* indata, long nelements, long nRows, long firstRow, S* nullValue)
    {
       // fixed length write of C-array
-      // implement as valarray version
+      // implement as valarray version unless the array can be written as it is.
       if (nRows <= 0) throw InvalidNumberOfRows(nRows);
+      if (writeFixedRows(indata,nelements,nRows,firstRow,nullValue)) return;
       std::valarray<S> __tmp(indata,nelements);
       write(__tmp,nRows,firstRow, nullValue);              
    }        
 
 
+   template <typename S>
+   bool Column::writeDirect (const S* indata, long nelements, long nRows, long firstRow, S* nullValue)
+   {
+      // cfitsio converts from S to the column's type, so the data need
+      // not be copied. Data already read into the column must be kept
+      // up to date, so these columns are written through it as before.
+      if (isRead() || !directWrite()) return false;
+      if (type() == Tstring || varLength()) return false;
+      if (nRows <= 0 || nelements != nRows*static_cast<long>(repeat())) return false;
+      FITSUtil::MatchType<S> inputType;
+      if (inputType() == Tstring) return false;
+
+      int status(0);
+      firstRow = std::max(firstRow,static_cast<long>(1));
+      makeHDUCurrent();
+      if (nullValue)
+      {
+         fits_write_colnull(fitsPointer(), inputType(), index(), firstRow, 1, nelements,
+                 const_cast<S*>(indata), nullValue, &status);
+      }
+      else
+      {
+         fits_write_col(fitsPointer(), inputType(), index(), firstRow, 1, nelements,
+                 const_cast<S*>(indata), &status);
+      }
+      if (status == NO_NULL) throw NoNullValue(name());
+      if (status) throw FitsError(status);
+
+      parent()->updateRows();
+      return true;
+   }
+
+   template <typename S>
+   bool Column::writeDirect (const std::vector<S>& indata, long nRows, long firstRow, S* nullValue)
+   {
+      if (indata.empty()) return false;
+      return writeDirect(&indata[0],static_cast<long>(indata.size()),nRows,firstRow,nullValue);
+   }
+
+   inline bool Column::writeDirect (const std::vector<bool>& indata, long nRows, long firstRow, bool* nullValue)
+   {
+      // std::vector<bool> has no contiguous storage to write from.
+      if (indata.empty() || isRead() || !directWrite()) return false;
+      const size_t n = indata.size();
+      FITSUtil::auto_array_ptr<bool> array(new bool[n]);
+      std::copy(indata.begin(),indata.end(),array.get());
+      return writeDirect(array.get(),static_cast<long>(n),nRows,firstRow,nullValue);
+   }
+
+   template <typename S>
+   bool Column::writeFixedRows (const S* indata, long nelements, long nRows, long firstRow, S* nullValue)
+   {
+      if (writeDirect(indata,nelements,nRows,firstRow,nullValue)) return true;
+
+      ColumnVectorData<S>* col = dynamic_cast<ColumnVectorData<S>*>(this);
+      if (!col || varLength() || nelements != nRows*static_cast<long>(repeat())) return false;
+      parent()->makeThisCurrent();
+      col->writeData(indata,nRows,std::max(firstRow,static_cast<long>(1)),nullValue);
+      return true;
+   }
+
    template <typename S>
    void Column::writeArrays (const std::vector<std::valarray<S> >& indata, long firstRow)
    {
@@ -22,77 +22,14 @@ namespace CCfits
         {
             int   status=0;
             float nulval (0);
-            FITSUtil::auto_array_ptr<float> pArray(new float[2*nelements]); 
-            float*     array = pArray.get();
             int    anynul(0);
 
-            if (fits_read_col_cmp(fitsPointer(),index(),firstRow, firstElem,
-                            nelements,nulval,array,&anynul,&status) ) throw FitsError(status);
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-
-            std::valarray<std::complex<float> > readData(nelements);
-            for (long j = 0; j < nelements; ++j)
-            {
-                    readData[j] = std::complex<float>(array[2*j],array[2*j+1]);
-            }
-            size_t countRead = 0;
-            const size_t ONE = 1;
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-            size_t vectorSize(0);
-            if (!varLength())
-            {
-                 vectorSize = std::max(repeat(),ONE); // safety check.
-            }
-            else
-            {
-                 // assume that the user specified the correct length for 
-                 // variable columns. This should be ok since readVariableColumns
-                 // uses fits_read_descripts to return this information from the
-                 // fits pointer, and this is passed as nelements here.
-                 vectorSize = nelements;       
-            }
-            size_t n = nelements; 
-
-            int i = firstRow;
-            int ii = i - 1;
-            while ( countRead < n)
-            {
-                    std::valarray<complex<float> >& current = m_data[ii];
-                    if (current.size() != vectorSize) current.resize(vectorSize,0.);
-                    int elementsInFirstRow = vectorSize-firstElem + 1;
-                    bool lastRow = ( (nelements - countRead) < vectorSize);
-                    if (lastRow)
-                    {
-                            int elementsInLastRow = nelements - countRead;
-                            std::copy(&readData[countRead],&readData[0]+nelements,&current[0]);
-                            countRead += elementsInLastRow;
-                    }             
-                    // what to do with complete rows. if firstElem == 1 the 
-                    else 
-                    {
-                            if (firstElem == 1 || (firstElem > 1 && i > firstRow) )
-                            {
-                                    current = readData[std::slice(vectorSize*(ii-firstRow)+
-                                                               elementsInFirstRow,vectorSize,1)];
-			            ++ii;
-			            ++i;
-                                    countRead += vectorSize;   
-                            }   
-                            else
-                            { 
-                                    if (i == firstRow)
-                                    {
-                                            std::copy(&readData[0],&readData[0]+elementsInFirstRow,
-                                                                            &current[firstElem]);
-                                            countRead += elementsInFirstRow;
-                                            ++i;
-                                            ++ii;
-                                    }
-                            }
-                    }
-            }
+            // the elements are read directly into the column storage; a
+            // complex<float> has the layout of a pair of floats.
+            std::complex<float>* array = readBuffer(firstRow, nelements, firstElem);
+
+            if (nelements > 0 && fits_read_col_cmp(fitsPointer(),index(),firstRow, firstElem,
+                            nelements,nulval,reinterpret_cast<float*>(array),&anynul,&status) ) throw FitsError(status);
     }
 
 #ifndef SPEC_TEMPLATE_DECL_DEFECT
@@ -124,77 +61,14 @@ void ColumnVectorData<complex<double> >::setDataLimits (complex<double>* limits)
         // actual compiler deficiencies.
             int   status=0;
             double nulval (0);
-            FITSUtil::auto_array_ptr<double> pArray(new double[2*nelements]); 
-            double*     array = pArray.get();
             int    anynul(0);
 
-            if (fits_read_col_dblcmp(fitsPointer(),index(),firstRow, firstElem,
-                            nelements,nulval,array,&anynul,&status) ) throw FitsError(status);
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-
-            std::valarray<std::complex<double> > readData(nelements);
-            for (long j = 0; j < nelements; ++j)
-            {
-                    readData[j] = std::complex<double>(array[2*j],array[2*j+1]);
-            }
-            size_t countRead = 0;
-            const size_t ONE = 1;
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-            size_t vectorSize(0);
-            if (!varLength())
-            {
-                 vectorSize = std::max(repeat(),ONE); // safety check.
-            }
-            else
-            {
-                 // assume that the user specified the correct length for 
-                 // variable columns. This should be ok since readVariableColumns
-                 // uses fits_read_descripts to return this information from the
-                 // fits pointer, and this is passed as nelements here.
-                 vectorSize = nelements;       
-            }
-            size_t n = nelements; 
-
-            int i = firstRow;
-            int ii = i - 1;
-            while ( countRead < n)
-            {
-                    std::valarray<std::complex<double> >& current = m_data[ii];
-                    if (current.size() != vectorSize) current.resize(vectorSize,0.);
-                    int elementsInFirstRow = vectorSize-firstElem + 1;
-                    bool lastRow = ( (nelements - countRead) < vectorSize);
-                    if (lastRow)
-                    {
-                            int elementsInLastRow = nelements - countRead;
-                            std::copy(&readData[countRead],&readData[0]+nelements,&current[0]);
-                            countRead += elementsInLastRow;
-                    }             
-                    // what to do with complete rows. if firstElem == 1 the 
-                    else 
-                    {
-                            if (firstElem == 1 || (firstElem > 1 && i > firstRow) )
-                            {
-                                    current = readData[std::slice(vectorSize*(ii-firstRow)+
-                                                               elementsInFirstRow,vectorSize,1)];
-			            ++ii;
-			            ++i;
-                                    countRead += vectorSize;   
-                            }   
-                            else
-                            { 
-                                    if (i == firstRow)
-                                    {
-                                            std::copy(&readData[0],&readData[0]+elementsInFirstRow,
-                                                                            &current[firstElem]);
-                                            countRead += elementsInFirstRow;
-                                            ++i;
-                                            ++ii;
-                                    }
-                            }
-                    }
-            }
+            // the elements are read directly into the column storage; a
+            // complex<double> has the layout of a pair of doubles.
+            std::complex<double>* array = readBuffer(firstRow, nelements, firstElem);
+
+            if (nelements > 0 && fits_read_col_dblcmp(fitsPointer(),index(),firstRow, firstElem,
+                            nelements,nulval,reinterpret_cast<double*>(array),&anynul,&status) ) throw FitsError(status);
     }
 
         template <>
@@ -67,10 +67,20 @@ namespace CCfits {
         void minDataValue (T value);
         const T maxDataValue () const;
         void maxDataValue (T value);
-        const std::vector<std::valarray<T> >& data () const;
+        //	Returns a copy of every row of the column.  This makes
+        //	one std::valarray per row; use dataView to read rows
+        //	in place.
+        std::vector<std::valarray<T> > data () const;
         void setData (const std::vector<std::valarray<T> >& value);
-        const std::valarray<T>& data (int i) const;
+        //	Returns a copy of row i.  Deprecated: the cells are kept
+        //	in one array, so this allocates and copies on each call.
+        //	Use dataView instead.
+        std::valarray<T> data (int i) const;
         void data (int i, const std::valarray<T>& value);
+        //	Returns a read-only view of row i, without copying.  The
+        //	view is invalidated by any operation that modifies the
+        //	column.
+        FITSUtil::ArrayView<T> dataView (int i) const;
 
       // Additional Public Declarations
         friend class Column;
@@ -91,6 +101,9 @@ namespace CCfits {
         virtual std::ostream& put (std::ostream& s) const;
         void writeData (const std::valarray<T>& indata, long numRows, long firstRow = 1, T* nullValue = 0);
         void writeData (const std::vector<std::valarray<T> >& indata, long firstRow = 1, T* nullValue = 0);
+        //	Writes numRows whole rows of a fixed width column from a
+        //	C array of numRows*repeat() elements.
+        void writeData (const T* indata, long numRows, long firstRow, T* nullValue = 0);
         //	Reads a specified number of column rows.
         //
         //	There are no default arguments. The function
@@ -107,6 +120,13 @@ namespace CCfits {
         virtual void insertRows (long first, long number = 1);
         virtual void deleteRows (long first, long number = 1);
         void doWrite (T* array, long row, long rowSize, long firstElem, T* nullValue);
+        T* rowData (size_t row) const;
+        void resizeRows (size_t nRows);
+        void resizeRow (size_t row, size_t n);
+        //	Sizes the rows covered by a read of nelements starting
+        //	at (firstrow, firstelem) and returns where they go.
+        T* readBuffer (long firstrow, long nelements, long firstelem);
+        void reserveData (size_t extra);
 
       // Additional Private Declarations
 
@@ -118,7 +138,17 @@ namespace CCfits {
         T m_maxDataValue;
 
       // Data Members for Associations
-        std::vector<std::valarray<T> > m_data;
+        //	All the cells of the column, in one array.  Fixed width
+        //	columns are laid out row after row, repeat() elements
+        //	per row.  Cells of variable width columns are appended
+        //	as they are read or written; space given up by rewritten
+        //	or deleted rows is reclaimed by reserveData.
+        std::valarray<T> m_data;
+        std::vector<size_t> m_rowStart;
+        //	Number of elements held for each row, 0 if the row has
+        //	not been read yet.
+        std::vector<size_t> m_rowSize;
+        size_t m_dataUsed;
 
       // Additional Implementation Declarations
 
@@ -181,29 +211,63 @@ namespace CCfits {
   }
 
   template <typename T>
-  inline const std::vector<std::valarray<T> >& ColumnVectorData<T>::data () const
+  inline std::vector<std::valarray<T> > ColumnVectorData<T>::data () const
   {
-    return m_data;
+    const size_t nRows = m_rowSize.size();
+    std::vector<std::valarray<T> > value(nRows);
+    for (size_t i = 0; i < nRows; ++i)
+    {
+       const size_t n = m_rowSize[i];
+       if (n) value[i] = std::valarray<T>(rowData(i), n);
+    }
+    return value;
   }
 
   template <typename T>
   inline void ColumnVectorData<T>::setData (const std::vector<std::valarray<T> >& value)
   {
-    m_data = value;
+    m_data.resize(0);
+    m_rowStart.clear();
+    m_rowSize.clear();
+    m_dataUsed = 0;
+    resizeRows(value.size());
+    for (size_t i = 0; i < value.size(); ++i) data(i + 1, value[i]);
   }
 
   template <typename T>
-  inline const std::valarray<T>& ColumnVectorData<T>::data (int i) const
+  inline std::valarray<T> ColumnVectorData<T>::data (int i) const
   {
-    return m_data[i - 1];
+    const size_t row = i - 1;
+    if (row >= m_rowSize.size() || !m_rowSize[row]) return std::valarray<T>();
+    return std::valarray<T>(rowData(row), m_rowSize[row]);
   }
 
   template <typename T>
   inline void ColumnVectorData<T>::data (int i, const std::valarray<T>& value)
   {
-     if (m_data[i-1].size() != value.size())
-        m_data[i-1].resize(value.size());
-     m_data[i - 1] = value;
+     const size_t row = i - 1;
+     const size_t n = value.size();
+     if (row >= m_rowSize.size()) resizeRows(row + 1);
+     resizeRow(row, n);
+     T* current = rowData(row);
+     for (size_t j = 0; j < n; ++j) current[j] = value[j];
+  }
+
+  template <typename T>
+  inline FITSUtil::ArrayView<T> ColumnVectorData<T>::dataView (int i) const
+  {
+    const size_t row = i - 1;
+    if (row >= m_rowSize.size()) return FITSUtil::ArrayView<T>();
+    return FITSUtil::ArrayView<T>(rowData(row), m_rowSize[row]);
+  }
+
+  template <typename T>
+  inline T* ColumnVectorData<T>::rowData (size_t row) const
+  {
+    // m_data is only modified through the non-const member functions;
+    // the cast gives the same pointer for reading and writing.
+    if (!m_rowSize[row]) return 0;
+    return &const_cast<std::valarray<T>&>(m_data)[m_rowStart[row]];
   }
 
   // Parameterized Class CCfits::ColumnVectorData 
@@ -215,7 +279,10 @@ namespace CCfits {
        m_maxLegalValue(right.m_maxLegalValue),
        m_minDataValue(right.m_minDataValue),
        m_maxDataValue(right.m_maxDataValue),
-       m_data(right.m_data)
+       m_data(right.m_data),
+       m_rowStart(right.m_rowStart),
+       m_rowSize(right.m_rowSize),
+       m_dataUsed(right.m_dataUsed)
   {
   }
 
@@ -226,7 +293,10 @@ namespace CCfits {
        m_maxLegalValue(0),
        m_minDataValue(0),
        m_maxDataValue(0),
-       m_data() 
+       m_data(),
+       m_rowStart(),
+       m_rowSize(),
+       m_dataUsed(0)
   {
   }
 
@@ -237,7 +307,10 @@ namespace CCfits {
           m_maxLegalValue(0),
           m_minDataValue(0),
           m_maxDataValue(0), 
-          m_data()
+          m_data(),
+          m_rowStart(),
+          m_rowSize(),
+          m_dataUsed(0)
   {
   }
 
@@ -254,19 +327,18 @@ namespace CCfits {
   {
           if ( !Column::compare(right) ) return false;
           const ColumnVectorData<T>& that = static_cast<const ColumnVectorData<T>&>(right);
-          size_t n = m_data.size();
-          // m_data is of type valarray<T>.
-          if ( that.m_data.size() != n ) return false;
+          size_t n = m_rowSize.size();
+          if ( that.m_rowSize.size() != n ) return false;
           for (size_t i = 0; i < n ; i++)
           {
-                const std::valarray<T>& thisValArray=m_data[i];
-                const std::valarray<T>& thatValArray=that.m_data[i];
-                size_t nn = thisValArray.size();
-                if (thatValArray.size() != nn ) return false;
+                size_t nn = m_rowSize[i];
+                if (that.m_rowSize[i] != nn ) return false;
      
+                const T* thisRow = rowData(i);
+                const T* thatRow = that.rowData(i);
                 for (size_t j = 0; j < nn ; j++ ) 
                 {
-                   if (thisValArray[j] != thatValArray[j])
+                   if (thisRow[j] != thatRow[j])
                       return false;
                 }
           }
@@ -295,10 +367,10 @@ namespace CCfits {
 
     // rows() >= origNRows since it is the value for entire table, 
     // not just this column.
-    const size_t origNRows(m_data.size());
-    // This will always be an expansion. vector.resize() doesn't
-    // invalidate any data on an expansion.
-    if (newLastRow > origNRows) m_data.resize(newLastRow);
+    const size_t origNRows(m_rowSize.size());
+    // This will always be an expansion, which preserves the
+    // contents of the existing rows.
+    if (newLastRow > origNRows) resizeRows(newLastRow);
 
     if (varLength())
     {
@@ -307,24 +379,23 @@ namespace CCfits {
        // Each value will eventually be overwritten.
        for (size_t iRow = firstRow-1; iRow < lastInputRow; ++iRow)
        {
-          std::valarray<T>& current = m_data[iRow];
           const size_t newSize = indata[iRow - (firstRow-1)].size();
-          if (current.size() != newSize)
-             current.resize(newSize);          
+          if (m_rowSize[iRow] != newSize)
+             resizeRow(iRow, newSize);          
        }
     }
     else
     {
-       // All row sizes in m_data should ALWAYS be either repeat(),
+       // All row sizes in m_rowSize should ALWAYS be either repeat(),
        // or 0 if they haven't been initialized.  This is true regardless
        // of the incoming data row size.  
 
-       // Perform LAZY initialization of m_data rows.  Only
-       // expand a row valarray when it is first needed.
+       // Perform LAZY initialization of m_data.  The storage for
+       // the column is only allocated when a row is first needed.
        for (size_t iRow = firstRow-1; iRow < lastInputRow; ++iRow)
        {
-          if (m_data[iRow].size() != repeat())
-             m_data[iRow].resize(repeat());
+          if (m_rowSize[iRow] != repeat())
+             resizeRow(iRow, repeat());
        }       
     }
   }
@@ -384,19 +455,20 @@ namespace CCfits {
           s << " Column Legal limits: ( " << m_minLegalValue << "," << m_maxLegalValue << " )\n" 
           << " Column Data  limits: ( " << m_minDataValue << "," << m_maxDataValue << " )\n";
     }
-    if (!m_data.empty())
+    if (!m_rowSize.empty())
     {
-  	  for (size_t j = 0; j < m_data.size(); j++)
+  	  for (size_t j = 0; j < m_rowSize.size(); j++)
   	  {
-                  size_t n = m_data[j].size();
+                  size_t n = m_rowSize[j];
 		  if ( n )
         	  {
+                          const T* current = rowData(j);
                           s << "Row " << j + 1 << " Vector Size " << n << '\n';
 			  for (size_t k = 0; k < n - 1; k++)
         		  {
-               		 	  s << m_data[j][k] << '\t';
+               		 	  s << current[k] << '\t';
         		  }
-        		  s << m_data[j][n - 1] << '\n';
+        		  s << current[n - 1] << '\n';
 		  }
   	  }
     }
@@ -465,7 +537,7 @@ namespace CCfits {
     using  std::valarray;
 
     resizeDataObject(indata,firstRow); 
-    // After the above call, can assume all m_data arrays to be written to 
+    // After the above call, can assume all m_data rows to be written to 
     // have been properly resized whether we're dealing with fixed or
     // variable length.       
 
@@ -476,9 +548,12 @@ namespace CCfits {
        const size_t endRow = nInputRows + firstRow-1;
        for (size_t iRow = firstRow-1; iRow < endRow; ++iRow)
        {
-          m_data[iRow] = indata[iRow - (firstRow-1)];
+          const valarray<T>& input = indata[iRow - (firstRow-1)];
+          const size_t n = m_rowSize[iRow];
+          T* current = rowData(iRow);
+          for (size_t j = 0; j < n; ++j) current[j] = input[j];
           // doWrite wants 1-based rows.
-          doWrite(&m_data[iRow][0], iRow+1, m_data[iRow].size(), 1, nullValue);
+          doWrite(current, iRow+1, n, 1, nullValue);
        }
        parent()->updateRows();
     }
@@ -524,9 +599,9 @@ namespace CCfits {
           for (size_t j = 0; j < nInputRows ; ++j)
           {
               const valarray<T>& input   = indata[j];
-              valarray<T>& current = m_data[j + firstRow - 1];
               // current should be resized by resizeDataObject.
-              current = input;
+              T* current = rowData(j + firstRow - 1);
+              for (size_t k = 0; k < colRepeat; ++k) current[k] = input[k];
           }
        }
        else
@@ -536,7 +611,7 @@ namespace CCfits {
           for (size_t iRow = firstRow-1; iRow<endRow; ++iRow)
           {
              // resizeDataObject should already have resized all
-             // corresponding m_data rows to repeat().
+             // corresponding m_rowSize entries to repeat().
              const valarray<T>& input = indata[iRow-(firstRow-1)];
              writeFixedRow(input, iRow, 1, nullValue);
           }
@@ -546,6 +621,26 @@ namespace CCfits {
     } // end if !varLength
   }
 
+  template <typename T>
+  void ColumnVectorData<T>::writeData (const T* indata, long numRows, long firstRow, T* nullValue)
+  {
+    // The rows of a fixed width column are contiguous in m_data, so
+    // indata is written to the file as it is and then copied in one go.
+    const size_t width = repeat();
+    const size_t first = static_cast<size_t>(firstRow - 1);
+    const size_t last = first + static_cast<size_t>(numRows);
+    const size_t newLastRow = std::max(last,static_cast<size_t>(rows()));
+    if (newLastRow > m_rowSize.size()) resizeRows(newLastRow);
+    for (size_t iRow = first; iRow < last; ++iRow)
+    {
+       if (m_rowSize[iRow] != width) resizeRow(iRow, width);
+    }
+
+    const long nElements = numRows*static_cast<long>(width);
+    writeFixedArray(const_cast<T*>(indata),nElements,numRows,firstRow,nullValue);
+    if (nElements > 0) std::copy(indata, indata + nElements, rowData(first));
+  }
+
   template <typename T>
   void ColumnVectorData<T>::readRow (size_t row, T* nullValue)
   {
@@ -600,81 +695,14 @@ namespace CCfits {
   void ColumnVectorData<T>::readColumnData (long firstrow, long nelements, long firstelem, T* nullValue)
   {
    int   status=0;
-
-   FITSUtil::auto_array_ptr<T> pArray(new T[nelements]); 
-   T*     array = pArray.get();
    int    anynul(0);
 
+   // the elements are read directly into the column storage.
+   T*     array = readBuffer(firstrow, nelements, firstelem);
 
-
-   if (fits_read_col(fitsPointer(), abs(type()),index(), firstrow, firstelem,
+   if (nelements > 0 && fits_read_col(fitsPointer(), abs(type()),index(), firstrow, firstelem,
                           nelements, nullValue, array, &anynul, &status) != 0)  
        throw FitsError(status);
-
-   size_t countRead = 0;
-   const size_t ONE = 1;
-
-   if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-   size_t vectorSize(0);
-   if (!varLength())
-   {
-
-        vectorSize = std::max(repeat(),ONE); // safety check.
-
-   }
-   else
-   {
-        // assume that the user specified the correct length for 
-        // variable columns. This should be ok since readVariableColumns
-        // uses fits_read_descripts to return this information from the
-        // fits pointer, and this is passed as nelements here.
-        vectorSize = nelements;       
-   }
-   size_t n = nelements; 
-
-   int i = firstrow;
-   int ii = i - 1;
-   while ( countRead < n)
-   {
-         std::valarray<T>& current = m_data[ii];
-         if (current.size() != vectorSize) current.resize(vectorSize);
-         int elementsInFirstRow = vectorSize-firstelem + 1;
-         bool lastRow = ( (nelements - countRead) < vectorSize);
-         if (lastRow)
-         {
-               int elementsInLastRow = nelements - countRead;
-               std::valarray<T> ttmp(array + vectorSize*(ii-firstrow) + elementsInFirstRow,
-                                                     elementsInLastRow);
-               for (int kk = 0; kk < elementsInLastRow; kk++) current[kk] = ttmp[kk];
-               countRead += elementsInLastRow;
-
-         }
-         // what to do with complete rows
-         else 
-         {
-                if (firstelem == 1 || (firstelem > 1 && i > firstrow) )
-                {
-                        std::valarray<T> ttmp(array + vectorSize*(ii - firstrow) + 
-                                        elementsInFirstRow,vectorSize);
-                        current = ttmp;
-			ii++;
-			i++;
-                        countRead += vectorSize;   
-                }   
-                else
-                { 
-                        if (i == firstrow)
-                        {
-                                std::valarray<T> ttmp(array,elementsInFirstRow);
-                                for (size_t kk = firstelem ; kk < vectorSize ; kk++)
-                                      current[kk] = ttmp[kk-firstelem];   
-                                countRead += elementsInFirstRow;
-                                i++;
-                                ii++;
-                        }
-                }
-         }
-    }
   }
 
   template <typename T>
@@ -745,9 +773,9 @@ namespace CCfits {
        throw FitsFatal(msgStr.str()); 
     }
 
-    std::valarray<T>& storedRow = m_data[row];    
+    T* storedRow = rowData(row);    
     long inputSize = static_cast<long>(data.size());
-    long storedSize(storedRow.size());
+    long storedSize(m_rowSize[row]);
     if (storedSize != static_cast<long>(repeat()))
     {
        msgStr<<"stored array size vs. column width mismatch in ColumnVectorData::writeFixedRow.\n";
@@ -827,54 +855,63 @@ namespace CCfits {
   template <typename T>
   void ColumnVectorData<T>::insertRows (long first, long number)
   {
-    typename std::vector<std::valarray<T> >::iterator in;
-    if (first !=0) 
+    // rows past the ones stored have not been read yet, and
+    // are not affected by the insertion.
+    const size_t at = static_cast<size_t>(first);
+    const size_t n = static_cast<size_t>(number);
+    const size_t nRows = m_rowSize.size();
+    if (at >= nRows) return;
+
+    m_rowSize.insert(m_rowSize.begin() + at, n, 0);
+    if (varLength())
     {
-            in = m_data.begin()+first;
+       m_rowStart.insert(m_rowStart.begin() + at, n, 0);
     }
     else
     {
-            in = m_data.begin();
-    }           
-
-    // non-throwing operations.
-    m_data.insert(in,number,std::valarray<T>(T(),0));
+       // open a gap of n rows in the fixed width layout.
+       const size_t width = repeat();
+       m_rowStart.resize(nRows + n);
+       for (size_t i = 0; i < nRows + n; ++i) m_rowStart[i] = i*width;
+       if (m_dataUsed)
+       {
+          std::valarray<T> tmp((nRows + n)*width);
+          for (size_t k = 0; k < at*width; ++k) tmp[k] = m_data[k];
+          for (size_t k = at*width; k < nRows*width; ++k) tmp[k + n*width] = m_data[k];
+          m_data.resize(tmp.size());
+          m_data = tmp;
+          m_dataUsed = m_data.size();
+       }
+    }
   }
 
   template <typename T>
   void ColumnVectorData<T>::deleteRows (long first, long number)
   {
-    // the following is an ugly workaround for a bug in g++ v3.0 that
-    // does not erase vector elements cleanly in this case.
-
-    long N = static_cast<long>(m_data.size());
-    size_t newSize = static_cast<size_t>(N - number);      
-    std::vector<std::valarray<T> > __tmp(newSize);
+    const size_t nRows = m_rowSize.size();
+    const size_t begin = static_cast<size_t>(first - 1);
+    if (begin >= nRows) return;
+    const size_t end = std::min(begin + static_cast<size_t>(number), nRows);
+    const size_t newSize = nRows - (end - begin);
 
-    long lastDeleted( number + first - 1 );
-    long firstDeleted(first);
-    long count(0);
+    m_rowSize.erase(m_rowSize.begin() + begin, m_rowSize.begin() + end);
+    if (varLength())
     {
-       for (long j = 1; j <= N; ++j)
-       {
-	  if (  (j - firstDeleted)*(lastDeleted - j) >= 0 )	
-	  {                ++count; 
-	  } 
-	  else
-	  {
-             __tmp[j - 1 - count].resize(m_data[j - 1].size());
-             __tmp[j - 1 - count] = m_data[j - 1];
-	  }
-       }                           
+       // the cells of the deleted rows are reclaimed by reserveData.
+       m_rowStart.erase(m_rowStart.begin() + begin, m_rowStart.begin() + end);
     }
-
-    m_data.clear();
-    m_data.resize(newSize);
+    else
     {
-       for (size_t j = 0; j < newSize; ++j)
+       const size_t width = repeat();
+       m_rowStart.resize(newSize);
+       if (m_dataUsed)
        {
-	  m_data[j].resize(__tmp[j].size());
-    	  m_data[j] = __tmp[j];
+          std::valarray<T> tmp(newSize*width);
+          for (size_t k = 0; k < begin*width; ++k) tmp[k] = m_data[k];
+          for (size_t k = end*width; k < nRows*width; ++k) tmp[k - (end - begin)*width] = m_data[k];
+          m_data.resize(tmp.size());
+          m_data = tmp;
+          m_dataUsed = m_data.size();
        }
     }
   }
@@ -908,6 +945,159 @@ namespace CCfits {
     }
   }
 
+  template <typename T>
+  void ColumnVectorData<T>::resizeRows (size_t nRows)
+  {
+    const size_t oldRows = m_rowSize.size();
+    if (nRows == oldRows) return;
+    if (!varLength())
+    {
+       const size_t width = repeat();
+       if (m_dataUsed)
+       {
+          // keep the rows that remain and clear the new ones.  The
+          // array grows with 50% headroom, so that a column written a
+          // block of rows at a time is not copied for every block.
+          const size_t used = nRows*width;
+          const size_t keep = std::min(nRows, oldRows)*width;
+          if (used > m_data.size())
+          {
+             std::valarray<T> tmp(used + used/2);
+             for (size_t k = 0; k < keep; ++k) tmp[k] = m_data[k];
+             m_data.resize(tmp.size());
+             m_data = tmp;
+          }
+          else
+          {
+             for (size_t k = keep; k < used; ++k) m_data[k] = T();
+          }
+          m_dataUsed = used;
+       }
+       m_rowStart.resize(nRows);
+       for (size_t i = oldRows; i < nRows; ++i) m_rowStart[i] = i*width;
+    }
+    else
+    {
+       m_rowStart.resize(nRows, 0);
+    }
+    m_rowSize.resize(nRows, 0);
+  }
+
+  template <typename T>
+  void ColumnVectorData<T>::resizeRow (size_t row, size_t n)
+  {
+    // The contents of a row are preserved only if it does not grow.
+    if (!varLength())
+    {
+       const size_t width = repeat();
+       if (n > width)
+       {
+#ifdef SSTREAM_DEFECT
+          std::ostrstream oss;
+#else
+          std::ostringstream oss;
+#endif 
+          oss << " vector column length " << width 
+             <<", input valarray length " << n;
+          throw InvalidRowParameter(oss.str());               
+       }
+       if (!m_dataUsed)
+       {
+          // first row to be stored: allocate the whole column.
+          m_data.resize(m_rowSize.size()*width);
+          m_dataUsed = m_data.size();
+       }
+       m_rowSize[row] = n;
+    }
+    else if (n <= m_rowSize[row])
+    {
+       m_rowSize[row] = n;
+    }
+    else
+    {
+       if (m_dataUsed + n > m_data.size()) reserveData(n);
+       m_rowStart[row] = m_dataUsed;
+       m_rowSize[row] = n;
+       m_dataUsed += n;
+    }
+  }
+
+  template <typename T>
+  T* ColumnVectorData<T>::readBuffer (long firstrow, long nelements, long firstelem)
+  {
+    const size_t nRows = static_cast<size_t>(rows());
+    if (m_rowSize.size() != nRows) resizeRows(nRows);
+    if (nelements <= 0) 
+    {
+       if (varLength() && firstelem == 1) resizeRow(firstrow - 1, 0);
+       return 0;
+    }
+
+    if (!varLength())
+    {
+       // the elements of a fixed width column are contiguous in the
+       // file as well as in m_data, whichever rows they span.
+       const size_t width = repeat();
+       const size_t first = (firstrow - 1)*width + (firstelem - 1);
+       const size_t last = first + nelements - 1;
+       if (width == 0 || last >= nRows*width)
+       {
+#ifdef SSTREAM_DEFECT
+          std::ostrstream msg;
+#else
+          std::ostringstream msg;
+#endif
+          msg << " requested read of " << nelements << " elements from row " 
+              << firstrow << " exceeds column " << name();
+#ifdef SSTREAM_DEFECT
+          msg << std::ends;
+#endif
+          throw InvalidRowParameter(msg.str());
+       }
+       for (size_t iRow = first/width; iRow <= last/width; ++iRow)
+       {
+          if (m_rowSize[iRow] != width) resizeRow(iRow, width);
+       }
+       return &m_data[first];
+    }
+    else
+    {
+       // assume that the user specified the correct length for 
+       // variable columns. This should be ok since readVariableColumns
+       // uses fits_read_descripts to return this information from the
+       // fits pointer, and this is passed as nelements here.
+       const size_t row = firstrow - 1;
+       resizeRow(row, nelements + firstelem - 1);
+       return rowData(row) + (firstelem - 1);
+    }
+  }
+
+  template <typename T>
+  void ColumnVectorData<T>::reserveData (size_t extra)
+  {
+    // Make room for extra elements at the end of a variable width 
+    // column.  The rows are copied, in order, to a new array with
+    // 50% headroom, which leaves out the space they no longer use.
+    const size_t nRows = m_rowSize.size();
+    size_t live(0);
+    for (size_t i = 0; i < nRows; ++i) live += m_rowSize[i];
+    const size_t capacity = (live + extra) + (live + extra)/2;
+
+    std::valarray<T> tmp(capacity);
+    size_t k(0);
+    for (size_t i = 0; i < nRows; ++i)
+    {
+       const size_t n = m_rowSize[i];
+       const size_t start = m_rowStart[i];
+       for (size_t j = 0; j < n; ++j) tmp[k + j] = m_data[start + j];
+       m_rowStart[i] = k;
+       k += n;
+    }
+    m_data.resize(capacity);
+    m_data = tmp;
+    m_dataUsed = k;
+  }
+
   // Additional Declarations
 
   // all functions that operate on complex data that call cfitsio 
@@ -957,77 +1147,14 @@ inline void ColumnVectorData<complex<double> >::setDataLimits (complex<double>*
         {
             int   status=0;
             float nulval (0);
-            FITSUtil::auto_array_ptr<float> pArray(new float[2*nelements]); 
-            float*     array = pArray.get();
             int    anynul(0);
 
-            if (fits_read_col_cmp(fitsPointer(),index(),firstRow, firstElem,
-                            nelements,nulval,array,&anynul,&status) ) throw FitsError(status);
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-
-            std::valarray<std::complex<float> > readData(nelements);
-            for (long j = 0; j < nelements; ++j)
-            {
-                    readData[j] = std::complex<float>(array[2*j],array[2*j+1]);
-            }
-            size_t countRead = 0;
-            const size_t ONE = 1;
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-            size_t vectorSize(0);
-            if (!varLength())
-            {
-                 vectorSize = std::max(repeat(),ONE); // safety check.
-            }
-            else
-            {
-                 // assume that the user specified the correct length for 
-                 // variable columns. This should be ok since readVariableColumns
-                 // uses fits_read_descripts to return this information from the
-                 // fits pointer, and this is passed as nelements here.
-                 vectorSize = nelements;       
-            }
-            size_t n = nelements; 
-
-            int i = firstRow;
-            int ii = i - 1;
-            while ( countRead < n)
-            {
-                    std::valarray<complex<float> >& current = m_data[ii];
-                    if (current.size() != vectorSize) current.resize(vectorSize,0.);
-                    int elementsInFirstRow = vectorSize-firstElem + 1;
-                    bool lastRow = ( (nelements - countRead) < vectorSize);
-                    if (lastRow)
-                    {
-                            int elementsInLastRow = nelements - countRead;
-                            std::copy(&readData[countRead],&readData[0]+nelements,&current[0]);
-                            countRead += elementsInLastRow;
-                    }             
-                    // what to do with complete rows. if firstElem == 1 the 
-                    else 
-                    {
-                            if (firstElem == 1 || (firstElem > 1 && i > firstRow) )
-                            {
-                                    current = readData[std::slice(vectorSize*(ii-firstRow)+
-                                                               elementsInFirstRow,vectorSize,1)];
-			            ++ii;
-			            ++i;
-                                    countRead += vectorSize;   
-                            }   
-                            else
-                            { 
-                                    if (i == firstRow)
-                                    {
-                                            std::copy(&readData[0],&readData[0]+elementsInFirstRow,
-                                                                            &current[firstElem]);
-                                            countRead += elementsInFirstRow;
-                                            ++i;
-                                            ++ii;
-                                    }
-                            }
-                    }
-            }
+            // the elements are read directly into the column storage; a
+            // complex<float> has the layout of a pair of floats.
+            std::complex<float>* array = readBuffer(firstRow, nelements, firstElem);
+
+            if (nelements > 0 && fits_read_col_cmp(fitsPointer(),index(),firstRow, firstElem,
+                            nelements,nulval,reinterpret_cast<float*>(array),&anynul,&status) ) throw FitsError(status);
     }
 #else
 template <>
@@ -1047,77 +1174,14 @@ void ColumnVectorData<complex<float> >::readColumnData(long firstRow,
         // actual compiler deficiencies.
             int   status=0;
             double nulval (0);
-            FITSUtil::auto_array_ptr<double> pArray(new double[2*nelements]); 
-            double*     array = pArray.get();
             int    anynul(0);
 
-            if (fits_read_col_dblcmp(fitsPointer(),index(),firstRow, firstElem,
-                            nelements,nulval,array,&anynul,&status) ) throw FitsError(status);
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-
-            std::valarray<std::complex<double> > readData(nelements);
-            for (long j = 0; j < nelements; ++j)
-            {
-                    readData[j] = std::complex<double>(array[2*j],array[2*j+1]);
-            }
-            size_t countRead = 0;
-            const size_t ONE = 1;
-
-            if (m_data.size() != static_cast<size_t>(rows())) m_data.resize(rows());
-            size_t vectorSize(0);
-            if (!varLength())
-            {
-                 vectorSize = std::max(repeat(),ONE); // safety check.
-            }
-            else
-            {
-                 // assume that the user specified the correct length for 
-                 // variable columns. This should be ok since readVariableColumns
-                 // uses fits_read_descripts to return this information from the
-                 // fits pointer, and this is passed as nelements here.
-                 vectorSize = nelements;       
-            }
-            size_t n = nelements; 
-
-            int i = firstRow;
-            int ii = i - 1;
-            while ( countRead < n)
-            {
-                    std::valarray<std::complex<double> >& current = m_data[ii];
-                    if (current.size() != vectorSize) current.resize(vectorSize,0.);
-                    int elementsInFirstRow = vectorSize-firstElem + 1;
-                    bool lastRow = ( (nelements - countRead) < vectorSize);
-                    if (lastRow)
-                    {
-                            int elementsInLastRow = nelements - countRead;
-                            std::copy(&readData[countRead],&readData[0]+nelements,&current[0]);
-                            countRead += elementsInLastRow;
-                    }             
-                    // what to do with complete rows. if firstElem == 1 the 
-                    else 
-                    {
-                            if (firstElem == 1 || (firstElem > 1 && i > firstRow) )
-                            {
-                                    current = readData[std::slice(vectorSize*(ii-firstRow)+
-                                                               elementsInFirstRow,vectorSize,1)];
-			            ++ii;
-			            ++i;
-                                    countRead += vectorSize;   
-                            }   
-                            else
-                            { 
-                                    if (i == firstRow)
-                                    {
-                                            std::copy(&readData[0],&readData[0]+elementsInFirstRow,
-                                                                            &current[firstElem]);
-                                            countRead += elementsInFirstRow;
-                                            ++i;
-                                            ++ii;
-                                    }
-                            }
-                    }
-            }
+            // the elements are read directly into the column storage; a
+            // complex<double> has the layout of a pair of doubles.
+            std::complex<double>* array = readBuffer(firstRow, nelements, firstElem);
+
+            if (nelements > 0 && fits_read_col_dblcmp(fitsPointer(),index(),firstRow, firstElem,
+                            nelements,nulval,reinterpret_cast<double*>(array),&anynul,&status) ) throw FitsError(status);
     }
 #else
 template <>
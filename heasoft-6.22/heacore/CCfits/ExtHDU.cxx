@@ -317,6 +317,18 @@ namespace CCfits {
      checkExtensionType();
      return static_cast<bool>(fits_is_compressed_image(fitsPointer(), &status));
   }
+
+  bool ExtHDU::readRows (RowBlocks& rows)
+  {
+     if (&rows.table() != this)
+     {
+        throw WrongExtensionType(" RowBlocks object was not made for HDU " + name());
+     }
+     if (!rows.next()) return false;
+     makeThisCurrent();
+     rows.read(fitsPointer());
+     return true;
+  }
   // Additional Declarations
 
 } // namespace CCfits
@@ -15,6 +15,10 @@
 #include "HDU.h"
 // FitsError
 #include "FitsError.h"
+// ImageTiles
+#include "ImageTiles.h"
+// RowBlocks
+#include "RowBlocks.h"
 
 namespace CCfits {
   class Column;
@@ -317,6 +321,30 @@ namespace CCfits {
 
 */
 
+/*! \fn      template<typename S> bool ExtHDU::readTile (ImageTiles& tiles, 
+                                std::valarray<S>& tile, 
+                                S* nullValue = 0);
+
+                \brief read the next tile of the image
+
+                Moves tiles to its next tile and reads it into tile, which is
+                resized only if the number of pixels changes, processing null
+                values if nullValue is given.  Returns false, and leaves tile
+                unchanged, once all the tiles have been read.
+
+                The pixels are read directly from the file and converted to
+                type S by cfitsio; the image cache used by read() is neither
+                filled nor consulted, so that images too large to be held in
+                memory can be processed tile by tile.
+
+                A WrongExtensionType exception is thrown if *this is not an image.
+
+                \param tiles the division of the image into tiles (see ImageTiles)
+                \param tile  array receiving the pixels of the tile
+                \param nullValue if not null, undefined pixels are set to *nullValue
+
+*/
+
 /*! \fn      template <typename S> void ExtHDU::write(const std::vector<long>& first,
                     long nElements,
                     const std::valarray<S>& data,
@@ -433,6 +461,25 @@ namespace CCfits {
       It will throw if this is not an Image extension.
  */
 
+/*! \fn bool ExtHDU::readRows (RowBlocks& rows);
+      \brief read the next block of rows of a set of table columns
+
+      Moves rows to its next block of rows and reads each of the columns
+      bound to it (see RowBlocks::add) into its array.  Returns false, and
+      leaves the arrays unchanged, once all the rows have been read.
+
+      The values are read directly from the file and converted by cfitsio,
+      one column after the other while the rows of the block are held in
+      cfitsio's I/O buffers, so the table is read from the file once
+      however many columns are bound.  The data of the table's Column
+      objects are neither filled nor consulted.
+
+      A WrongExtensionType exception is thrown if rows was constructed
+      for another HDU.
+
+      \param rows the row range, block size and bound columns (see RowBlocks)
+ */
+
 
 
   class ExtHDU : public HDU  //## Inherits: <unnamed>%38048213E7A8
@@ -482,6 +529,7 @@ namespace CCfits {
         virtual const ColMap& column () const;
 
         bool isCompressed () const;
+        bool readRows (RowBlocks& rows);
         int version () const;
         void version (int value);
         static const String& missHDU ();
@@ -568,6 +616,10 @@ namespace CCfits {
 		      const std::vector<long>& stride, 
                       S* nullValue) ; 
 
+      // read an image one tile at a time, bypassing the image cache.
+      template<typename S>
+      bool readTile (ImageTiles& tiles, std::valarray<S>& tile, S* nullValue = 0);
+
     protected:
         //	ExtHDU needs a default constructor. This is it.
         ExtHDU (FITSBase* p, HduType xtype, const String &hduName, int version);
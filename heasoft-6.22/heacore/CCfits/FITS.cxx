@@ -85,11 +85,12 @@ namespace CCfits {
   // Class CCfits::FITS 
   bool FITS::s_verboseMode = false;
 
-  FITS::FITS (const String &name, RWmode mode, bool readDataFlag, const std::vector<String>& primaryKeys)
+  FITS::FITS (const String &name, RWmode mode, bool readDataFlag, const std::vector<String>& primaryKeys, bool lazyRead)
   : m_FITSImpl(0)
   {
      std::auto_ptr<FITSBase> apBase(new FITSBase(name,mode));
      m_FITSImpl = apBase.get();
+     m_FITSImpl->lazyRead(lazyRead);
 
      if (mode == Read) 
      {
@@ -407,6 +408,9 @@ namespace CCfits {
 
     if (fits_delete_hdu(fitsPointer(),0,&status)) throw FitsError(status);
     unmapExtension(d);
+    FITSBase::HDUDirectory& directory = m_FITSImpl->directory();
+    if (removeIdx <= static_cast<int>(directory.size()))
+       directory.erase(directory.begin() + (removeIdx-1));
     // Reindex the extensions that follow the deleted.
     for (size_t i=0; i<trailingExts.size(); ++i)
        trailingExts[i]->index(trailingExts[i]->index()-1);
@@ -446,7 +450,9 @@ namespace CCfits {
     // exists in the file. The first clause copes with the results from the ctor that reads the 
     // entire file for HDUs, the second when adding a new HDU from a file which selected HDUs were
     // read on construction.
-    ExtHDU* requested = checkAlreadyRead(0, hduName, version);
+    // A lazily opened file knows where the extension is without searching.
+    ExtHDU* requested = readFromDirectory(hduName, version);
+    if (!requested) requested = checkAlreadyRead(0, hduName, version);
 
     if (!requested)
     {
@@ -759,6 +765,14 @@ namespace CCfits {
 
   if (hduByNum == endOfList) 
   {
+       // Not read yet in lazy read mode: reading it only adds it to the
+       // extension map, as in extbyVersion.
+       ExtHDU* lazyHDU = const_cast<FITS*>(this)->readFromDirectory(i);
+       if (lazyHDU)
+       {
+          lazyHDU->makeThisCurrent();
+          return *lazyHDU;
+       }
 #ifdef SSTREAM_DEFECT
        std::strstream msg;
 #else
@@ -810,6 +824,12 @@ namespace CCfits {
 
   if (hduByNum == endOfList) 
   {
+       ExtHDU* lazyHDU = readFromDirectory(i);
+       if (lazyHDU)
+       {
+          lazyHDU->makeThisCurrent();
+          return *lazyHDU;
+       }
 #ifdef SSTREAM_DEFECT
        std:: strstream msg;
 #else
@@ -843,6 +863,11 @@ namespace CCfits {
   ExtHDU& FITS::extbyVersion (const String& hduName, int version) const
   {
   // hey! remember it's a multimap and we need to work a little harder!
+  // in lazy read mode, first make sure the requested one has been read.
+  // That adds it to the extension map, which is not part of the logical
+  // state of the object, so the cast is safe.
+  const_cast<FITS*>(this)->readFromDirectory(hduName, version);
+
   // first, for convenience...
   // how many extensions with name hduName?
   ExtMap& ext = m_FITSImpl->extension();        
@@ -902,6 +927,22 @@ namespace CCfits {
 
    if (fits_get_num_hdus(m_FITSImpl->fptr(),&numHDUs,&status) != 0) throw FitsError(status);
 
+   if (m_FITSImpl->lazyRead())
+   {
+      // Only record the extension names here.  The ExtHDU objects are made
+      // by readFromDirectory when they are first asked for.
+      FITSBase::HDUDirectory& directory = m_FITSImpl->directory();
+      directory.resize(numHDUs > 1 ? numHDUs - 1 : 0);
+      for (int i = 1; i < numHDUs; i++)
+      {
+         directory[i-1].version = 1;
+         ExtHDU::readHduName(m_FITSImpl->fptr(), i, directory[i-1].name,
+                        directory[i-1].version);
+      }
+      m_FITSImpl->lazyReadData(readDataFlag);
+      return;
+   }
+
    // Not clearly exception safe : revisit!!!
 
    // Unused:   ExtHDU* newExt = 0;
@@ -917,6 +958,7 @@ namespace CCfits {
   Table* FITS::addTable (const String& hduName, int rows, const std::vector<String>& columnName, const std::vector<String>& columnFmt, const std::vector<String>& columnUnit, HduType type, int version)
   {
    ExtHDU* current(0);
+   readFromDirectory(hduName, version);
    size_t N(extension().count(hduName));
    std::pair<ExtMapIt,ExtMapIt> matches(extensionMap().equal_range(hduName));
    if ( N > 0 )
@@ -947,6 +989,7 @@ namespace CCfits {
   ExtHDU* FITS::addImage (const String& hduName, int bpix, std::vector<long>& naxes, int version)
   {
    ExtHDU* current(0);
+   readFromDirectory(hduName, version);
    size_t N(extension().count(hduName));
    std::pair<ExtMapIt,ExtMapIt> matches(extensionMap().equal_range(hduName));
    if ( N > 0 )
@@ -1069,6 +1112,7 @@ namespace CCfits {
     HDU* hduCopy = source.clone(m_FITSImpl);
     std::auto_ptr<ExtHDU> extCopy(static_cast<ExtHDU*>(hduCopy));
     const String& hduName = extCopy->name(); 
+    readFromDirectory(hduName, extCopy->version());
     size_t N = extension().count(hduName);
     std::pair<ExtMapIt,ExtMapIt> matches(extensionMap().equal_range(hduName));
     if ( N > 0 )
@@ -1383,6 +1427,9 @@ namespace CCfits {
 
     if (fits_delete_hdu(fitsPointer(),0,&status)) throw FitsError(status);
     unmapExtension(d);
+    FITSBase::HDUDirectory& directory = m_FITSImpl->directory();
+    if (removeIdx <= static_cast<int>(directory.size()))
+       directory.erase(directory.begin() + (removeIdx-1));
     // Reindex the extensions that follow the deleted.
     for (size_t i=0; i<trailingExts.size(); ++i)
        trailingExts[i]->index(trailingExts[i]->index()-1);
@@ -1459,6 +1506,31 @@ namespace CCfits {
      return noiseBits;
   }
 
+  void FITS::setDirectRead (bool value)
+  {
+     m_FITSImpl->directRead(value);
+  }
+
+  bool FITS::getDirectRead () const
+  {
+     return m_FITSImpl->directRead();
+  }
+
+  void FITS::setDirectWrite (bool value)
+  {
+     m_FITSImpl->directWrite(value);
+  }
+
+  bool FITS::getDirectWrite () const
+  {
+     return m_FITSImpl->directWrite();
+  }
+
+  bool FITS::getLazyRead () const
+  {
+     return m_FITSImpl->lazyRead();
+  }
+
   ExtHDU* FITS::checkAlreadyRead(const int hduIdx, const String& hduName,
                         const int version) const throw()
   {
@@ -1503,6 +1575,49 @@ namespace CCfits {
      return found;
   }
 
+  ExtHDU* FITS::readFromDirectory (int hduIdx)
+  {
+     // See header for description.
+     const FITSBase::HDUDirectory& directory = m_FITSImpl->directory();
+     if (!m_FITSImpl->lazyRead() || hduIdx < 1 || 
+                hduIdx > static_cast<int>(directory.size()))
+        return 0;
+
+     ExtHDU* found = checkAlreadyRead(hduIdx);
+     if (!found)
+     {
+        HDUCreator create(m_FITSImpl);
+        found = static_cast<ExtHDU*>(create.getHdu(hduIdx, m_FITSImpl->lazyReadData()));
+        ExtMap::value_type addHDUEntry(found->name(),found);
+        m_FITSImpl->extension().insert(addHDUEntry);
+        m_FITSImpl->currentExtensionName() = found->name();
+        found->index(hduIdx);
+     }
+     return found;
+  }
+
+  ExtHDU* FITS::readFromDirectory (const String& hduName, int version)
+  {
+     if (!m_FITSImpl->lazyRead()) return 0;
+
+     const FITSBase::HDUDirectory& directory = m_FITSImpl->directory();
+     int found = 0;
+     int lastNamed = 0;
+     int nNamed = 0;
+     for (size_t i=0; !found && i<directory.size(); ++i)
+     {
+        if (directory[i].name == hduName)
+        {
+           ++nNamed;
+           lastNamed = static_cast<int>(i) + 1;
+           if (directory[i].version == version) found = lastNamed;
+        }
+     }
+     if (!found && nNamed == 1) found = lastNamed;
+
+     return found ? readFromDirectory(found) : 0;
+  }
+
   // Additional Declarations
 
 } // namespace CCfits
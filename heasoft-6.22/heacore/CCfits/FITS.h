@@ -148,7 +148,7 @@ namespace CCfits {
 
 */
 
-/*!   \fn  FITS::FITS(const String &name, RWmode mode, bool readDataFlag, const std::vector<String>& primaryKeys) 
+/*!   \fn  FITS::FITS(const String &name, RWmode mode, bool readDataFlag, const std::vector<String>& primaryKeys, bool lazyRead) 
       \brief basic constructor
 
       This basic constructor makes a FITS object from the given filename.  The file name is the only required
@@ -178,6 +178,8 @@ namespace CCfits {
       \param mode The read/write mode: must be Read or Write
       \param readDataFlag boolean: read data on construction if true
       \param primaryKeys Allows optional reading of primary header keys on construction
+      \param lazyRead boolean: if true, only record the name and version of each extension
+                       and read the extensions when they are first requested (see FITS::getLazyRead)
 
 
       \exception NoSuchHDU thrown on HDU seek error either by index or {name,version}
@@ -657,6 +659,48 @@ do this either).
        \brief Get the cfitsio noisebits parameter used when compressing floating-point images.
    */
 
+   /*! \fn  void FITS::setDirectRead (bool value)
+       \brief set whether column reads bypass the columns' data caches.
+
+       When true, reading rows of a scalar column into a std::vector or
+       std::valarray copies the data from cfitsio straight into the caller's
+       container, instead of first filling (and keeping) the Column object's
+       internal copy of the data. Columns whose data have already been read
+       are still served from memory. The default is false.
+   */
+
+   /*! \fn  bool FITS::getDirectRead () const
+       \brief return whether column reads bypass the columns' data caches.
+   */
+
+   /*! \fn  void FITS::setDirectWrite (bool value)
+       \brief set whether column writes bypass the columns' data caches.
+
+       When true, writing rows of a scalar or fixed width vector column passes
+       the caller's data straight to cfitsio, which converts them to the
+       column's type, and the Column object's internal copy of the data is
+       neither filled nor grown.  Columns whose data have already been read
+       are still written through memory, to keep them up to date.  The
+       default is false.
+   */
+
+   /*! \fn  bool FITS::getDirectWrite () const
+       \brief return whether column writes bypass the columns' data caches.
+   */
+
+   /*! \fn bool FITS::getLazyRead () const
+
+        \brief return whether this object reads its extensions on demand
+
+        Normally the basic constructor creates an ExtHDU object, with its column
+        descriptors, for every extension in the file.  When its lazyRead argument
+        is true, it only records the name and version of each extension.  An
+        extension is read the first time it is requested through FITS::extension,
+        FITS::read or FITS::currentExtension, as it would have been by the
+        constructor (including its data, if readDataFlag was true).  Until then
+        it does not appear in the map returned by FITS::extension().
+   */
+
    /*! \fn fitsfile* FITS::fitsPointer() const
        \brief return the CFITSIO fitsfile pointer for this FITS object
 
@@ -717,7 +761,7 @@ do this either).
         private:
         private: //## implementation
       };
-        FITS (const String &name, RWmode mode = Read, bool readDataFlag = false, const std::vector<String>& primaryKeys = std::vector<String>());
+        FITS (const String &name, RWmode mode = Read, bool readDataFlag = false, const std::vector<String>& primaryKeys = std::vector<String>(), bool lazyRead = false);
         //	Open a file and read a specified HDU.
         //
         //	Optional parameter allows the reading of specified primary HDU keys.
@@ -804,6 +848,11 @@ do this either).
         int getCompressionType () const;
         void getTileDimensions (std::vector<long>& tileSizes) const;
         int getNoiseBits () const;
+        void setDirectRead (bool value);
+        bool getDirectRead () const;
+        void setDirectWrite (bool value);
+        bool getDirectWrite () const;
+        bool getLazyRead () const;
         static bool verboseMode ();
         static void setVerboseMode (bool value);
 
@@ -853,6 +902,15 @@ do this either).
         ExtHDU* checkAlreadyRead(const int hduIdx, 
                     const String& hduName = string(""), const int version=1) const throw();
 
+        // For files opened in lazy read mode, read an extension which is in
+        // the directory made at opening but not yet in ExtMap, and add it to
+        // ExtMap.  Returns 0 if there is no such extension.  Lookup by name
+        // ignores the version if only one extension has that name, as
+        // extbyVersion does.  This changes ExtMap, so const accessors
+        // which find an extension this way must cast away their constness.
+        ExtHDU* readFromDirectory (int hduIdx);
+        ExtHDU* readFromDirectory (const String& hduName, int version);
+
       // Additional Private Declarations
 
     private: //## implementation
@@ -25,9 +25,10 @@ namespace CCfits {
   // Class CCfits::FITSBase 
 
   FITSBase::FITSBase (const String& fileName, RWmode rwmode)
-    : m_currentCompressionTileDim(0),
+    : m_currentCompressionTileDim(0), m_directRead(false),
+      m_directWrite(false), m_lazyRead(false), m_lazyReadData(false),
       m_mode(rwmode), m_currentExtensionName(""), m_name(fileName),
-      m_pHDU(0), m_extension(), m_fptr(0)
+      m_pHDU(0), m_extension(), m_directory(), m_fptr(0)
   {
   }
 
@@ -15,6 +15,8 @@
 #include <string>
 // map
 #include <map>
+// vector
+#include <vector>
 // CCfitsHeader
 #include "CCfits.h"
 
@@ -34,6 +36,16 @@ namespace CCfits {
   {
 
     public:
+        //	Name and version of an extension which has been found in the
+        //	file but not yet read into the extension map.
+        struct HDUEntry
+        {
+            String name;
+            int version;
+        };
+
+        typedef std::vector<HDUEntry> HDUDirectory;
+
         FITSBase (const String& fileName, RWmode rwmode);
         ~FITSBase();
 
@@ -41,6 +53,14 @@ namespace CCfits {
         void destroyExtensions ();
         int currentCompressionTileDim () const;
         void currentCompressionTileDim (int value);
+        bool directRead () const;
+        void directRead (bool value);
+        bool directWrite () const;
+        void directWrite (bool value);
+        bool lazyRead () const;
+        void lazyRead (bool value);
+        bool lazyReadData () const;
+        void lazyReadData (bool value);
         RWmode mode ();
         std::string& currentExtensionName ();
         std::string& name ();
@@ -48,6 +68,7 @@ namespace CCfits {
         ExtMap& extension ();
 
         const ExtMap& extension() const;
+        HDUDirectory& directory ();
         fitsfile*& fptr ();
 
       // Additional Public Declarations
@@ -64,6 +85,10 @@ namespace CCfits {
     private: //## implementation
       // Data Members for Class Attributes
         int m_currentCompressionTileDim;
+        bool m_directRead;
+        bool m_directWrite;
+        bool m_lazyRead;
+        bool m_lazyReadData;
 
       // Data Members for Associations
         RWmode m_mode;
@@ -71,6 +96,7 @@ namespace CCfits {
         std::string m_name;
         PHDU* m_pHDU;
         ExtMap m_extension;
+        HDUDirectory m_directory;
         fitsfile* m_fptr;
 
       // Additional Implementation Declarations
@@ -89,6 +115,46 @@ namespace CCfits {
     m_currentCompressionTileDim = value;
   }
 
+  inline bool FITSBase::directRead () const
+  {
+    return m_directRead;
+  }
+
+  inline void FITSBase::directRead (bool value)
+  {
+    m_directRead = value;
+  }
+
+  inline bool FITSBase::directWrite () const
+  {
+    return m_directWrite;
+  }
+
+  inline void FITSBase::directWrite (bool value)
+  {
+    m_directWrite = value;
+  }
+
+  inline bool FITSBase::lazyRead () const
+  {
+    return m_lazyRead;
+  }
+
+  inline void FITSBase::lazyRead (bool value)
+  {
+    m_lazyRead = value;
+  }
+
+  inline bool FITSBase::lazyReadData () const
+  {
+    return m_lazyReadData;
+  }
+
+  inline void FITSBase::lazyReadData (bool value)
+  {
+    m_lazyReadData = value;
+  }
+
   inline RWmode FITSBase::mode ()
   {
     return m_mode;
@@ -119,6 +185,11 @@ namespace CCfits {
      return m_extension;
   }
 
+  inline FITSBase::HDUDirectory& FITSBase::directory ()
+  {
+    return m_directory;
+  }
+
   inline fitsfile*& FITSBase::fptr ()
   {
     return m_fptr;
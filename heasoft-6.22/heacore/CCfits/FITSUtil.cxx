@@ -451,6 +451,110 @@ namespace CCfits {
                 }
 	}                  
 
+// AF<-view F
+	void 
+	fill(std::valarray<std::complex<float> >& outArray, 
+                        const ArrayView<std::complex<float> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<float>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
+// AD<-view D
+	void 
+	fill(std::valarray<std::complex<double> >& outArray, 
+                        const ArrayView<std::complex<double> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<double>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
+// AF<-view D
+	void 
+	fill(std::valarray<std::complex<float> >& outArray, 
+                        const ArrayView<std::complex<double> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<float>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
+// AD<-view F
+	void 
+	fill(std::valarray<std::complex<double> >& outArray, 
+                        const ArrayView<std::complex<float> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<double>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
+// VF<-view F
+	void 
+	fill(std::vector<std::complex<float> >& outArray, 
+                        const ArrayView<std::complex<float> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<float>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
+// VD<-view D
+	void 
+	fill(std::vector<std::complex<double> >& outArray, 
+                        const ArrayView<std::complex<double> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<double>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
+// VF<-view D
+	void 
+	fill(std::vector<std::complex<float> >& outArray, 
+                        const ArrayView<std::complex<double> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<float>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
+// VD<-view F
+	void 
+	fill(std::vector<std::complex<double> >& outArray, 
+                        const ArrayView<std::complex<float> >& inArray)
+	{
+                size_t N (inArray.size());
+                if (outArray.size() != N) outArray.resize(N);
+                for (size_t j = 0; j < N; ++j ) 
+                {
+                        outArray[j] = std::complex<double>(inArray[j].real(),inArray[j].imag());
+                }
+	}                  
+
 // VF<-AF
 	void 
 	fill(std::vector<std::complex<float> >& outArray, 
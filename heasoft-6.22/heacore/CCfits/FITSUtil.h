@@ -256,6 +256,16 @@ which might be of use for other applications.
 
 */
 
+/*! \class ArrayView
+        \brief read-only view of a contiguous run of elements held elsewhere.
+
+        ColumnVectorData keeps the cells of a vector column in one buffer.
+        Its dataView(i) returns an ArrayView over row i, which avoids the
+        copy made by data(i). The view supports size(), operator[] and begin()/end()
+        and converts to a std::valarray<T>. It is invalidated by any
+        operation that modifies the column.
+*/
+
 
 /*! \fn template <typename S, typename T> void fill(std::vector< S > &outArray, const std::vector< T > &inArray, size_t first, size_t last);
 
@@ -321,6 +331,8 @@ object.
   static const  bool b1(false);
   static const  unsigned char b2(0);  
 
+  template <typename T> class ArrayView;
+
   char** CharArray(const std::vector<string>& inArray);
 
   string FITSType2String( int typeInt );
@@ -339,6 +351,12 @@ object.
   template <typename S, typename T> 
   void fill(std::vector<S>& outArray, const std::valarray<T>& inArray);
 
+  template <typename S, typename T> 
+  void fill(std::valarray<S>& outArray, const ArrayView<T>& inArray);
+
+  template <typename S, typename T> 
+  void fill(std::vector<S>& outArray, const ArrayView<T>& inArray);
+
   // VF<-AF
    void fill(std::vector<std::complex<float> >& outArray, 
                   const std::valarray<std::complex<float> >& inArray);
@@ -448,6 +466,30 @@ object.
   // AD<-AF
   void fill(std::valarray<std::complex<double> >& outArray,  
                   const std::valarray<std::complex<float> >& inArray);
+  // AF<-view F
+  void fill(std::valarray<std::complex<float> >& outArray,  
+                  const ArrayView<std::complex<float> >& inArray);
+  // AD<-view D
+  void fill(std::valarray<std::complex<double> >& outArray,  
+                  const ArrayView<std::complex<double> >& inArray);
+  // AF<-view D
+  void fill(std::valarray<std::complex<float> >& outArray, 
+                  const ArrayView<std::complex<double> >& inArray);
+  // AD<-view F
+  void fill(std::valarray<std::complex<double> >& outArray,  
+                  const ArrayView<std::complex<float> >& inArray);
+  // VF<-view F
+  void fill(std::vector<std::complex<float> >& outArray,  
+                  const ArrayView<std::complex<float> >& inArray);
+  // VD<-view D
+  void fill(std::vector<std::complex<double> >& outArray,  
+                  const ArrayView<std::complex<double> >& inArray);
+  // VF<-view D
+  void fill(std::vector<std::complex<float> >& outArray,  
+                  const ArrayView<std::complex<double> >& inArray);
+  // VD<-view F
+  void fill(std::vector<std::complex<double> >& outArray,  
+                  const ArrayView<std::complex<float> >& inArray);
 
 #if TEMPLATE_AMBIG_DEFECT || TEMPLATE_AMBIG7_DEFECT
   void fillMSvsvs(std::vector<string>& outArray, const std::vector<string>& inArray, size_t first, size_t last);
@@ -633,6 +675,29 @@ object.
 
 
 
+    template <typename T>
+    class ArrayView 
+    {
+      public:
+          ArrayView (const T* p = 0, size_t n = 0);
+
+          size_t size () const;
+          const T& operator [] (size_t i) const;
+          const T* begin () const;
+          const T* end () const;
+          operator std::valarray<T> () const;
+
+      protected:
+      private:
+      private: //## implementation
+        // Data Members for Class Attributes
+          const T* m_p;
+          size_t m_n;
+
+    };
+
+
+
     class UnrecognizedType : public FitsException  //## Inherits: <unnamed>%3CE143AB00C6
     {
       public:
@@ -897,6 +962,44 @@ object.
       return pC.release();      
     }
 
+    // Parameterized Class CCfits::FITSUtil::ArrayView 
+
+    template <typename T>
+    inline ArrayView<T>::ArrayView (const T* p, size_t n)
+      : m_p(p), m_n(n)
+    {
+    }
+
+    template <typename T>
+    inline size_t ArrayView<T>::size () const
+    {
+      return m_n;
+    }
+
+    template <typename T>
+    inline const T& ArrayView<T>::operator [] (size_t i) const
+    {
+      return m_p[i];
+    }
+
+    template <typename T>
+    inline const T* ArrayView<T>::begin () const
+    {
+      return m_p;
+    }
+
+    template <typename T>
+    inline const T* ArrayView<T>::end () const
+    {
+      return m_p + m_n;
+    }
+
+    template <typename T>
+    inline ArrayView<T>::operator std::valarray<T> () const
+    {
+      return m_n ? std::valarray<T>(m_p, m_n) : std::valarray<T>();
+    }
+
   } // namespace FITSUtil
 } // namespace CCfits
 
@@ -71,6 +71,28 @@ namespace CCfits
                                  = static_cast<S>(inArray[j]);
 	        }
 
+                // view to valarray conversion.
+
+	        template <typename S, typename T> 
+	        void fill(std::valarray<S>& outArray, const ArrayView<T>& inArray)
+	        {
+                         size_t n = inArray.size();
+       		         if (outArray.size() !=  n) outArray.resize(n);           
+                         for (size_t j = 0;j < n; ++j) outArray[j] 
+                                 = static_cast<S>(inArray[j]);
+	        }
+
+                // view to vector conversion.
+
+	        template <typename S, typename T> 
+	        void fill(std::vector<S>& outArray, const ArrayView<T>& inArray)
+	        {
+                         size_t n = inArray.size();
+       		         if (outArray.size() !=  n) outArray.resize(n);           
+                         for (size_t j = 0;j < n; ++j) outArray[j] 
+                                 = static_cast<S>(inArray[j]);
+	        }
+
 #ifdef TEMPLATE_AMBIG7_DEFECT
 	        template <typename S, typename T> 
 	        void fillMSva(std::vector<S>& outArray, const std::valarray<T>& inArray)
@@ -357,9 +357,9 @@ namespace CCfits {
         bool silent = false;
         throw FitsException(errMsg, silent);
      }
-     FITSUtil::CAarray<T> convert;
-     FITSUtil::auto_array_ptr<T>    pArray(convert(inData));                     
-     T* array = pArray.get();
+     // cfitsio does not change the array it writes from, so inData
+     // need not be copied.
+     T* array = &const_cast<std::valarray<T>&>(inData)[0];
 
      m_isRead = false;
      newNaxisN = 0;
@@ -0,0 +1,160 @@
+//	Astrophysics Science Division,
+//	NASA/ Goddard Space Flight Center
+//	HEASARC
+//	http://heasarc.gsfc.nasa.gov
+//	e-mail: ccfits@legacy.gsfc.nasa.gov
+//
+
+#ifdef _MSC_VER
+#include "MSconfig.h"
+#endif
+
+#include <algorithm>
+#ifdef SSTREAM_DEFECT
+#include <strstream>
+#else
+#include <sstream>
+#endif
+// HDU
+#include "HDU.h"
+// ImageTiles
+#include "ImageTiles.h"
+
+
+
+namespace CCfits {
+
+  // Class CCfits::ImageTiles
+
+  ImageTiles::ImageTiles (const HDU& hdu, const std::vector<long>& tileSize)
+    : m_axes(static_cast<size_t>(hdu.axes())),
+      m_tileSize(static_cast<size_t>(hdu.axes())),
+      m_firstVertex(),
+      m_lastVertex()
+  {
+    const size_t n = m_axes.size();
+    for (size_t i = 0; i < n; ++i) m_axes[i] = hdu.axis(i);
+
+    if (tileSize.empty())
+    {
+       defaultTileSize(hdu);
+    }
+    else
+    {
+       for (size_t i = 0; i < n; ++i)
+       {
+          const long length = i < tileSize.size() ? tileSize[i] : 0;
+          m_tileSize[i] = length > 0 ? std::min(length, m_axes[i]) : m_axes[i];
+       }
+    }
+  }
+
+
+  bool ImageTiles::next ()
+  {
+    const size_t n = m_axes.size();
+    if (m_firstVertex.empty())
+    {
+       if (count() == 0) return false;
+       m_firstVertex.assign(n, 1);
+       m_lastVertex.resize(n);
+    }
+    else
+    {
+       // advance along the first axis, carrying over to the next one
+       // at the end of each axis.
+       size_t i = 0;
+       for ( ; i < n; ++i)
+       {
+          m_firstVertex[i] += m_tileSize[i];
+          if (m_firstVertex[i] <= m_axes[i]) break;
+          m_firstVertex[i] = 1;
+       }
+       if (i == n)
+       {
+          reset();
+          return false;
+       }
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+       m_lastVertex[i] = std::min(m_firstVertex[i] + m_tileSize[i] - 1, m_axes[i]);
+    }
+    return true;
+  }
+
+  void ImageTiles::reset ()
+  {
+    m_firstVertex.clear();
+    m_lastVertex.clear();
+  }
+
+  long ImageTiles::nelements () const
+  {
+    if (m_firstVertex.empty()) return 0;
+    long n(1);
+    for (size_t i = 0; i < m_axes.size(); ++i)
+    {
+       n *= m_lastVertex[i] - m_firstVertex[i] + 1;
+    }
+    return n;
+  }
+
+  long ImageTiles::count () const
+  {
+    if (m_axes.empty()) return 0;
+    long n(1);
+    for (size_t i = 0; i < m_axes.size(); ++i)
+    {
+       if (m_axes[i] <= 0) return 0;
+       n *= (m_axes[i] + m_tileSize[i] - 1)/m_tileSize[i];
+    }
+    return n;
+  }
+
+  void ImageTiles::defaultTileSize (const HDU& hdu)
+  {
+    const size_t n = m_axes.size();
+    if (n == 0) return;
+
+    int status(0);
+    hdu.makeThisCurrent();
+    fitsfile* fPtr = hdu.fitsPointer();
+    if (fits_is_compressed_image(fPtr, &status))
+    {
+       // the compression tiles default to single rows.
+       for (size_t i = 0; i < n; ++i)
+       {
+#ifdef SSTREAM_DEFECT
+          std::ostrstream key;
+          key << "ZTILE" << i + 1 << std::ends;
+#else
+          std::ostringstream key;
+          key << "ZTILE" << i + 1;
+#endif
+          const String keyName(key.str());
+          long length(0);
+          status = 0;
+          if (fits_read_key_lng(fPtr, keyName.c_str(), &length, 0, &status) 
+                          || length <= 0)
+          {
+             length = (i == 0) ? m_axes[0] : 1;
+          }
+          m_tileSize[i] = std::min(length, m_axes[i]);
+       }
+    }
+    else
+    {
+       // whole rows, about a million pixels at a time.
+       static const long TILEPIXELS = 1L << 20;
+       m_tileSize[0] = m_axes[0];
+       for (size_t i = 1; i < n; ++i) m_tileSize[i] = 1;
+       if (n > 1 && m_axes[0] > 0)
+       {
+          m_tileSize[1] = std::min(std::max(TILEPIXELS/m_axes[0], 1L), m_axes[1]);
+       }
+    }
+  }
+
+} // namespace CCfits
@@ -0,0 +1,158 @@
+//	Astrophysics Science Division,
+//	NASA/ Goddard Space Flight Center
+//	HEASARC
+//	http://heasarc.gsfc.nasa.gov
+//	e-mail: ccfits@legacy.gsfc.nasa.gov
+//
+
+#ifndef IMAGETILES_H
+#define IMAGETILES_H 1
+
+// vector
+#include <vector>
+// CCfitsHeader
+#include "CCfits.h"
+
+namespace CCfits {
+  class HDU;
+
+} // namespace CCfits
+
+
+namespace CCfits {
+
+/*! \class ImageTiles
+
+        \brief Divides an image into N-dimensional tiles and steps through them.
+
+        An ImageTiles object is used with PHDU::readTile and ExtHDU::readTile
+        to process an image one tile at a time.  Each tile is read from the
+        file directly into an array supplied by the caller, which can be reused
+        from one tile to the next; the image cache of the HDU is not filled, so
+        only one tile needs to be held in memory.
+
+        The tiles are visited in the order of the pixels in the file, the first
+        axis varying fastest.  Tiles at the upper edge of an axis are cut short
+        if the axis length is not a multiple of the tile length.
+
+\code
+    ImageTiles tiles(image);
+    std::valarray<float> tile;
+    while (image.readTile(tiles, tile))
+    {
+        // tile holds the pixels from tiles.firstVertex() to tiles.lastVertex()
+    }
+\endcode
+
+*/
+
+/*! \fn ImageTiles::ImageTiles (const HDU& hdu, const std::vector<long>& tileSize = std::vector<long>());
+
+        \brief Constructor
+
+        \param hdu The primary HDU or image extension to be divided
+        \param tileSize The length of the tiles along each axis.  An axis with
+        no length given, or a length <= 0, is covered in full by each tile.
+
+        If tileSize is empty, the tiles of a tile-compressed image are those
+        of the compression (the ZTILEn keywords), so that each compressed
+        tile is decompressed once.  Other images are divided into groups of
+        whole rows of about a million pixels.
+*/
+
+/*! \fn bool ImageTiles::next ();
+
+        \brief Move to the next tile.
+
+        The first call moves to the first tile.  Returns false, and goes back
+        to the start, when all the tiles have been visited.
+*/
+
+/*! \fn void ImageTiles::reset ();
+
+        \brief Go back to the start: the next call to next() moves to the first tile.
+*/
+
+/*! \fn const std::vector<long>& ImageTiles::firstVertex () const;
+
+        \brief The (1-based) coordinates of the first pixel of the current tile.
+*/
+
+/*! \fn const std::vector<long>& ImageTiles::lastVertex () const;
+
+        \brief The (1-based) coordinates of the last pixel of the current tile.
+*/
+
+/*! \fn const std::vector<long>& ImageTiles::tileSize () const;
+
+        \brief The length of the tiles along each axis.
+*/
+
+/*! \fn long ImageTiles::nelements () const;
+
+        \brief The number of pixels in the current tile, 0 if next() has not been called.
+*/
+
+/*! \fn long ImageTiles::count () const;
+
+        \brief The number of tiles in the image.
+*/
+
+
+
+  class ImageTiles
+  {
+
+    public:
+        ImageTiles (const HDU& hdu, const std::vector<long>& tileSize = std::vector<long>());
+
+        bool next ();
+        void reset ();
+        long nelements () const;
+        long count () const;
+        const std::vector<long>& firstVertex () const;
+        const std::vector<long>& lastVertex () const;
+        const std::vector<long>& tileSize () const;
+
+      // Additional Public Declarations
+
+    protected:
+      // Additional Protected Declarations
+
+    private:
+        void defaultTileSize (const HDU& hdu);
+
+      // Additional Private Declarations
+
+    private: //## implementation
+      // Data Members for Class Attributes
+        std::vector<long> m_axes;
+        std::vector<long> m_tileSize;
+        std::vector<long> m_firstVertex;
+        std::vector<long> m_lastVertex;
+
+      // Additional Implementation Declarations
+
+  };
+
+  // Class CCfits::ImageTiles
+
+  inline const std::vector<long>& ImageTiles::firstVertex () const
+  {
+    return m_firstVertex;
+  }
+
+  inline const std::vector<long>& ImageTiles::lastVertex () const
+  {
+    return m_lastVertex;
+  }
+
+  inline const std::vector<long>& ImageTiles::tileSize () const
+  {
+    return m_tileSize;
+  }
+
+} // namespace CCfits
+
+
+#endif
@@ -17,6 +17,8 @@
 #include "FITS.h"
 // FITSUtil
 #include "FITSUtil.h"
+// ImageTiles
+#include "ImageTiles.h"
 
 namespace CCfits {
   class FITSBase;
@@ -187,6 +189,28 @@ namespace CCfits {
 
 */
 
+/*! \fn      template<typename S> bool PHDU::readTile (ImageTiles& tiles, 
+                                std::valarray<S>& tile, 
+                                S* nullValue = 0);
+
+                \brief read the next tile of the image
+
+                Moves tiles to its next tile and reads it into tile, which is
+                resized only if the number of pixels changes, processing null
+                values if nullValue is given.  Returns false, and leaves tile
+                unchanged, once all the tiles have been read.
+
+                The pixels are read directly from the file and converted to
+                type S by cfitsio; the image cache used by read() is neither
+                filled nor consulted, so that images too large to be held in
+                memory can be processed tile by tile.
+
+                \param tiles the division of the image into tiles (see ImageTiles)
+                \param tile  array receiving the pixels of the tile
+                \param nullValue if not null, undefined pixels are set to *nullValue
+
+*/
+
 /*! \fn      template <typename S> void PHDU::write(const std::vector<long>& first,
                     long nElements,
                     const std::valarray<S>& data,
@@ -359,6 +383,10 @@ namespace CCfits {
 				const std::vector<long>& stride, 
                                 S* nullValue) ; 
 
+        // read an image one tile at a time, bypassing the image cache.
+        template<typename S>
+        bool readTile (ImageTiles& tiles, std::valarray<S>& tile, S* nullValue = 0);
+
 
     protected:
         PHDU(const PHDU &right);
@@ -571,6 +571,26 @@ namespace CCfits
                 }  
         }  
 
+        template <typename S>
+        bool PHDU::readTile (ImageTiles& tiles, std::valarray<S>& tile, S* nullValue)
+        {
+                if (!tiles.next()) return false;
+                makeThisCurrent();
+                const size_t n = static_cast<size_t>(tiles.nelements());
+                if (tile.size() != n) tile.resize(n);
+
+                // fits_read_subset takes non-const vertex arrays.
+                std::vector<long> firstVertex(tiles.firstVertex());
+                std::vector<long> lastVertex(tiles.lastVertex());
+                std::vector<long> stride(firstVertex.size(), 1);
+                FITSUtil::MatchType<S> imageType;
+                int status(0);
+                int any(0);
+                if (fits_read_subset(fitsPointer(), imageType(), &firstVertex[0],
+                                &lastVertex[0], &stride[0], nullValue, &tile[0],
+                                &any, &status) != 0) throw FitsError(status);
+                return true;
+        }
 
 
 
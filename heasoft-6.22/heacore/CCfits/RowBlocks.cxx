@@ -0,0 +1,169 @@
+//	Astrophysics Science Division,
+//	NASA/ Goddard Space Flight Center
+//	HEASARC
+//	http://heasarc.gsfc.nasa.gov
+//	e-mail: ccfits@legacy.gsfc.nasa.gov
+//
+
+#ifdef _MSC_VER
+#include "MSconfig.h"
+#endif
+
+#include <algorithm>
+#ifdef SSTREAM_DEFECT
+#include <strstream>
+#else
+#include <sstream>
+#endif
+// Column
+#include "Column.h"
+// ExtHDU
+#include "ExtHDU.h"
+// RowBlocks
+#include "RowBlocks.h"
+
+
+
+namespace CCfits {
+
+  // Class CCfits::RowBlocks::ColumnBuffer
+
+  RowBlocks::ColumnBuffer::ColumnBuffer (int index, long elementsPerRow, long width)
+    : m_index(index), m_elementsPerRow(elementsPerRow), m_width(width)
+  {
+  }
+
+
+  RowBlocks::ColumnBuffer::~ColumnBuffer()
+  {
+  }
+
+
+  template <>
+  void RowBlocks::ColumnBufferT<String>::read (fitsfile* fPtr, long firstRow, long nRows)
+  {
+    const size_t n = static_cast<size_t>(nRows*m_elementsPerRow);
+    if (m_data.size() != n) m_data.resize(n);
+    if (n == 0) return;
+
+    // one buffer holds all the strings of the block.
+    const size_t length = static_cast<size_t>(m_width) + 1;
+    std::vector<char> buffer(n*length);
+    std::vector<char*> array(n);
+    for (size_t i = 0; i < n; ++i) array[i] = &buffer[i*length];
+
+    char empty[] = {""};
+    char* nulval = m_nullValue ? const_cast<char*>(m_nullValue->c_str()) : empty;
+    int status(0);
+    int any(0);
+    if (fits_read_col_str(fPtr, m_index, firstRow, 1, static_cast<LONGLONG>(n),
+                    nulval, &array[0], &any, &status) != 0) throw FitsError(status);
+    for (size_t i = 0; i < n; ++i) m_data[i] = array[i];
+  }
+
+  // Class CCfits::RowBlocks
+
+  RowBlocks::RowBlocks (const ExtHDU& table, long firstRow, long lastRow, long blockRows)
+    : m_table(&table),
+      m_first(firstRow),
+      m_last(lastRow),
+      m_blockRows(blockRows),
+      m_blockFirst(0),
+      m_blockLast(-1),
+      m_buffers()
+  {
+    // rows() throws WrongExtensionType for images.
+    const long nRows = table.rows();
+    if (m_last <= 0) m_last = nRows;
+    if (m_first < 1 || m_last > nRows || m_first > m_last + 1)
+    {
+#ifdef SSTREAM_DEFECT
+       std::ostrstream msg;
+       msg << " rows " << m_first << " to " << m_last << " of " << table.name()
+           << " (" << nRows << " rows)" << std::ends;
+#else
+       std::ostringstream msg;
+       msg << " rows " << m_first << " to " << m_last << " of " << table.name()
+           << " (" << nRows << " rows)";
+#endif
+       throw Column::InvalidRowParameter(msg.str());
+    }
+    if (m_blockRows <= 0)
+    {
+       table.makeThisCurrent();
+       m_blockRows = std::max(table.getRowsize(), 1L);
+    }
+  }
+
+
+  RowBlocks::~RowBlocks()
+  {
+    for (size_t i = 0; i < m_buffers.size(); ++i) delete m_buffers[i];
+  }
+
+
+  bool RowBlocks::next ()
+  {
+    const long first = m_blockFirst == 0 ? m_first : m_blockLast + 1;
+    if (first > m_last)
+    {
+       reset();
+       return false;
+    }
+    m_blockFirst = first;
+    m_blockLast = std::min(first + m_blockRows - 1, m_last);
+    return true;
+  }
+
+  void RowBlocks::reset ()
+  {
+    m_blockFirst = 0;
+    m_blockLast = -1;
+  }
+
+  long RowBlocks::count () const
+  {
+    return (m_last - m_first + m_blockRows)/m_blockRows;
+  }
+
+  void RowBlocks::read (fitsfile* fPtr)
+  {
+    for (size_t i = 0; i < m_buffers.size(); ++i)
+    {
+       m_buffers[i]->read(fPtr, m_blockFirst, rows());
+    }
+  }
+
+  int RowBlocks::findColumn (const String& columnName, long& elementsPerRow, long* width) const
+  {
+    // column() throws NoSuchColumn if there is no such column.
+    Column& col = m_table->column(columnName);
+    if (col.varLength())
+    {
+       String msg(" variable length column ");
+       msg += col.name();
+       msg += " cannot be read in blocks of rows";
+       throw Column::WrongColumnType(msg);
+    }
+    elementsPerRow = static_cast<long>(col.repeat());
+    if (width)
+    {
+       if (col.type() == Tstring)
+       {
+          *width = std::max(col.width(), 1L);
+          elementsPerRow = std::max(elementsPerRow/(*width), 1L);
+       }
+       else
+       {
+          int status(0);
+          int displayWidth(0);
+          m_table->makeThisCurrent();
+          if (fits_get_col_display_width(m_table->fitsPointer(), col.index(),
+                                  &displayWidth, &status) != 0) throw FitsError(status);
+          *width = displayWidth;
+       }
+    }
+    return col.index();
+  }
+
+} // namespace CCfits
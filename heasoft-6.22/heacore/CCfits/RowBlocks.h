@@ -0,0 +1,279 @@
+//	Astrophysics Science Division,
+//	NASA/ Goddard Space Flight Center
+//	HEASARC
+//	http://heasarc.gsfc.nasa.gov
+//	e-mail: ccfits@legacy.gsfc.nasa.gov
+//
+
+#ifndef ROWBLOCKS_H
+#define ROWBLOCKS_H 1
+
+// vector
+#include <vector>
+// CCfitsHeader
+#include "CCfits.h"
+// FitsError
+#include "FitsError.h"
+// FITSUtil
+#include "FITSUtil.h"
+
+namespace CCfits {
+  class ExtHDU;
+
+} // namespace CCfits
+
+
+namespace CCfits {
+
+/*! \class RowBlocks
+
+        \brief Reads a set of table columns together, one block of rows at a time.
+
+        A RowBlocks object is used with ExtHDU::readRows to stream several
+        columns of a table.  Each column is bound with add() to an array
+        supplied by the caller, giving a struct-of-arrays view of the current
+        block of rows.  Each call to ExtHDU::readRows moves to the next block
+        and reads all the bound columns for it, so that the rows of the block
+        are read from the file once whatever the number of columns.  The
+        Column objects of the table are not filled, so only one block of rows
+        needs to be held in memory.
+
+        For each block, element j of row firstRow() + i of a column with n
+        elements per row is at index i*n + j of its array.  The arrays are
+        resized only when the number of rows in the block changes.
+
+\code
+    RowBlocks rows(table);
+    std::vector<double> time;
+    std::vector<float> energy;
+    rows.add("TIME", time);
+    rows.add("ENERGY", energy);
+    while (table.readRows(rows))
+    {
+        // time and energy hold rows rows.firstRow() to rows.lastRow()
+    }
+\endcode
+
+*/
+
+/*! \fn RowBlocks::RowBlocks (const ExtHDU& table, long firstRow = 1, long lastRow = 0, long blockRows = 0);
+
+        \brief Constructor
+
+        \param table The table extension to be read.  A WrongExtensionType
+        exception is thrown if it is an image.
+        \param firstRow The first row (1-based) to be read
+        \param lastRow The last row to be read.  If <= 0, the rows are read to the end of the table.
+        \param blockRows The number of rows read at a time.  If <= 0, the number
+        of rows that fit in cfitsio's I/O buffers (see ExtHDU::getRowsize) is used.
+
+        A Column::InvalidRowParameter exception is thrown if the row range is
+        not within the table.
+*/
+
+/*! \fn template <typename S> void RowBlocks::add (const String& columnName, std::vector<S>& data, S* nullValue = 0);
+
+        \brief Bind a column to an array.
+
+        The column is read into data, converting to type S where necessary,
+        each time the block moves.  S may be any numeric type, std::complex
+        (for complex columns) or String.  If nullValue is given, undefined
+        values are set to *nullValue; it must remain valid while rows are read.
+        data must remain valid as long as *this is used.
+
+        A Table::NoSuchColumn exception is thrown if the table has no
+        column of that name, and a Column::WrongColumnType exception if
+        the column has variable length rows.
+*/
+
+/*! \fn bool RowBlocks::next ();
+
+        \brief Move to the next block of rows.
+
+        Called by ExtHDU::readRows; the first call moves to the first block.
+        Returns false, and goes back to the start, when all the rows have been visited.
+*/
+
+/*! \fn void RowBlocks::reset ();
+
+        \brief Go back to the start: the next call to next() moves to the first block.
+*/
+
+/*! \fn long RowBlocks::firstRow () const;
+
+        \brief The first row of the current block, 0 if next() has not been called.
+*/
+
+/*! \fn long RowBlocks::lastRow () const;
+
+        \brief The last row of the current block, -1 if next() has not been called.
+*/
+
+/*! \fn long RowBlocks::rows () const;
+
+        \brief The number of rows in the current block.
+*/
+
+/*! \fn long RowBlocks::blockRows () const;
+
+        \brief The maximum number of rows read at a time.
+*/
+
+/*! \fn long RowBlocks::count () const;
+
+        \brief The number of blocks in the row range.
+*/
+
+
+
+  class RowBlocks
+  {
+
+    public:
+        RowBlocks (const ExtHDU& table, long firstRow = 1, long lastRow = 0, long blockRows = 0);
+        ~RowBlocks();
+
+        template <typename S>
+        void add (const String& columnName, std::vector<S>& data, S* nullValue = 0);
+        bool next ();
+        void reset ();
+        long firstRow () const;
+        long lastRow () const;
+        long rows () const;
+        long blockRows () const;
+        long count () const;
+        const ExtHDU& table () const;
+
+      // Additional Public Declarations
+
+    protected:
+      // Additional Protected Declarations
+
+    private:
+        RowBlocks(const RowBlocks &right);
+        RowBlocks & operator=(const RowBlocks &right);
+
+        // read the current block of all the bound columns from fPtr, which
+        // must be positioned at the table.
+        void read (fitsfile* fPtr);
+
+      // Additional Private Declarations
+
+      // A column bound to the caller's array.
+      class ColumnBuffer
+      {
+        public:
+            ColumnBuffer (int index, long elementsPerRow, long width);
+            virtual ~ColumnBuffer();
+            virtual void read (fitsfile* fPtr, long firstRow, long nRows) = 0;
+
+        protected:
+            int m_index;
+            long m_elementsPerRow;
+            long m_width;
+      };
+
+      template <typename S>
+      class ColumnBufferT : public ColumnBuffer
+      {
+        public:
+            ColumnBufferT (int index, long elementsPerRow, long width, std::vector<S>& data, S* nullValue);
+            virtual void read (fitsfile* fPtr, long firstRow, long nRows);
+
+        private:
+            std::vector<S>& m_data;
+            S* m_nullValue;
+      };
+
+      // returns the column number and the number of elements per row,
+      // throwing if the column has variable length rows.  If width is
+      // not null it is set to the length of the column's values as strings.
+      int findColumn (const String& columnName, long& elementsPerRow, long* width = 0) const;
+
+    private: //## implementation
+      // Data Members for Class Attributes
+        const ExtHDU* m_table;
+        long m_first;
+        long m_last;
+        long m_blockRows;
+        long m_blockFirst;
+        long m_blockLast;
+        std::vector<ColumnBuffer*> m_buffers;
+
+      // Additional Implementation Declarations
+      friend class ExtHDU;
+  };
+
+  // Class CCfits::RowBlocks
+
+  inline long RowBlocks::firstRow () const
+  {
+    return m_blockFirst;
+  }
+
+  inline long RowBlocks::lastRow () const
+  {
+    return m_blockLast;
+  }
+
+  inline long RowBlocks::rows () const
+  {
+    return m_blockLast - m_blockFirst + 1;
+  }
+
+  inline long RowBlocks::blockRows () const
+  {
+    return m_blockRows;
+  }
+
+  inline const ExtHDU& RowBlocks::table () const
+  {
+    return *m_table;
+  }
+
+  template <typename S>
+  void RowBlocks::add (const String& columnName, std::vector<S>& data, S* nullValue)
+  {
+    long elementsPerRow(0);
+    const int index = findColumn(columnName, elementsPerRow);
+    m_buffers.reserve(m_buffers.size() + 1);
+    m_buffers.push_back(new ColumnBufferT<S>(index, elementsPerRow, 0, data, nullValue));
+  }
+
+  template <>
+  inline void RowBlocks::add (const String& columnName, std::vector<String>& data, String* nullValue)
+  {
+    long elementsPerRow(0);
+    long width(0);
+    const int index = findColumn(columnName, elementsPerRow, &width);
+    m_buffers.reserve(m_buffers.size() + 1);
+    m_buffers.push_back(new ColumnBufferT<String>(index, elementsPerRow, width, data, nullValue));
+  }
+
+  template <typename S>
+  RowBlocks::ColumnBufferT<S>::ColumnBufferT (int index, long elementsPerRow, long width, std::vector<S>& data, S* nullValue)
+    : ColumnBuffer(index, elementsPerRow, width), m_data(data), m_nullValue(nullValue)
+  {
+  }
+
+  template <typename S>
+  void RowBlocks::ColumnBufferT<S>::read (fitsfile* fPtr, long firstRow, long nRows)
+  {
+    const size_t n = static_cast<size_t>(nRows*m_elementsPerRow);
+    if (m_data.size() != n) m_data.resize(n);
+    if (n == 0) return;
+    FITSUtil::MatchType<S> columnType;
+    int status(0);
+    int any(0);
+    if (fits_read_col(fPtr, columnType(), m_index, firstRow, 1,
+                    static_cast<LONGLONG>(n), m_nullValue, &m_data[0],
+                    &any, &status) != 0) throw FitsError(status);
+  }
+
+  template <>
+  void RowBlocks::ColumnBufferT<String>::read (fitsfile* fPtr, long firstRow, long nRows);
+
+} // namespace CCfits
+
+
+#endif
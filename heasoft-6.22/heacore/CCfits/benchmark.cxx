@@ -0,0 +1,462 @@
+// benchmark CCfits timing and allocation program
+//	Astrophysics Science Division,
+//	NASA/ Goddard Space Flight Center
+//	HEASARC
+//	http://heasarc.gsfc.nasa.gov
+//	e-mail: ccfits@legacy.gsfc.nasa.gov
+//
+
+// Times common CCfits operations on generated files and compares them
+// with the equivalent cfitsio calls.  For each scenario the program reports
+// the best time of several runs, the rows (or keywords) per second and the
+// data rate, the number and size of the C++ heap allocations made by the
+// last run, and the peak resident set size of the process so far.
+//
+// Allocations are counted by replacing the global operator new, so they
+// cover CCfits and the standard library but not cfitsio's own malloc calls.
+// The peak RSS is a high water mark for the whole process; use -only to run
+// a single scenario when it matters.
+//
+// usage: benchmark [-rows n] [-cols n] [-width n] [-image n] [-keys n]
+//                  [-loops n] [-dir path] [-only scenario]
+//
+// The scenarios are columns (open a table and read all its scalar
+// columns), blocks (the same with RowBlocks), vector (read a vector
+// column), image (write a square float image) and keywords (write a header
+// with many keywords and read it back).
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <CCfits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+using namespace CCfits;
+
+// C++ heap allocation counters, updated by the operators below.
+
+namespace {
+    size_t s_allocations = 0;
+    size_t s_allocatedBytes = 0;
+    size_t s_liveBytes = 0;
+    size_t s_peakBytes = 0;
+}
+
+// The block size is taken from the allocator so that the pointers handed
+// out are exactly those returned by malloc.  Where there is no way to ask
+// for it only the number of allocations and bytes requested are counted.
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define BENCHMARK_BLOCK_SIZE(p) malloc_usable_size(p)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define BENCHMARK_BLOCK_SIZE(p) malloc_size(p)
+#else
+#define BENCHMARK_BLOCK_SIZE(p) 0
+#endif
+
+#if __cplusplus >= 201103L
+#define BENCHMARK_THROW_BAD_ALLOC
+#define BENCHMARK_NO_THROW noexcept
+#else
+#define BENCHMARK_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define BENCHMARK_NO_THROW throw ()
+#endif
+
+void* operator new (size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    ++s_allocations;
+    s_allocatedBytes += size;
+    s_liveBytes += BENCHMARK_BLOCK_SIZE(p);
+    if (s_liveBytes > s_peakBytes) s_peakBytes = s_liveBytes;
+    return p;
+}
+
+void operator delete (void* ptr) BENCHMARK_NO_THROW
+{
+    if (!ptr) return;
+    s_liveBytes -= BENCHMARK_BLOCK_SIZE(ptr);
+    std::free(ptr);
+}
+
+void* operator new[] (size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+void operator delete[] (void* ptr) BENCHMARK_NO_THROW
+{
+    operator delete(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete (void* ptr, size_t) BENCHMARK_NO_THROW
+{
+    operator delete(ptr);
+}
+
+void operator delete[] (void* ptr, size_t) BENCHMARK_NO_THROW
+{
+    operator delete(ptr);
+}
+#endif
+
+namespace {
+
+    struct Options
+    {
+        long rows;
+        int cols;
+        long width;
+        long image;
+        int keys;
+        int loops;
+        String dir;
+        String only;
+    };
+
+    struct Result
+    {
+        double seconds;
+        size_t allocations;
+        size_t allocatedBytes;
+        size_t peakBytes;
+    };
+
+    double now ()
+    {
+        timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec + 1.e-6*tv.tv_usec;
+    }
+
+    double peakRSS ()
+    {
+        // in MB; ru_maxrss is in kilobytes except on Mac OS X.
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss/1048576.;
+#else
+        return usage.ru_maxrss/1024.;
+#endif
+    }
+
+    void check (int status)
+    {
+        if (status) throw FitsError(status);
+    }
+
+    String columnName (int i)
+    {
+        char name[16];
+        std::sprintf(name, "C%d", i + 1);
+        return name;
+    }
+
+    String keywordName (int i)
+    {
+        char name[16];
+        std::sprintf(name, "KEY%d", i + 1);
+        return name;
+    }
+
+    // a binary table BENCH with cols scalar double columns and a
+    // vector float column VEC, written with cfitsio.
+    void makeTable (const Options& opt, const String& file)
+    {
+        int status(0);
+        fitsfile* fptr(0);
+        String name("!" + file);
+        check(fits_create_file(&fptr, name.c_str(), &status));
+
+        std::vector<String> types(opt.cols + 1, "D");
+        std::vector<String> names(opt.cols + 1);
+        std::vector<char*> ttype(opt.cols + 1), tform(opt.cols + 1);
+        char width[32];
+        std::sprintf(width, "%ldE", opt.width);
+        types[opt.cols] = width;
+        for (int i = 0; i <= opt.cols; ++i)
+        {
+            names[i] = i < opt.cols ? columnName(i) : String("VEC");
+            ttype[i] = const_cast<char*>(names[i].c_str());
+            tform[i] = const_cast<char*>(types[i].c_str());
+        }
+        char extname[] = "BENCH";
+        check(fits_create_tbl(fptr, BINARY_TBL, opt.rows, opt.cols + 1,
+                        &ttype[0], &tform[0], 0, extname, &status));
+
+        std::vector<double> d(opt.rows);
+        for (int i = 0; i < opt.cols; ++i)
+        {
+            for (long j = 0; j < opt.rows; ++j) d[j] = i + 1.e-3*j;
+            check(fits_write_col(fptr, TDOUBLE, i + 1, 1, 1, opt.rows, &d[0], &status));
+        }
+        std::vector<float> v(opt.rows*opt.width);
+        for (size_t j = 0; j < v.size(); ++j) v[j] = 0.5f*j;
+        check(fits_write_col(fptr, TFLOAT, opt.cols + 1, 1, 1, v.size(), &v[0], &status));
+        check(fits_close_file(fptr, &status));
+    }
+
+    void ccfitsColumns (const Options& opt, const String& file)
+    {
+        FITS f(file, Read, String("BENCH"), false);
+        ExtHDU& table = f.extension("BENCH");
+        std::vector<double> d;
+        for (int i = 0; i < opt.cols; ++i)
+        {
+            table.column(columnName(i)).read(d, 1, opt.rows);
+        }
+    }
+
+    void ccfitsBlocks (const Options& opt, const String& file)
+    {
+        FITS f(file, Read, String("BENCH"), false);
+        ExtHDU& table = f.extension("BENCH");
+        RowBlocks rows(table);
+        std::vector<std::vector<double> > d(opt.cols);
+        for (int i = 0; i < opt.cols; ++i) rows.add(columnName(i), d[i]);
+        while (table.readRows(rows)) ;
+    }
+
+    void cfitsioColumns (const Options& opt, const String& file)
+    {
+        int status(0);
+        fitsfile* fptr(0);
+        char extname[] = "BENCH";
+        check(fits_open_file(&fptr, file.c_str(), READONLY, &status));
+        check(fits_movnam_hdu(fptr, BINARY_TBL, extname, 0, &status));
+        std::vector<double> d(opt.rows);
+        for (int i = 0; i < opt.cols; ++i)
+        {
+            check(fits_read_col(fptr, TDOUBLE, i + 1, 1, 1, opt.rows, 0, &d[0], 0, &status));
+        }
+        check(fits_close_file(fptr, &status));
+    }
+
+    void ccfitsVector (const Options& opt, const String& file)
+    {
+        FITS f(file, Read, String("BENCH"), false);
+        ExtHDU& table = f.extension("BENCH");
+        std::vector<std::valarray<float> > v;
+        table.column("VEC").readArrays(v, 1, opt.rows);
+    }
+
+    void cfitsioVector (const Options& opt, const String& file)
+    {
+        int status(0);
+        fitsfile* fptr(0);
+        char extname[] = "BENCH";
+        int colnum(0);
+        char vec[] = "VEC";
+        check(fits_open_file(&fptr, file.c_str(), READONLY, &status));
+        check(fits_movnam_hdu(fptr, BINARY_TBL, extname, 0, &status));
+        check(fits_get_colnum(fptr, CASEINSEN, vec, &colnum, &status));
+        std::vector<float> v(opt.rows*opt.width);
+        check(fits_read_col(fptr, TFLOAT, colnum, 1, 1, v.size(), 0, &v[0], 0, &status));
+        check(fits_close_file(fptr, &status));
+    }
+
+    void ccfitsImage (const Options& opt, const String& file)
+    {
+        std::vector<long> axes(2, opt.image);
+        FITS f("!" + file, FLOAT_IMG, 2, &axes[0]);
+        std::valarray<float> pixels(opt.image*opt.image);
+        for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = 0.25f*i;
+        f.pHDU().write(1, pixels.size(), pixels);
+    }
+
+    void cfitsioImage (const Options& opt, const String& file)
+    {
+        int status(0);
+        fitsfile* fptr(0);
+        long axes[] = {opt.image, opt.image};
+        String name("!" + file);
+        check(fits_create_file(&fptr, name.c_str(), &status));
+        check(fits_create_img(fptr, FLOAT_IMG, 2, axes, &status));
+        std::vector<float> pixels(opt.image*opt.image);
+        for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = 0.25f*i;
+        check(fits_write_img(fptr, TFLOAT, 1, pixels.size(), &pixels[0], &status));
+        check(fits_close_file(fptr, &status));
+    }
+
+    void ccfitsKeywords (const Options& opt, const String& file)
+    {
+        {
+            FITS f("!" + file, BYTE_IMG, 0, static_cast<long*>(0));
+            for (int i = 0; i < opt.keys; ++i)
+            {
+                f.pHDU().addKey(keywordName(i), 0.5*i, "benchmark keyword");
+            }
+        }
+        FITS f(file, Read, false);
+        f.pHDU().readAllKeys();
+        double value(0);
+        for (int i = 0; i < opt.keys; ++i)
+        {
+            f.pHDU().keyWord(keywordName(i)).value(value);
+        }
+    }
+
+    void cfitsioKeywords (const Options& opt, const String& file)
+    {
+        int status(0);
+        fitsfile* fptr(0);
+        String name("!" + file);
+        char comment[] = "benchmark keyword";
+        check(fits_create_file(&fptr, name.c_str(), &status));
+        check(fits_create_img(fptr, BYTE_IMG, 0, 0, &status));
+        for (int i = 0; i < opt.keys; ++i)
+        {
+            check(fits_write_key_dbl(fptr, keywordName(i).c_str(), 0.5*i, -15, comment, &status));
+        }
+        check(fits_close_file(fptr, &status));
+
+        check(fits_open_file(&fptr, file.c_str(), READONLY, &status));
+        double value(0);
+        for (int i = 0; i < opt.keys; ++i)
+        {
+            check(fits_read_key_dbl(fptr, keywordName(i).c_str(), &value, 0, &status));
+        }
+        check(fits_close_file(fptr, &status));
+    }
+
+    typedef void (*Scenario)(const Options&, const String&);
+
+    Result run (Scenario scenario, const Options& opt, const String& file)
+    {
+        Result result;
+        result.seconds = -1;
+        for (int i = 0; i < opt.loops; ++i)
+        {
+            s_allocations = 0;
+            s_allocatedBytes = 0;
+            s_peakBytes = s_liveBytes;
+            const size_t startBytes = s_liveBytes;
+            const double start = now();
+            scenario(opt, file);
+            const double seconds = now() - start;
+            if (result.seconds < 0 || seconds < result.seconds) result.seconds = seconds;
+            result.allocations = s_allocations;
+            result.allocatedBytes = s_allocatedBytes;
+            result.peakBytes = s_peakBytes - startBytes;
+        }
+        return result;
+    }
+
+    void report (const String& scenario, const String& library, const Result& result,
+                    double count, double bytes)
+    {
+        const double MB = 1048576.;
+        const double seconds = result.seconds > 0 ? result.seconds : 1.e-9;
+        std::cout << std::left << std::setw(10) << scenario
+                  << std::setw(10) << library << std::right << std::fixed
+                  << std::setprecision(4) << std::setw(10) << result.seconds
+                  << std::setprecision(0) << std::setw(14) << count/seconds
+                  << std::setprecision(1) << std::setw(10) << bytes/MB/seconds
+                  << std::setw(10) << result.allocations
+                  << std::setw(12) << result.allocatedBytes/MB
+                  << std::setw(12) << result.peakBytes/MB
+                  << std::setw(10) << peakRSS() << std::endl;
+    }
+
+    void compare (const String& scenario, const Options& opt, const String& file,
+                    Scenario ccfits, Scenario cfitsio, double count, double bytes)
+    {
+        if (!opt.only.empty() && opt.only != scenario) return;
+        if (cfitsio) report(scenario, "cfitsio", run(cfitsio, opt, file), count, bytes);
+        report(scenario, "CCfits", run(ccfits, opt, file), count, bytes);
+    }
+
+    void usage ()
+    {
+        std::cerr << "usage: benchmark [-rows n] [-cols n] [-width n] [-image n] [-keys n]\n"
+                  << "                 [-loops n] [-dir path] [-only scenario]\n"
+                  << "scenarios: columns blocks vector image keywords" << std::endl;
+        std::exit(1);
+    }
+}
+
+
+int main (int argc, char** argv)
+{
+    Options opt;
+    opt.rows = 1000000;
+    opt.cols = 8;
+    opt.width = 16;
+    opt.image = 2048;
+    opt.keys = 1000;
+    opt.loops = 3;
+    opt.dir = ".";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const String arg(argv[i]);
+        if (i + 1 == argc) usage();
+        const char* value = argv[++i];
+        if (arg == "-rows") opt.rows = std::atol(value);
+        else if (arg == "-cols") opt.cols = std::atoi(value);
+        else if (arg == "-width") opt.width = std::atol(value);
+        else if (arg == "-image") opt.image = std::atol(value);
+        else if (arg == "-keys") opt.keys = std::atoi(value);
+        else if (arg == "-loops") opt.loops = std::atoi(value);
+        else if (arg == "-dir") opt.dir = value;
+        else if (arg == "-only") opt.only = value;
+        else usage();
+    }
+    if (opt.rows < 1 || opt.cols < 1 || opt.width < 1 || opt.image < 1
+                    || opt.keys < 1 || opt.loops < 1) usage();
+
+    const String table(opt.dir + "/benchmark_table.fits");
+    const String image(opt.dir + "/benchmark_image.fits");
+    const String header(opt.dir + "/benchmark_keys.fits");
+
+    try
+    {
+        std::cout << "rows " << opt.rows << ", columns " << opt.cols
+                  << ", vector width " << opt.width << ", image " << opt.image
+                  << "x" << opt.image << ", keywords " << opt.keys
+                  << ", best of " << opt.loops << "\n\n"
+                  << std::left << std::setw(10) << "scenario" << std::setw(10) << "library"
+                  << std::right << std::setw(10) << "seconds" << std::setw(14) << "rows/s"
+                  << std::setw(10) << "MB/s" << std::setw(10) << "allocs"
+                  << std::setw(12) << "alloc MB" << std::setw(12) << "peak MB"
+                  << std::setw(10) << "RSS MB" << std::endl;
+
+        makeTable(opt, table);
+        const double rows = static_cast<double>(opt.rows);
+        compare("columns", opt, table, ccfitsColumns, cfitsioColumns,
+                        rows, rows*opt.cols*sizeof(double));
+        compare("blocks", opt, table, ccfitsBlocks, 0,
+                        rows, rows*opt.cols*sizeof(double));
+        compare("vector", opt, table, ccfitsVector, cfitsioVector,
+                        rows, rows*opt.width*sizeof(float));
+        compare("image", opt, image, ccfitsImage, cfitsioImage,
+                        static_cast<double>(opt.image),
+                        static_cast<double>(opt.image)*opt.image*sizeof(float));
+        compare("keywords", opt, header, ccfitsKeywords, cfitsioKeywords,
+                        static_cast<double>(opt.keys), 80.*opt.keys);
+
+        std::remove(table.c_str());
+        std::remove(image.c_str());
+        std::remove(header.c_str());
+    }
+    catch (FitsException& e)
+    {
+        std::cerr << "benchmark failed: " << e.message() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -7,7 +7,9 @@
 /// \section ahgen_ahrandom Random Numbers - ahrandom
 ///
 /// This library provides wrapper routines for the Marsenne Twister random
-/// number generator provided by HEADAS.
+/// number generator provided by HEADAS.  The RandomStream class provides
+/// separate streams of random numbers from the counter-based generator in
+/// HEADAS, for use by multiple threads.
 ///
 
 #ifndef AHGEN_AHRANDOM_H
@@ -18,6 +20,8 @@ AHVERSION(AHGEN_AHRANDOM,"$Id$")
 
 #include "ahlog/ahlog.h"
 
+#include "headas_rand.h"
+
 /// \ingroup mod_ahgen
 namespace ahgen {
 
@@ -45,6 +49,55 @@ double getRandom(void);
 /// \return random integer
 int getRandomInt(int minval, int maxval);
 
+/// \brief a stream of random numbers independent of all others
+///
+/// Each stream is identified by a seed and a stream number, and the nth
+/// number of a stream depends on nothing else, so a calculation which gives
+/// each thread (or each photon, source, etc.) its own stream, or its own
+/// block of one stream, gives the same results whatever the number of
+/// threads.  Streams use the Philox counter-based generator (HDphilox_*)
+/// rather than the Mersenne Twister behind getRandom().
+class RandomStream {
+  public:
+
+    /// \brief start a stream at its first number
+    /// \param[in] seed value of seed to use (=0 to use current time)
+    /// \param[in] stream stream number
+    RandomStream(unsigned long int seed, unsigned long int stream=0);
+
+    /// \brief return random number between [0:1)
+    /// \return next random number
+    double get();
+
+    /// \brief return random integer in given range
+    /// \param[in] minval minimum value of random integer
+    /// \param[in] maxval maximum value of random integer
+    /// \return random integer
+    int getInt(int minval, int maxval);
+
+    /// \brief fill an array with random numbers between [0:1)
+    /// \param[out] values array to fill
+    /// \param[in] num number of values, the same as num calls to get()
+    /// \param[in] nthreads maximum number of threads to use
+    void fill(double* values, long num, int nthreads=1);
+
+    /// \brief skip over random numbers
+    /// \param[in] num number of calls to get() to skip
+    void jump(unsigned long long num);
+
+    /// \brief return another stream with the same seed
+    /// \param[in] stream stream number
+    /// \return the new stream, at its first number
+    RandomStream split(unsigned long int stream) const;
+
+    /// \brief return the seed (useful when seeded from the time)
+    unsigned long int seed() const { return m_seed; }
+
+  private:
+    unsigned long int m_seed;
+    HDphilox_state m_state;
+};
+
 } // namespace ahgen
 
 /** @} */
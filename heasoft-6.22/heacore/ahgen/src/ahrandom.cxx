@@ -28,7 +28,7 @@ HDmt_state* & getRandSeedState() {
 
 // -----------------------------------------------------------------------------
 
-void seedRandom(unsigned long int seedIn) {
+static unsigned long int timeSeed(unsigned long int seedIn) {
   unsigned long int seed = seedIn;
   if (0 == seedIn) {
     struct timeval tt;      // time structure
@@ -40,7 +40,13 @@ void seedRandom(unsigned long int seedIn) {
     time_us = tt.tv_usec;      // time in micro seconds
     seed = time_s + time_us;   // combine into powerfully random seed
   }
-  getRandSeedState() = HDmt_srand(seed);
+  return seed;
+}
+
+// -----------------------------------------------------------------------------
+
+void seedRandom(unsigned long int seedIn) {
+  getRandSeedState() = HDmt_srand(timeSeed(seedIn));
 }
 
 // -----------------------------------------------------------------------------
@@ -65,6 +71,46 @@ int getRandomInt(int minval, int maxval) {
 
 // -----------------------------------------------------------------------------
 
+RandomStream::RandomStream(unsigned long int seed, unsigned long int stream):
+  m_seed(timeSeed(seed)) {
+  HDphilox_init(&m_state,m_seed,stream);
+}
+
+// -----------------------------------------------------------------------------
+
+double RandomStream::get() {
+  return HDphilox_drand(&m_state);
+}
+
+// -----------------------------------------------------------------------------
+
+int RandomStream::getInt(int minval, int maxval) {
+  if (minval > maxval) AH_THROW_LOGIC("minimum value cannot exceed maximum value");
+  if (minval == maxval) return minval;
+  return minval+(int)(get()*(maxval-minval+1));
+}
+
+// -----------------------------------------------------------------------------
+
+void RandomStream::fill(double* values, long num, int nthreads) {
+  HDphilox_fill_threads(&m_state,num,values,nthreads);
+}
+
+// -----------------------------------------------------------------------------
+
+void RandomStream::jump(unsigned long long num) {
+  // each call to get() uses two values of the underlying stream
+  HDphilox_jump(&m_state,2*num);
+}
+
+// -----------------------------------------------------------------------------
+
+RandomStream RandomStream::split(unsigned long int stream) const {
+  return RandomStream(m_seed,stream);
+}
+
+// -----------------------------------------------------------------------------
+
 } // namespace ahgen
 
 /* Revision Log
@@ -16,6 +16,7 @@
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -290,6 +291,32 @@ void ut_random() {
     ahgen::getRandomInt(10,0);
   } END_TEST
 
+  START_TEST("random streams are reproducible and independent") {
+    ahgen::RandomStream a(1234,0);
+    ahgen::RandomStream b(1234,0);
+    ahgen::RandomStream c=a.split(1);
+    for (int i=0; i < 10; i++) {
+      double aval=a.get();
+      if (0. > aval || 1. <= aval) FAILTEXT("did not get a random number in range");
+      if (aval != b.get()) FAILTEXT("same stream gave different values");
+      if (aval == c.get()) FAILTEXT("different streams gave the same value");
+    }
+  } END_TEST
+
+  START_TEST("random stream fill does not depend on number of threads") {
+    const long num=100000;
+    std::vector<double> one(num), four(num);
+    ahgen::RandomStream a(1234,5);
+    ahgen::RandomStream b(1234,5);
+    a.fill(&one[0],num);
+    b.fill(&four[0],num,4);
+    if (one != four) FAILTEXT("fill with 4 threads gave different values");
+    ahgen::RandomStream c(1234,5);
+    c.jump(num-1);
+    if (c.get() != one[num-1]) FAILTEXT("jump did not reach the same value");
+    if (a.get() != b.get()) FAILTEXT("streams not at the same place after fill");
+  } END_TEST
+
 }
 
 // ---------------------------------------------------------------------------
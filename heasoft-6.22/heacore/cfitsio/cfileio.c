@@ -17,7 +17,7 @@
 #endif
 
 #define MAX_PREFIX_LEN 20  /* max length of file type prefix (e.g. 'http://') */
-#define MAX_DRIVERS 27     /* max number of file I/O drivers */
+#define MAX_DRIVERS 28     /* max number of file I/O drivers */
 
 typedef struct    /* structure containing pointers to I/O driver functions */ 
 {   char prefix[MAX_PREFIX_LEN];
@@ -103,6 +103,21 @@ int fitsio_init_lock(void)
         return(status);
     }
 
+    /* the FITSfile table and parser locks may also be re-entered */
+    /* by the same thread (e.g. ffclos -> fits_clear_Fptr)        */
+
+    status = pthread_mutex_init(&Fitsio_FptrLock,&mutex_init);
+    if (status) {
+        ffpmsg("pthread_mutex_init failed (fitsio_init_lock)");
+        return(status);
+    }
+
+    status = pthread_mutex_init(&Fitsio_ParseLock,&mutex_init);
+    if (status) {
+        ffpmsg("pthread_mutex_init failed (fitsio_init_lock)");
+        return(status);
+    }
+
     need_to_init = 0;
   }
 
@@ -722,14 +737,14 @@ int ffopen(fitsfile **fptr,      /* O - FITS file pointer                   */
     /* check if this same file is already open, and if so, attach to it  */
     /*-------------------------------------------------------------------*/
 
-    FFLOCK;
+    FFLOCK_FPTR;
     if (fits_already_open(fptr, url, urltype, infile, extspec, rowfilter,
             binspec, colspec, mode, &isopen, status) > 0)
     {
-        FFUNLOCK;
+        FFUNLOCK_FPTR;
         return(*status);
     }
-    FFUNLOCK;
+    FFUNLOCK_FPTR;
 
     if (isopen) {
        goto move2hdu;  
@@ -1414,7 +1429,10 @@ int ffreopen(fitsfile *openfptr, /* I - FITS file pointer to open file  */
 
     (*newfptr)->Fptr = openfptr->Fptr; /* both point to the same structure */
     (*newfptr)->HDUposition = 0;  /* set initial position to primary array */
+
+    FFLOCK_FPTR;
     (((*newfptr)->Fptr)->open_count)++;   /* increment the file usage counter */
+    FFUNLOCK_FPTR;
 
     return(*status);
 }
@@ -1430,14 +1448,14 @@ int fits_store_Fptr(FITSfile *Fptr,  /* O - FITS file pointer               */
     if (*status > 0)
         return(*status);
 
-    FFLOCK;
+    FFLOCK_FPTR;
     for (ii = 0; ii < NMAXFILES; ii++) {
         if (FptrTable[ii] == 0) {
             FptrTable[ii] = Fptr;
             break;
         }
     }
-    FFUNLOCK;
+    FFUNLOCK_FPTR;
     return(*status);
 }
 /*--------------------------------------------------------------------------*/
@@ -1449,14 +1467,14 @@ int fits_clear_Fptr(FITSfile *Fptr,  /* O - FITS file pointer               */
 {
     int ii;
 
-    FFLOCK;
+    FFLOCK_FPTR;
     for (ii = 0; ii < NMAXFILES; ii++) {
         if (FptrTable[ii] == Fptr) {
             FptrTable[ii] = 0;
             break;
         }
     }
-    FFUNLOCK;
+    FFUNLOCK_FPTR;
     return(*status);
 }
 /*--------------------------------------------------------------------------*/
@@ -4715,6 +4733,36 @@ int fits_init_cfitsio(void)
         return(status);
     }
 
+#endif
+
+#ifdef HAVE_POSIX_SHM
+
+    /* 22a-----------------POSIX shared memory driver-------------------*/
+    status = fits_register_driver("pshm://", 
+            pshm_init,
+            pshm_shutdown,
+            pshm_setoptions,
+            pshm_getoptions, 
+            pshm_getversion,
+            NULL,            /* checkfile not needed */ 
+            pshm_open,
+            pshm_create,
+            pshm_truncate,
+            pshm_close,
+            pshm_remove,
+            pshm_size,
+            pshm_flush,
+            pshm_seek,
+            pshm_read,
+            pshm_write );
+
+    if (status)
+    {
+        ffpmsg("failed to register the pshm:// driver (init_cfitsio)");
+        FFUNLOCK;
+        return(status);
+    }
+
 #endif
 /* ==================== END OF SHARED MEMORY DRIVER SECTION ================ */
 
@@ -5104,6 +5152,12 @@ int ffifile2(char *url,       /* input filename */
                 strcat(urltype, "shmem://");
             ptr1 += 6;
         }
+        else if (!strncmp(ptr1, "pshm:", 5) )
+        {                              /* the 2 //'s are optional */
+            if (urltype)
+                strcat(urltype, "pshm://");
+            ptr1 += 5;
+        }
         else if (!strncmp(ptr1, "file:", 5) )
         {                              /* the 2 //'s are optional */
             if (urltype)
@@ -6101,6 +6155,11 @@ int ffrtnm(char *url,
             strcat(urltype, "shmem://");
             ptr1 += 6;
         }
+        else if (!strncmp(ptr1, "pshm:", 5) )
+        {                              /* the 2 //'s are optional */
+            strcat(urltype, "pshm://");
+            ptr1 += 5;
+        }
         else if (!strncmp(ptr1, "file:", 5) )
         {                              /* the 2 //'s are optional */
             ptr1 += 5;
@@ -6992,7 +7051,7 @@ int ffclos(fitsfile *fptr,      /* I - FITS file pointer */
   then calling the system dependent routine to physically close the FITS file
 */   
 {
-    int tstatus = NO_CLOSE_ERROR, zerostatus = 0;
+    int tstatus = NO_CLOSE_ERROR, zerostatus = 0, lastuse;
 
     if (!fptr)
         return(*status = NULL_INPUT_PTR);
@@ -7005,9 +7064,17 @@ int ffclos(fitsfile *fptr,      /* I - FITS file pointer */
     else
        ffchdu(fptr, status);         
 
+    /* decrement the usage counter and, if this was the last user, remove */
+    /* the structure from the table in one step so that no other thread   */
+    /* can attach to it in fits_already_open while it is being closed     */
+    FFLOCK_FPTR;
     ((fptr->Fptr)->open_count)--;           /* decrement usage counter */
+    lastuse = ((fptr->Fptr)->open_count == 0);
+    if (lastuse)
+        fits_clear_Fptr( fptr->Fptr, status);  /* clear Fptr address */
+    FFUNLOCK_FPTR;
 
-    if ((fptr->Fptr)->open_count == 0)  /* if no other files use structure */
+    if (lastuse)  /* if no other files use structure */
     {
         ffflsh(fptr, TRUE, status);   /* flush and disassociate IO buffers */
 
@@ -7023,7 +7090,6 @@ int ffclos(fitsfile *fptr,      /* I - FITS file pointer */
             }
         }
 
-        fits_clear_Fptr( fptr->Fptr, status);  /* clear Fptr address */
         free((fptr->Fptr)->iobuffer);    /* free memory for I/O buffers */
         free((fptr->Fptr)->headstart);    /* free memory for headstart array */
         free((fptr->Fptr)->filename);     /* free memory for the filename */
@@ -29,7 +29,8 @@
 #define IO_READ 1        /* last file I/O operation was a read */
 #define IO_WRITE 2       /* last file I/O operation was a write */
 
-static char file_outfile[FLEN_FILENAME];
+/* set by file_checkfile and consumed by file_open in the same thread */
+static FFTHREADLOCAL char file_outfile[FLEN_FILENAME];
 
 typedef struct    /* structure containing disk file structure */ 
 {
@@ -552,7 +553,9 @@ int file_close(int handle)
     if (fclose(handleTable[handle].fileptr) )
         return(FILE_NOT_CLOSED);
 
+    FFLOCK;  /* the open drivers scan this table for a vacant handle */
     handleTable[handle].fileptr = 0;
+    FFUNLOCK;
     return(0);
 }
 /*--------------------------------------------------------------------------*/
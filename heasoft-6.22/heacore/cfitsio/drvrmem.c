@@ -31,7 +31,7 @@ void bzip2uncompress2mem(char *filename, FILE *diskfile, int hdl,
 
 #define RECBUFLEN 1000
 
-static char stdin_outfile[FLEN_FILENAME];
+static FFTHREADLOCAL char stdin_outfile[FLEN_FILENAME];
 
 typedef struct    /* structure containing mem file structure */ 
 {
@@ -544,8 +544,10 @@ int stdout_close(int handle)
     }
 
     free( memTable[handle].memaddr );   /* free the memory */
+    FFLOCK;  /* the open drivers scan this table for a vacant handle */
     memTable[handle].memaddrptr = 0;
     memTable[handle].memaddr = 0;
+    FFUNLOCK;
     return(status);
 }
 /*--------------------------------------------------------------------------*/
@@ -1108,8 +1110,10 @@ int mem_close_free(int handle)
 {
     free( *(memTable[handle].memaddrptr) );
 
+    FFLOCK;  /* the open drivers scan this table for a vacant handle */
     memTable[handle].memaddrptr = 0;
     memTable[handle].memaddr = 0;
+    FFUNLOCK;
     return(0);
 }
 /*--------------------------------------------------------------------------*/
@@ -1118,8 +1122,10 @@ int mem_close_keep(int handle)
   close the memory file but do not free the memory.
 */
 {
+    FFLOCK;  /* the open drivers scan this table for a vacant handle */
     memTable[handle].memaddrptr = 0;
     memTable[handle].memaddr = 0;
+    FFUNLOCK;
     return(0);
 }
 /*--------------------------------------------------------------------------*/
@@ -1144,8 +1150,10 @@ int mem_close_comp(int handle)
     }
 
     free( memTable[handle].memaddr );   /* free the memory */
+    FFLOCK;  /* the open drivers scan this table for a vacant handle */
     memTable[handle].memaddrptr = 0;
     memTable[handle].memaddr = 0;
+    FFUNLOCK;
 
     /* close the compressed disk file (except if it is 'stdout' */
     if (memTable[handle].fileptr != stdout)
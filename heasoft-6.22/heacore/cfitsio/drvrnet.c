@@ -202,7 +202,7 @@ static void signal_handler(int sig);
 /* local defines and variables */
 #define MAXLEN 1200
 #define SHORTLEN 100
-static char netoutfile[MAXLEN];
+static FFTHREADLOCAL char netoutfile[MAXLEN];
 
 
 #define ROOTD_USER  2000       /*user id follows */
@@ -3198,7 +3198,9 @@ int root_close(int handle)
   sock = handleTable[handle].sock;
   status = root_send_buffer(sock,ROOTD_CLOSE,NULL,0);
   close(sock);
+  FFLOCK;  /* the open drivers scan this table for a vacant handle */
   handleTable[handle].sock = 0;
+  FFUNLOCK;
   return(0);
 }
 /*--------------------------------------------------------------------------*/
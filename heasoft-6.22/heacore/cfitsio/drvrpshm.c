@@ -0,0 +1,690 @@
+/*  This file, drvrpshm.c, contains driver routines for FITS files that   */
+/*  are held in POSIX shared memory objects (shm_open) or in a shared      */
+/*  memory file descriptor (e.g. from memfd_create) inherited from a       */
+/*  parent process.                                                        */
+
+/*  The FITSIO software was written by William Pence at the High Energy    */
+/*  Astrophysic Science Archive Research Center (HEASARC) at the NASA      */
+/*  Goddard Space Flight Center.                                           */
+
+/*
+  This driver lets one process hand a FITS file to another without it
+  ever being written to disk.  Two forms of file name are supported:
+
+    pshm://name    a named POSIX shared memory object ("/name")
+    pshm://fd/N    the shared memory object already open on descriptor
+                   N, typically a memfd created by a parent process and
+                   inherited across fork/exec
+
+  A producer creates the file in the usual way (fits_create_file) and
+  closes it when it is complete; a consumer then opens it by the same
+  name.  Every object starts with a small header (pshmhead) holding the
+  size of the FITS file and counts of the handles that are attached to
+  it, in all processes.  A file that is open for writing cannot be
+  opened by anyone else, so readers never see a partly written file.
+  fits_delete_file unlinks the name, but if other handles are still
+  attached the unlinking is deferred until the last of them is closed.
+
+  Readers map the file data read-only and CFITSIO reads directly from
+  that mapping, so the data are never copied into private memory as they
+  are by the mem:// driver; only the header is mapped writable, to update
+  the counts.  (A reader without write permission on the object is not
+  counted.)  Writers map the whole object read/write and grow it as
+  needed.
+
+  Unlike the shmem:// driver, there is no fixed table of segments: any
+  number of objects may exist, and the handle table grows on demand.
+*/
+
+#ifdef HAVE_POSIX_SHM
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE   /* for mremap */
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "fitsio2.h"
+
+#define PSHM_MAGIC    "FITSPSHM"
+#define PSHM_VERSION  1
+#define PSHM_HEADLEN  4096L      /* FITS data start on a page boundary */
+#define PSHM_MINSIZE  1048576L   /* initial data capacity for new files */
+#define PSHM_CHUNK    256        /* handles allocated at a time */
+#define PSHM_NCHUNK   1024       /* max. chunks (262144 open handles) */
+
+/* the counts in the header are shared between processes */
+#if defined(__GNUC__)
+#define PSHM_ADD(ptr, n)        __sync_add_and_fetch((ptr), (n))
+#define PSHM_CAS(ptr, old, new) __sync_bool_compare_and_swap((ptr), (old), (new))
+#define PSHM_BARRIER            __sync_synchronize()
+#else
+#define PSHM_ADD(ptr, n)        (*(ptr) += (n))
+#define PSHM_CAS(ptr, old, new) (*(ptr) == (old) ? (*(ptr) = (new), 1) : 0)
+#define PSHM_BARRIER
+#endif
+
+typedef struct    /* header at the start of every shared memory object */
+{
+    char magic[8];          /* PSHM_MAGIC, not null terminated */
+    int version;            /* PSHM_VERSION */
+    volatile int nattach;   /* number of handles attached, in all processes */
+    volatile int nwriters;  /* 1 while the file is open for writing */
+    volatile int removed;   /* unlink the name when nattach drops to 0 */
+    LONGLONG filesize;      /* size of the FITS file, in bytes */
+} pshmhead;
+
+typedef struct    /* structure containing pshm file information */
+{
+    int used;               /* is this slot in use? */
+    int fd;                 /* descriptor of the shared memory object */
+    int isfd;               /* opened as pshm://fd/N, so there is no name */
+    int writable;           /* opened for writing */
+    char name[FLEN_FILENAME];  /* object name, with a leading '/' */
+    char *base;             /* start of the mapping of the whole object */
+    size_t mapsize;         /* size of that mapping, in bytes */
+    pshmhead *head;         /* writable header: base for writers, a */
+                            /* separate mapping for readers, or NULL */
+    LONGLONG filesize;      /* size of the FITS file, in bytes */
+    LONGLONG currentpos;    /* current file position, relative to start */
+} pshmdriver;
+
+/* The handle table is allocated in chunks which never move, so that */
+/* reads on one handle are safe while another thread opens a file.   */
+static pshmdriver *pshmTable[PSHM_NCHUNK];
+
+#define PSHM_ENTRY(hdl) (&pshmTable[(hdl) / PSHM_CHUNK][(hdl) % PSHM_CHUNK])
+
+
+static int pshm_getslot(int *handle);
+static int pshm_parsename(char *filename, char *name, int *fd);
+static int pshm_attach(int hdl, int rwmode);
+static int pshm_remap(int hdl, LONGLONG filesize);
+static void pshm_release(int hdl);
+
+/*--------------------------------------------------------------------------*/
+int pshm_init(void)
+{
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_setoptions(int options)
+{
+  /* do something with the options argument, to stop compiler warning */
+  options = 0;
+  return(options);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_getoptions(int *options)
+{
+  *options = 0;
+  return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_getversion(int *version)
+{
+    *version = 10;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_shutdown(void)
+{
+    int ii;
+
+    /* the driver is only shut down when no files are open */
+    for (ii = 0; ii < PSHM_NCHUNK; ii++)
+    {
+        free(pshmTable[ii]);
+        pshmTable[ii] = NULL;
+    }
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_open(char *filename, int rwmode, int *handle)
+/*
+  open an existing shared memory FITS file
+*/
+{
+    pshmdriver *entry;
+    char name[FLEN_FILENAME];
+    int status, fd, hdl;
+
+    *handle = -1;
+
+    if (pshm_parsename(filename, name, &fd))
+        return(FILE_NOT_OPENED);
+
+    if (pshm_getslot(&hdl))
+        return(TOO_MANY_FILES);
+
+    entry = PSHM_ENTRY(hdl);
+    strcpy(entry->name, name);
+    entry->writable = (rwmode == READWRITE);
+
+    if (fd >= 0)
+    {
+        /* use our own copy of the inherited descriptor */
+        entry->fd = dup(fd);
+        entry->isfd = 1;
+    }
+    else
+    {
+        /* readers also want write access, for the attach count */
+        entry->fd = shm_open(name, O_RDWR, 0);
+        if (entry->fd < 0 && errno == EACCES && rwmode == READONLY)
+            entry->fd = shm_open(name, O_RDONLY, 0);
+    }
+
+    if (entry->fd < 0)
+    {
+        ffpmsg("could not open the shared memory object (pshm_open):");
+        ffpmsg(filename);
+        pshm_release(hdl);
+        return(FILE_NOT_OPENED);
+    }
+
+    status = pshm_attach(hdl, rwmode);
+    if (status)
+    {
+        ffpmsg(filename);
+        pshm_release(hdl);
+        return(status);
+    }
+
+    *handle = hdl;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_create(char *filename, int *handle)
+/*
+  create a new empty shared memory FITS file.  A named object must not
+  already exist; an inherited descriptor is truncated to zero length.
+*/
+{
+    pshmdriver *entry;
+    pshmhead *head;
+    char name[FLEN_FILENAME];
+    int fd, hdl;
+
+    *handle = -1;
+
+    if (pshm_parsename(filename, name, &fd))
+        return(FILE_NOT_CREATED);
+
+    if (pshm_getslot(&hdl))
+        return(TOO_MANY_FILES);
+
+    entry = PSHM_ENTRY(hdl);
+    strcpy(entry->name, name);
+    entry->writable = 1;
+
+    if (fd >= 0)
+    {
+        entry->fd = dup(fd);
+        entry->isfd = 1;
+    }
+    else
+    {
+        entry->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    }
+
+    if (entry->fd < 0)
+    {
+        if (errno == EEXIST)
+            ffpmsg("shared memory object already exists (pshm_create):");
+        else
+            ffpmsg("could not create the shared memory object (pshm_create):");
+        ffpmsg(filename);
+        pshm_release(hdl);
+        return(FILE_NOT_CREATED);
+    }
+
+    /* discard any previous contents of an inherited descriptor */
+    if ((entry->isfd && ftruncate(entry->fd, 0)) ||
+        ftruncate(entry->fd, PSHM_HEADLEN + PSHM_MINSIZE))
+    {
+        ffpmsg("could not size the shared memory object (pshm_create):");
+        ffpmsg(filename);
+        if (!entry->isfd)
+            shm_unlink(name);
+        pshm_release(hdl);
+        return(FILE_NOT_CREATED);
+    }
+
+    entry->mapsize = PSHM_HEADLEN + PSHM_MINSIZE;
+    entry->base = (char *) mmap(NULL, entry->mapsize,
+        PROT_READ | PROT_WRITE, MAP_SHARED, entry->fd, 0);
+
+    if (entry->base == (char *) MAP_FAILED)
+    {
+        entry->base = NULL;
+        ffpmsg("could not map the shared memory object (pshm_create):");
+        ffpmsg(filename);
+        if (!entry->isfd)
+            shm_unlink(name);
+        pshm_release(hdl);
+        return(FILE_NOT_CREATED);
+    }
+
+    /* The new object is zero filled, so another process that tries to */
+    /* open it before the magic string is set will reject it.           */
+    head = entry->head = (pshmhead *) entry->base;
+    head->version = PSHM_VERSION;
+    head->nattach = 1;
+    head->nwriters = 1;
+    head->removed = 0;
+    head->filesize = 0;
+    PSHM_BARRIER;
+    memcpy(head->magic, PSHM_MAGIC, sizeof(head->magic));
+
+    *handle = hdl;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_truncate(int handle, LONGLONG filesize)
+/*
+  truncate the file to a new size
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(handle);
+
+    if (!entry->writable)
+        return(READONLY_FILE);
+
+    if (pshm_remap(handle, filesize))
+    {
+        ffpmsg("failed to resize the shared memory file (pshm_truncate)");
+        return(WRITE_ERROR);
+    }
+
+    entry->filesize = filesize;
+    entry->head->filesize = filesize;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_size(int handle, LONGLONG *filesize)
+/*
+  return the size of the file
+*/
+{
+    *filesize = PSHM_ENTRY(handle)->filesize;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_close(int handle)
+/*
+  detach from the shared memory file.  The last handle to close a file
+  that has been deleted unlinks its name.
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(handle);
+    pshmhead *head = entry->head;
+    int status = 0;
+
+    if (entry->writable)
+    {
+        /* release the memory beyond the end of the FITS file */
+        if (ftruncate(entry->fd, (off_t) (PSHM_HEADLEN + entry->filesize)))
+            status = WRITE_ERROR;
+
+        PSHM_ADD(&head->nwriters, -1);
+    }
+
+    if (head && PSHM_ADD(&head->nattach, -1) == 0 && head->removed &&
+        !entry->isfd)
+        shm_unlink(entry->name);
+
+    pshm_release(handle);
+    return(status);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_remove(char *filename)
+/*
+  delete a shared memory file.  If other handles are still attached,
+  only mark it for removal; the last of them to close unlinks the name.
+*/
+{
+    pshmhead *head = NULL;
+    struct stat statbuf;
+    char name[FLEN_FILENAME];
+    int fd, inuse = 0, status = 0;
+
+    if (pshm_parsename(filename, name, &fd))
+        return(FILE_NOT_OPENED);
+
+    if (fd >= 0)
+        return(0);   /* an inherited descriptor has no name to remove */
+
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return(FILE_NOT_OPENED);
+
+    if (!fstat(fd, &statbuf) && statbuf.st_size >= PSHM_HEADLEN)
+    {
+        head = (pshmhead *) mmap(NULL, PSHM_HEADLEN, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+        if (head == (pshmhead *) MAP_FAILED)
+            head = NULL;
+    }
+
+    if (head && !memcmp(head->magic, PSHM_MAGIC, sizeof(head->magic)))
+    {
+        /* set the flag before looking at the count; pshm_close */
+        /* does the opposite, so one of us will unlink the name */
+        PSHM_CAS(&head->removed, 0, 1);
+        inuse = (PSHM_ADD(&head->nattach, 0) > 0);
+    }
+
+    if (!inuse && shm_unlink(name))
+        status = FILE_NOT_OPENED;
+
+    if (head)
+        munmap(head, PSHM_HEADLEN);
+    close(fd);
+
+    return(status);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_flush(int handle)
+/*
+  nothing to do: the mapping is the shared memory object itself
+*/
+{
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_seek(int handle, LONGLONG offset)
+/*
+  seek to position relative to start of the file.
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(handle);
+
+    if (offset > entry->filesize)
+        return(END_OF_FILE);
+
+    entry->currentpos = offset;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_read(int hdl, void *buffer, long nbytes)
+/*
+  read bytes from the current position in the file
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(hdl);
+
+    if (entry->currentpos + nbytes > entry->filesize)
+        return(END_OF_FILE);
+
+    memcpy(buffer, entry->base + PSHM_HEADLEN + entry->currentpos, nbytes);
+
+    entry->currentpos += nbytes;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+int pshm_write(int hdl, void *buffer, long nbytes)
+/*
+  write bytes at the current position in the file
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(hdl);
+    LONGLONG endpos = entry->currentpos + nbytes;
+
+    if (!entry->writable)
+        return(READONLY_FILE);
+
+    if ((size_t) (PSHM_HEADLEN + endpos) > entry->mapsize)
+    {
+        if (pshm_remap(hdl, endpos))
+        {
+            ffpmsg("failed to extend the shared memory file (pshm_write)");
+            return(WRITE_ERROR);
+        }
+    }
+
+    memcpy(entry->base + PSHM_HEADLEN + entry->currentpos, buffer, nbytes);
+
+    entry->currentpos = endpos;
+    if (endpos > entry->filesize)
+    {
+        entry->filesize = endpos;
+        entry->head->filesize = endpos;
+    }
+
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static int pshm_getslot(int *handle)
+/*
+  find (or allocate) a free slot in the handle table.  Called with the
+  driver lock held by ffopen/ffinit.
+*/
+{
+    int ii, jj;
+
+    for (ii = 0; ii < PSHM_NCHUNK; ii++)
+    {
+        if (!pshmTable[ii])
+        {
+            pshmTable[ii] = (pshmdriver *) calloc(PSHM_CHUNK,
+                                                  sizeof(pshmdriver));
+            if (!pshmTable[ii])
+                return(MEMORY_ALLOCATION);
+        }
+
+        for (jj = 0; jj < PSHM_CHUNK; jj++)
+        {
+            if (!pshmTable[ii][jj].used)
+            {
+                memset(&pshmTable[ii][jj], 0, sizeof(pshmdriver));
+                pshmTable[ii][jj].used = 1;
+                pshmTable[ii][jj].fd = -1;
+                *handle = ii * PSHM_CHUNK + jj;
+                return(0);
+            }
+        }
+    }
+
+    return(TOO_MANY_FILES);
+}
+/*--------------------------------------------------------------------------*/
+static int pshm_parsename(char *filename, char *name, int *fd)
+/*
+  Interpret the file name given after 'pshm://'.  Returns the object
+  name with a leading '/' for shm_open, or the descriptor number for
+  the 'fd/N' form (else *fd = -1).
+*/
+{
+    char *cptr;
+    long ival;
+
+    *fd = -1;
+    name[0] = '\0';
+
+    if (!strncmp(filename, "fd/", 3))
+    {
+        ival = strtol(filename + 3, &cptr, 10);
+        if (cptr == filename + 3 || *cptr != '\0' || ival < 0)
+        {
+            ffpmsg("bad file descriptor in pshm:// file name:");
+            ffpmsg(filename);
+            return(URL_PARSE_ERROR);
+        }
+        *fd = (int) ival;
+        return(0);
+    }
+
+    while (*filename == '/')  /* the name is always rooted */
+        filename++;
+
+    if (*filename == '\0' || strchr(filename, '/') ||
+        strlen(filename) > FLEN_FILENAME - 2)
+    {
+        ffpmsg("illegal pshm:// shared memory object name:");
+        ffpmsg(filename);
+        return(URL_PARSE_ERROR);
+    }
+
+    name[0] = '/';
+    strcpy(name + 1, filename);
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static int pshm_attach(int hdl, int rwmode)
+/*
+  map an existing shared memory file, check its header and attach to it
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(hdl);
+    pshmhead *head;
+    struct stat statbuf;
+    int canwrite;
+
+    if (fstat(entry->fd, &statbuf) || statbuf.st_size < PSHM_HEADLEN)
+    {
+        ffpmsg("not a pshm:// FITS file (pshm_open):");
+        return(FILE_NOT_OPENED);
+    }
+
+    canwrite = ((fcntl(entry->fd, F_GETFL) & O_ACCMODE) == O_RDWR);
+    if (rwmode == READWRITE && !canwrite)
+    {
+        ffpmsg("no write access to the shared memory object (pshm_open):");
+        return(FILE_NOT_OPENED);
+    }
+
+    entry->mapsize = (size_t) statbuf.st_size;
+    entry->base = (char *) mmap(NULL, entry->mapsize,
+        rwmode == READWRITE ? PROT_READ | PROT_WRITE : PROT_READ,
+        MAP_SHARED, entry->fd, 0);
+
+    if (entry->base == (char *) MAP_FAILED)
+    {
+        entry->base = NULL;
+        ffpmsg("could not map the shared memory object (pshm_open):");
+        return(FILE_NOT_OPENED);
+    }
+
+    head = (pshmhead *) entry->base;
+    if (memcmp(head->magic, PSHM_MAGIC, sizeof(head->magic)) ||
+        head->version != PSHM_VERSION ||
+        (size_t) (PSHM_HEADLEN + head->filesize) > entry->mapsize)
+    {
+        ffpmsg("not a pshm:// FITS file, or incompatible version (pshm_open):");
+        return(FILE_NOT_OPENED);
+    }
+
+    if (rwmode == READWRITE)
+    {
+        /* a writer must have exclusive access */
+        if (!PSHM_CAS(&head->nwriters, 0, 1))
+        {
+            ffpmsg("shared memory file is already open for writing (pshm_open):");
+            return(FILE_NOT_OPENED);
+        }
+
+        if (PSHM_ADD(&head->nattach, 1) > 1)
+        {
+            PSHM_ADD(&head->nattach, -1);
+            PSHM_ADD(&head->nwriters, -1);
+            ffpmsg("shared memory file is open by another reader (pshm_open):");
+            return(FILE_NOT_OPENED);
+        }
+
+        entry->head = head;
+    }
+    else
+    {
+        /* only the header is mapped writable, to update the counts */
+        if (canwrite)
+        {
+            entry->head = (pshmhead *) mmap(NULL, PSHM_HEADLEN,
+                PROT_READ | PROT_WRITE, MAP_SHARED, entry->fd, 0);
+            if (entry->head == (pshmhead *) MAP_FAILED)
+                entry->head = NULL;
+        }
+
+        if (entry->head)
+            PSHM_ADD(&entry->head->nattach, 1);
+
+        if (head->nwriters)
+        {
+            if (entry->head)
+                PSHM_ADD(&entry->head->nattach, -1);
+            ffpmsg("shared memory file is still being written (pshm_open):");
+            return(FILE_NOT_OPENED);
+        }
+    }
+
+    entry->filesize = head->filesize;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static int pshm_remap(int hdl, LONGLONG filesize)
+/*
+  resize the object and its mapping to hold a file of filesize bytes.
+  The capacity grows geometrically, so that writing a large file does
+  not remap the object for every FITS block.
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(hdl);
+    size_t newsize;
+    void *ptr;
+
+    newsize = (size_t) (PSHM_HEADLEN + filesize);
+    if (newsize > entry->mapsize)
+        newsize = maxvalue(newsize, 2 * entry->mapsize);
+
+    if (newsize == entry->mapsize)
+        return(0);
+
+    if (ftruncate(entry->fd, (off_t) newsize))
+        return(WRITE_ERROR);
+
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+    ptr = mremap(entry->base, entry->mapsize, newsize, MREMAP_MAYMOVE);
+#else
+    ptr = mmap(NULL, newsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+               entry->fd, 0);
+    if (ptr != MAP_FAILED)
+        munmap(entry->base, entry->mapsize);
+#endif
+
+    if (ptr == MAP_FAILED)
+        return(WRITE_ERROR);
+
+    entry->base = (char *) ptr;
+    entry->head = (pshmhead *) ptr;
+    entry->mapsize = newsize;
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static void pshm_release(int hdl)
+/*
+  unmap the object, close the descriptor and free the handle table slot
+*/
+{
+    pshmdriver *entry = PSHM_ENTRY(hdl);
+
+    if (entry->head && (char *) entry->head != entry->base)
+        munmap(entry->head, PSHM_HEADLEN);
+
+    if (entry->base)
+        munmap(entry->base, entry->mapsize);
+
+    if (entry->fd >= 0)
+        close(entry->fd);
+
+    entry->base = NULL;
+    entry->head = NULL;
+    entry->fd = -1;
+    entry->used = 0;
+}
+#endif
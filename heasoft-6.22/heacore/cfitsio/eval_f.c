@@ -97,11 +97,11 @@ int fffrow( fitsfile *fptr,         /* I - Input FITS file                   */
 
    if( *status ) return( *status );
 
-   FFLOCK;
+   FFLOCK_PARSE;
    if( ffiprs( fptr, 0, expr, MAXDIMS, &Info.datatype, &nelem, &naxis,
                naxes, status ) ) {
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
    if( nelem<0 ) {
@@ -113,7 +113,7 @@ int fffrow( fitsfile *fptr,         /* I - Input FITS file                   */
    if( Info.datatype!=TLOGICAL || nelem!=1 ) {
       ffcprs();
       ffpmsg("Expression does not evaluate to a logical scalar.");
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status = PARSE_BAD_TYPE );
    }
 
@@ -152,7 +152,7 @@ int fffrow( fitsfile *fptr,         /* I - Input FITS file                   */
    }
 
    ffcprs();
-   FFUNLOCK;
+   FFUNLOCK_PARSE;
    return(*status);
 }
 
@@ -183,11 +183,11 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
 
    if( *status ) return( *status );
 
-   FFLOCK;
+   FFLOCK_PARSE;
    if( ffiprs( infptr, 0, expr, MAXDIMS, &Info.datatype, &nelem, &naxis,
                naxes, status ) ) {
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
 
@@ -204,7 +204,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
    if( Info.datatype!=TLOGICAL || nelem!=1 ) {
       ffcprs();
       ffpmsg("Expression does not evaluate to a logical scalar.");
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status = PARSE_BAD_TYPE );
    }
 
@@ -216,7 +216,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
       ffmahd( infptr, (infptr->HDUposition) + 1, NULL, status );
    if( *status ) {
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
    inExt.rowLength = (long) (infptr->Fptr)->rowlength;
@@ -224,7 +224,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
    inExt.heapSize  = (infptr->Fptr)->heapsize;
    if( inExt.numRows == 0 ) { /* Nothing to copy */
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
 
@@ -234,7 +234,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
       ffrdef( outfptr, status );
    if( *status ) {
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
    outExt.rowLength = (long) (outfptr->Fptr)->rowlength;
@@ -246,7 +246,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
    if( inExt.rowLength != outExt.rowLength ) {
       ffpmsg("Output table has different row length from input");
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status = PARSE_BAD_OUTPUT );
    }
 
@@ -260,7 +260,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
    if( !Info.dataPtr ) {
       ffpmsg("Unable to allocate memory for row selection");
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status = MEMORY_ALLOCATION );
    }
    
@@ -291,7 +291,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
       buffer = (unsigned char *)malloc(maxvalue(500000,rdlen) * sizeof(char) );
       if( buffer==NULL ) {
          ffcprs();
-         FFUNLOCK;
+         FFUNLOCK_PARSE;
          return( *status=MEMORY_ALLOCATION );
       }
       maxrows = maxvalue( (500000L/rdlen), 1);
@@ -413,7 +413,7 @@ int ffsrow( fitsfile *infptr,   /* I - Input FITS file                      */
    ffcprs();
 
    ffcmph(outfptr, status);  /* compress heap, deleting any orphaned data */
-   FFUNLOCK;
+   FFUNLOCK_PARSE;
    return(*status);
 }
 
@@ -442,11 +442,11 @@ int ffcrow( fitsfile *fptr,      /* I - Input FITS file                      */
 
    if( *status ) return( *status );
 
-   FFLOCK;
+   FFLOCK_PARSE;
    if( ffiprs( fptr, 0, expr, MAXDIMS, &Info.datatype, &nelem1, &naxis,
                naxes, status ) ) {
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
    if( nelem1<0 ) nelem1 = - nelem1;
@@ -454,7 +454,7 @@ int ffcrow( fitsfile *fptr,      /* I - Input FITS file                      */
    if( nelements<nelem1 ) {
       ffcprs();
       ffpmsg("Array not large enough to hold at least one row of data.");
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status = PARSE_LRG_VECTOR );
    }
 
@@ -472,7 +472,7 @@ int ffcrow( fitsfile *fptr,      /* I - Input FITS file                      */
 
    *anynul = Info.anyNull;
    ffcprs();
-   FFUNLOCK;
+   FFUNLOCK_PARSE;
    return( *status );
 }
 
@@ -528,12 +528,12 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
 
    if( *status ) return( *status );
 
-   FFLOCK;
+   FFLOCK_PARSE;
    if( ffiprs( infptr, 0, expr, MAXDIMS, &Info.datatype, &nelem, &naxis,
                naxes, status ) ) {
 
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
    if( nelem<0 ) {
@@ -556,7 +556,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
          if( ! constant ) {
             ffcprs();
             ffpmsg( "Cannot put tabular result into keyword (ffcalc)" );
-            FFUNLOCK;
+            FFUNLOCK_PARSE;
             return( *status = PARSE_BAD_TYPE );
          }
          parName++;  /* Advance past '#' */
@@ -564,7 +564,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
 	      Info.datatype != TSTRING ) {
             ffcprs();
             ffpmsg( "HISTORY and COMMENT values must be strings (ffcalc)" );
-	    FFUNLOCK;
+	    FFUNLOCK_PARSE;
 	    return( *status = PARSE_BAD_TYPE );
 	 }
 
@@ -576,7 +576,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
             colNo = -1;
          } else if( *status ) {
             ffcprs();
-            FFUNLOCK;
+            FFUNLOCK_PARSE;
             return( *status );
          }
 
@@ -607,7 +607,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
                case TLOGICAL:
                   ffcprs();
                   ffpmsg("Cannot create LOGICAL column in ASCII table");
-                  FFUNLOCK;
+                  FFUNLOCK_PARSE;
                   return( *status = NOT_BTABLE );
                case TLONG:     strcpy(tform,"I11");     break;
                case TDOUBLE:   strcpy(tform,"D23.15");  break;
@@ -661,7 +661,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
 
    } else if( *status ) {
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    } else {
 
@@ -686,7 +686,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
          /*  Either some other error happened in ffgcrd   */
          /*  or one happened in ffptdm                    */
          ffcprs();
-         FFUNLOCK;
+         FFUNLOCK_PARSE;
          return( *status );
       }
 
@@ -709,7 +709,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
       col_cnt = gParse.nCols;
       if( allocateCol( col_cnt, status ) ) {
          ffcprs();
-         FFUNLOCK;
+         FFUNLOCK_PARSE;
          return( *status );
       }
 
@@ -740,7 +740,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
             *status = 0;
          else if( *status ) {
             ffcprs();
-            FFUNLOCK;
+            FFUNLOCK_PARSE;
             return( *status );
          }
          if( Info.anyNull ) anyNull = 1;
@@ -780,7 +780,7 @@ int ffcalc_rng( fitsfile *infptr,   /* I - Input FITS file                  */
    }
 
    ffcprs();
-   FFUNLOCK;
+   FFUNLOCK_PARSE;
    return( *status );
 }
 
@@ -797,10 +797,10 @@ int fftexp( fitsfile *fptr,      /* I - Input FITS file                     */
 /* Evaluate the given expression and return information on the result.      */
 /*--------------------------------------------------------------------------*/
 {
-   FFLOCK;
+   FFLOCK_PARSE;
    ffiprs( fptr, 0, expr, maxdim, datatype, nelem, naxis, naxes, status );
    ffcprs();
-   FFUNLOCK;
+   FFUNLOCK_PARSE;
    return( *status );
 }
 
@@ -2096,11 +2096,11 @@ int ffffrw( fitsfile *fptr,         /* I - Input FITS file                   */
 
    if( *status ) return( *status );
 
-   FFLOCK;
+   FFLOCK_PARSE;
    if( ffiprs( fptr, 0, expr, MAXDIMS, &dtype, &nelem, &naxis,
                naxes, status ) ) {
       ffcprs();
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status );
    }
    if( nelem<0 ) {
@@ -2112,7 +2112,7 @@ int ffffrw( fitsfile *fptr,         /* I - Input FITS file                   */
    if( dtype!=TLOGICAL || nelem!=1 ) {
       ffcprs();
       ffpmsg("Expression does not evaluate to a logical scalar.");
-      FFUNLOCK;
+      FFUNLOCK_PARSE;
       return( *status = PARSE_BAD_TYPE );
    }
 
@@ -2132,7 +2132,7 @@ int ffffrw( fitsfile *fptr,         /* I - Input FITS file                   */
    }
 
    ffcprs();
-   FFUNLOCK;
+   FFUNLOCK_PARSE;
    return(*status);
 }
 
@@ -2610,7 +2610,7 @@ int fits_pixel_filter (PixelFilter * filter, int * status)
    if (*status)
       return (*status);
 
-   FFLOCK;
+   FFLOCK_PARSE;
    if (!filter->tag || !filter->tag[0] || !filter->tag[0][0]) {
       filter->tag = DEFAULT_TAGS;
       if (DEBUG_PIXFILTER)
@@ -2834,6 +2834,6 @@ int fits_pixel_filter (PixelFilter * filter, int * status)
 
 CLEANUP:
    ffcprs();
-   FFUNLOCK;
+   FFUNLOCK_PARSE;
    return (*status);
 }
@@ -36,8 +36,9 @@ The following modifications have been made to the original code:
 #include <stdlib.h>
 #include "fitsio2.h"
 
-static long noutchar;
-static long noutmax;
+/* encoder state; thread-local so that tiles may be compressed in parallel */
+static FFTHREADLOCAL long noutchar;
+static FFTHREADLOCAL long noutmax;
 
 static int htrans(int a[],int nx,int ny);
 static void digitize(int a[], int nx, int ny, int scale);
@@ -112,12 +113,10 @@ int fits_hcompress(int *a, int ny, int nx, int scale, char *output,
 
   /* encode and write to output array */
 
-  FFLOCK;
   noutmax = *nbytes;  /* input value is the allocated size of the array */
   *nbytes = 0;  /* reset */
 
   stat = encode(output, nbytes, a, nx, ny, scale);
-  FFUNLOCK;
   
   *status = stat;
   return(*status);
@@ -159,12 +158,10 @@ int fits_hcompress64(LONGLONG *a, int ny, int nx, int scale, char *output,
 
   /* encode and write to output array */
 
-  FFLOCK;
   noutmax = *nbytes;  /* input value is the allocated size of the array */
   *nbytes = 0;  /* reset */
 
   stat = encode64(output, nbytes, a, nx, ny, scale);
-  FFUNLOCK;
 
   *status = stat;
   return(*status);
@@ -1081,12 +1078,12 @@ int nx2, ny2, stat;
 /* BIT OUTPUT ROUTINES */
 
 
-static LONGLONG bitcount;
+static FFTHREADLOCAL LONGLONG bitcount;
 
 /* THE BIT BUFFER */
 
-static int buffer2;			/* Bits buffered for output	*/
-static int bits_to_go2;			/* Number of bits free in buffer */
+static FFTHREADLOCAL int buffer2;			/* Bits buffered for output	*/
+static FFTHREADLOCAL int bits_to_go2;			/* Number of bits free in buffer */
 
 
 /* ######################################################################### */
@@ -1268,7 +1265,7 @@ static int ncode[16] =
 /*
  * variables for bit output to buffer when Huffman coding
  */
-static int bitbuffer, bits_to_go3;
+static FFTHREADLOCAL int bitbuffer, bits_to_go3;
 
 /*
  * macros to write out 4-bit nybble, Huffman code for this value
@@ -45,7 +45,7 @@ The following modifications have been made to the original code:
 #define max(a,b)        (((a)>(b))?(a):(b))
 #endif
 
-static long nextchar;
+static FFTHREADLOCAL long nextchar;  /* thread-local decoder state */
 
 static int decode(unsigned char *infile, int *a, int *nx, int *ny, int *scale);
 static int decode64(unsigned char *infile, LONGLONG *a, int *nx, int *ny, int *scale);
@@ -103,9 +103,7 @@ int stat;
 
 	/* decode the input array */
 
-        FFLOCK;  /* decode uses the nextchar global variable */
 	stat = decode(input, a, nx, ny, scale);
-        FFUNLOCK;
 
         *status = stat;
 	if (stat) return(*status);
@@ -146,9 +144,7 @@ int fits_hdecompress64(unsigned char *input, int smooth, LONGLONG *a, int *ny, i
 
 	/* decode the input array */
 
-        FFLOCK;  /* decode uses the nextchar global variable */
 	stat = decode64(input, a, nx, ny, scale);
-        FFUNLOCK;
 
         *status = stat;
 	if (stat) return(*status);
@@ -2464,8 +2460,8 @@ static void qread(unsigned char *file, char buffer[], int n)
 
 /* THE BIT BUFFER */
 
-static int buffer2;			/* Bits waiting to be input	*/
-static int bits_to_go;			/* Number of bits still in buffer */
+static FFTHREADLOCAL int buffer2;			/* Bits waiting to be input	*/
+static FFTHREADLOCAL int bits_to_go;			/* Number of bits still in buffer */
 
 /* INITIALIZE BIT INPUT */
 
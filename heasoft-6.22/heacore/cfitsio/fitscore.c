@@ -57,9 +57,13 @@ SERVICES PROVIDED HEREUNDER."
 
 #ifdef _REENTRANT
 /*
-    Fitsio_Lock and Fitsio_Pthread_Status are declared in fitsio2.h. 
+    Fitsio_Lock, Fitsio_FptrLock, Fitsio_ParseLock and Fitsio_Pthread_Status
+    are declared in fitsio2.h; the mutexes are initialized (as recursive
+    locks) by fitsio_init_lock in cfileio.c.
 */
 pthread_mutex_t Fitsio_Lock;
+pthread_mutex_t Fitsio_FptrLock;
+pthread_mutex_t Fitsio_ParseLock;
 int Fitsio_Pthread_Status = 0;
 
 #endif
@@ -732,11 +736,11 @@ PutMark    6  add a marker to the stack
 {
     int ii;
     char markflag;
-    static char *txtbuff[errmsgsiz], *tmpbuff, *msgptr;
-    static char errbuff[errmsgsiz][81];  /* initialize all = \0 */
-    static int nummsg = 0;
+    /* each thread has its own message stack, so no locking is needed */
+    static FFTHREADLOCAL char *txtbuff[errmsgsiz], *tmpbuff, *msgptr;
+    static FFTHREADLOCAL char errbuff[errmsgsiz][81];  /* initialize all = \0 */
+    static FFTHREADLOCAL int nummsg = 0;
 
-    FFLOCK;
     
     if (action == DelAll)  /* clear the whole message stack */
     {
@@ -777,7 +781,6 @@ PutMark    6  add a marker to the stack
              txtbuff[ii] = txtbuff[ii + 1]; /* shift remaining pointers */
 
          if (errmsg[0] != ESMARKER) {   /* quit if this is not a marker */
-            FFUNLOCK;
             return;
          }
        }
@@ -848,7 +851,6 @@ PutMark    6  add a marker to the stack
 
     }
 
-    FFUNLOCK;
     return;
 }
 /*--------------------------------------------------------------------------*/
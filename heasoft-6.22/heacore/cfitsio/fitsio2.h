@@ -19,18 +19,55 @@
 #ifdef _REENTRANT
 #include <pthread.h>
 /*  #include <assert.h>  not needed any more */
+
+/*
+    Rather than one process-wide lock, each piece of shared state has its
+    own mutex so that threads working on different files do not contend:
+
+      Fitsio_Lock       driver table and the drivers' handle tables
+                        (recursive; taken by FFLOCK/FFUNLOCK)
+      Fitsio_FptrLock   the table of open FITSfile structures and their
+                        open_count (FFLOCK_FPTR/FFUNLOCK_FPTR)
+      Fitsio_ParseLock  the flex/bison expression parser, whose generated
+                        code is not reentrant (FFLOCK_PARSE/FFUNLOCK_PARSE)
+
+    Lock order is Fitsio_ParseLock -> Fitsio_FptrLock -> Fitsio_Lock.
+    Other per-call state (error message stack, H-compress bit streams,
+    histogram accumulators, driver 'outfile' names) is thread-local.
+*/
 extern pthread_mutex_t Fitsio_Lock;
+extern pthread_mutex_t Fitsio_FptrLock;
+extern pthread_mutex_t Fitsio_ParseLock;
 extern int Fitsio_Pthread_Status;
 
 #define FFLOCK1(lockname)   (Fitsio_Pthread_Status = pthread_mutex_lock(&lockname))
 #define FFUNLOCK1(lockname) (Fitsio_Pthread_Status = pthread_mutex_unlock(&lockname))
 #define FFLOCK   FFLOCK1(Fitsio_Lock)
 #define FFUNLOCK FFUNLOCK1(Fitsio_Lock)
+#define FFLOCK_FPTR    FFLOCK1(Fitsio_FptrLock)
+#define FFUNLOCK_FPTR  FFUNLOCK1(Fitsio_FptrLock)
+#define FFLOCK_PARSE   FFLOCK1(Fitsio_ParseLock)
+#define FFUNLOCK_PARSE FFUNLOCK1(Fitsio_ParseLock)
 #define ffstrtok(str, tok, save) strtok_r(str, tok, save)
 
+#if defined(_MSC_VER)
+#define FFTHREADLOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__SUNPRO_C) || defined(__INTEL_COMPILER)
+#define FFTHREADLOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define FFTHREADLOCAL _Thread_local
+#else
+#error "cannot build a thread-safe CFITSIO: no thread-local storage keyword"
+#endif
+
 #else
 #define FFLOCK
 #define FFUNLOCK
+#define FFLOCK_FPTR
+#define FFUNLOCK_FPTR
+#define FFLOCK_PARSE
+#define FFUNLOCK_PARSE
+#define FFTHREADLOCAL
 #define ffstrtok(str, tok, save) strtok(str, tok)
 #endif
 
@@ -1001,6 +1038,14 @@ int fits_read_compressed_img_plane(fitsfile *fptr, int  datatype,
       long *inc,  long *naxes,  int  nullcheck,  void *nullval, 
       void *array, char *nullarray, int  *anynul, long *nread, int  *status);
 
+/*  uncompressed image section gathering (getcol.c) */
+int fits_use_gather_section(int naxis, long *naxes, long *blc, long *trc,
+            long *inc);
+int fits_gather_img_section(fitsfile *fptr, int datatype, long group,
+            int naxis, long *naxes, long *blc, long *trc, long *inc,
+            int nultyp, void *nulval, void *array, char *flagval,
+            int *anynul, int *status);
+
 int imcomp_get_compressed_image_par(fitsfile *infptr, int *status);
 int imcomp_decompress_tile (fitsfile *infptr,
           int nrow, int tilesize, int datatype, int nullcheck,
@@ -1131,6 +1176,26 @@ int mem_uncompress2mem(char *filename, FILE *diskfile, int hdl);
 int iraf2mem(char *filename, char **buffptr, size_t *buffsize, 
       size_t *filesize, int *status);
 
+#ifdef HAVE_POSIX_SHM
+/* POSIX shared memory driver I/O routines */
+
+int pshm_init(void);
+int pshm_setoptions(int options);
+int pshm_getoptions(int *options);
+int pshm_getversion(int *version);
+int pshm_shutdown(void);
+int pshm_open(char *filename, int rwmode, int *handle);
+int pshm_create(char *filename, int *handle);
+int pshm_truncate(int handle, LONGLONG filesize);
+int pshm_size(int handle, LONGLONG *filesize);
+int pshm_close(int handle);
+int pshm_remove(char *filename);
+int pshm_flush(int handle);
+int pshm_seek(int handle, LONGLONG offset);
+int pshm_read(int hdl, void *buffer, long nbytes);
+int pshm_write(int hdl, void *buffer, long nbytes);
+#endif
+
 /* root driver I/O routines */
 
 int root_init(void);
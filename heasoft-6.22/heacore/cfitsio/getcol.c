@@ -7,6 +7,7 @@
 /*  Goddard Space Flight Center.                                           */
 
 #include <stdlib.h>
+#include <string.h>
 #include "fitsio2.h"
 
 /*--------------------------------------------------------------------------*/
@@ -536,6 +537,404 @@ int ffgsv(  fitsfile *fptr,   /* I - FITS file pointer                       */
     return(*status);
 }
 /*--------------------------------------------------------------------------*/
+/*
+  Image sections that are narrower than the image, or that have an X
+  increment > 1, are read by the ffgsv* routines one image row at a time;
+  each row is a separate call to the low level column reader, and with an
+  increment every pixel is extracted from the IO buffers individually.
+  When successive rows of the section lie close together in the file it
+  is cheaper to read the whole span of file covering a block of rows with
+  one call, converting the data type once, and then to gather the
+  requested pixels in memory.  The routines below do this.  Rows that are
+  more than GATHER_GAP pixels apart are read in separate blocks, so a
+  sparse section never reads much more data than the row-by-row method.
+*/
+#define GATHER_SPAN  262144L    /* max. pixels read into the scratch array */
+#define GATHER_GAP   2048L      /* max. unwanted pixels between two rows   */
+#define GATHER_ROWS  65536L     /* max. section rows gathered per block    */
+
+static int gather_elemsize(int datatype);
+static int gather_nulval_is_zero(int datatype, void *nulval);
+static int gather_block(fitsfile *fptr, int datatype, int elemsize,
+            long group, LONGLONG *rowstart, long nrows, LONGLONG lo,
+            LONGLONG hi, long n0, long step0, int nultyp, void *nulval,
+            char *scratch, char **flags, char *outptr, char *flagptr,
+            int *anynul, int *status);
+/*--------------------------------------------------------------------------*/
+int fits_use_gather_section(int naxis,  /* I - number of image dimensions  */
+            long *naxes,      /* I - size of each dimension                  */
+            long *blc,        /* I - 'bottom left corner' of the subsection  */
+            long *trc,        /* I - 'top right corner' of the subsection    */
+            long *inc)        /* I - increment to be applied in each dim.    */
+/*
+  Return true if an image section would be read more efficiently by
+  fits_gather_img_section than one row at a time, i.e. if the section
+  does not consist of whole image rows and the unwanted pixels between
+  successive rows of the section are few enough to be read along with
+  them.
+*/
+{
+    long width, span, gap;
+    int ii, yaxis = 0;
+
+    if (naxis < 1 || naxis > 9 || inc[0] < 1)
+        return(0);
+
+    width = (trc[0] > blc[0] ? trc[0] - blc[0] : blc[0] - trc[0]) + 1;
+    if (width >= naxes[0] && inc[0] == 1)
+        return(0);  /* whole rows are already read efficiently */
+
+    /* find the first higher axis along which the section has > 1 pixel */
+    for (ii = 1; ii < naxis; ii++)
+    {
+        if (trc[ii] != blc[ii])
+        {
+            yaxis = ii;
+            break;
+        }
+    }
+
+    if (!yaxis)     /* a single row */
+        return(inc[0] > 1);
+
+    /* number of pixels skipped between the end of one section row */
+    /* and the start of the next                                    */
+    span = (width - 1) / inc[0] * inc[0] + 1;
+    gap = naxes[0] - span;
+    for (ii = 1; ii < yaxis; ii++)
+        gap += (naxes[ii] - 1) * naxes[0];   /* never reached for 2-D images */
+    if (inc[yaxis] > 1)
+    {
+        for (ii = 0, span = 1; ii < yaxis; ii++)
+            span *= naxes[ii];
+        gap += (inc[yaxis] - 1) * span;
+    }
+
+    return(gap <= GATHER_GAP);
+}
+/*--------------------------------------------------------------------------*/
+int fits_gather_img_section(fitsfile *fptr, /* I - FITS file pointer        */
+            int  datatype,    /* I - datatype of the output array            */
+            long group,       /* I - group (row) number; 1 for most images   */
+            int  naxis,       /* I - number of image dimensions              */
+            long *naxes,      /* I - size of each dimension                  */
+            long *blc,        /* I - 'bottom left corner' of the subsection  */
+            long *trc,        /* I - 'top right corner' of the subsection    */
+            long *inc,        /* I - increment to be applied in each dim.    */
+            int  nultyp,      /* I - 1: set nulls = nulval; 2: set flagval   */
+            void *nulval,     /* I - value for undefined pixels (nultyp 1)   */
+            void *array,      /* O - array of values that are returned       */
+            char *flagval,    /* O - null flags (nultyp = 2)                 */
+            int  *anynul,     /* O - set to 1 if any values are null; else 0 */
+            int  *status)     /* IO - error status                           */
+/*
+  Read a section of an uncompressed image (primary array or IMAGE
+  extension) by reading blocks of rows with single contiguous reads and
+  gathering the requested pixels in memory.  Reversed axes (trc < blc)
+  are supported, as in the ffgsv* routines.  The output pixel order,
+  null handling and type conversion are identical to those routines.
+*/
+{
+    long cnt[9], step[9], idx[9], ii, n0, rowspan, nrows, maxrows, nblock;
+    LONGLONG stride[9], pos[9], rowoff, lo = 0, hi = 0, newlo, newhi;
+    LONGLONG *rowstart, maxspan;
+    char *outptr, *flagptr, *scratch, *flags = NULL;
+    int elemsize, done, blockany;
+    char msg[FLEN_ERRMSG];
+
+    if (*status > 0)
+        return(*status);
+
+    if (naxis < 1 || naxis > 9)
+    {
+        sprintf(msg, "NAXIS = %d in call to fits_gather_img_section is out of range", naxis);
+        ffpmsg(msg);
+        return(*status = BAD_DIMEN);
+    }
+
+    elemsize = gather_elemsize(datatype);
+    if (!elemsize)
+        return(*status = BAD_DATATYPE);
+
+    if (nultyp == 1 && gather_nulval_is_zero(datatype, nulval))
+        nulval = NULL;   /* no checking for null values */
+
+    /* number of pixels, signed step and file stride along each axis */
+    nrows = 1;
+    for (ii = 0; ii < naxis; ii++)
+    {
+        if (inc[ii] < 1 || blc[ii] < 1 || trc[ii] < 1 ||
+            blc[ii] > naxes[ii] || trc[ii] > naxes[ii])
+        {
+            sprintf(msg, "fits_gather_img_section: illegal range specified for axis %ld", ii + 1);
+            ffpmsg(msg);
+            return(*status = BAD_PIX_NUM);
+        }
+
+        step[ii] = (trc[ii] >= blc[ii]) ? inc[ii] : -inc[ii];
+        cnt[ii] = (trc[ii] >= blc[ii] ? trc[ii] - blc[ii] : blc[ii] - trc[ii])
+                   / inc[ii] + 1;
+        stride[ii] = (ii == 0) ? 1 : stride[ii - 1] * naxes[ii - 1];
+
+        if (ii > 0)
+            nrows *= cnt[ii];
+    }
+
+    n0 = cnt[0];
+    rowspan = (n0 - 1) * inc[0] + 1;
+
+    /* the scratch array holds one block, or one row if that is larger */
+    maxspan = maxvalue(GATHER_SPAN, rowspan);
+    maxspan = minvalue(maxspan, stride[naxis - 1] * naxes[naxis - 1]);
+    maxrows = minvalue(nrows, GATHER_ROWS);
+
+    rowstart = (LONGLONG *) malloc(maxrows * sizeof(LONGLONG));
+    scratch = (char *) malloc((size_t) (maxspan * elemsize));
+    if (!rowstart || !scratch)
+    {
+        free(rowstart);
+        free(scratch);
+        ffpmsg("Out of memory (fits_gather_img_section)");
+        return(*status = MEMORY_ALLOCATION);
+    }
+
+    if (anynul)
+        *anynul = FALSE;
+
+    /* odometer over axes 1..naxis-1; pos[] is the current pixel (1-based) */
+    for (ii = 0; ii < naxis; ii++)
+    {
+        idx[ii] = 0;
+        pos[ii] = blc[ii];
+    }
+
+    outptr = (char *) array;
+    flagptr = flagval;
+    nblock = 0;
+    done = 0;
+
+    while (!done)
+    {
+        /* file element (1-based) of the first pixel of this section row, */
+        /* and the range of elements spanned by the row                    */
+        rowoff = 1;
+        for (ii = 0; ii < naxis; ii++)
+            rowoff += (pos[ii] - 1) * stride[ii];
+
+        newlo = (step[0] > 0) ? rowoff : rowoff + (n0 - 1) * step[0];
+        newhi = newlo + rowspan - 1;
+
+        /* flush the current block if this row would make it too large */
+        /* or would add too many unwanted pixels                       */
+        if (nblock)
+        {
+            if (nblock == maxrows ||
+                maxvalue(hi, newhi) - minvalue(lo, newlo) + 1 > maxspan ||
+                newlo - hi - 1 > GATHER_GAP || lo - newhi - 1 > GATHER_GAP)
+            {
+                blockany = 0;
+                if (gather_block(fptr, datatype, elemsize, group, rowstart,
+                    nblock, lo, hi, n0, step[0], nultyp, nulval, scratch,
+                    &flags, outptr, flagptr, &blockany, status) > 0)
+                    break;
+
+                if (blockany && anynul)
+                    *anynul = TRUE;
+
+                outptr += nblock * n0 * elemsize;
+                if (flagptr)
+                    flagptr += nblock * n0;
+                nblock = 0;
+            }
+        }
+
+        if (nblock == 0)
+        {
+            lo = newlo;
+            hi = newhi;
+        }
+        else
+        {
+            lo = minvalue(lo, newlo);
+            hi = maxvalue(hi, newhi);
+        }
+        rowstart[nblock++] = rowoff;
+
+        /* advance to the next section row */
+        done = 1;
+        for (ii = 1; ii < naxis; ii++)
+        {
+            if (++idx[ii] < cnt[ii])
+            {
+                pos[ii] += step[ii];
+                done = 0;
+                break;
+            }
+            idx[ii] = 0;
+            pos[ii] = blc[ii];
+        }
+    }
+
+    if (*status <= 0 && nblock)
+    {
+        blockany = 0;
+        gather_block(fptr, datatype, elemsize, group, rowstart, nblock,
+            lo, hi, n0, step[0], nultyp, nulval, scratch, &flags, outptr,
+            flagptr, &blockany, status);
+
+        if (blockany && anynul)
+            *anynul = TRUE;
+    }
+
+    free(flags);
+    free(scratch);
+    free(rowstart);
+    return(*status);
+}
+/*--------------------------------------------------------------------------*/
+static int gather_block(fitsfile *fptr, int datatype, int elemsize,
+            long group, LONGLONG *rowstart, long nrows, LONGLONG lo,
+            LONGLONG hi, long n0, long step0, int nultyp, void *nulval,
+            char *scratch, char **flags, char *outptr, char *flagptr,
+            int *anynul, int *status)
+/*
+  Read file elements lo through hi into the scratch array with a single
+  call, then copy the n0 pixels (with increment step0) of each of the
+  nrows section rows that start at the elements in rowstart[] to the
+  output array.  The null flag array is allocated on first use, with the
+  same number of elements as the scratch array, and is reused by later
+  blocks.
+*/
+{
+    LONGLONG nelem = hi - lo + 1;
+    long ii, jj, src, base;
+    char *flg = NULL;
+    int anyf = 0;
+
+    /* read and convert the whole span once; the image data are in */
+    /* column 2 of the (single-row, or random groups) image 'table' */
+    if (nultyp == 1)
+    {
+        /* nulval = NULL: no null checking, as in the ffgsv* routines */
+        ffgcv(fptr, datatype, 2, group, lo, nelem, nulval, scratch,
+              &anyf, status);
+    }
+
+    if (nultyp == 2 || anyf)
+    {
+        /* the span contains null pixels; get their flags so that */
+        /* anynul only reflects the pixels that are returned       */
+        if (!*flags)
+        {
+            *flags = (char *) malloc((size_t) maxvalue(GATHER_SPAN, nelem));
+            if (!*flags)
+            {
+                ffpmsg("Out of memory (fits_gather_img_section)");
+                return(*status = MEMORY_ALLOCATION);
+            }
+        }
+        flg = *flags;
+
+        ffgcf(fptr, datatype, 2, group, lo, nelem, scratch, flg, &anyf,
+              status);
+    }
+
+    if (*status > 0)
+        return(*status);
+
+    for (ii = 0; ii < nrows; ii++)
+    {
+        base = (long) (rowstart[ii] - lo);
+
+        switch (elemsize)
+        {
+          case 1:
+            for (jj = 0, src = base; jj < n0; jj++, src += step0)
+                outptr[jj] = scratch[src];
+            break;
+          case 2:
+            for (jj = 0, src = base; jj < n0; jj++, src += step0)
+                ((short *) outptr)[jj] = ((short *) scratch)[src];
+            break;
+          case 4:
+            for (jj = 0, src = base; jj < n0; jj++, src += step0)
+                ((INT32BIT *) outptr)[jj] = ((INT32BIT *) scratch)[src];
+            break;
+          default:
+            for (jj = 0, src = base; jj < n0; jj++, src += step0)
+                memcpy(outptr + jj * elemsize, scratch + src * elemsize,
+                       elemsize);
+            break;
+        }
+
+        if (flg)
+        {
+            for (jj = 0, src = base; jj < n0; jj++, src += step0)
+            {
+                if (!flg[src])
+                {
+                    if (nultyp == 2)
+                        flagptr[jj] = 0;
+                    continue;
+                }
+
+                *anynul = TRUE;
+                if (nultyp == 2)
+                    flagptr[jj] = 1;
+                else
+                    memcpy(outptr + jj * elemsize, nulval, elemsize);
+            }
+            if (nultyp == 2)
+                flagptr += n0;
+        }
+
+        outptr += n0 * elemsize;
+    }
+
+    return(*status);
+}
+/*--------------------------------------------------------------------------*/
+static int gather_elemsize(int datatype)
+{
+    switch (datatype)
+    {
+      case TBYTE:      return(sizeof(unsigned char));
+      case TSBYTE:     return(sizeof(signed char));
+      case TSHORT:     return(sizeof(short));
+      case TUSHORT:    return(sizeof(unsigned short));
+      case TINT:       return(sizeof(int));
+      case TUINT:      return(sizeof(unsigned int));
+      case TLONG:      return(sizeof(long));
+      case TULONG:     return(sizeof(unsigned long));
+      case TLONGLONG:  return(sizeof(LONGLONG));
+      case TFLOAT:     return(sizeof(float));
+      case TDOUBLE:    return(sizeof(double));
+    }
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static int gather_nulval_is_zero(int datatype, void *nulval)
+{
+    if (!nulval)
+        return(1);
+
+    switch (datatype)
+    {
+      case TBYTE:      return(*(unsigned char *) nulval == 0);
+      case TSBYTE:     return(*(signed char *) nulval == 0);
+      case TSHORT:     return(*(short *) nulval == 0);
+      case TUSHORT:    return(*(unsigned short *) nulval == 0);
+      case TINT:       return(*(int *) nulval == 0);
+      case TUINT:      return(*(unsigned int *) nulval == 0);
+      case TLONG:      return(*(long *) nulval == 0);
+      case TULONG:     return(*(unsigned long *) nulval == 0);
+      case TLONGLONG:  return(*(LONGLONG *) nulval == 0);
+      case TFLOAT:     return(*(float *) nulval == 0);
+      case TDOUBLE:    return(*(double *) nulval == 0);
+    }
+    return(1);
+}
+/*--------------------------------------------------------------------------*/
 int ffgpv(  fitsfile *fptr,   /* I - FITS file pointer                       */
             int  datatype,    /* I - datatype of the value                   */
             LONGLONG firstelem,   /* I - first vector element to read (1 = 1st)  */
@@ -292,6 +292,14 @@ int ffgsvd(fitsfile *fptr, /* I - FITS file pointer                         */
         numcol = colnum;
     }
 
+    if (hdutype == IMAGE_HDU &&
+        fits_use_gather_section(naxis, naxes, blc, trc, inc))
+    {
+        /* read blocks of rows at once and pick out the pixels */
+        return(fits_gather_img_section(fptr, TDOUBLE, rstr, naxis, naxes,
+            blc, trc, inc, 1, &nulval, array, NULL, anynul, status));
+    }
+
     nultyp = 1;
     if (anynul)
         *anynul = FALSE;
@@ -466,6 +474,14 @@ int ffgsfd(fitsfile *fptr, /* I - FITS file pointer                         */
         numcol = colnum;
     }
 
+    if (hdutype == IMAGE_HDU &&
+        fits_use_gather_section(naxis, naxes, blc, trc, inc))
+    {
+        /* read blocks of rows at once and pick out the pixels */
+        return(fits_gather_img_section(fptr, TDOUBLE, rstr, naxis, naxes,
+            blc, trc, inc, 2, NULL, array, flagval, anynul, status));
+    }
+
     nultyp = 2;
     if (anynul)
         *anynul = FALSE;
@@ -290,6 +290,14 @@ int ffgsvj(fitsfile *fptr, /* I - FITS file pointer                         */
         numcol = colnum;
     }
 
+    if (hdutype == IMAGE_HDU &&
+        fits_use_gather_section(naxis, naxes, blc, trc, inc))
+    {
+        /* read blocks of rows at once and pick out the pixels */
+        return(fits_gather_img_section(fptr, TLONG, rstr, naxis, naxes,
+            blc, trc, inc, 1, &nulval, array, NULL, anynul, status));
+    }
+
     nultyp = 1;
     if (anynul)
         *anynul = FALSE;
@@ -465,6 +473,14 @@ int ffgsfj(fitsfile *fptr, /* I - FITS file pointer                         */
         numcol = colnum;
     }
 
+    if (hdutype == IMAGE_HDU &&
+        fits_use_gather_section(naxis, naxes, blc, trc, inc))
+    {
+        /* read blocks of rows at once and pick out the pixels */
+        return(fits_gather_img_section(fptr, TLONG, rstr, naxis, naxes,
+            blc, trc, inc, 2, NULL, array, flagval, anynul, status));
+    }
+
     nultyp = 2;
     if (anynul)
         *anynul = FALSE;
@@ -2176,6 +2192,14 @@ int ffgsvjj(fitsfile *fptr, /* I - FITS file pointer                         */
         numcol = colnum;
     }
 
+    if (hdutype == IMAGE_HDU &&
+        fits_use_gather_section(naxis, naxes, blc, trc, inc))
+    {
+        /* read blocks of rows at once and pick out the pixels */
+        return(fits_gather_img_section(fptr, TLONGLONG, rstr, naxis, naxes,
+            blc, trc, inc, 1, &nulval, array, NULL, anynul, status));
+    }
+
     nultyp = 1;
     if (anynul)
         *anynul = FALSE;
@@ -2351,6 +2375,14 @@ int ffgsfjj(fitsfile *fptr, /* I - FITS file pointer                         */
         numcol = colnum;
     }
 
+    if (hdutype == IMAGE_HDU &&
+        fits_use_gather_section(naxis, naxes, blc, trc, inc))
+    {
+        /* read blocks of rows at once and pick out the pixels */
+        return(fits_gather_img_section(fptr, TLONGLONG, rstr, naxis, naxes,
+            blc, trc, inc, 2, NULL, array, flagval, anynul, status));
+    }
+
     nultyp = 2;
     if (anynul)
         *anynul = FALSE;
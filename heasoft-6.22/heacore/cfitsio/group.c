@@ -5618,6 +5618,15 @@ int  fits_get_url(fitsfile *fptr,       /* I ptr to FITS file to evaluate    */
 	  *tmpStr2   = 0;
 	  tmpIOstate = 1;
 	}
+
+      /* file residing in a POSIX shared memory object */
+
+      else if(fits_strcasecmp(tmpStr3,"pshm://")         == 0)
+	{
+	  *tmpStr4   = 0;
+	  *tmpStr2   = 0;
+	  tmpIOstate = 1;
+	}
       
       /* file accessed via the ROOT network protocol */
 
@@ -6177,9 +6186,10 @@ int fits_relurl2url(char     *refURL, /* I reference URL string             */
       */
 	  
       if(fits_strncasecmp(tmpStr,"MEM:",4)   == 0 ||
-                	                fits_strncasecmp(tmpStr,"SHMEM:",6) == 0)
+                	                fits_strncasecmp(tmpStr,"SHMEM:",6) == 0 ||
+                	                fits_strncasecmp(tmpStr,"PSHM:",5) == 0)
 	{
-	  ffpmsg("ref URL has access mem:// or shmem:// (fits_relurl2url)");
+	  ffpmsg("ref URL has access mem://, shmem:// or pshm:// (fits_relurl2url)");
 	  ffpmsg("   cannot construct full URL from a partial URL and ");
 	  ffpmsg("   MEM/SHMEM base URL");
 	  *status = URL_PARSE_ERROR;
@@ -2188,13 +2188,10 @@ int ffwritehisto(long totaln, long pixoffset, long firstn, long nvalues,
 
     /* call iterator function to calc the histogram pixel values */
 
-    /* must lock this call in multithreaded environoments because */
-    /* the ffcalchist work routine uses static vaiables that would */
-    /* get clobbered if multiple threads were running at the same time */
-    FFLOCK;
+    /* the ffcalchist work routine keeps its state in thread-local */
+    /* static variables, so no lock is needed around this call     */
     fits_iterate_data(ncols, colpars, offset, rows_per_loop,
                           ffcalchist, (void*)histData, &status);
-    FFUNLOCK;
 
     return(status);
 }
@@ -2207,11 +2204,13 @@ int ffcalchist(long totalrows, long offset, long firstrow, long nrows,
 {
     long ii, ipix, iaxisbin;
     float pix, axisbin;
-    static float *col1, *col2, *col3, *col4; /* static to preserve values */
-    static float *wtcol;
-    static long incr2, incr3, incr4;
-    static histType histData;
-    static char *rowselect;
+    /* static to preserve values; thread-local so that several threads */
+    /* may build histograms at the same time                           */
+    static FFTHREADLOCAL float *col1, *col2, *col3, *col4;
+    static FFTHREADLOCAL float *wtcol;
+    static FFTHREADLOCAL long incr2, incr3, incr4;
+    static FFTHREADLOCAL histType histData;
+    static FFTHREADLOCAL char *rowselect;
 
     /*  Initialization procedures: execute on the first call  */
     if (firstrow == 1)
@@ -175,6 +175,7 @@ int fits_init_randoms(void) {
 /* initialize an array of random numbers */
 
     int ii;
+    float *randoms;
     double a = 16807.0;
     double m = 2147483647.0;
     double temp, seed;
@@ -188,9 +189,9 @@ int fits_init_randoms(void) {
 
     /* allocate array for the random number sequence */
     /* THIS MEMORY IS NEVER FREED */
-    fits_rand_value = calloc(N_RANDOM, sizeof(float));
+    randoms = calloc(N_RANDOM, sizeof(float));
 
-    if (!fits_rand_value) {
+    if (!randoms) {
         FFUNLOCK;
 	return(MEMORY_ALLOCATION);
     }
@@ -208,9 +209,13 @@ int fits_init_randoms(void) {
     for (ii = 0; ii < N_RANDOM; ii++) {
         temp = a * seed;
 	seed = temp -m * ((int) (temp / m) );
-	fits_rand_value[ii] = (float) (seed / m);
+	randoms[ii] = (float) (seed / m);
     }
 
+    /* only publish the array once it is completely filled, because the */
+    /* quantizing routines test fits_rand_value without taking the lock */
+    fits_rand_value = randoms;
+
     FFUNLOCK;
 
     /* 
@@ -0,0 +1,227 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/*
+  Test of the pshm:// (POSIX shared memory) driver.
+
+  A producer writes an image and a binary table to a shared memory file;
+  a child process then reads it back, as the next stage of a pipeline
+  would, and deletes it.  The same handoff is repeated through an
+  anonymous object passed to the child as an open descriptor
+  (pshm://fd/N).  The test also checks that a file cannot be opened by
+  another process while it is still being written.
+*/
+#include "fitsio.h"
+
+#define NX     300
+#define NY     200
+#define NROWS 5000
+
+static int writefile(char *filename, int closeit, fitsfile **fptr,
+                     int *status);
+static int readfile(char *filename, int delete, int *status);
+static int inchild(char *filename, int delete, int expect);
+
+int main()
+{
+    fitsfile *fptr;
+    char name[FLEN_FILENAME], fdname[FLEN_FILENAME];
+    int fd, status = 0, nfail = 0;
+
+    /* 1: named object, written and closed, then read and deleted */
+    sprintf(name, "pshm://cfitsio_pshmtest_%d", (int) getpid());
+    writefile(name, 1, &fptr, &status);
+    if (status)
+    {
+        printf("failed to write %s, status = %d\n", name, status);
+        return(1);
+    }
+
+    if (inchild(name, 1, 0))
+    {
+        printf("child could not read %s\n", name);
+        nfail++;
+    }
+
+    /* the child deleted the file, so it can no longer be opened */
+    if (!fits_open_file(&fptr, name, READONLY, &status))
+    {
+        printf("%s still exists after it was deleted\n", name);
+        fits_close_file(fptr, &status);
+        nfail++;
+    }
+    status = 0;
+    fits_clear_errmsg();
+
+    /* 2: a file that is open for writing cannot be read by others */
+    writefile(name, 0, &fptr, &status);
+    if (inchild(name, 0, FILE_NOT_OPENED))
+    {
+        printf("child opened %s while it was being written\n", name);
+        nfail++;
+    }
+    fits_close_file(fptr, &status);
+    if (inchild(name, 1, 0))
+    {
+        printf("child could not read %s once it was closed\n", name);
+        nfail++;
+    }
+
+    /* 3: anonymous object, handed to the child as a descriptor */
+    sprintf(name, "/cfitsio_pshmtest_fd_%d", (int) getpid());
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        printf("could not create shared memory object %s\n", name);
+        return(1);
+    }
+    shm_unlink(name);
+
+    sprintf(fdname, "pshm://fd/%d", fd);
+    writefile(fdname, 1, &fptr, &status);
+    if (status || inchild(fdname, 0, 0))
+    {
+        printf("handoff through %s failed, status = %d\n", fdname, status);
+        nfail++;
+    }
+    close(fd);
+
+    if (nfail)
+    {
+        printf("%d pshm:// tests failed\n", nfail);
+        return(1);
+    }
+
+    printf("pshm:// driver tests completed successfully\n");
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static int inchild(char *filename, int delete, int expect)
+/*
+  read the file in a child process; return 0 if the child's status
+  was the expected one
+*/
+{
+    pid_t pid;
+    int status = 0, waitstatus;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0)
+        return(1);
+
+    if (pid == 0)
+    {
+        readfile(filename, delete, &status);
+        _exit(status == expect ? 0 : 1);
+    }
+
+    if (waitpid(pid, &waitstatus, 0) != pid || !WIFEXITED(waitstatus))
+        return(1);
+
+    return(WEXITSTATUS(waitstatus));
+}
+/*--------------------------------------------------------------------------*/
+static int writefile(char *filename, int closeit, fitsfile **fptr,
+                     int *status)
+/*
+   write an image and a binary table; leave the file open if closeit = 0
+*/
+{
+    long naxes[2] = {NX, NY};
+    long ii;
+    int *image;
+    double *xcol;
+    char *ttype[] = {"X"};
+    char *tform[] = {"1D"};
+    char *tunit[] = {""};
+
+    if (*status > 0)
+        return(*status);
+
+    image = (int *) malloc(NX * NY * sizeof(int));
+    xcol = (double *) malloc(NROWS * sizeof(double));
+    if (!image || !xcol)
+    {
+        free(image);
+        free(xcol);
+        return(*status = MEMORY_ALLOCATION);
+    }
+
+    for (ii = 0; ii < NX * NY; ii++)
+        image[ii] = (int) (ii % 1000);
+    for (ii = 0; ii < NROWS; ii++)
+        xcol[ii] = ii * 0.5;
+
+    fits_create_file(fptr, filename, status);
+    fits_create_img(*fptr, LONG_IMG, 2, naxes, status);
+    fits_write_img(*fptr, TINT, 1, NX * NY, image, status);
+    fits_create_tbl(*fptr, BINARY_TBL, NROWS, 1, ttype, tform, tunit,
+                    "EVENTS", status);
+    fits_write_col(*fptr, TDOUBLE, 1, 1, 1, NROWS, xcol, status);
+
+    if (closeit)
+        fits_close_file(*fptr, status);
+    else
+        fits_flush_file(*fptr, status);
+
+    free(image);
+    free(xcol);
+    return(*status);
+}
+/*--------------------------------------------------------------------------*/
+static int readfile(char *filename, int delete, int *status)
+/*
+   read back and verify the file written by writefile, and delete it
+   if requested.  Returns -1 for a data mismatch.
+*/
+{
+    fitsfile *fptr;
+    long ii, nrows = 0;
+    int *image, anynul, bad = 0;
+    double *xcol;
+
+    if (fits_open_file(&fptr, filename, READONLY, status))
+        return(*status);
+
+    image = (int *) malloc(NX * NY * sizeof(int));
+    xcol = (double *) malloc(NROWS * sizeof(double));
+    if (!image || !xcol)
+    {
+        free(image);
+        free(xcol);
+        return(*status = MEMORY_ALLOCATION);
+    }
+
+    fits_read_img(fptr, TINT, 1, NX * NY, NULL, image, &anynul, status);
+    for (ii = 0; ii < NX * NY && *status <= 0; ii++)
+        if (image[ii] != (int) (ii % 1000))
+            bad = 1;
+
+    fits_movnam_hdu(fptr, BINARY_TBL, "EVENTS", 0, status);
+    fits_get_num_rows(fptr, &nrows, status);
+    fits_read_col(fptr, TDOUBLE, 1, 1, 1, NROWS, NULL, xcol, &anynul, status);
+    for (ii = 0; ii < NROWS && *status <= 0; ii++)
+        if (xcol[ii] != ii * 0.5)
+            bad = 1;
+    if (nrows != NROWS)
+        bad = 1;
+
+    if (delete)
+        fits_delete_file(fptr, status);
+    else
+        fits_close_file(fptr, status);
+
+    free(image);
+    free(xcol);
+
+    if (bad && *status <= 0)
+        *status = -1;
+
+    return(*status);
+}
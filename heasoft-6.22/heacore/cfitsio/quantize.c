@@ -8,9 +8,14 @@
 # include <math.h>
 # include <limits.h>
 # include <float.h>
+# include <string.h>
 
 #include "fitsio2.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /* nearest integer function */
 # define NINT(x)  ((x >= 0.) ? (int) (x + 0.5) : (int) (x - 0.5))
 
@@ -80,6 +85,20 @@ static int quick_select_int(int arr[], int n);
 static LONGLONG quick_select_longlong(LONGLONG arr[], int n);
 static double quick_select_double(double arr[], int n);
 
+static void *fits_quantize_scratch(size_t nbytes);
+static long fits_noise_goodpix_float(float *rowpix, long nx, float nullvalue,
+   float *goodpix);
+static void fits_noise_range_float(float *pix, long npix, float *minval,
+   float *maxval);
+static void fits_noise5_diffs_float(float *pix, long npix, float *differences2,
+   float *differences3, float *differences5, long *nvals2, long *nvals);
+static void fits_noise3_diffs_float(float *pix, long npix, float *differences,
+   long *nvals);
+static float fits_select_float(float arr[], long n, float work[]);
+static void fits_quantize_pixels_float(float *fdata, long npix, int *idata,
+   double zeropt, double delta, float *randval, int dither2, int nullcheck,
+   float in_null_value);
+
 /*---------------------------------------------------------------------------*/
 int fits_quantize_float (long row, float fdata[], long nxpix, long nypix, int nullcheck, 
 	float in_null_value, float qlevel, int dither_method, int idata[], double *bscale,
@@ -108,7 +127,7 @@ If the function value is zero, the data were not copied to idata.
 */
 
 	int status, iseed = 0;
-	long i, nx, ngood = 0;
+	long i, n, nx, ngood = 0;
 	double stdev, noise2, noise3, noise5;	/* MAD 2nd, 3rd, and 5th order noise values */
 	float minval = 0., maxval = 0.;  /* min & max of fdata */
 	double delta;		/* bscale, 1 in idata = delta in fdata */
@@ -200,15 +219,17 @@ If the function value is zero, the data were not copied to idata.
             }
 
             if (row > 0) {  /* dither the values when quantizing */
-              for (i = 0;  i < nx;  i++) {
-	    
-		if (dither_method == SUBTRACTIVE_DITHER_2 && fdata[i] == 0.0) {
-		   idata[i] = ZERO_VALUE;
-		} else {
-		   idata[i] =  NINT((((double) fdata[i] - zeropt) / delta) + fits_rand_value[nextrand] - 0.5);
-		}
+              for (i = 0;  i < nx;  i += n) {
 
-                nextrand++;
+                /* the pixels up to the end of the list of random numbers */
+                n = N_RANDOM - nextrand;
+                if (n > nx - i) n = nx - i;
+
+                fits_quantize_pixels_float(fdata + i, n, idata + i, zeropt,
+                    delta, fits_rand_value + nextrand,
+                    dither_method == SUBTRACTIVE_DITHER_2, 0, in_null_value);
+
+                nextrand += n;
 		if (nextrand == N_RANDOM) {
 		    iseed++;
 		    if (iseed == N_RANDOM) iseed = 0;
@@ -217,9 +238,8 @@ If the function value is zero, the data were not copied to idata.
               }
             } else {  /* do not dither the values */
 
-       	        for (i = 0;  i < nx;  i++) {
-	            idata[i] = NINT ((fdata[i] - zeropt) / delta);
-                }
+                fits_quantize_pixels_float(fdata, nx, idata, zeropt, delta,
+                    0, 0, 0, in_null_value);
             } 
         }
         else {
@@ -228,19 +248,17 @@ If the function value is zero, the data were not copied to idata.
             zeropt = minval - delta * (NULL_VALUE + N_RESERVED_VALUES);
 
             if (row > 0) {  /* dither the values */
-	      for (i = 0;  i < nx;  i++) {
-                if (fdata[i] != in_null_value) {
-		    if (dither_method == SUBTRACTIVE_DITHER_2 && fdata[i] == 0.0) {
-		       idata[i] = ZERO_VALUE;
-		    } else {
-		       idata[i] =  NINT((((double) fdata[i] - zeropt) / delta) + fits_rand_value[nextrand] - 0.5);
-		    }
-                } else {
-                    idata[i] = NULL_VALUE;
-                }
+	      for (i = 0;  i < nx;  i += n) {
 
-                /* increment the random number index, regardless */
-                nextrand++;
+                /* the random number index is incremented for null pixels too */
+                n = N_RANDOM - nextrand;
+                if (n > nx - i) n = nx - i;
+
+                fits_quantize_pixels_float(fdata + i, n, idata + i, zeropt,
+                    delta, fits_rand_value + nextrand,
+                    dither_method == SUBTRACTIVE_DITHER_2, 1, in_null_value);
+
+                nextrand += n;
 		if (nextrand == N_RANDOM) {
 		    iseed++;
 		    if (iseed == N_RANDOM) iseed = 0;
@@ -248,14 +266,8 @@ If the function value is zero, the data were not copied to idata.
                 }
               }
             } else {  /* do not dither the values */
-	       for (i = 0;  i < nx;  i++) {
- 
-                 if (fdata[i] != in_null_value) {
-		    idata[i] =  NINT((fdata[i] - zeropt) / delta);
-                 } else { 
-                    idata[i] = NULL_VALUE;
-                 }
-               }
+                fits_quantize_pixels_float(fdata, nx, idata, zeropt, delta,
+                    0, 0, 1, in_null_value);
             }
 	}
 
@@ -270,6 +282,76 @@ If the function value is zero, the data were not copied to idata.
 	return (1);			/* yes, data have been quantized */
 }
 /*---------------------------------------------------------------------------*/
+static void fits_quantize_pixels_float(float *fdata, long npix, int *idata,
+	double zeropt, double delta, float *randval, int dither2, int nullcheck,
+	float in_null_value)
+/*
+  quantize npix pixels for fits_quantize_float.  If randval is not null, the
+  i-th pixel is dithered with randval[i], and if dither2 is true zero-valued
+  pixels are set to ZERO_VALUE.  If nullcheck is true, pixels equal to
+  in_null_value are set to NULL_VALUE.
+
+  The vector code performs the same double precision operations as the
+  scalar code, so that the quantized values are identical.
+*/
+{
+	long i = 0;
+#ifdef __SSE2__
+	__m128 f, r, nullv = _mm_set1_ps(in_null_value), fzero = _mm_setzero_ps();
+	__m128d lo, hi, zero = _mm_setzero_pd(), half = _mm_set1_pd(0.5);
+	__m128d vzeropt = _mm_set1_pd(zeropt), vdelta = _mm_set1_pd(delta);
+	__m128d ge;
+	__m128i ival, mask;
+	__m128i nullval = _mm_set1_epi32(NULL_VALUE), zeroval = _mm_set1_epi32(ZERO_VALUE);
+
+	for (; i + 4 <= npix; i += 4) {
+	    f = _mm_loadu_ps(fdata + i);
+
+	    lo = _mm_div_pd(_mm_sub_pd(_mm_cvtps_pd(f), vzeropt), vdelta);
+	    hi = _mm_div_pd(_mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(f, f)), vzeropt), vdelta);
+	    if (randval) {
+	        r = _mm_loadu_ps(randval + i);
+	        lo = _mm_sub_pd(_mm_add_pd(lo, _mm_cvtps_pd(r)), half);
+	        hi = _mm_sub_pd(_mm_add_pd(hi, _mm_cvtps_pd(_mm_movehl_ps(r, r))), half);
+	    }
+
+	    /* NINT: truncate x + 0.5 if x >= 0, and x - 0.5 otherwise */
+	    ge = _mm_cmpge_pd(lo, zero);
+	    lo = _mm_or_pd(_mm_and_pd(ge, _mm_add_pd(lo, half)),
+	        _mm_andnot_pd(ge, _mm_sub_pd(lo, half)));
+	    ge = _mm_cmpge_pd(hi, zero);
+	    hi = _mm_or_pd(_mm_and_pd(ge, _mm_add_pd(hi, half)),
+	        _mm_andnot_pd(ge, _mm_sub_pd(hi, half)));
+	    ival = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+
+	    if (randval && dither2) {
+	        mask = _mm_castps_si128(_mm_cmpeq_ps(f, fzero));
+	        ival = _mm_or_si128(_mm_and_si128(mask, zeroval), _mm_andnot_si128(mask, ival));
+	    }
+	    if (nullcheck) {
+	        mask = _mm_castps_si128(_mm_cmpeq_ps(f, nullv));
+	        ival = _mm_or_si128(_mm_and_si128(mask, nullval), _mm_andnot_si128(mask, ival));
+	    }
+
+	    _mm_storeu_si128((__m128i *) (idata + i), ival);
+	}
+#endif
+
+	for (; i < npix; i++) {
+	    if (nullcheck && fdata[i] == in_null_value) {
+	        idata[i] = NULL_VALUE;
+	    } else if (randval) {
+	        if (dither2 && fdata[i] == 0.0) {
+	            idata[i] = ZERO_VALUE;
+	        } else {
+	            idata[i] =  NINT((((double) fdata[i] - zeropt) / delta) + randval[i] - 0.5);
+	        }
+	    } else {
+	        idata[i] = NINT((fdata[i] - zeropt) / delta);
+	    }
+	}
+}
+/*---------------------------------------------------------------------------*/
 int fits_quantize_double (long row, double fdata[], long nxpix, long nypix, int nullcheck, 
 	double in_null_value, float qlevel, int dither_method, int idata[], double *bscale,
 	double *bzero, int *iminval, int *imaxval) {
@@ -1574,6 +1656,331 @@ row of the image.
 	return(*status);
 }
 /*--------------------------------------------------------------------------*/
+/*
+  Work space for the float noise estimators.  It is kept from one call to
+  the next, so that compressing an image does not allocate new difference
+  arrays for every tile.  In the thread-safe build each thread has its own
+  buffer, which is freed when the thread exits.
+*/
+
+typedef struct {
+    void *buf;
+    size_t size;
+} quantize_scratch;
+
+#ifdef _REENTRANT
+static pthread_key_t scratch_key;
+static pthread_once_t scratch_once = PTHREAD_ONCE_INIT;
+
+static void fits_quantize_scratch_free(void *p)
+{
+    quantize_scratch *scratch = (quantize_scratch *) p;
+
+    free(scratch->buf);
+    free(scratch);
+}
+static void fits_quantize_scratch_init(void)
+{
+    pthread_key_create(&scratch_key, fits_quantize_scratch_free);
+}
+#else
+static quantize_scratch scratch_buffer = {0, 0};
+#endif
+
+static void *fits_quantize_scratch(size_t nbytes)
+/*
+  return a work buffer of at least nbytes, or NULL if it cannot be allocated.
+  The contents of the buffer are undefined.
+*/
+{
+    quantize_scratch *scratch;
+
+#ifdef _REENTRANT
+    pthread_once(&scratch_once, fits_quantize_scratch_init);
+    scratch = (quantize_scratch *) pthread_getspecific(scratch_key);
+    if (!scratch) {
+        scratch = (quantize_scratch *) calloc(1, sizeof(quantize_scratch));
+        if (!scratch)
+            return(NULL);
+        if (pthread_setspecific(scratch_key, scratch)) {
+            free(scratch);
+            return(NULL);
+        }
+    }
+#else
+    scratch = &scratch_buffer;
+#endif
+
+    if (nbytes > scratch->size) {
+        free(scratch->buf);
+        scratch->buf = malloc(nbytes);
+        scratch->size = scratch->buf ? nbytes : 0;
+    }
+    return(scratch->buf);
+}
+/*--------------------------------------------------------------------------*/
+static long fits_noise_goodpix_float(float *rowpix, long nx, float nullvalue,
+    float *goodpix)
+/*
+  copy the non-null pixels of a row to goodpix; return how many there are
+*/
+{
+    long ii, npix = 0;
+
+    for (ii = 0; ii < nx; ii++) {
+        goodpix[npix] = rowpix[ii];
+        npix += (rowpix[ii] != nullvalue);
+    }
+    return(npix);
+}
+/*--------------------------------------------------------------------------*/
+static void fits_noise_range_float(float *pix, long npix, float *minval,
+    float *maxval)
+/*
+  update minval and maxval with the pixels of a row.  The result is the same
+  as that of testing one pixel after the other: NaNs are ignored, and of
+  0. and -0. the one that occurs first is kept.
+*/
+{
+    long ii = 0;
+    float xminval = *minval, xmaxval = *maxval;
+#ifdef __SSE2__
+    float lanes[4];
+    __m128 vmin, vmax, v;
+    int k;
+
+    if (npix >= 8) {
+        vmin = _mm_set1_ps(xminval);
+        vmax = _mm_set1_ps(xmaxval);
+
+        /* minps and maxps return their second operand unless the first
+           one is smaller (larger), exactly like the scalar tests */
+        for (; ii + 4 <= npix; ii += 4) {
+            v = _mm_loadu_ps(pix + ii);
+            vmin = _mm_min_ps(v, vmin);
+            vmax = _mm_max_ps(v, vmax);
+        }
+
+        _mm_storeu_ps(lanes, vmin);
+        for (k = 0; k < 4; k++)
+            if (lanes[k] < xminval) xminval = lanes[k];
+        _mm_storeu_ps(lanes, vmax);
+        for (k = 0; k < 4; k++)
+            if (lanes[k] > xmaxval) xmaxval = lanes[k];
+    }
+#endif
+
+    for (; ii < npix; ii++) {
+        if (pix[ii] < xminval) xminval = pix[ii];
+        if (pix[ii] > xmaxval) xmaxval = pix[ii];
+    }
+
+    /* a new zero extreme may have come from any lane; take the first one */
+    if (xminval == 0. && xminval < *minval) {
+        for (ii = 0; pix[ii] != 0.; ii++);
+        xminval = pix[ii];
+    }
+    if (xmaxval == 0. && xmaxval > *maxval) {
+        for (ii = 0; pix[ii] != 0.; ii++);
+        xmaxval = pix[ii];
+    }
+
+    *minval = xminval;
+    *maxval = xmaxval;
+}
+/*--------------------------------------------------------------------------*/
+static void fits_noise5_diffs_float(float *pix, long npix, float *differences2,
+    float *differences3, float *differences5, long *nvals2, long *nvals)
+/*
+  compute the 2nd, 3rd and 5th order absolute differences of the npix (>= 9)
+  valid pixels of a row, skipping constant background regions.  The values
+  and their order are the same as in the original pixel by pixel loop.
+*/
+{
+    long ii = 8, n2 = 0, n3 = 0;
+    float v1, v3, v4, v5, v6, v7, v9;
+#ifdef __SSE2__
+    float d2[4], d3[4], d5[4];
+    __m128 x1, x3, x4, x5, x6, x7, x9, same;
+    __m128 absmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 two = _mm_set1_ps(2.f), four = _mm_set1_ps(4.f), six = _mm_set1_ps(6.f);
+    int k, same2, same3;
+
+    for (; ii + 4 <= npix; ii += 4) {
+        x1 = _mm_loadu_ps(pix + ii - 8);
+        x3 = _mm_loadu_ps(pix + ii - 6);
+        x4 = _mm_loadu_ps(pix + ii - 5);
+        x5 = _mm_loadu_ps(pix + ii - 4);
+        x6 = _mm_loadu_ps(pix + ii - 3);
+        x7 = _mm_loadu_ps(pix + ii - 2);
+        x9 = _mm_loadu_ps(pix + ii);
+
+        same = _mm_and_ps(_mm_cmpeq_ps(x5, x6), _mm_cmpeq_ps(x6, x7));
+        same2 = _mm_movemask_ps(same);
+        same = _mm_and_ps(same, _mm_and_ps(_mm_cmpeq_ps(x3, x4), _mm_cmpeq_ps(x4, x5)));
+        same3 = _mm_movemask_ps(same);
+
+        /* same operations, in the same order, as the scalar expressions */
+        _mm_storeu_ps(d2, _mm_and_ps(_mm_sub_ps(x5, x7), absmask));
+        _mm_storeu_ps(d3, _mm_and_ps(_mm_sub_ps(_mm_sub_ps(
+            _mm_mul_ps(two, x5), x3), x7), absmask));
+        _mm_storeu_ps(d5, _mm_and_ps(_mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_sub_ps(
+            _mm_mul_ps(six, x5), _mm_mul_ps(four, x3)), _mm_mul_ps(four, x7)),
+            x1), x9), absmask));
+
+        for (k = 0; k < 4; k++) {
+            if (!(same2 & (1 << k)))
+                differences2[n2++] = d2[k];
+
+            differences3[n3] = d3[k];
+            differences5[n3] = d5[k];
+            n3 += !(same3 & (1 << k));
+        }
+    }
+#endif
+
+    for (; ii < npix; ii++) {
+        v1 = pix[ii - 8];
+        v3 = pix[ii - 6];
+        v4 = pix[ii - 5];
+        v5 = pix[ii - 4];
+        v6 = pix[ii - 3];
+        v7 = pix[ii - 2];
+        v9 = pix[ii];
+
+        if (!(v5 == v6 && v6 == v7) ) {
+            differences2[n2] = (float) fabs(v5 - v7);
+            n2++;
+        }
+
+        if (!(v3 == v4 && v4 == v5 && v5 == v6 && v6 == v7) ) {
+            differences3[n3] = (float) fabs((2 * v5) - v3 - v7);
+            differences5[n3] = (float) fabs((6 * v5) - (4 * v3) - (4 * v7) + v1 + v9);
+            n3++;
+        }
+    }
+
+    *nvals2 = n2;
+    *nvals = n3;
+}
+/*--------------------------------------------------------------------------*/
+static void fits_noise3_diffs_float(float *pix, long npix, float *differences,
+    long *nvals)
+/*
+  compute the 3rd order absolute differences of the npix (>= 4) valid pixels
+  of a row, skipping constant background regions.  The differences are
+  computed in double precision, as in the original pixel by pixel loop.
+*/
+{
+    long ii = 4, n = 0;
+    float v1, v2, v3, v4, v5;
+#ifdef __SSE2__
+    float d[4];
+    __m128 x1, x2, x3, x4, x5, same;
+    __m128d lo, hi;
+    __m128d two = _mm_set1_pd(2.), signmask = _mm_set1_pd(-0.);
+    int k, same3;
+
+    for (; ii + 4 <= npix; ii += 4) {
+        x1 = _mm_loadu_ps(pix + ii - 4);
+        x2 = _mm_loadu_ps(pix + ii - 3);
+        x3 = _mm_loadu_ps(pix + ii - 2);
+        x4 = _mm_loadu_ps(pix + ii - 1);
+        x5 = _mm_loadu_ps(pix + ii);
+
+        same = _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(x1, x2), _mm_cmpeq_ps(x2, x3)),
+            _mm_and_ps(_mm_cmpeq_ps(x3, x4), _mm_cmpeq_ps(x4, x5)));
+        same3 = _mm_movemask_ps(same);
+
+        lo = _mm_sub_pd(_mm_sub_pd(_mm_mul_pd(two, _mm_cvtps_pd(x3)),
+            _mm_cvtps_pd(x1)), _mm_cvtps_pd(x5));
+        hi = _mm_sub_pd(_mm_sub_pd(_mm_mul_pd(two, _mm_cvtps_pd(_mm_movehl_ps(x3, x3))),
+            _mm_cvtps_pd(_mm_movehl_ps(x1, x1))), _mm_cvtps_pd(_mm_movehl_ps(x5, x5)));
+        lo = _mm_andnot_pd(signmask, lo);
+        hi = _mm_andnot_pd(signmask, hi);
+        _mm_storeu_ps(d, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+
+        for (k = 0; k < 4; k++) {
+            differences[n] = d[k];
+            n += !(same3 & (1 << k));
+        }
+    }
+#endif
+
+    for (; ii < npix; ii++) {
+        v1 = pix[ii - 4];
+        v2 = pix[ii - 3];
+        v3 = pix[ii - 2];
+        v4 = pix[ii - 1];
+        v5 = pix[ii];
+
+        if (!(v1 == v2 && v2 == v3 && v3 == v4 && v4 == v5)) {
+            differences[n] = (float) fabs((2. * v3) - v1 - v5);
+            n++;
+        }
+    }
+
+    *nvals = n;
+}
+/*--------------------------------------------------------------------------*/
+static float fits_select_float(float arr[], long n, float work[])
+/*
+  return the same value as quick_select_float(arr, n), i.e. the (n-1)/2-th
+  smallest element, for arrays of absolute differences.  Non-negative floats
+  sort in the same order as their bit patterns, so the element is found by
+  successive histograms of the bits, without the data dependent branches of
+  quick_select.  arr is not modified; work must hold n values.  Arrays that
+  contain NaNs are passed to quick_select_float, which orders them its own way.
+*/
+{
+    int count[1 << 12];
+    int level, nbins, shift;
+    unsigned int key, bin, bad = 0;
+    long ii, k, ncand, nkeep;
+    float *cand;
+
+    if (n < 64)
+        return(quick_select_float(arr, (int) n));
+
+    k = (n - 1) / 2;
+    cand = arr;
+    ncand = n;
+
+    /* 12, 10 and 10 bits of the keys, from the most significant */
+    for (level = 0; level < 3; level++) {
+        shift = (level == 0) ? 20 : (level == 1 ? 10 : 0);
+        nbins = (level == 0) ? (1 << 12) : (1 << 10);
+
+        memset(count, 0, nbins * sizeof(int));
+        for (ii = 0; ii < ncand; ii++) {
+            memcpy(&key, cand + ii, sizeof(key));
+            bad |= (key > 0x7f800000);
+            count[(key >> shift) & (nbins - 1)]++;
+        }
+        if (bad)
+            return(quick_select_float(arr, (int) n));
+
+        /* find the bin holding the k-th value */
+        for (bin = 0; k >= count[bin]; bin++)
+            k -= count[bin];
+
+        if (count[bin] == ncand)
+            continue;  /* all the candidates are in this bin */
+
+        nkeep = 0;
+        for (ii = 0; ii < ncand; ii++) {
+            memcpy(&key, cand + ii, sizeof(key));
+            work[nkeep] = cand[ii];
+            nkeep += (((key >> shift) & (nbins - 1)) == bin);
+        }
+        cand = work;
+        ncand = nkeep;
+    }
+
+    /* the remaining candidates all have the same value */
+    return(cand[0]);
+}
+/*--------------------------------------------------------------------------*/
 static int FnNoise5_float
        (float *array,       /*  2 dimensional array of image pixels */
         long nx,            /* number of pixels in each row of the image */
@@ -1603,14 +2010,14 @@ The returned estimates are the median of the values that are computed for each
 row of the image.
 */
 {
-	long ii, jj, nrows = 0, nrows2 = 0, nvals, nvals2, ngoodpix = 0;
-	float *differences2, *differences3, *differences5;
-	float *rowpix, v1, v2, v3, v4, v5, v6, v7, v8, v9;
+	long ii, jj, nrows = 0, nrows2 = 0, nvals, nvals2, ngoodpix = 0, npix;
+	float *differences2, *differences3, *differences5, *goodpix, *work;
+	float *rowpix;
 	float xminval = FLT_MAX, xmaxval = -FLT_MAX;
 	int do_range = 0;
 	double *diffs2, *diffs3, *diffs5; 
 	double xnoise2 = 0, xnoise3 = 0, xnoise5 = 0;
-	
+
 	if (nx < 9) {
 		/* treat entire array as an image with a single row */
 		nx = nx * ny;
@@ -1640,222 +2047,53 @@ row of the image.
 
 	/* do we need to compute the min and max value? */
 	if (minval || maxval) do_range = 1;
-	
-        /* allocate arrays used to compute the median and noise estimates */
-	differences2 = calloc(nx, sizeof(float));
-	if (!differences2) {
-        	*status = MEMORY_ALLOCATION;
-		return(*status);
-	}
-	differences3 = calloc(nx, sizeof(float));
-	if (!differences3) {
-		free(differences2);
-        	*status = MEMORY_ALLOCATION;
-		return(*status);
-	}
-	differences5 = calloc(nx, sizeof(float));
-	if (!differences5) {
-		free(differences2);
-		free(differences3);
-        	*status = MEMORY_ALLOCATION;
-		return(*status);
-	}
 
-	diffs2 = calloc(ny, sizeof(double));
+        /* get the arrays used to compute the median and noise estimates */
+	diffs2 = (double *) fits_quantize_scratch(3 * ny * sizeof(double) +
+	    5 * nx * sizeof(float));
 	if (!diffs2) {
-		free(differences2);
-		free(differences3);
-		free(differences5);
-        	*status = MEMORY_ALLOCATION;
-		return(*status);
-	}
-
-	diffs3 = calloc(ny, sizeof(double));
-	if (!diffs3) {
-		free(differences2);
-		free(differences3);
-		free(differences5);
-		free(diffs2);
-        	*status = MEMORY_ALLOCATION;
-		return(*status);
-	}
-
-	diffs5 = calloc(ny, sizeof(double));
-	if (!diffs5) {
-		free(differences2);
-		free(differences3);
-		free(differences5);
-		free(diffs2);
-		free(diffs3);
         	*status = MEMORY_ALLOCATION;
 		return(*status);
 	}
+	diffs3 = diffs2 + ny;
+	diffs5 = diffs3 + ny;
+	differences2 = (float *) (diffs5 + ny);
+	differences3 = differences2 + nx;
+	differences5 = differences3 + nx;
+	goodpix = differences5 + nx;
+	work = goodpix + nx;
+
+	/* the median of differences2 is taken over nvals values, which may
+	   include values left from previous rows, so it must start out zeroed */
+	memset(differences2, 0, nx * sizeof(float));
 
 	/* loop over each row of the image */
 	for (jj=0; jj < ny; jj++) {
 
                 rowpix = array + (jj * nx); /* point to first pixel in the row */
 
-		/***** find the first valid pixel in row */
-		ii = 0;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v1 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
-
-		if (do_range) {
-			if (v1 < xminval) xminval = v1;
-			if (v1 > xmaxval) xmaxval = v1;
-		}
-
-		/***** find the 2nd valid pixel in row (which we will skip over) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v2 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
-		
-		if (do_range) {
-			if (v2 < xminval) xminval = v2;
-			if (v2 > xmaxval) xmaxval = v2;
-		}
-
-		/***** find the 3rd valid pixel in row */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v3 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
-
-		if (do_range) {
-			if (v3 < xminval) xminval = v3;
-			if (v3 > xmaxval) xmaxval = v3;
-		}
-				
-		/* find the 4nd valid pixel in row (to be skipped) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v4 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
-
-		if (do_range) {
-			if (v4 < xminval) xminval = v4;
-			if (v4 > xmaxval) xmaxval = v4;
-		}
-			
-		/* find the 5th valid pixel in row (to be skipped) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v5 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
-
-		if (do_range) {
-			if (v5 < xminval) xminval = v5;
-			if (v5 > xmaxval) xmaxval = v5;
-		}
-				
-		/* find the 6th valid pixel in row (to be skipped) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v6 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
-
-		if (do_range) {
-			if (v6 < xminval) xminval = v6;
-			if (v6 > xmaxval) xmaxval = v6;
+		/* gather the valid pixels of the row */
+		if (nullcheck) {
+		    npix = fits_noise_goodpix_float(rowpix, nx, nullvalue, goodpix);
+		    rowpix = goodpix;
+		} else {
+		    npix = nx;
 		}
-				
-		/* find the 7th valid pixel in row (to be skipped) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
 
-		if (ii == nx) continue;  /* hit end of row */
-		v7 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
+		if (do_range)
+		    fits_noise_range_float(rowpix, npix, &xminval, &xmaxval);
 
-		if (do_range) {
-			if (v7 < xminval) xminval = v7;
-			if (v7 > xmaxval) xmaxval = v7;
-		}
-				
-		/* find the 8th valid pixel in row (to be skipped) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
+		/* every valid pixel is counted, whether or not it lies
+		   in a constant background region */
+		ngoodpix += npix;
 
-		if (ii == nx) continue;  /* hit end of row */
-		v8 = rowpix[ii];  /* store the good pixel value */
-		ngoodpix++;
+		if (npix < 9) continue;  /* too few pixels for the differences */
 
-		if (do_range) {
-			if (v8 < xminval) xminval = v8;
-			if (v8 > xmaxval) xmaxval = v8;
-		}
 		/* now populate the differences arrays */
-		/* for the remaining pixels in the row */
-		nvals = 0;
-		nvals2 = 0;
-		for (ii++; ii < nx; ii++) {
-
-		    /* find the next valid pixel in row */
-                    if (nullcheck)
-		        while (ii < nx && rowpix[ii] == nullvalue) ii++;
-		     
-		    if (ii == nx) break;  /* hit end of row */
-		    v9 = rowpix[ii];  /* store the good pixel value */
-
-		    if (do_range) {
-			if (v9 < xminval) xminval = v9;
-			if (v9 > xmaxval) xmaxval = v9;
-		    }
-
-		    /* construct array of absolute differences */
-
-		    if (!(v5 == v6 && v6 == v7) ) {
-		        differences2[nvals2] = (float) fabs(v5 - v7);
-			nvals2++;
-		    }
-
-		    if (!(v3 == v4 && v4 == v5 && v5 == v6 && v6 == v7) ) {
-		        differences3[nvals] = (float) fabs((2 * v5) - v3 - v7);
-		        differences5[nvals] = (float) fabs((6 * v5) - (4 * v3) - (4 * v7) + v1 + v9);
-		        nvals++;  
-		    } else {
-		        /* ignore constant background regions */
-			ngoodpix++;
-		    }
-
-		    /* shift over 1 pixel */
-		    v1 = v2;
-		    v2 = v3;
-		    v3 = v4;
-		    v4 = v5;
-		    v5 = v6;
-		    v6 = v7;
-		    v7 = v8;
-		    v8 = v9;
-	        }  /* end of loop over pixels in the row */
+		fits_noise5_diffs_float(rowpix, npix, differences2, differences3,
+		    differences5, &nvals2, &nvals);
 
 		/* compute the median diffs */
-		/* Note that there are 8 more pixel values than there are diffs values. */
-		ngoodpix += nvals;
-
 		if (nvals == 0) {
 		    continue;  /* cannot compute medians on this row */
 		} else if (nvals == 1) {
@@ -1863,7 +2101,7 @@ row of the image.
 		        diffs2[nrows2] = differences2[0];
 			nrows2++;
 		    }
-		        
+
 		    diffs3[nrows] = differences3[0];
 		    diffs5[nrows] = differences5[0];
 		} else {
@@ -1873,8 +2111,8 @@ row of the image.
 			nrows2++;
 		    }
 
-                    diffs3[nrows] = quick_select_float(differences3, nvals);
-                    diffs5[nrows] = quick_select_float(differences5, nvals);
+                    diffs3[nrows] = fits_select_float(differences3, nvals, work);
+                    diffs5[nrows] = fits_select_float(differences5, nvals, work);
 		}
 
 		nrows++;
@@ -1910,13 +2148,6 @@ row of the image.
 	if (noise3)  *noise3  = 0.6052697 * xnoise3;
 	if (noise5)  *noise5  = 0.1772048 * xnoise5;
 
-	free(diffs5);
-	free(diffs3);
-	free(diffs2);
-	free(differences5);
-	free(differences3);
-	free(differences2);
-
 	return(*status);
 }
 /*--------------------------------------------------------------------------*/
@@ -2726,8 +2957,8 @@ The returned estimates are the median of the values that are computed for each
 row of the image.
 */
 {
-	long ii, jj, nrows = 0, nvals, ngoodpix = 0;
-	float *differences, *rowpix, v1, v2, v3, v4, v5;
+	long ii, jj, nrows = 0, nvals, ngoodpix = 0, npix;
+	float *differences, *goodpix, *work, *rowpix;
 	float xminval = FLT_MAX, xmaxval = -FLT_MAX;
 	int do_range = 0;
 	double *diffs, xnoise = 0;
@@ -2759,133 +2990,49 @@ row of the image.
 
 	/* do we need to compute the min and max value? */
 	if (minval || maxval) do_range = 1;
-	
-        /* allocate arrays used to compute the median and noise estimates */
-	if (noise) {
-	    differences = calloc(nx, sizeof(float));
-	    if (!differences) {
-        	*status = MEMORY_ALLOCATION;
-		return(*status);
-	    }
 
-	    diffs = calloc(ny, sizeof(double));
-	    if (!diffs) {
-		free(differences);
+        /* get the arrays used to compute the median and noise estimates */
+	diffs = (double *) fits_quantize_scratch(ny * sizeof(double) +
+	    3 * nx * sizeof(float));
+	if (!diffs) {
         	*status = MEMORY_ALLOCATION;
 		return(*status);
-	    }
 	}
+	differences = (float *) (diffs + ny);
+	goodpix = differences + nx;
+	work = goodpix + nx;
 
 	/* loop over each row of the image */
 	for (jj=0; jj < ny; jj++) {
 
                 rowpix = array + (jj * nx); /* point to first pixel in the row */
 
-		/***** find the first valid pixel in row */
-		ii = 0;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v1 = rowpix[ii];  /* store the good pixel value */
-
-		if (do_range) {
-			if (v1 < xminval) xminval = v1;
-			if (v1 > xmaxval) xmaxval = v1;
-		}
-
-		/***** find the 2nd valid pixel in row (which we will skip over) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v2 = rowpix[ii];  /* store the good pixel value */
-		
-		if (do_range) {
-			if (v2 < xminval) xminval = v2;
-			if (v2 > xmaxval) xmaxval = v2;
-		}
-
-		/***** find the 3rd valid pixel in row */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v3 = rowpix[ii];  /* store the good pixel value */
-
-		if (do_range) {
-			if (v3 < xminval) xminval = v3;
-			if (v3 > xmaxval) xmaxval = v3;
-		}
-				
-		/* find the 4nd valid pixel in row (to be skipped) */
-		ii++;
-		if (nullcheck)
-		    while (ii < nx && rowpix[ii] == nullvalue) ii++;
-
-		if (ii == nx) continue;  /* hit end of row */
-		v4 = rowpix[ii];  /* store the good pixel value */
-
-		if (do_range) {
-			if (v4 < xminval) xminval = v4;
-			if (v4 > xmaxval) xmaxval = v4;
+		/* gather the valid pixels of the row */
+		if (nullcheck) {
+		    npix = fits_noise_goodpix_float(rowpix, nx, nullvalue, goodpix);
+		    rowpix = goodpix;
+		} else {
+		    npix = nx;
 		}
-		
-		/* now populate the differences arrays */
-		/* for the remaining pixels in the row */
-		nvals = 0;
-		for (ii++; ii < nx; ii++) {
 
-		    /* find the next valid pixel in row */
-                    if (nullcheck)
-		        while (ii < nx && rowpix[ii] == nullvalue) {
-			  ii++;
-		        }
-			
-		    if (ii == nx) break;  /* hit end of row */
-		    v5 = rowpix[ii];  /* store the good pixel value */
+		if (do_range)
+		    fits_noise_range_float(rowpix, npix, &xminval, &xmaxval);
 
-		    if (do_range) {
-			if (v5 < xminval) xminval = v5;
-			if (v5 > xmaxval) xmaxval = v5;
-		    }
-
-		    /* construct array of 3rd order absolute differences */
-		    if (noise) {
-		        if (!(v1 == v2 && v2 == v3 && v3 == v4 && v4 == v5)) {
-
-		            differences[nvals] = (float) fabs((2. * v3) - v1 - v5);
-		            nvals++;  
-		       } else {
-		            /* ignore constant background regions */
-			    ngoodpix++;
-		       }
-		    } else {
-		       /* just increment the number of non-null pixels */
-		       ngoodpix++;
-		    }
-
-		    /* shift over 1 pixel */
-		    v1 = v2;
-		    v2 = v3;
-		    v3 = v4;
-		    v4 = v5;
-	        }  /* end of loop over pixels in the row */
+		/* rows with fewer than 4 valid pixels are not counted */
+		if (npix < 4) continue;
+		ngoodpix += npix;
 
 		/* compute the 3rd order diffs */
-		/* Note that there are 4 more pixel values than there are diffs values. */
-		ngoodpix += (nvals + 4);
-
 		if (noise) {
+		    fits_noise3_diffs_float(rowpix, npix, differences, &nvals);
+
 		    if (nvals == 0) {
 		        continue;  /* cannot compute medians on this row */
 		    } else if (nvals == 1) {
 		        diffs[nrows] = differences[0];
 		    } else {
                         /* quick_select returns the median MUCH faster than using qsort */
-                        diffs[nrows] = quick_select_float(differences, nvals);
+                        diffs[nrows] = fits_select_float(differences, nvals, work);
 		    }
 		}
 		nrows++;
@@ -2908,8 +3055,6 @@ row of the image.
 	if (maxval) *maxval = xmaxval;
 	if (noise) {
 		*noise  = 0.6052697 * xnoise;
-		free(diffs);
-		free(differences);
 	}
 
 	return(*status);
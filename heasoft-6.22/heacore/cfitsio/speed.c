@@ -8,24 +8,32 @@
   Every program which uses the CFITSIO interface must include the
   the fitsio.h header file.  This contains the prototypes for all
   the routines and defines the error status values and other symbolic
-  constants used in the interface.  
+  constants used in the interface.
 */
 #include "fitsio.h"
 
+/*
+  This program measures the speed of writing and reading FITS files with
+  CFITSIO.  Each benchmark is run a configurable number of times and the
+  minimum, mean and maximum elapsed times are reported, either as a text
+  table or in JSON or CSV format so that results can be compared between
+  CFITSIO versions, driver options and storage systems.  Run 'speed -h'
+  for the list of options and benchmark groups.
+*/
+
 #define minvalue(A,B) ((A) < (B) ? (A) : (B))
 
-/* size of the image */
+/* default size of the image */
 #define XSIZE 3000
 #define YSIZE 3000
 
-/* size of data buffer */
+/* default number of pixels or rows transferred per call */
 #define SHTSIZE 20000
-static long sarray[ SHTSIZE ] = {SHTSIZE * 0};
 
-/* no. of rows in binary table */
+/* default no. of rows in binary table */
 #define BROWS 2500000
 
-/* no. of rows in ASCII table */
+/* default no. of rows in ASCII table */
 #define AROWS 400000
 
 /*  CLOCKS_PER_SEC should be defined by most compilers */
@@ -34,476 +42,1087 @@ static long sarray[ SHTSIZE ] = {SHTSIZE * 0};
 #else
 /* on SUN OS machine, CLOCKS_PER_SEC is not defined, so set its value */
 #define CLOCKTICKS 1000000
-#define difftime(A,B) ((double) A - (double) B)
 #endif
 
-/* define variables for measuring elapsed time */
-clock_t scpu, ecpu;
-time_t start, finish;
-long startsec;   /* start of elapsed time interval */
-int startmilli;  /* start of elapsed time interval */
-
-int writeimage(fitsfile *fptr, int *status);
-int writebintable(fitsfile *fptr, int *status);
-int writeasctable(fitsfile *fptr, int *status);
-int readimage(fitsfile *fptr, int *status);
-int readatable(fitsfile *fptr, int *status);
-int readbtable(fitsfile *fptr, int *status);
+#define FMT_TEXT 0
+#define FMT_JSON 1
+#define FMT_CSV  2
+
+#define MAXRESULTS 64
+
+typedef struct
+{
+    long nx, ny;          /* image dimensions                               */
+    long brows;           /* number of rows in the binary table             */
+    long arows;           /* number of rows in the ASCII table              */
+    long chunk;           /* pixels or rows transferred per CFITSIO call    */
+    long stride;          /* pixel increment for strided subimage reads     */
+    int  repeat;          /* number of times each benchmark is run          */
+    int  format;          /* FMT_TEXT, FMT_JSON or FMT_CSV                  */
+    int  keep;            /* if true, do not delete the test files          */
+    char groups[FLEN_FILENAME]; /* comma-separated groups to run; "" = all  */
+    char root[FLEN_FILENAME];   /* root name of the test files              */
+} speedOpts;
+
+typedef struct
+{
+    char group[16];
+    char name[32];
+    double bytes;         /* bytes transferred by one run                   */
+    int nrun;
+    double tmin, tmax, tsum;  /* elapsed times, in seconds                  */
+    double cpusum;        /* CPU time, in seconds                           */
+} speedResult;
+
+/* a benchmark performs one run and returns the number of bytes processed */
+typedef int (*speedFunc)(speedOpts *opts, int arg, double *nbytes,
+                         int *status);
+
+static speedResult results[MAXRESULTS];
+static int nresults = 0;
+
+/* the data types exercised by the image and table benchmarks */
+static int   ntypes = 5;
+static int   types[]    = {TBYTE, TSHORT, TINT, TFLOAT, TDOUBLE};
+static int   bitpixes[] = {BYTE_IMG, SHORT_IMG, LONG_IMG, FLOAT_IMG,
+                           DOUBLE_IMG};
+static int   typesizes[] = {1, 2, 4, 4, 8};
+static char *typenames[] = {"byte", "short", "int", "float", "double"};
+static char *tblforms[]  = {"1B", "1I", "1J", "1E", "1D"};
+static char *tblnames[]  = {"C_B", "C_I", "C_J", "C_E", "C_D"};
+
+/* the tile-compression algorithms exercised by the compress benchmarks */
+static int   ncodecs = 5;
+static int   codecs[] = {RICE_1, GZIP_1, GZIP_2, HCOMPRESS_1, PLIO_1};
+static char *codecnames[] = {"rice", "gzip1", "gzip2", "hcompress", "plio"};
+
+static int parseopts(int argc, char *argv[], speedOpts *opts);
+static void usage(void);
+static int wantgroup(speedOpts *opts, char *group);
+static void runbench(speedOpts *opts, char *group, char *name,
+                     speedFunc func, int arg);
+static void printresult(speedOpts *opts, speedResult *res);
+static void printsummary(speedOpts *opts);
+static void filename(speedOpts *opts, char *kind, char *suffix, char *ext,
+                     char *name);
+static void fillbuffer(int type, void *buffer, long n, long offset);
+static double wallclock(void);
+
+static int rawwrite(speedOpts *opts, int arg, double *nbytes, int *status);
+static int rawread(speedOpts *opts, int arg, double *nbytes, int *status);
+static int writeimage(speedOpts *opts, int itype, double *nbytes,
+                      int *status);
+static int readimage(speedOpts *opts, int itype, double *nbytes,
+                     int *status);
+static int readsubset(speedOpts *opts, int arg, double *nbytes,
+                      int *status);
+static int writebintable(speedOpts *opts, int arg, double *nbytes,
+                         int *status);
+static int readbincol(speedOpts *opts, int itype, double *nbytes,
+                      int *status);
+static int readbtable(speedOpts *opts, int arg, double *nbytes, int *status);
+static int writeasctable(speedOpts *opts, int arg, double *nbytes,
+                         int *status);
+static int readatable(speedOpts *opts, int arg, double *nbytes, int *status);
+static int writecompressed(speedOpts *opts, int icodec, double *nbytes,
+                           int *status);
+static int readcompressed(speedOpts *opts, int icodec, double *nbytes,
+                          int *status);
+static int filterrows(speedOpts *opts, int arg, double *nbytes,
+                      int *status);
+static int makehist(speedOpts *opts, int arg, double *nbytes, int *status);
+static int checksum(speedOpts *opts, int arg, double *nbytes, int *status);
+static void removefiles(speedOpts *opts);
 void printerror( int status);
-int marktime(int *status);
-int gettime(double *elapse, float *elapscpu, int *status);
-int main(void);
+int main(int argc, char *argv[]);
 
-int main()
+int main(int argc, char *argv[])
 {
 /*************************************************************************
     This program tests the speed of writing/reading FITS files with cfitsio
 **************************************************************************/
 
-    FILE *diskfile;
-    fitsfile *fptr;        /* pointer to the FITS file, defined in fitsio.h */
-    int status, ii;
-    long rawloop;
-    char filename[] = "speedcc.fit";           /* name for new FITS file */
-    char buffer[2880] = {2880 * 0};
-    time_t tbegin, tend;
-    float rate, size, elapcpu, cpufrac;
-    double elapse;
+    speedOpts opts;
+    char name[32];
+    int ii;
 
-    tbegin = time(0);
+    if (parseopts(argc, argv, &opts))
+        return(1);
 
-    remove(filename);               /* Delete old file if it already exists */
+    if (opts.format == FMT_TEXT)
+        printf("%-36s SIZE / ELAPSE(%%CPU) =     RATE\n", "");
+    else if (opts.format == FMT_CSV)
+        printf("group,name,bytes,runs,min_s,mean_s,max_s,cpu_s,mb_per_s\n");
 
-    diskfile =  fopen(filename,"w+b");
-    rawloop = XSIZE * YSIZE / 720;
+    if (wantgroup(&opts, "raw"))
+    {
+        runbench(&opts, "raw", "fwrite_2880", rawwrite, 0);
+        runbench(&opts, "raw", "fread_2880", rawread, 0);
+    }
 
-    printf("                                                ");
-    printf(" SIZE / ELAPSE(%%CPU) = RATE\n");
-    printf("RAW fwrite (2880 bytes/loop)...                 ");
-    marktime(&status);
+    if (wantgroup(&opts, "image"))
+    {
+        for (ii = 0; ii < ntypes; ii++)
+        {
+            sprintf(name, "write_%s", typenames[ii]);
+            runbench(&opts, "image", name, writeimage, ii);
+            sprintf(name, "read_%s", typenames[ii]);
+            runbench(&opts, "image", name, readimage, ii);
+        }
+        runbench(&opts, "image", "read_subset_strided", readsubset, 0);
+    }
 
-    for (ii = 0; ii < rawloop; ii++)
-      if (fwrite(buffer, 1, 2880, diskfile) != 2880)
-        printf("write error \n");
+    /* the filter, histogram and column benchmarks need the binary table */
+    if (wantgroup(&opts, "table") || wantgroup(&opts, "filter") ||
+        wantgroup(&opts, "histogram"))
+    {
+        runbench(&opts, "table", "write_bintable", writebintable, 0);
+    }
 
-    gettime(&elapse, &elapcpu, &status);
+    if (wantgroup(&opts, "table"))
+    {
+        runbench(&opts, "table", "read_bintable", readbtable, 0);
+        for (ii = 0; ii < ntypes; ii++)
+        {
+            sprintf(name, "read_col_%s", typenames[ii]);
+            runbench(&opts, "table", name, readbincol, ii);
+        }
+        runbench(&opts, "table", "write_asctable", writeasctable, 0);
+        runbench(&opts, "table", "read_asctable", readatable, 0);
+    }
 
-    cpufrac = elapcpu / elapse * 100.;
-    size = 2880. * rawloop / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    if (wantgroup(&opts, "compress"))
+    {
+        for (ii = 0; ii < ncodecs; ii++)
+        {
+            sprintf(name, "write_%s", codecnames[ii]);
+            runbench(&opts, "compress", name, writecompressed, ii);
+            sprintf(name, "read_%s", codecnames[ii]);
+            runbench(&opts, "compress", name, readcompressed, ii);
+        }
+    }
 
-    /* read back the binary records */
-    fseek(diskfile, 0, 0);
+    if (wantgroup(&opts, "filter"))
+        runbench(&opts, "filter", "find_rows", filterrows, 0);
 
-    printf("RAW fread  (2880 bytes/loop)...                 ");
-    marktime(&status);
+    if (wantgroup(&opts, "histogram"))
+        runbench(&opts, "histogram", "bin_2d", makehist, 0);
 
-    for (ii = 0; ii < rawloop; ii++)
-      if (fread(buffer, 1, 2880, diskfile) != 2880)
-        printf("read error \n");
+    if (wantgroup(&opts, "checksum"))
+    {
+        /* checksum the int image; write it first if the image */
+        /* group was not run */
+        if (!wantgroup(&opts, "image"))
+            runbench(&opts, "image", "write_int", writeimage, 2);
+        runbench(&opts, "checksum", "write_verify", checksum, 0);
+    }
 
-    gettime(&elapse, &elapcpu, &status);
+    printsummary(&opts);
 
-    cpufrac = elapcpu / elapse * 100.;
-    size = 2880. * rawloop / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    if (!opts.keep)
+        removefiles(&opts);
 
-    fclose(diskfile);
-    remove(filename);
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static int parseopts(int argc, char *argv[], speedOpts *opts)
+{
+    int ii;
+
+    opts->nx = XSIZE;
+    opts->ny = YSIZE;
+    opts->brows = BROWS;
+    opts->arows = AROWS;
+    opts->chunk = SHTSIZE;
+    opts->stride = 4;
+    opts->repeat = 1;
+    opts->format = FMT_TEXT;
+    opts->keep = 0;
+    opts->groups[0] = '\0';
+    strcpy(opts->root, "speedcc");
+
+    for (ii = 1; ii < argc; ii++)
+    {
+        if (!strcmp(argv[ii], "-h"))
+        {
+            usage();
+            exit(0);
+        }
+        else if (!strcmp(argv[ii], "-k"))
+        {
+            opts->keep = 1;
+            continue;
+        }
+
+        if (ii + 1 >= argc || argv[ii][0] != '-' || strlen(argv[ii]) != 2)
+        {
+            usage();
+            return(1);
+        }
+
+        switch (argv[ii][1])
+        {
+          case 'x': opts->nx = atol(argv[++ii]); break;
+          case 'y': opts->ny = atol(argv[++ii]); break;
+          case 'b': opts->brows = atol(argv[++ii]); break;
+          case 'a': opts->arows = atol(argv[++ii]); break;
+          case 'c': opts->chunk = atol(argv[++ii]); break;
+          case 's': opts->stride = atol(argv[++ii]); break;
+          case 'r': opts->repeat = atoi(argv[++ii]); break;
+          case 'g':
+            strncat(opts->groups, argv[++ii], FLEN_FILENAME - 1);
+            break;
+          case 'f':
+            opts->root[0] = '\0';
+            strncat(opts->root, argv[++ii], FLEN_FILENAME - 32);
+            break;
+          case 'o':
+            ii++;
+            if (!strcmp(argv[ii], "text"))
+                opts->format = FMT_TEXT;
+            else if (!strcmp(argv[ii], "json"))
+                opts->format = FMT_JSON;
+            else if (!strcmp(argv[ii], "csv"))
+                opts->format = FMT_CSV;
+            else
+            {
+                usage();
+                return(1);
+            }
+            break;
+          default:
+            usage();
+            return(1);
+        }
+    }
 
-    status = 0;     
-    fptr = 0;
+    if (opts->nx < 1 || opts->ny < 1 || opts->brows < 1 || opts->arows < 1 ||
+        opts->chunk < 1 || opts->stride < 1 || opts->repeat < 1)
+    {
+        fprintf(stderr, "speed: sizes, chunk, stride and repeat must be > 0\n");
+        return(1);
+    }
 
-    if (fits_create_file(&fptr, filename, &status)) /* create new FITS file */
-       printerror( status);          
-   
-    if (writeimage(fptr, &status))
-       printerror( status);     
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static void usage(void)
+{
+    printf("Usage: speed [options]\n");
+    printf("  -x nx      image width           (default %d)\n", XSIZE);
+    printf("  -y ny      image height          (default %d)\n", YSIZE);
+    printf("  -b nrows   binary table rows     (default %d)\n", BROWS);
+    printf("  -a nrows   ASCII table rows      (default %d)\n", AROWS);
+    printf("  -c n       pixels/rows per call  (default %d)\n", SHTSIZE);
+    printf("  -s n       subimage read stride  (default 4)\n");
+    printf("  -r n       runs per benchmark    (default 1)\n");
+    printf("  -g list    comma-separated benchmark groups to run:\n");
+    printf("             raw,image,table,compress,filter,histogram,checksum\n");
+    printf("             (default all)\n");
+    printf("  -f root    root name of the test files, which may include\n");
+    printf("             a directory on the storage to test (default speedcc)\n");
+    printf("  -o format  text, json or csv     (default text)\n");
+    printf("  -k         keep the test files\n");
+}
+/*--------------------------------------------------------------------------*/
+static int wantgroup(speedOpts *opts, char *group)
+{
+    char *ptr;
+    size_t len = strlen(group);
 
-    if (writebintable(fptr, &status))
-       printerror( status);     
+    if (!opts->groups[0])
+        return(1);
 
-    if (writeasctable(fptr, &status))
-       printerror( status);     
+    for (ptr = opts->groups; (ptr = strstr(ptr, group)) != NULL; ptr += len)
+    {
+        if ((ptr == opts->groups || *(ptr - 1) == ',') &&
+            (ptr[len] == '\0' || ptr[len] == ','))
+            return(1);
+    }
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static void runbench(speedOpts *opts, char *group, char *name,
+                     speedFunc func, int arg)
+/*
+   run one benchmark opts->repeat times, recording the elapsed times
+*/
+{
+    speedResult *res;
+    double tstart, elapse, nbytes = 0.;
+    clock_t cstart;
+    int ii, status = 0;
 
-    if (readimage(fptr, &status))
-       printerror( status);     
+    if (nresults == MAXRESULTS)
+    {
+        fprintf(stderr, "speed: too many benchmarks\n");
+        return;
+    }
 
-    if (readbtable(fptr, &status))
-       printerror( status);     
+    res = &results[nresults++];
+    strcpy(res->group, group);
+    strcpy(res->name, name);
+    res->nrun = 0;
+    res->tsum = 0.;
+    res->cpusum = 0.;
 
-    if (readatable(fptr, &status))
-       printerror( status);     
+    for (ii = 0; ii < opts->repeat; ii++)
+    {
+        cstart = clock();
+        tstart = wallclock();
 
-    if (fits_close_file(fptr, &status))     
-         printerror( status );
+        if ((*func)(opts, arg, &nbytes, &status))
+            printerror(status);
 
-    tend = time(0);
-    elapse = difftime(tend, tbegin) + 0.5;
-    printf("Total elapsed time = %.3fs, status = %d\n",elapse, status);
-    return(0);
+        elapse = wallclock() - tstart;
+        res->cpusum += (double) (clock() - cstart) / CLOCKTICKS;
+
+        if (ii == 0 || elapse < res->tmin)
+            res->tmin = elapse;
+        if (ii == 0 || elapse > res->tmax)
+            res->tmax = elapse;
+        res->tsum += elapse;
+        res->nrun++;
+    }
+
+    res->bytes = nbytes;
+
+    if (opts->format != FMT_JSON)
+        printresult(opts, res);
 }
 /*--------------------------------------------------------------------------*/
-int writeimage(fitsfile *fptr, int *status)
+static void printresult(speedOpts *opts, speedResult *res)
+{
+    double mean, cpufrac, rate;
+    char label[64];
+
+    mean = res->tsum / res->nrun;
+    cpufrac = (res->tsum > 0.) ? res->cpusum / res->tsum * 100. : 0.;
+    rate = (mean > 0.) ? res->bytes / 1000000. / mean : 0.;
+
+    if (opts->format == FMT_CSV)
+    {
+        printf("%s,%s,%.0f,%d,%.6f,%.6f,%.6f,%.6f,%.3f\n", res->group,
+               res->name, res->bytes, res->nrun, res->tmin, mean, res->tmax,
+               res->cpusum / res->nrun, rate);
+    }
+    else
+    {
+        sprintf(label, "%s %s", res->group, res->name);
+        printf("%-36s %7.1fMB/%7.3fs(%3.0f) = %7.2fMB/s\n", label,
+               res->bytes / 1000000., mean, cpufrac, rate);
+    }
+}
+/*--------------------------------------------------------------------------*/
+static void printsummary(speedOpts *opts)
+{
+    speedResult *res;
+    float version;
+    double mean;
+    int ii;
+
+    if (opts->format != FMT_JSON)
+        return;
+
+    fits_get_version(&version);
+
+    printf("{\n");
+    printf("  \"cfitsio_version\": %.2f,\n", version);
+    printf("  \"reentrant\": %s,\n", fits_is_reentrant() ? "true" : "false");
+    printf("  \"options\": {\"nx\": %ld, \"ny\": %ld, \"brows\": %ld, "
+           "\"arows\": %ld, \"chunk\": %ld, \"stride\": %ld, "
+           "\"repeat\": %d, \"root\": \"%s\"},\n", opts->nx, opts->ny,
+           opts->brows, opts->arows, opts->chunk, opts->stride,
+           opts->repeat, opts->root);
+    printf("  \"results\": [\n");
+
+    for (ii = 0; ii < nresults; ii++)
+    {
+        res = &results[ii];
+        mean = res->tsum / res->nrun;
+        printf("    {\"group\": \"%s\", \"name\": \"%s\", \"bytes\": %.0f, "
+               "\"runs\": %d, \"min_s\": %.6f, \"mean_s\": %.6f, "
+               "\"max_s\": %.6f, \"cpu_s\": %.6f, \"mb_per_s\": %.3f}%s\n",
+               res->group, res->name, res->bytes, res->nrun, res->tmin,
+               mean, res->tmax, res->cpusum / res->nrun,
+               (mean > 0.) ? res->bytes / 1000000. / mean : 0.,
+               (ii < nresults - 1) ? "," : "");
+    }
+
+    printf("  ]\n}\n");
+}
+/*--------------------------------------------------------------------------*/
+static void filename(speedOpts *opts, char *kind, char *suffix, char *ext,
+                     char *name)
+/*
+   construct the name of a test file, e.g. speedcc_img_float.fit, followed
+   by the extended file name syntax in ext if it is not NULL.  name is a
+   FLEN_FILENAME buffer, or one character into it when the caller prefixes
+   a '!', so at most FLEN_FILENAME - 1 characters are written.
+*/
+{
+    int len;
+
+    if (!ext)
+        ext = "";
+
+    if (suffix && *suffix)
+        len = snprintf(name, FLEN_FILENAME - 1, "%s_%s_%s.fit%s", opts->root,
+                       kind, suffix, ext);
+    else
+        len = snprintf(name, FLEN_FILENAME - 1, "%s_%s.fit%s", opts->root,
+                       kind, ext);
+
+    if (len < 0 || len >= FLEN_FILENAME - 1)
+    {
+        fprintf(stderr, "speed: test file name for %s is too long\n", opts->root);
+        exit(1);
+    }
+}
+/*--------------------------------------------------------------------------*/
+static void fillbuffer(int itype, void *buffer, long n, long offset)
+/*
+   fill a buffer with a deterministic ramp of values of the given type
+*/
+{
+    long ii;
+
+    for (ii = 0; ii < n; ii++)
+    {
+        long val = (offset + ii) % 1000;
+
+        switch (types[itype])
+        {
+          case TBYTE:   ((unsigned char *) buffer)[ii] = (unsigned char) val;
+                        break;
+          case TSHORT:  ((short *) buffer)[ii] = (short) val; break;
+          case TINT:    ((int *) buffer)[ii] = (int) val; break;
+          case TFLOAT:  ((float *) buffer)[ii] = (float) val * 0.5f; break;
+          case TDOUBLE: ((double *) buffer)[ii] = (double) val * 0.25; break;
+        }
+    }
+}
+/*--------------------------------------------------------------------------*/
+static double wallclock(void)
+{
+    struct  timeval tv;
+
+    gettimeofday (&tv, NULL);
+    return(tv.tv_sec + tv.tv_usec / 1000000.);
+}
+/*--------------------------------------------------------------------------*/
+static int rawwrite(speedOpts *opts, int arg, double *nbytes, int *status)
+
+    /***************************************************/
+    /* write 2880-byte records with fwrite, for reference */
+    /***************************************************/
+{
+    FILE *diskfile;
+    char buffer[2880], name[FLEN_FILENAME];
+    long ii, rawloop;
+
+    filename(opts, "raw", NULL, NULL, name);
+    rawloop = opts->nx * opts->ny / 720;
+    memset(buffer, 0, 2880);
+
+    diskfile = fopen(name, "w+b");
+    if (!diskfile)
+        return(*status = FILE_NOT_CREATED);
+
+    for (ii = 0; ii < rawloop; ii++)
+      if (fwrite(buffer, 1, 2880, diskfile) != 2880)
+        *status = WRITE_ERROR;
+
+    fclose(diskfile);
+
+    *nbytes = 2880. * rawloop;
+    return(*status);
+}
+/*--------------------------------------------------------------------------*/
+static int rawread(speedOpts *opts, int arg, double *nbytes, int *status)
+
+    /*************************************************/
+    /* read 2880-byte records with fread, for reference */
+    /*************************************************/
+{
+    FILE *diskfile;
+    char buffer[2880], name[FLEN_FILENAME];
+    long ii, rawloop;
+
+    filename(opts, "raw", NULL, NULL, name);
+    rawloop = opts->nx * opts->ny / 720;
+
+    diskfile = fopen(name, "rb");
+    if (!diskfile)
+        return(*status = FILE_NOT_OPENED);
+
+    for (ii = 0; ii < rawloop; ii++)
+      if (fread(buffer, 1, 2880, diskfile) != 2880)
+        *status = READ_ERROR;
+
+    fclose(diskfile);
+
+    *nbytes = 2880. * rawloop;
+    return(*status);
+}
+/*--------------------------------------------------------------------------*/
+static int writeimage(speedOpts *opts, int itype, double *nbytes,
+                      int *status)
 
     /**************************************************/
     /* write the primary array containing a 2-D image */
     /**************************************************/
 {
-    long  nremain, ii;
-    float rate, size, elapcpu, cpufrac;
-    double elapse;
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long naxes[2], npix, ii, ntodo;
+    void *buffer;
+
+    naxes[0] = opts->nx;
+    naxes[1] = opts->ny;
+    npix = opts->nx * opts->ny;
 
-    /* initialize FITS image parameters */
-    int bitpix   =  32;   /* 32-bit  signed integer pixel values       */
-    long naxis    =   2;  /* 2-dimensional image                            */    
-    long naxes[2] = {XSIZE, YSIZE }; /* image size */
+    buffer = malloc(opts->chunk * typesizes[itype]);
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
+    fillbuffer(itype, buffer, opts->chunk, 0);
 
-    /* write the required keywords for the primary array image */
-    if ( fits_create_img(fptr, bitpix, naxis, naxes, status) )
-         printerror( *status );          
+    name[0] = '!';
+    filename(opts, "img", typenames[itype], NULL, name + 1);
 
-    printf("\nWrite %dx%d I*4 image, %d pixels/loop:   ",XSIZE,YSIZE,SHTSIZE);
-    marktime(status);
+    fits_create_file(&fptr, name, status);
+    fits_create_img(fptr, bitpixes[itype], 2, naxes, status);
 
-    nremain = XSIZE * YSIZE;
-    for (ii = 1; ii <= nremain; ii += SHTSIZE)
+    for (ii = 1; ii <= npix && *status <= 0; ii += opts->chunk)
     {
-      ffpprj(fptr, 0, ii, SHTSIZE, sarray, status);
+        ntodo = minvalue(opts->chunk, npix - ii + 1);
+        fits_write_img(fptr, types[itype], ii, ntodo, buffer, status);
     }
 
-    ffflus(fptr, status);  /* flush all buffers to disk */
+    fits_close_file(fptr, status);
+    free(buffer);
+
+    *nbytes = (double) npix * typesizes[itype];
+    return( *status );
+}
+/*--------------------------------------------------------------------------*/
+static int readimage(speedOpts *opts, int itype, double *nbytes, int *status)
+
+    /*********************/
+    /* Read a FITS image */
+    /*********************/
+{
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long npix, ii, ntodo;
+    int anynull;
+    void *buffer;
+
+    npix = opts->nx * opts->ny;
+
+    buffer = malloc(opts->chunk * typesizes[itype]);
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
+
+    filename(opts, "img", typenames[itype], NULL, name);
 
-    gettime(&elapse, &elapcpu, status);
+    fits_open_file(&fptr, name, READONLY, status);
 
-    cpufrac = elapcpu / elapse * 100.;
-    size = XSIZE * 4. * YSIZE / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    for (ii = 1; ii <= npix && *status <= 0; ii += opts->chunk)
+    {
+        ntodo = minvalue(opts->chunk, npix - ii + 1);
+        fits_read_img(fptr, types[itype], ii, ntodo, NULL, buffer,
+                      &anynull, status);
+    }
+
+    fits_close_file(fptr, status);
+    free(buffer);
 
+    *nbytes = (double) npix * typesizes[itype];
     return( *status );
 }
 /*--------------------------------------------------------------------------*/
-int writebintable (fitsfile *fptr, int *status)
+static int readsubset(speedOpts *opts, int arg, double *nbytes, int *status)
 
     /*********************************************************/
-    /* Create a binary table extension containing 3 columns  */
+    /* read a decimated copy of the float image, using the   */
+    /* stride in both axes (e.g. to make a preview)          */
     /*********************************************************/
 {
-    int tfields = 2;
-    long nremain, ntodo, firstrow = 1, firstelem = 1, nrows;
-    float rate, size, elapcpu, cpufrac;
-    double elapse;
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long fpixel[2], lpixel[2], inc[2], nout;
+    int anynull;
+    float *buffer;
+
+    fpixel[0] = fpixel[1] = 1;
+    lpixel[0] = opts->nx;
+    lpixel[1] = opts->ny;
+    inc[0] = inc[1] = opts->stride;
+    nout = ((opts->nx - 1) / opts->stride + 1) *
+           ((opts->ny - 1) / opts->stride + 1);
+
+    buffer = (float *) malloc(nout * sizeof(float));
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
+
+    filename(opts, "img", "float", NULL, name);
+
+    /* write the image first if the float image benchmark was skipped */
+    if (fits_open_file(&fptr, name, READONLY, status) == FILE_NOT_OPENED)
+    {
+        *status = 0;
+        fits_clear_errmsg();
+        writeimage(opts, 3, nbytes, status);
+        fits_open_file(&fptr, name, READONLY, status);
+    }
 
-    char extname[] = "Speed_Test";           /* extension name */
+    fits_read_subset(fptr, TFLOAT, fpixel, lpixel, inc, NULL, buffer,
+                     &anynull, status);
 
-    /* define the name, datatype, and physical units for the columns */
-    char *ttype[] = { "first", "second" };
-    char *tform[] = {"1J",       "1J"   };
-    char *tunit[] = { " ",       " "    };
+    fits_close_file(fptr, status);
+    free(buffer);
 
-    /* append a new empty binary table onto the FITS file */
+    *nbytes = (double) nout * sizeof(float);
+    return( *status );
+}
+/*--------------------------------------------------------------------------*/
+static int writebintable(speedOpts *opts, int arg, double *nbytes,
+                         int *status)
+
+    /******************************************************************/
+    /* Create a binary table extension with one column for each type */
+    /******************************************************************/
+{
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    char *tunit[] = {" ", " ", " ", " ", " "};
+    long nremain, ntodo, firstrow = 1, nrows;
+    void *buffers[5];
+    int ii, rowbytes = 0;
 
-    if ( fits_create_tbl( fptr, BINARY_TBL, BROWS, tfields, ttype, tform,
-                tunit, extname, status) )
-         printerror( *status );
+    name[0] = '!';
+    filename(opts, "tbl", NULL, NULL, name + 1);
+
+    fits_create_file(&fptr, name, status);
+    fits_create_img(fptr, SHORT_IMG, 0, NULL, status);
+    fits_create_tbl(fptr, BINARY_TBL, opts->brows, ntypes, tblnames,
+                    tblforms, tunit, "Speed_Test", status);
 
     /* get table row size and optimum number of rows to write per loop */
     fits_get_rowsize(fptr, &nrows, status);
-    nrows = minvalue(nrows, SHTSIZE);
-    nremain = BROWS;
+    nrows = minvalue(nrows, opts->chunk);
 
-    printf("Write %7drow x %dcol bintable %4ld rows/loop:", BROWS, tfields,
-       nrows);
-    marktime(status);
+    for (ii = 0; ii < ntypes; ii++)
+    {
+        buffers[ii] = malloc(nrows * typesizes[ii]);
+        if (!buffers[ii])
+            return(*status = MEMORY_ALLOCATION);
+        rowbytes += typesizes[ii];
+    }
 
-    while(nremain)
+    nremain = opts->brows;
+    while(nremain && *status <= 0)
     {
       ntodo = minvalue(nrows, nremain);
-      ffpclj(fptr, 1, firstrow, firstelem, ntodo, sarray, status);
-      ffpclj(fptr, 2, firstrow, firstelem, ntodo, sarray, status);
+      for (ii = 0; ii < ntypes; ii++)
+      {
+        fillbuffer(ii, buffers[ii], ntodo, firstrow - 1);
+        fits_write_col(fptr, types[ii], ii + 1, firstrow, 1, ntodo,
+                       buffers[ii], status);
+      }
       firstrow += ntodo;
       nremain -= ntodo;
     }
 
-    ffflus(fptr, status);  /* flush all buffers to disk */
+    fits_close_file(fptr, status);
+
+    for (ii = 0; ii < ntypes; ii++)
+        free(buffers[ii]);
 
-    gettime(&elapse, &elapcpu, status);
+    *nbytes = (double) opts->brows * rowbytes;
+    return( *status );
+}
+/*--------------------------------------------------------------------------*/
+static int readbtable(speedOpts *opts, int arg, double *nbytes, int *status)
+
+    /****************************************/
+    /* read back every column of the table  */
+    /****************************************/
+{
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long nremain, ntodo, firstrow = 1, nrows;
+    void *buffer;
+    int ii, anynull, rowbytes = 0;
+
+    filename(opts, "tbl", NULL, "[Speed_Test]", name);
+    fits_open_file(&fptr, name, READONLY, status);
+
+    fits_get_rowsize(fptr, &nrows, status);
+    nrows = minvalue(nrows, opts->chunk);
+
+    buffer = malloc(nrows * sizeof(double));
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
 
-    cpufrac = elapcpu / elapse * 100.;
-    size = BROWS * 8. / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    for (ii = 0; ii < ntypes; ii++)
+        rowbytes += typesizes[ii];
 
+    nremain = opts->brows;
+    while(nremain && *status <= 0)
+    {
+      ntodo = minvalue(nrows, nremain);
+      for (ii = 0; ii < ntypes; ii++)
+        fits_read_col(fptr, types[ii], ii + 1, firstrow, 1, ntodo, NULL,
+                      buffer, &anynull, status);
+      firstrow += ntodo;
+      nremain -= ntodo;
+    }
+
+    fits_close_file(fptr, status);
+    free(buffer);
+
+    *nbytes = (double) opts->brows * rowbytes;
     return( *status );
 }
 /*--------------------------------------------------------------------------*/
-int writeasctable (fitsfile *fptr, int *status)
+static int readbincol(speedOpts *opts, int itype, double *nbytes,
+                      int *status)
+
+    /***********************************************************/
+    /* read a single column; its values are strided by the row */
+    /* width of the table, so this measures strided access     */
+    /***********************************************************/
+{
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long nremain, ntodo, firstrow = 1;
+    void *buffer;
+    int anynull;
+
+    filename(opts, "tbl", NULL, "[Speed_Test]", name);
+    fits_open_file(&fptr, name, READONLY, status);
+
+    buffer = malloc(opts->chunk * typesizes[itype]);
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
+
+    nremain = opts->brows;
+    while(nremain && *status <= 0)
+    {
+      ntodo = minvalue(opts->chunk, nremain);
+      fits_read_col(fptr, types[itype], itype + 1, firstrow, 1, ntodo, NULL,
+                    buffer, &anynull, status);
+      firstrow += ntodo;
+      nremain -= ntodo;
+    }
+
+    fits_close_file(fptr, status);
+    free(buffer);
+
+    *nbytes = (double) opts->brows * typesizes[itype];
+    return( *status );
+}
+/*--------------------------------------------------------------------------*/
+static int writeasctable(speedOpts *opts, int arg, double *nbytes,
+                         int *status)
 
     /*********************************************************/
     /* Create an ASCII table extension containing 2 columns  */
     /*********************************************************/
 {
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
     int tfields = 2;
-    long nremain, ntodo, firstrow = 1, firstelem = 1;
-    long nrows;
-    float rate, size, elapcpu, cpufrac;
-    double elapse;
-
-    char extname[] = "Speed_Test";           /* extension name */
+    long nremain, ntodo, firstrow = 1, nrows;
+    int *buffer;
 
     /* define the name, datatype, and physical units for the columns */
     char *ttype[] = { "first", "second" };
     char *tform[] = {"I6",       "I6"   };
     char *tunit[] = { " ",      " "     };
 
-    /* append a new empty ASCII table onto the FITS file */
-    if ( fits_create_tbl( fptr, ASCII_TBL, AROWS, tfields, ttype, tform,
-                tunit, extname, status) )
-         printerror( *status );
+    name[0] = '!';
+    filename(opts, "asc", NULL, NULL, name + 1);
+
+    fits_create_file(&fptr, name, status);
+    fits_create_img(fptr, SHORT_IMG, 0, NULL, status);
+    fits_create_tbl(fptr, ASCII_TBL, opts->arows, tfields, ttype, tform,
+                    tunit, "Speed_Test", status);
 
     /* get table row size and optimum number of rows to write per loop */
     fits_get_rowsize(fptr, &nrows, status);
-    nrows = minvalue(nrows, SHTSIZE);
-    nremain = AROWS;
+    nrows = minvalue(nrows, opts->chunk);
 
-    printf("Write %7drow x %dcol asctable %4ld rows/loop:", AROWS, tfields,
-           nrows);
-    marktime(status);
+    buffer = (int *) malloc(nrows * sizeof(int));
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
 
-    while(nremain)
+    nremain = opts->arows;
+    while(nremain && *status <= 0)
     {
       ntodo = minvalue(nrows, nremain);
-      ffpclj(fptr, 1, firstrow, firstelem, ntodo, sarray, status);
-      ffpclj(fptr, 2, firstrow, firstelem, ntodo, sarray, status);
+      fillbuffer(2, buffer, ntodo, firstrow - 1);
+      fits_write_col(fptr, TINT, 1, firstrow, 1, ntodo, buffer, status);
+      fits_write_col(fptr, TINT, 2, firstrow, 1, ntodo, buffer, status);
       firstrow += ntodo;
       nremain -= ntodo;
     }
 
-    ffflus(fptr, status);  /* flush all buffers to disk */
-
-    gettime(&elapse, &elapcpu, status);
-
-    cpufrac = elapcpu / elapse * 100.;
-    size = AROWS * 13. / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    fits_close_file(fptr, status);
+    free(buffer);
 
+    *nbytes = opts->arows * 13.;
     return( *status );
 }
 /*--------------------------------------------------------------------------*/
-int readimage( fitsfile *fptr, int *status )
+static int readatable(speedOpts *opts, int arg, double *nbytes, int *status)
 
-    /*********************/
-    /* Read a FITS image */
-    /*********************/
+    /*************************************/
+    /* read back both ASCII table columns */
+    /*************************************/
 {
-    int anynull, hdutype;
-    long nremain, ii;
-    long longnull = 0;
-    float rate, size, elapcpu, cpufrac;
-    double elapse;
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long nremain, ntodo, firstrow = 1, nrows;
+    int *buffer, anynull;
+
+    filename(opts, "asc", NULL, "[Speed_Test]", name);
+    fits_open_file(&fptr, name, READONLY, status);
 
-    /* move to the primary array */
-    if ( fits_movabs_hdu(fptr, 1, &hdutype, status) ) 
-         printerror( *status );
+    fits_get_rowsize(fptr, &nrows, status);
+    nrows = minvalue(nrows, opts->chunk);
 
-    printf("\nRead back image                                 ");
-    marktime(status);
+    buffer = (int *) malloc(nrows * sizeof(int));
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
 
-    nremain = XSIZE * YSIZE;
-    for (ii=1; ii <= nremain; ii += SHTSIZE)
+    nremain = opts->arows;
+    while(nremain && *status <= 0)
     {
-      ffgpvj(fptr, 0, ii, SHTSIZE, longnull, sarray, &anynull, status);
+      ntodo = minvalue(nrows, nremain);
+      fits_read_col(fptr, TINT, 1, firstrow, 1, ntodo, NULL, buffer,
+                    &anynull, status);
+      fits_read_col(fptr, TINT, 2, firstrow, 1, ntodo, NULL, buffer,
+                    &anynull, status);
+      firstrow += ntodo;
+      nremain  -= ntodo;
     }
 
-    gettime(&elapse, &elapcpu, status);
-
-    cpufrac = elapcpu / elapse * 100.;
-    size = XSIZE * 4. * YSIZE / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    fits_close_file(fptr, status);
+    free(buffer);
 
+    *nbytes = opts->arows * 13.;
     return( *status );
 }
 /*--------------------------------------------------------------------------*/
-int readbtable( fitsfile *fptr, int *status )
+static int writecompressed(speedOpts *opts, int icodec, double *nbytes,
+                           int *status)
 
-    /************************************************************/
-    /* read and print data values from the binary table */
-    /************************************************************/
+    /*******************************************************************/
+    /* write a tile-compressed 16-bit image with the given algorithm;  */
+    /* the rate is given in terms of the uncompressed image size       */
+    /*******************************************************************/
 {
-    int hdutype, anynull;
-    long nremain, ntodo, firstrow = 1, firstelem = 1;
-    long nrows;
-    long lnull = 0;
-    float rate, size, elapcpu, cpufrac;
-    double elapse;
-
-    /* move to the table */
-    if ( fits_movrel_hdu(fptr, 1, &hdutype, status) ) 
-           printerror( *status );
-
-    /* get table row size and optimum number of rows to read per loop */
-    fits_get_rowsize(fptr, &nrows, status);
-    nrows = minvalue(nrows, SHTSIZE);
-    
-    /*  read the columns */  
-    nremain = BROWS;
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long naxes[2], npix, ii, ntodo;
+    short *buffer;
+
+    naxes[0] = opts->nx;
+    naxes[1] = opts->ny;
+    npix = opts->nx * opts->ny;
+
+    buffer = (short *) malloc(opts->chunk * sizeof(short));
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
 
-    printf("Read back BINTABLE                              ");
-    marktime(status);
+    name[0] = '!';
+    filename(opts, "cmp", codecnames[icodec], NULL, name + 1);
 
-    while(nremain)
+    fits_create_file(&fptr, name, status);
+    fits_set_compression_type(fptr, codecs[icodec], status);
+    fits_create_img(fptr, SHORT_IMG, 2, naxes, status);
+
+    for (ii = 1; ii <= npix && *status <= 0; ii += opts->chunk)
     {
-      ntodo = minvalue(nrows, nremain);
-      ffgcvj(fptr, 1, firstrow, firstelem, ntodo,
-                     lnull, sarray, &anynull, status);
-      ffgcvj(fptr, 2, firstrow, firstelem, ntodo,
-                     lnull, sarray, &anynull, status);
-      firstrow += ntodo; 
-      nremain  -= ntodo;
+        ntodo = minvalue(opts->chunk, npix - ii + 1);
+        fillbuffer(1, buffer, ntodo, ii - 1);
+        fits_write_img(fptr, TSHORT, ii, ntodo, buffer, status);
     }
 
-    gettime(&elapse, &elapcpu, status);
-
-    cpufrac = elapcpu / elapse * 100.;
-    size = BROWS * 8. / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    fits_close_file(fptr, status);
+    free(buffer);
 
+    *nbytes = (double) npix * sizeof(short);
     return( *status );
 }
 /*--------------------------------------------------------------------------*/
-int readatable( fitsfile *fptr, int *status )
+static int readcompressed(speedOpts *opts, int icodec, double *nbytes,
+                          int *status)
 
-    /************************************************************/
-    /* read and print data values from an ASCII or binary table */
-    /************************************************************/
+    /****************************************/
+    /* read back a tile-compressed image     */
+    /****************************************/
 {
-    int hdutype, anynull;
-    long nremain, ntodo, firstrow = 1, firstelem = 1;
-    long nrows;
-    long lnull = 0;
-    float rate, size, elapcpu, cpufrac;
-    double elapse;
-
-    /* move to the table */
-    if ( fits_movrel_hdu(fptr, 1, &hdutype, status) ) 
-           printerror( *status );
-
-    /* get table row size and optimum number of rows to read per loop */
-    fits_get_rowsize(fptr, &nrows, status);
-    nrows = minvalue(nrows, SHTSIZE);
- 
-    /*  read the columns */  
-    nremain = AROWS;
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    long npix, ii, ntodo;
+    short *buffer;
+    int anynull;
+
+    npix = opts->nx * opts->ny;
+
+    buffer = (short *) malloc(opts->chunk * sizeof(short));
+    if (!buffer)
+        return(*status = MEMORY_ALLOCATION);
 
-    printf("Read back ASCII Table                           ");
-    marktime(status);
+    filename(opts, "cmp", codecnames[icodec], "[1]", name);
+    fits_open_file(&fptr, name, READONLY, status);
 
-    while(nremain)
+    for (ii = 1; ii <= npix && *status <= 0; ii += opts->chunk)
     {
-      ntodo = minvalue(nrows, nremain);
-      ffgcvj(fptr, 1, firstrow, firstelem, ntodo,
-                     lnull, sarray, &anynull, status);
-      ffgcvj(fptr, 2, firstrow, firstelem, ntodo,
-                     lnull, sarray, &anynull, status);
-      firstrow += ntodo;
-      nremain  -= ntodo;
+        ntodo = minvalue(opts->chunk, npix - ii + 1);
+        fits_read_img(fptr, TSHORT, ii, ntodo, NULL, buffer, &anynull,
+                      status);
     }
 
-    gettime(&elapse, &elapcpu, status);
+    fits_close_file(fptr, status);
+    free(buffer);
 
-    cpufrac = elapcpu / elapse * 100.;
-    size = AROWS * 13. / 1000000.;
-    rate = size / elapse;
-    printf(" %4.1fMB/%6.3fs(%3.0f) = %5.2fMB/s\n", size, elapse, cpufrac,rate);
+    *nbytes = (double) npix * sizeof(short);
+    return( *status );
+}
+/*--------------------------------------------------------------------------*/
+static int filterrows(speedOpts *opts, int arg, double *nbytes, int *status)
 
+    /*******************************************************/
+    /* evaluate a row-selection expression over the table  */
+    /*******************************************************/
+{
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    char *rowstatus;
+    long ngood;
+
+    rowstatus = (char *) malloc(opts->brows);
+    if (!rowstatus)
+        return(*status = MEMORY_ALLOCATION);
+
+    filename(opts, "tbl", NULL, "[Speed_Test]", name);
+    fits_open_file(&fptr, name, READONLY, status);
+
+    fits_find_rows(fptr, "C_J > 100 && C_E < 400.", 1, opts->brows, &ngood,
+                   rowstatus, status);
+
+    fits_close_file(fptr, status);
+    free(rowstatus);
+
+    /* the expression reads the int and float columns */
+    *nbytes = (double) opts->brows * (4 + 4);
     return( *status );
 }
 /*--------------------------------------------------------------------------*/
-void printerror( int status)
+static int makehist(speedOpts *opts, int arg, double *nbytes, int *status)
+
+    /**************************************************************/
+    /* bin two table columns into a 100 x 100 histogram image     */
+    /**************************************************************/
 {
-    /*****************************************************/
-    /* Print out cfitsio error messages and exit program */
-    /*****************************************************/
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    float *hist;
+    int anynull;
 
-    char status_str[FLEN_STATUS], errmsg[FLEN_ERRMSG];
-  
-    if (status)
-      fprintf(stderr, "\n*** Error occurred during program execution ***\n");
+    hist = (float *) malloc(100 * 100 * sizeof(float));
+    if (!hist)
+        return(*status = MEMORY_ALLOCATION);
 
-    fits_get_errstatus(status, status_str);   /* get the error description */
-    fprintf(stderr, "\nstatus = %d: %s\n", status, status_str);
+    filename(opts, "tbl", NULL, "[Speed_Test][bin (C_I,C_J)=0:1000:10]", name);
+    fits_open_file(&fptr, name, READONLY, status);
 
-    /* get first message; null if stack is empty */
-    if ( fits_read_errmsg(errmsg) ) 
-    {
-         fprintf(stderr, "\nError message stack:\n");
-         fprintf(stderr, " %s\n", errmsg);
+    fits_read_img(fptr, TFLOAT, 1, 100 * 100, NULL, hist, &anynull, status);
 
-         while ( fits_read_errmsg(errmsg) )  /* get remaining messages */
-             fprintf(stderr, " %s\n", errmsg);
-    }
+    fits_close_file(fptr, status);
+    free(hist);
 
-    exit( status );       /* terminate the program, returning error status */
+    /* the histogram reads the short and int columns */
+    *nbytes = (double) opts->brows * (2 + 4);
+    return( *status );
 }
 /*--------------------------------------------------------------------------*/
-int marktime( int *status)
+static int checksum(speedOpts *opts, int arg, double *nbytes, int *status)
+
+    /*************************************************************/
+    /* compute, write and verify the checksums of the int image  */
+    /*************************************************************/
 {
-    double telapse;
-    time_t temp;
-    struct  timeval tv;
+    fitsfile *fptr;
+    char name[FLEN_FILENAME];
+    int datastatus, hdustatus;
 
-    temp = time(0);
+    filename(opts, "img", "int", NULL, name);
+    fits_open_file(&fptr, name, READWRITE, status);
 
-    /* Since elapsed time is only measured to the nearest second */
-    /* keep getting the time until the seconds tick just changes. */
-    /* This provides more consistent timing measurements since the */
-    /* intervals all start on an integer seconds. */
+    fits_write_chksum(fptr, status);
+    fits_verify_chksum(fptr, &datastatus, &hdustatus, status);
 
-    telapse = 0.;
+    fits_close_file(fptr, status);
 
-        scpu = clock();
-        start = time(0);
-/*
-    while (telapse == 0.)
+    /* the data unit is summed once when writing and once when verifying */
+    *nbytes = 2. * opts->nx * opts->ny * 4;
+    return( *status );
+}
+/*--------------------------------------------------------------------------*/
+static void removefiles(speedOpts *opts)
+{
+    char name[FLEN_FILENAME];
+    int ii;
+
+    filename(opts, "raw", NULL, NULL, name);
+    remove(name);
+    filename(opts, "tbl", NULL, NULL, name);
+    remove(name);
+    filename(opts, "asc", NULL, NULL, name);
+    remove(name);
+
+    for (ii = 0; ii < ntypes; ii++)
     {
-        scpu = clock();
-        start = time(0);
-        telapse = difftime( start, temp );
+        filename(opts, "img", typenames[ii], NULL, name);
+        remove(name);
     }
-*/
-        gettimeofday (&tv, NULL);
 
-	startsec = tv.tv_sec;
-        startmilli = tv.tv_usec/1000;
-
-    return( *status );
+    for (ii = 0; ii < ncodecs; ii++)
+    {
+        filename(opts, "cmp", codecnames[ii], NULL, name);
+        remove(name);
+    }
 }
 /*--------------------------------------------------------------------------*/
-int gettime(double *elapse, float *elapscpu, int *status)
+void printerror( int status)
 {
-        struct  timeval tv;
-	int stopmilli;
-	long stopsec;
+    /*****************************************************/
+    /* Print out cfitsio error messages and exit program */
+    /*****************************************************/
 
+    char status_str[FLEN_STATUS], errmsg[FLEN_ERRMSG];
 
-        gettimeofday (&tv, NULL);
-    ecpu = clock();
-    finish = time(0);
+    if (status)
+      fprintf(stderr, "\n*** Error occurred during program execution ***\n");
 
-        stopmilli = tv.tv_usec/1000;
-	stopsec = tv.tv_sec;
-	
+    fits_get_errstatus(status, status_str);   /* get the error description */
+    fprintf(stderr, "\nstatus = %d: %s\n", status, status_str);
 
-	*elapse = (stopsec - startsec) + (stopmilli - startmilli)/1000.;
+    /* get first message; null if stack is empty */
+    if ( fits_read_errmsg(errmsg) )
+    {
+         fprintf(stderr, "\nError message stack:\n");
+         fprintf(stderr, " %s\n", errmsg);
 
-/*    *elapse = difftime(finish, start) + 0.5; */
-    *elapscpu = (ecpu - scpu) * 1.0 / CLOCKTICKS;
+         while ( fits_read_errmsg(errmsg) )  /* get remaining messages */
+             fprintf(stderr, " %s\n", errmsg);
+    }
 
-    return( *status );
+    exit( status );       /* terminate the program, returning error status */
 }
@@ -0,0 +1,236 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+  Stress test for a thread-safe (-D_REENTRANT) build of CFITSIO.
+
+  Each of NTHREADS threads repeatedly creates its own FITS file, writes a
+  tile-compressed image and a binary table, closes it, then reopens it to
+  read the data back, apply a row filter, build a histogram and verify the
+  checksum, before deleting the file.  All threads run at the same time,
+  so this exercises the driver, FITSfile-table and parser locks as well as
+  the thread-local state used by the compression and histogram code.
+*/
+#include "fitsio.h"
+
+#define NTHREADS  32
+#define NLOOPS     4
+#define NX       200
+#define NY       150
+#define NROWS   5000
+
+typedef struct
+{
+    int id;          /* thread number */
+    int status;      /* CFITSIO status at exit, or -1 for a data mismatch */
+    char errmsg[FLEN_ERRMSG];
+} threadInfo;
+
+static int writefile(char *filename, int id, int *status);
+static int readfile(char *filename, int id, int *status);
+static void *worker(void *arg);
+
+int main()
+{
+    pthread_t threads[NTHREADS];
+    threadInfo info[NTHREADS];
+    int ii, nfail = 0;
+
+    if (!fits_is_reentrant())
+    {
+        printf("CFITSIO was not built with -D_REENTRANT; skipping test.\n");
+        return(0);
+    }
+
+    for (ii = 0; ii < NTHREADS; ii++)
+    {
+        info[ii].id = ii;
+        info[ii].status = 0;
+        info[ii].errmsg[0] = '\0';
+
+        if (pthread_create(&threads[ii], NULL, worker, &info[ii]))
+        {
+            printf("failed to create thread %d\n", ii);
+            return(1);
+        }
+    }
+
+    for (ii = 0; ii < NTHREADS; ii++)
+    {
+        pthread_join(threads[ii], NULL);
+
+        if (info[ii].status)
+        {
+            printf("thread %d failed with status %d: %s\n", ii,
+                   info[ii].status, info[ii].errmsg);
+            nfail++;
+        }
+    }
+
+    if (nfail)
+    {
+        printf("%d of %d threads failed\n", nfail, NTHREADS);
+        return(1);
+    }
+
+    printf("%d threads x %d loops completed successfully\n",
+           NTHREADS, NLOOPS);
+    return(0);
+}
+/*--------------------------------------------------------------------------*/
+static void *worker(void *arg)
+{
+    threadInfo *info = (threadInfo *) arg;
+    char filename[FLEN_FILENAME];
+    int loop, status = 0;
+
+    for (loop = 0; loop < NLOOPS && !status; loop++)
+    {
+        sprintf(filename, "!threadtest_%02d.fit", info->id);
+        writefile(filename, info->id, &status);
+        readfile(filename + 1, info->id, &status);
+    }
+
+    if (status > 0)
+        fits_read_errmsg(info->errmsg);  /* messages are kept per thread */
+
+    info->status = status;
+    return(NULL);
+}
+/*--------------------------------------------------------------------------*/
+static int writefile(char *filename, int id, int *status)
+/*
+   write a compressed image and a binary table, with checksums
+*/
+{
+    fitsfile *fptr;
+    long naxes[2] = {NX, NY}, tilesize[2] = {NX, 10};
+    long ii;
+    int *image;
+    double *xcol;
+    int *ycol;
+    char *ttype[] = {"X", "Y"};
+    char *tform[] = {"1D", "1J"};
+    char *tunit[] = {"", ""};
+
+    if (*status > 0)
+        return(*status);
+
+    image = (int *) malloc(NX * NY * sizeof(int));
+    xcol = (double *) malloc(NROWS * sizeof(double));
+    ycol = (int *) malloc(NROWS * sizeof(int));
+    if (!image || !xcol || !ycol)
+    {
+        free(image);
+        free(xcol);
+        free(ycol);
+        return(*status = MEMORY_ALLOCATION);
+    }
+
+    for (ii = 0; ii < NX * NY; ii++)
+        image[ii] = (int) ((ii * 7 + id) % 1000);
+
+    for (ii = 0; ii < NROWS; ii++)
+    {
+        xcol[ii] = (double) (ii % 100);
+        ycol[ii] = (int) (ii % 10) + id;
+    }
+
+    fits_create_file(&fptr, filename, status);
+    fits_create_img(fptr, SHORT_IMG, 0, NULL, status);
+
+    /* alternate between H-compress and Rice so that both */
+    /* compression codecs run concurrently in different threads */
+    fits_set_compression_type(fptr, (id % 2) ? HCOMPRESS_1 : RICE_1, status);
+    fits_set_tile_dim(fptr, 2, tilesize, status);
+    fits_create_img(fptr, LONG_IMG, 2, naxes, status);
+    fits_write_img(fptr, TINT, 1, NX * NY, image, status);
+    fits_set_compression_type(fptr, 0, status);
+
+    fits_create_tbl(fptr, BINARY_TBL, NROWS, 2, ttype, tform, tunit,
+                    "EVENTS", status);
+    fits_write_col(fptr, TDOUBLE, 1, 1, 1, NROWS, xcol, status);
+    fits_write_col(fptr, TINT, 2, 1, 1, NROWS, ycol, status);
+    fits_write_chksum(fptr, status);
+
+    fits_close_file(fptr, status);
+
+    free(image);
+    free(xcol);
+    free(ycol);
+    return(*status);
+}
+/*--------------------------------------------------------------------------*/
+static int readfile(char *filename, int id, int *status)
+/*
+   read back and verify the file written by writefile, then delete it
+*/
+{
+    fitsfile *fptr;
+    char fullname[FLEN_FILENAME + 64];  /* room for the longest filter */
+    long ii, nrows = 0;
+    int *image, anynul, datastatus, hdustatus, bad = 0;
+    double total;
+    float hist[100];
+
+    if (*status > 0)
+        return(*status);
+
+    image = (int *) malloc(NX * NY * sizeof(int));
+    if (!image)
+        return(*status = MEMORY_ALLOCATION);
+
+    /* read the compressed image */
+    snprintf(fullname, sizeof(fullname), "%s[1]", filename);
+    if (!fits_open_file(&fptr, fullname, READONLY, status))
+    {
+        fits_read_img(fptr, TINT, 1, NX * NY, NULL, image, &anynul, status);
+        for (ii = 0; ii < NX * NY && *status <= 0; ii++)
+            if (image[ii] != (int) ((ii * 7 + id) % 1000))
+                bad = 1;
+        fits_close_file(fptr, status);
+    }
+    free(image);
+
+    /* verify the table checksum */
+    snprintf(fullname, sizeof(fullname), "%s[EVENTS]", filename);
+    if (!fits_open_file(&fptr, fullname, READONLY, status))
+    {
+        fits_verify_chksum(fptr, &datastatus, &hdustatus, status);
+        if (datastatus != 1 || hdustatus != 1)
+            bad = 1;
+        fits_close_file(fptr, status);
+    }
+
+    /* apply a row filter; 1 row in 20 satisfies both conditions */
+    snprintf(fullname, sizeof(fullname), "%s[EVENTS][X >= 50 && Y == %d]", filename, id);
+    if (!fits_open_file(&fptr, fullname, READONLY, status))
+    {
+        fits_get_num_rows(fptr, &nrows, status);
+        if (*status <= 0 && nrows != NROWS / 20)
+            bad = 1;
+        fits_close_file(fptr, status);
+    }
+
+    /* build a 1-D histogram of X, which should be flat */
+    snprintf(fullname, sizeof(fullname), "%s[EVENTS][bin X=0:100:1]", filename);
+    if (!fits_open_file(&fptr, fullname, READONLY, status))
+    {
+        fits_read_img(fptr, TFLOAT, 1, 100, NULL, hist, &anynul, status);
+        for (ii = 0, total = 0.; ii < 100; ii++)
+            total += hist[ii];
+        if (*status <= 0 && (total != NROWS || hist[0] != NROWS / 100))
+            bad = 1;
+        fits_close_file(fptr, status);
+    }
+
+    if (!fits_open_file(&fptr, filename, READWRITE, status))
+        fits_delete_file(fptr, status);
+
+    if (bad && *status <= 0)
+        *status = -1;
+
+    return(*status);
+}
@@ -179,6 +179,86 @@ struct BinFactors {
 
 };
 
+/* Opaque handles to the heasp objects. Unlike the RMF, ARF and PHA structures,
+   which hold copies of the arrays, a handle holds the object itself so reading,
+   operating on or passing a handle between routines does not convert or copy
+   any arrays. The arrays can be looked at through a view, whose pointers point
+   into the object and remain valid until the handle is next modified or freed. */
+
+struct RMFhandle;
+struct ARFhandle;
+struct PHAhandle;
+
+/* define the RMFview structure - a read-only view of the arrays in an RMFhandle */
+
+struct RMFview {
+
+  long NumberChannels;                            /* Number of spectrum channels */
+  long NumberEnergyBins;                          /* Number of response energies */
+  long NumberTotalGroups;                         /* Total number of response groups */
+  long NumberTotalElements;                       /* Total number of response elements */
+  long FirstChannel;                              /* First channel number */
+
+  const int* NumberGroups; /*NumberEnergyBins*/   /* Number of response groups for this energy bin */
+  const int* FirstGroup; /*NumberEnergyBins*/     /* First response group for this energy bin (counts from 0)*/
+
+  const int* FirstChannelGroup; /*NumberTotalGroups*/ /* First channel number in this group */
+  const int* NumberChannelGroups; /*NumberTotalGroups*/ /* Number of channels in this group */
+  const int* FirstElement; /*NumberTotalGroups*/  /* First response element for this group (counts from 0)*/
+  const int* OrderGroup; /*NumberTotalGroups*/    /* The grating order of this group, NULL if none */
+
+  const double* LowEnergy; /*NumberEnergyBins*/   /* Start energy of bin */
+  const double* HighEnergy; /*NumberEnergyBins*/  /* End energy of bin */
+
+  const double* Matrix; /*NumberTotalElements*/   /* Matrix elements */
+
+  const double* ChannelLowEnergy; /*NumberChannels*/ /* Start energy of channel */
+  const double* ChannelHighEnergy; /*NumberChannels*/ /* End energy of channel */
+
+  double AreaScaling;                             /* Value of EFFAREA keyword */
+  double ResponseThreshold;                       /* Minimum value in response */
+
+};
+
+/* define the ARFview structure - a read-only view of the arrays in an ARFhandle */
+
+struct ARFview {
+
+  long NumberEnergyBins;                          /* Number of response energies */
+
+  const double* LowEnergy; /*NumberEnergyBins*/   /* Start energy of bin */
+  const double* HighEnergy; /*NumberEnergyBins*/  /* End energy of bin */
+
+  const double* EffArea; /*NumberEnergyBins*/     /* Effective areas */
+
+};
+
+/* define the PHAview structure - a read-only view of the arrays in a PHAhandle.
+   Arrays which are not set are NULL. */
+
+struct PHAview {
+
+  long NumberChannels;                            /* Number of spectrum channels */
+  long FirstChannel;                              /* First channel number */
+
+  const double* Pha; /*NumberChannels*/           /* PHA data */
+  const double* StatError; /*NumberChannels*/     /* Statistical error */
+  const double* SysError; /*NumberChannels*/      /* Systematic error */
+
+  const int* Quality; /*NumberChannels*/          /* Data quality */
+  const int* Grouping; /*NumberChannels*/         /* Data grouping */
+  const int* Channel; /*NumberChannels*/          /* Channel number */
+
+  long NumberAreaScaling;                         /* Size of AreaScaling, 1 or NumberChannels */
+  const double* AreaScaling;                      /* Area scaling factor */
+  long NumberBackScaling;                         /* Size of BackScaling, 1 or NumberChannels */
+  const double* BackScaling;                      /* Background scaling factor */
+
+  double Exposure;                                /* Exposure time */
+  double CorrectionScaling;                       /* Correction file scale factor */
+
+};
+
 /* function proto-types */
 
 /* read the RMF matrix and ebounds from a FITS file. this assumes that there is only one
@@ -316,6 +396,119 @@ int CheckPHAcounts(char *filename, long PHAnumber);
 
 long ReturnNumberofSpectra(char *filename, long PHAnumber);
 
+/* create and free handles */
+
+struct RMFhandle* NewRMFhandle(void);
+void FreeRMFhandle(struct RMFhandle *handle);
+struct ARFhandle* NewARFhandle(void);
+void FreeARFhandle(struct ARFhandle *handle);
+struct PHAhandle* NewPHAhandle(void);
+void FreePHAhandle(struct PHAhandle *handle);
+
+/* read the RMF matrix and ebounds from a FITS file into a handle. this assumes
+   that there is only one of each in the file. */
+
+int ReadRMFhandle(char *filename, struct RMFhandle *handle);
+
+/* write the RMF matrix and ebounds in a handle to a FITS file */
+
+int WriteRMFhandle(char *filename, struct RMFhandle *handle);
+
+/* set up a read-only view of the arrays in the RMF handle */
+
+void ViewRMFhandle(struct RMFhandle *handle, struct RMFview *view);
+
+/* copy between an RMF structure and an RMF handle */
+
+void RMFstructToHandle(struct RMF *rmf, struct RMFhandle *handle);
+void RMFhandleToStruct(struct RMFhandle *handle, struct RMF *rmf);
+
+/* write information about the RMF in a handle to stdout */
+
+void DisplayRMFhandle(struct RMFhandle *handle);
+
+/* normalize the response in a handle to unity in each energy */
+
+void NormalizeRMFhandle(struct RMFhandle *handle);
+
+/* compress the response in a handle to remove all elements below the threshold value */
+
+void CompressRMFhandle(struct RMFhandle *handle, float threshold);
+
+/* rebin the RMF in a handle in channel or energy space */
+
+int RebinRMFChannelHandle(struct RMFhandle *handle, struct BinFactors *bins);
+int RebinRMFEnergyHandle(struct RMFhandle *handle, struct BinFactors *bins);
+
+/* multiply the ARF in a handle into the RMF in a handle. Returns -1 if they
+   are not compatible */
+
+int MergeARFRMFhandle(struct ARFhandle *arf, struct RMFhandle *rmf);
+
+/* fold a model (NumberEnergyBins values) through the RMF in a handle to give
+   the counts (NumberChannels values) */
+
+void FoldRMFhandle(struct RMFhandle *handle, const double *model, double *counts);
+
+/* return a single value from the matrix in a handle */
+
+float ReturnRMFhandleElement(struct RMFhandle *handle, long channel, long energybin);
+
+/* return channels for photons of the given input energy or energies using the
+   RMF in a handle, as ReturnChannel and ReturnChannelMultiEnergies */
+
+void ReturnChannelHandle(struct RMFhandle *handle, float energy, int NumberPhotons, long *channel);
+void ReturnChannelMultiEnergiesHandle(struct RMFhandle *handle, int NumberEnergies, float *energy, 
+				      int *NumberPhotons, long *channel);
+
+/* read the effective areas from a FITS file into a handle - if there are multiple
+   SPECRESP extensions then read the one in ARFnumber */
+
+int ReadARFhandle(char *filename, long ARFnumber, struct ARFhandle *handle);
+
+/* write the ARF in a handle to a FITS file */
+
+int WriteARFhandle(char *filename, struct ARFhandle *handle);
+
+/* set up a read-only view of the arrays in the ARF handle */
+
+void ViewARFhandle(struct ARFhandle *handle, struct ARFview *view);
+
+/* copy between an ARF structure and an ARF handle */
+
+void ARFstructToHandle(struct ARF *arf, struct ARFhandle *handle);
+void ARFhandleToStruct(struct ARFhandle *handle, struct ARF *arf);
+
+/* write information about the ARF in a handle to stdout */
+
+void DisplayARFhandle(struct ARFhandle *handle);
+
+/* read the type I PHA extension from a FITS file into a handle - if there are
+   multiple PHA extensions then read the one in PHAnumber */
+
+int ReadPHAhandle(char *filename, long PHAnumber, struct PHAhandle *handle);
+
+/* write the spectrum in a handle to a FITS file as a type I PHA extension */
+
+int WritePHAhandle(char *filename, struct PHAhandle *handle);
+
+/* set up a read-only view of the arrays in the PHA handle */
+
+void ViewPHAhandle(struct PHAhandle *handle, struct PHAview *view);
+
+/* copy between a PHA structure and a PHA handle */
+
+void PHAstructToHandle(struct PHA *phastruct, struct PHAhandle *handle);
+void PHAhandleToStruct(struct PHAhandle *handle, struct PHA *phastruct);
+
+/* write information about the spectrum in a handle to stdout */
+
+void DisplayPHAhandle(struct PHAhandle *handle);
+
+/* rebin the spectrum in a handle */
+
+int RebinPHAhandle(struct PHAhandle *handle, struct BinFactors *bins);
+
 /* Read an ascii file with binning factors and load the binning array */
 
 int SPReadBinningFile(char *filename, struct BinFactors *binning);
@@ -326,7 +326,7 @@ int AddRMF(struct RMF *rmf1, struct RMF *rmf2)
   RMFstructToObject(rmf1, inRMF1, 0);
   RMFstructToObject(rmf2, inRMF2, 0);
 
-  if ( !inRMF1.checkCompatibility(inRMF2) ) return 1;
+  if ( inRMF1.checkCompatibility(inRMF2) != OK ) return 1;
 
   inRMF1 += inRMF2;
 
@@ -375,7 +375,7 @@ int AddARF(struct ARF *arf1, struct ARF *arf2)
   ARFstructToObject(arf1, ea1);
   ARFstructToObject(arf2, ea2);
 
-  if ( !ea1.checkCompatibility(ea2) ) return 1;
+  if ( ea1.checkCompatibility(ea2) != OK ) return 1;
 
   ea1 += ea2;
 
@@ -411,7 +411,7 @@ long MergeARFRMF(struct ARF *arfstruct, struct RMF *rmfstruct){
 
   // Check for compatibility
 
-  if ( !inRMF.checkCompatibility(inARF) ) return(-1);
+  if ( inRMF.checkCompatibility(inARF) != OK ) return(-1);
 
   // Merge ARF and RMF
 
@@ -678,6 +678,389 @@ int SPReadBinningFile(char *filename, struct BinFactors *binning)
 }
 
 
+// *******************************************************************************************
+// Opaque handle routines. The handles hold the C++ objects so the routines
+// operate on them in place. Prototypes in Cheasp.h.
+
+struct RMFhandle {
+  rmf object;
+};
+
+struct ARFhandle {
+  arf object;
+};
+
+struct PHAhandle {
+  pha object;
+};
+
+// load a grouping object from the BinFactors structure
+
+static Integer BinFactorsToGrouping(struct BinFactors *bin, const Integer Number,
+				    const Integer First, grouping& outGrouping)
+{
+  vector<Integer> StartBin(bin->NumberBinFactors);
+  vector<Integer> EndBin(bin->NumberBinFactors);
+  vector<Integer> BinFactor(bin->NumberBinFactors);
+
+  for (size_t i=0; i<StartBin.size(); i++) {
+    StartBin[i] = bin->StartBin[i];
+    EndBin[i] = bin->EndBin[i];
+    BinFactor[i] = bin->Binning[i];
+  }
+
+  return outGrouping.load(StartBin, EndBin, BinFactor, Number, First);
+}
+
+// create and free handles
+
+struct RMFhandle* NewRMFhandle(void)
+{
+  return new RMFhandle;
+}
+
+void FreeRMFhandle(struct RMFhandle *handle)
+{
+  delete handle;
+  return;
+}
+
+struct ARFhandle* NewARFhandle(void)
+{
+  return new ARFhandle;
+}
+
+void FreeARFhandle(struct ARFhandle *handle)
+{
+  delete handle;
+  return;
+}
+
+struct PHAhandle* NewPHAhandle(void)
+{
+  return new PHAhandle;
+}
+
+void FreePHAhandle(struct PHAhandle *handle)
+{
+  delete handle;
+  return;
+}
+
+// read the RMF matrix and ebounds from a FITS file into a handle
+
+int ReadRMFhandle(char *filename, struct RMFhandle *handle)
+{
+  return (int)handle->object.read((string)filename);
+}
+
+// write the RMF matrix and ebounds in a handle to a FITS file
+
+int WriteRMFhandle(char *filename, struct RMFhandle *handle)
+{
+  return (int)handle->object.write((string)filename);
+}
+
+// set up a read-only view of the arrays in the RMF handle
+
+void ViewRMFhandle(struct RMFhandle *handle, struct RMFview *view)
+{
+  rmf& response = handle->object;
+
+  view->NumberChannels = response.ChannelLowEnergy.size();
+  view->NumberEnergyBins = response.LowEnergy.size();
+  view->NumberTotalGroups = response.FirstChannelGroup.size();
+  view->NumberTotalElements = response.Matrix.size();
+  view->FirstChannel = response.FirstChannel;
+
+  view->NumberGroups = response.NumberGroups.size() > 0 ? &response.NumberGroups[0] : NULL;
+  view->FirstGroup = response.FirstGroup.size() > 0 ? &response.FirstGroup[0] : NULL;
+  view->FirstChannelGroup = response.FirstChannelGroup.size() > 0 ? &response.FirstChannelGroup[0] : NULL;
+  view->NumberChannelGroups = response.NumberChannelsGroup.size() > 0 ? &response.NumberChannelsGroup[0] : NULL;
+  view->FirstElement = response.FirstElement.size() > 0 ? &response.FirstElement[0] : NULL;
+  view->OrderGroup = response.OrderGroup.size() > 0 ? &response.OrderGroup[0] : NULL;
+
+  view->LowEnergy = response.LowEnergy.size() > 0 ? &response.LowEnergy[0] : NULL;
+  view->HighEnergy = response.HighEnergy.size() > 0 ? &response.HighEnergy[0] : NULL;
+  view->Matrix = response.Matrix.size() > 0 ? &response.Matrix[0] : NULL;
+  view->ChannelLowEnergy = response.ChannelLowEnergy.size() > 0 ? &response.ChannelLowEnergy[0] : NULL;
+  view->ChannelHighEnergy = response.ChannelHighEnergy.size() > 0 ? &response.ChannelHighEnergy[0] : NULL;
+
+  view->AreaScaling = response.AreaScaling;
+  view->ResponseThreshold = response.ResponseThreshold;
+
+  return;
+}
+
+// copy between an RMF structure and an RMF handle
+
+void RMFstructToHandle(struct RMF *rmfstruct, struct RMFhandle *handle)
+{
+  RMFstructToObject(rmfstruct, handle->object, 0);
+  return;
+}
+
+void RMFhandleToStruct(struct RMFhandle *handle, struct RMF *rmfstruct)
+{
+  RMFobjectToStruct(handle->object, rmfstruct, 0);
+  return;
+}
+
+// write information about the RMF in a handle to stdout
+
+void DisplayRMFhandle(struct RMFhandle *handle)
+{
+  cout << handle->object.disp();
+  return;
+}
+
+// normalize the response in a handle to unity in each energy
+
+void NormalizeRMFhandle(struct RMFhandle *handle)
+{
+  handle->object.normalize();
+  return;
+}
+
+// compress the response in a handle to remove all elements below the threshold value
+
+void CompressRMFhandle(struct RMFhandle *handle, float threshold)
+{
+  handle->object.compress((Real)threshold);
+  return;
+}
+
+// rebin the RMF in a handle in channel space
+
+int RebinRMFChannelHandle(struct RMFhandle *handle, struct BinFactors *bin)
+{
+  rmf& response = handle->object;
+
+  grouping inGrouping;
+  Integer Status = BinFactorsToGrouping(bin, response.NumberChannels(), response.FirstChannel,
+					inGrouping);
+  if ( Status != 0 ) return (int)Status;
+
+  return (int)response.rebinChannels(inGrouping);
+}
+
+// rebin the RMF in a handle in energy space
+
+int RebinRMFEnergyHandle(struct RMFhandle *handle, struct BinFactors *bin)
+{
+  rmf& response = handle->object;
+
+  grouping inGrouping;
+  Integer Status = BinFactorsToGrouping(bin, response.NumberEnergyBins(), 0, inGrouping);
+  if ( Status != 0 ) return (int)Status;
+
+  return (int)response.rebinEnergies(inGrouping);
+}
+
+// multiply the ARF in a handle into the RMF in a handle
+
+int MergeARFRMFhandle(struct ARFhandle *arfhandle, struct RMFhandle *rmfhandle)
+{
+  if ( rmfhandle->object.checkCompatibility(arfhandle->object) != OK ) return(-1);
+
+  rmfhandle->object *= arfhandle->object;
+
+  return(0);
+}
+
+// fold a model through the RMF in a handle. Note that this routine assumes that
+// memory has been allocated for the counts array.
+
+void FoldRMFhandle(struct RMFhandle *handle, const double *model, double *counts)
+{
+  const rmf& response = handle->object;
+
+  // the same loop as rmf::multiplyByModel but reading model and writing counts
+  // directly so no copies are made
+
+  size_t nChan = response.ChannelLowEnergy.size();
+  for (size_t ich=0; ich<nChan; ich++) counts[ich] = 0.0;
+
+  size_t nE = response.LowEnergy.size();
+  for (size_t ie=0; ie<nE; ie++) {
+    size_t gEnd = (size_t)(response.FirstGroup[ie]+response.NumberGroups[ie]);
+    for (size_t ig=(size_t)response.FirstGroup[ie]; ig<gEnd; ig++) {
+      const Real* elements = &response.Matrix[response.FirstElement[ig]];
+      double* chanCounts = counts + (response.FirstChannelGroup[ig]-response.FirstChannel);
+      for (Integer k=0; k<response.NumberChannelsGroup[ig]; k++) {
+	chanCounts[k] += model[ie] * elements[k];
+      }
+    }
+  }
+
+  return;
+}
+
+// return a single value from the matrix in a handle
+
+float ReturnRMFhandleElement(struct RMFhandle *handle, long channel, long energybin)
+{
+  return (float)handle->object.ElementValue((Integer)channel, (Integer)energybin);
+}
+
+// return channels for photons of the given input energy using the RMF in a
+// handle. Note that this routine assumes that memory has been allocated for
+// the channel array.
+
+void ReturnChannelHandle(struct RMFhandle *handle, float energy, int NumberPhotons, long *channel)
+{
+  vector<Integer> channelVector = handle->object.RandomChannels((Real)energy,(Integer)NumberPhotons);
+
+  for (size_t i=0; i<(size_t)NumberPhotons; i++) channel[i] = channelVector[i];
+
+  return;
+}
+
+// return channels for photons of the given input energies using the RMF in a
+// handle. Note that this routine assumes that memory has been allocated for
+// the channel array.
+
+void ReturnChannelMultiEnergiesHandle(struct RMFhandle *handle, int NumberEnergies, 
+				      float *energy, int *NumberPhotons, long *channel)
+{
+  vector<Real> EnergyArray(energy, energy+NumberEnergies);
+  vector<Integer> NPhotArray(NumberPhotons, NumberPhotons+NumberEnergies);
+
+  vector<Integer> channelVector = handle->object.RandomChannels(EnergyArray,NPhotArray);
+
+  for (size_t i=0; i<channelVector.size(); i++) channel[i] = channelVector[i];
+
+  return;
+}
+
+// read the effective areas from a FITS file into a handle
+
+int ReadARFhandle(char *filename, long ARFnumber, struct ARFhandle *handle)
+{
+  return (int)handle->object.read((string)filename, (Integer)ARFnumber);
+}
+
+// write the ARF in a handle to a FITS file
+
+int WriteARFhandle(char *filename, struct ARFhandle *handle)
+{
+  return (int)handle->object.write((string)filename);
+}
+
+// set up a read-only view of the arrays in the ARF handle
+
+void ViewARFhandle(struct ARFhandle *handle, struct ARFview *view)
+{
+  arf& ea = handle->object;
+
+  view->NumberEnergyBins = ea.LowEnergy.size();
+  view->LowEnergy = ea.LowEnergy.size() > 0 ? &ea.LowEnergy[0] : NULL;
+  view->HighEnergy = ea.HighEnergy.size() > 0 ? &ea.HighEnergy[0] : NULL;
+  view->EffArea = ea.EffArea.size() > 0 ? &ea.EffArea[0] : NULL;
+
+  return;
+}
+
+// copy between an ARF structure and an ARF handle
+
+void ARFstructToHandle(struct ARF *arfstruct, struct ARFhandle *handle)
+{
+  ARFstructToObject(arfstruct, handle->object);
+  return;
+}
+
+void ARFhandleToStruct(struct ARFhandle *handle, struct ARF *arfstruct)
+{
+  ARFobjectToStruct(handle->object, arfstruct);
+  return;
+}
+
+// write information about the ARF in a handle to stdout
+
+void DisplayARFhandle(struct ARFhandle *handle)
+{
+  cout << handle->object.disp();
+  return;
+}
+
+// read the type I PHA extension from a FITS file into a handle
+
+int ReadPHAhandle(char *filename, long PHAnumber, struct PHAhandle *handle)
+{
+  return (int)handle->object.read((string)filename, (Integer)PHAnumber);
+}
+
+// write the spectrum in a handle to a FITS file
+
+int WritePHAhandle(char *filename, struct PHAhandle *handle)
+{
+  return (int)handle->object.write((string)filename);
+}
+
+// set up a read-only view of the arrays in the PHA handle
+
+void ViewPHAhandle(struct PHAhandle *handle, struct PHAview *view)
+{
+  pha& spectrum = handle->object;
+
+  view->NumberChannels = spectrum.Pha.size();
+  view->FirstChannel = spectrum.FirstChannel;
+
+  view->Pha = spectrum.Pha.size() > 0 ? &spectrum.Pha[0] : NULL;
+  view->StatError = spectrum.StatError.size() > 0 ? &spectrum.StatError[0] : NULL;
+  view->SysError = spectrum.SysError.size() > 0 ? &spectrum.SysError[0] : NULL;
+
+  view->Quality = spectrum.Quality.size() > 0 ? &spectrum.Quality[0] : NULL;
+  view->Grouping = spectrum.Group.size() > 0 ? &spectrum.Group[0] : NULL;
+  view->Channel = spectrum.Channel.size() > 0 ? &spectrum.Channel[0] : NULL;
+
+  view->NumberAreaScaling = spectrum.AreaScaling.size();
+  view->AreaScaling = spectrum.AreaScaling.size() > 0 ? &spectrum.AreaScaling[0] : NULL;
+  view->NumberBackScaling = spectrum.BackScaling.size();
+  view->BackScaling = spectrum.BackScaling.size() > 0 ? &spectrum.BackScaling[0] : NULL;
+
+  view->Exposure = spectrum.Exposure;
+  view->CorrectionScaling = spectrum.CorrectionScaling;
+
+  return;
+}
+
+// copy between a PHA structure and a PHA handle
+
+void PHAstructToHandle(struct PHA *phastruct, struct PHAhandle *handle)
+{
+  PHAstructToObject(phastruct, handle->object);
+  return;
+}
+
+void PHAhandleToStruct(struct PHAhandle *handle, struct PHA *phastruct)
+{
+  PHAobjectToStruct(handle->object, phastruct);
+  return;
+}
+
+// write information about the spectrum in a handle to stdout
+
+void DisplayPHAhandle(struct PHAhandle *handle)
+{
+  cout << handle->object.disp();
+  return;
+}
+
+// rebin the spectrum in a handle
+
+int RebinPHAhandle(struct PHAhandle *handle, struct BinFactors *bin)
+{
+  pha& spectrum = handle->object;
+
+  grouping inGrouping;
+  Integer Status = BinFactorsToGrouping(bin, spectrum.NumberChannels(), spectrum.FirstChannel,
+					inGrouping);
+  if ( Status != 0 ) return (int)Status;
+
+  return (int)spectrum.rebinChannels(inGrouping);
+}
+
 // *******************************************************************************************
 // conversion routines
 
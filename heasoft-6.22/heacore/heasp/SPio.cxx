@@ -70,7 +70,7 @@ template<class T> T SPreadKey(ExtHDU& ext, string KeyName, Integer RowNumber, T
 
   try {
     vector<T> Data;
-    ext.column(KeyName).read(Data,RowNumber,1);
+    ext.column(KeyName).read(Data,RowNumber,RowNumber);
     keyValue = Data[0];
   } catch (CCfits::Table::NoSuchColumn&) {
     // No column so fall back to looking for a keyword called KeyName
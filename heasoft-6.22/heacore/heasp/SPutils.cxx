@@ -4,6 +4,8 @@
 #include "SPutils.h"
 #endif
 
+#include <pthread.h>
+
 // Arrays to store unit conversion information
 
 static size_t nValidXUnits = 8;
@@ -857,3 +859,60 @@ template void SPbisect(Integer&, Integer&, const vector<Real>&, const Real&, boo
 template void SPbisect(Integer&, Integer&, const RealArray&, const Real&, bool);
 template void SPbisect(Integer&, Integer&, const IntegerArray&, const Real&, bool);
 template void SPbisect(Integer&, Integer&, const valarray<Integer>&, const Real&, bool);
+
+// split the indices 0 to n-1 into NumberThreads contiguous ranges and run
+// work on each in its own thread
+
+struct SPparallelRange {
+  size_t first;
+  size_t last;
+  Integer thread;
+  void (*work)(size_t, size_t, Integer, void*);
+  void* data;
+};
+
+extern "C" {
+  static void* SPparallelStart(void* arg)
+  {
+    SPparallelRange* range = static_cast<SPparallelRange*>(arg);
+    range->work(range->first, range->last, range->thread, range->data);
+    return 0;
+  }
+}
+
+void SPparallelFor(const size_t n, const Integer NumberThreads,
+		   void (*work)(size_t first, size_t last, Integer thread, void* data),
+		   void* data)
+{
+  if ( n == 0 ) return;
+
+  size_t nthreads = NumberThreads > 1 ? (size_t)NumberThreads : 1;
+  if ( nthreads > n ) nthreads = n;
+
+  vector<SPparallelRange> ranges(nthreads);
+  for (size_t i=0; i<nthreads; i++) {
+    ranges[i].first = (n*i)/nthreads;
+    ranges[i].last = (n*(i+1))/nthreads - 1;
+    ranges[i].thread = i;
+    ranges[i].work = work;
+    ranges[i].data = data;
+  }
+
+  // the first range is done in this thread while the others run
+
+  vector<pthread_t> threads(nthreads);
+  vector<bool> started(nthreads, false);
+  for (size_t i=1; i<nthreads; i++) {
+    started[i] = pthread_create(&threads[i], NULL, SPparallelStart, &ranges[i]) == 0;
+  }
+  work(ranges[0].first, ranges[0].last, 0, data);
+  for (size_t i=1; i<nthreads; i++) {
+    if ( started[i] ) {
+      pthread_join(threads[i], NULL);
+    } else {
+      work(ranges[i].first, ranges[i].last, ranges[i].thread, data);
+    }
+  }
+
+  return;
+}
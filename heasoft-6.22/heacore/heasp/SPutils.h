@@ -146,3 +146,12 @@ template <class T> void SPfind(const T& array, const Real& target, Integer& inde
 
 template <class T> void SPbisect(Integer& lower, Integer& upper, const T& array,
 				 const Real& target, bool increasing);
+
+// split the indices 0 to n-1 into NumberThreads contiguous ranges and call
+// work(first, last, thread, data) for each range, thread numbering the ranges
+// from 0, each in its own thread. work must not throw. With NumberThreads <= 1,
+// or if a thread cannot be started, the ranges are done in the calling thread.
+
+void SPparallelFor(const size_t n, const Integer NumberThreads,
+		   void (*work)(size_t first, size_t last, Integer thread, void* data),
+		   void* data);
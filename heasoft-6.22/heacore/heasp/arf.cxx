@@ -393,7 +393,7 @@ arf& arf::operator+=(const arf& a)
 {
   // check that the ARF to be added is compatible
 
-  if ( !checkCompatibility(a) ) return *this;
+  if ( checkCompatibility(a) != OK ) return *this;
 
   // Sum effective areas
 
@@ -0,0 +1,124 @@
+/* Checks of the handle interface to heasp. Makes a small response and ARFs
+   in memory, merges a compatible and an incompatible ARF into the response
+   and folds a model through it. Returns 0 if all is well. */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "Cheasp.h"
+
+#define NE 3
+#define NCHAN 4
+
+int main(int argc, char **argv)
+{
+  struct RMF rmfstruct;
+  struct ARF arfstruct, badarfstruct;
+  struct RMFhandle *rmf;
+  struct ARFhandle *arf, *badarf;
+  struct RMFview view;
+
+  /* energy bin i responds in channels i and i+1 */
+
+  long NumberGroups[NE] = {1, 1, 1};
+  long FirstGroup[NE] = {0, 1, 2};
+  long FirstChannelGroup[NE] = {1, 2, 3};
+  long NumberChannelGroups[NE] = {2, 2, 2};
+  long FirstElement[NE] = {0, 2, 4};
+  float LowEnergy[NE] = {1.0, 2.0, 3.0};
+  float HighEnergy[NE] = {2.0, 3.0, 4.0};
+  float Matrix[2*NE] = {0.75, 0.25, 0.5, 0.5, 0.25, 0.75};
+  float ChannelLowEnergy[NCHAN] = {1.0, 2.0, 3.0, 4.0};
+  float ChannelHighEnergy[NCHAN] = {2.0, 3.0, 4.0, 5.0};
+  float EffArea[NE] = {10.0, 20.0, 30.0};
+
+  double model[NE] = {1.0, 2.0, 4.0};
+  double counts[NCHAN];
+  double expected[NCHAN] = {7.5, 22.5, 50.0, 90.0};
+  int nfail = 0;
+  int i, status;
+
+  memset(&rmfstruct, 0, sizeof(rmfstruct));
+  rmfstruct.NumberChannels = NCHAN;
+  rmfstruct.NumberEnergyBins = NE;
+  rmfstruct.NumberTotalGroups = NE;
+  rmfstruct.NumberTotalElements = 2*NE;
+  rmfstruct.FirstChannel = 1;
+  rmfstruct.isOrder = 0;
+  rmfstruct.NumberGroups = NumberGroups;
+  rmfstruct.FirstGroup = FirstGroup;
+  rmfstruct.FirstChannelGroup = FirstChannelGroup;
+  rmfstruct.NumberChannelGroups = NumberChannelGroups;
+  rmfstruct.FirstElement = FirstElement;
+  rmfstruct.LowEnergy = LowEnergy;
+  rmfstruct.HighEnergy = HighEnergy;
+  rmfstruct.Matrix = Matrix;
+  rmfstruct.ChannelLowEnergy = ChannelLowEnergy;
+  rmfstruct.ChannelHighEnergy = ChannelHighEnergy;
+  rmfstruct.AreaScaling = 1.0;
+  strcpy(rmfstruct.EnergyUnits, "keV");
+
+  memset(&arfstruct, 0, sizeof(arfstruct));
+  arfstruct.NumberEnergyBins = NE;
+  arfstruct.LowEnergy = LowEnergy;
+  arfstruct.HighEnergy = HighEnergy;
+  arfstruct.EffArea = EffArea;
+  strcpy(arfstruct.EnergyUnits, "keV");
+  strcpy(arfstruct.arfUnits, "cm^2");
+
+  /* the incompatible ARF is missing the last energy bin */
+
+  badarfstruct = arfstruct;
+  badarfstruct.NumberEnergyBins = NE-1;
+
+  rmf = NewRMFhandle();
+  arf = NewARFhandle();
+  badarf = NewARFhandle();
+  RMFstructToHandle(&rmfstruct, rmf);
+  ARFstructToHandle(&arfstruct, arf);
+  ARFstructToHandle(&badarfstruct, badarf);
+
+  status = MergeARFRMFhandle(badarf, rmf);
+  if ( status != -1 ) {
+    printf("MergeARFRMFhandle with incompatible ARF returned %d, not -1\n", status);
+    nfail++;
+  }
+  ViewRMFhandle(rmf, &view);
+  for (i=0; i<2*NE; i++) {
+    if ( view.Matrix[i] != Matrix[i] ) {
+      printf("Incompatible ARF changed matrix element %d to %g\n", i, view.Matrix[i]);
+      nfail++;
+    }
+  }
+
+  status = MergeARFRMFhandle(arf, rmf);
+  if ( status != 0 ) {
+    printf("MergeARFRMFhandle with compatible ARF returned %d, not 0\n", status);
+    nfail++;
+  }
+  ViewRMFhandle(rmf, &view);
+  for (i=0; i<2*NE; i++) {
+    if ( fabs(view.Matrix[i] - Matrix[i]*EffArea[i/2]) > 1.0e-6 ) {
+      printf("Matrix element %d is %g after merging ARF, not %g\n", i,
+	     view.Matrix[i], Matrix[i]*EffArea[i/2]);
+      nfail++;
+    }
+  }
+
+  /* channel c gets contributions from energies c-1 and c */
+
+  FoldRMFhandle(rmf, model, counts);
+  for (i=0; i<NCHAN; i++) {
+    if ( fabs(counts[i] - expected[i]) > 1.0e-6 ) {
+      printf("Folded counts in channel %d is %g, not %g\n", i, counts[i], expected[i]);
+      nfail++;
+    }
+  }
+
+  FreeRMFhandle(rmf);
+  FreeARFhandle(arf);
+  FreeARFhandle(badarf);
+
+  if ( nfail == 0 ) printf("handletest: all checks passed\n");
+  return nfail;
+}
@@ -0,0 +1,117 @@
+
+// Times folding models through a response with rmf::multiplyByModel and with
+// the rmfsparse layouts, for one model at a time and for batches of models.
+//
+// usage: rmffold [rmffile] [number of models] [number of threads]
+//
+// If no response file is given a gaussian response with 4096 channels and
+// 2000 energies is made.
+
+#include "rmf.h"
+#ifndef HAVE_rmfsparse
+#include "rmfsparse.h"
+#endif
+
+#include <sys/time.h>
+
+using namespace std;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1.0e-6*tv.tv_usec;
+}
+
+int main(int argc, char* argv[])
+{
+  rmf inputRMF;
+
+  if ( argc > 1 && string(argv[1]) != "-" ) {
+    Integer Status = inputRMF.read(string(argv[1]));
+    if ( Status != OK ) {
+      cout << "Failed to read " << argv[1] << endl;
+      exit(1);
+    }
+  } else {
+    Integer NumberChannels(4096), NumberEnergies(2000);
+    inputRMF.FirstChannel = 1;
+    inputRMF.ChannelLowEnergy.resize(NumberChannels);
+    inputRMF.ChannelHighEnergy.resize(NumberChannels);
+    for (Integer i=0; i<NumberChannels; i++) {
+      inputRMF.ChannelLowEnergy[i] = 0.1 + i*0.003;
+      inputRMF.ChannelHighEnergy[i] = 0.1 + (i+1)*0.003;
+    }
+    vector<Real> eLow(NumberEnergies), eHigh(NumberEnergies), sigma(1, 0.02);
+    for (Integer i=0; i<NumberEnergies; i++) {
+      eLow[i] = 0.2+i*0.005;
+      eHigh[i] = 0.2+(i+1)*0.005;
+    }
+    inputRMF.addGaussRows(eLow, eHigh, sigma, 1.0e-6);
+    inputRMF.compress(1.0e-6);
+  }
+
+  Integer NumberModels = argc > 2 ? atoi(argv[2]) : 16;
+  Integer NumberThreads = argc > 3 ? atoi(argv[3]) : 1;
+  if ( NumberModels < 1 ) NumberModels = 1;
+
+  size_t nE = inputRMF.NumberEnergyBins();
+  size_t nChan = inputRMF.NumberChannels();
+  cout << nE << " energies, " << nChan << " channels, "
+       << inputRMF.NumberTotalElements() << " elements" << endl;
+
+  vector<Real> models(nE*NumberModels);
+  for (size_t i=0; i<nE; i++) {
+    for (Integer k=0; k<NumberModels; k++) {
+      models[i*NumberModels+k] = 1.0/(1.0 + 0.01*i) + 0.1*k;
+    }
+  }
+
+  // the current routine, one model at a time
+
+  vector<Real> model(nE);
+  vector<vector<Real> > reference(NumberModels);
+  double start = now();
+  for (Integer k=0; k<NumberModels; k++) {
+    for (size_t i=0; i<nE; i++) model[i] = models[i*NumberModels+k];
+    reference[k] = inputRMF.multiplyByModel(model);
+  }
+  double tReference = now() - start;
+
+  // the sparse layouts
+
+  start = now();
+  rmfsparse sparse;
+  sparse.load(inputRMF);
+  sparse.NumberThreads = NumberThreads;
+  double tLoad = now() - start;
+
+  vector<Real> counts;
+  Real maxdiff(0.0);
+  start = now();
+  for (Integer k=0; k<NumberModels; k++) {
+    for (size_t i=0; i<nE; i++) model[i] = models[i*NumberModels+k];
+    sparse.fold(model, counts);
+    for (size_t j=0; j<nChan; j++) maxdiff = max(maxdiff, fabs(counts[j]-reference[k][j]));
+  }
+  double tSingle = now() - start;
+
+  vector<Real> batch;
+  start = now();
+  sparse.fold(models, NumberModels, batch);
+  double tBatch = now() - start;
+  for (Integer k=0; k<NumberModels; k++) {
+    for (size_t j=0; j<nChan; j++) {
+      maxdiff = max(maxdiff, fabs(batch[j*NumberModels+k]-reference[k][j]));
+    }
+  }
+
+  cout << NumberModels << " models, " << NumberThreads << " threads" << endl;
+  cout << "multiplyByModel     : " << tReference << " s" << endl;
+  cout << "rmfsparse load      : " << tLoad << " s" << endl;
+  cout << "rmfsparse fold      : " << tSingle << " s" << endl;
+  cout << "rmfsparse batch fold: " << tBatch << " s" << endl;
+  cout << "maximum difference  : " << maxdiff << endl;
+
+  exit(0);
+}
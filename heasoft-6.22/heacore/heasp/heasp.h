@@ -14,6 +14,7 @@
 #include <ctime>
 #include <valarray>
 #include <vector>
+#include <map>
 #include <algorithm>
 
 #include <CCfits/CCfits>
@@ -87,9 +87,6 @@ Integer pha::read(string filename, Integer PHAnumber, Integer SpectrumNumber)
 {
 
   const string hduName("SPECTRUM");
-  string DefString;
-  bool verbosity = FITS::verboseMode();
-
 
   // Read in the SPECTRUM extension number PHAnumber
   // and set up an object called spectrum with the contents
@@ -108,6 +105,19 @@ Integer pha::read(string filename, Integer PHAnumber, Integer SpectrumNumber)
   }
 
   ExtHDU& spectrum = pInfile->extension(hduName, (int)PHAnumber);
+
+  return(this->read(spectrum, SpectrumNumber));
+}
+
+// reading from an extension which has already been opened. For a type I
+// extension SpectrumNumber should be set to 1. Used by phaII and phaIIreader to
+// read many spectra without opening the file for each.
+
+Integer pha::read(ExtHDU& spectrum, Integer SpectrumNumber)
+{
+
+  string DefString;
+  bool verbosity = FITS::verboseMode();
   
   // read the standard keywords and store in the object
 
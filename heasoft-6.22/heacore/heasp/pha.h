@@ -73,6 +73,10 @@ class pha{
   Integer read(string filename, Integer PHAnumber);
   Integer read(string filename, Integer PHAnumber, Integer SpectrumNumber);
 
+  // read from a SPECTRUM extension which is already open
+
+  Integer read(ExtHDU& spectrum, Integer SpectrumNumber);
+
   // Deep copy
 
   pha& operator= (const pha&);
@@ -55,15 +55,34 @@ Integer phaII::read(string filename, Integer PHAnumber)
   return(this->read(filename, PHAnumber, SpectrumNumber));
 }
 
-// reading from PHA file.Somewhat inefficient but just reads each spectrum individually
+// reading from PHA file. The file is opened once and each spectrum read from
+// the extension in turn. For files with many spectra phaIIreader reads the
+// data columns in blocks without making pha objects.
 
 Integer phaII::read(string filename, Integer PHAnumber, vector<Integer> SpectrumNumber)
 {
   Integer Status(OK);
 
+  const string hduName("SPECTRUM");
+  const vector<string> hduKeys;
+  const vector<string> primaryKey;
+
+  auto_ptr<FITS> pInfile(0);
+
+  try {
+    pInfile.reset(new FITS(filename,Read,hduName,false,hduKeys,primaryKey,(int)PHAnumber));
+  } catch(...) {
+    string msg = "Failed to read "+hduName+" in "+filename;
+    SPreportError(NoSuchFile, msg);
+    return(NoSuchFile);
+  }
+
+  ExtHDU& spectrum = pInfile->extension(hduName, (int)PHAnumber);
+
+  phas.reserve(phas.size()+SpectrumNumber.size());
   for (size_t i=0; i<SpectrumNumber.size(); i++) {
     pha inpha;
-    Status = inpha.read(filename, PHAnumber, SpectrumNumber[i]);
+    Status = inpha.read(spectrum, SpectrumNumber[i]);
     if ( Status != OK ) return(Status);
     phas.push_back(inpha);
   }
@@ -0,0 +1,441 @@
+// phaIIreader object code. Definitions in phaIIreader.h
+
+#ifndef HAVE_phaIIreader
+#include "phaIIreader.h"
+#endif
+
+#ifndef HAVE_SPio
+#include "SPio.h"
+#endif
+
+// find a column and the number of elements in each row. Returns 0 if there
+// is no such column and -1 if it is a variable length array.
+
+static int phaIIreaderColumn(fitsfile* fptr, string name, long& repeat)
+{
+  int colnum(0), typecode(0), status(0);
+  long width;
+
+  repeat = 0;
+  fits_get_colnum(fptr, CASEINSEN, const_cast<char*>(name.c_str()), &colnum, &status);
+  if ( status != 0 ) {
+    fits_clear_errmsg();
+    return 0;
+  }
+  fits_get_coltype(fptr, colnum, &typecode, &repeat, &width, &status);
+  if ( status != 0 || typecode < 0 ) return -1;
+
+  return colnum;
+}
+
+// read nRows rows of a column starting at FirstRow giving nout values per row.
+// If the column has one value per row it is copied to all nout.
+
+template <class T> static void phaIIreaderRead(fitsfile* fptr, int datatype, int colnum,
+					      long repeat, long nout, Integer FirstRow,
+					      Integer nRows, T* out, int& status)
+{
+  if ( repeat == nout ) {
+    fits_read_col(fptr, datatype, colnum, FirstRow, 1, nRows*repeat, NULL, out, NULL, &status);
+  } else {
+    vector<T> values(nRows);
+    fits_read_col(fptr, datatype, colnum, FirstRow, 1, nRows, NULL, &values[0], NULL, &status);
+    for (size_t i=0; i<(size_t)nRows; i++) {
+      for (size_t j=0; j<(size_t)nout; j++) out[i*nout+j] = values[i];
+    }
+  }
+  return;
+}
+
+// Class phaIIreader
+
+// default constructor
+
+phaIIreader::phaIIreader()
+  : Filename(" "),
+    PHAnumber(1),
+    NumberSpectra(0),
+    NumberChannels(0),
+    BlockRows(0),
+    Datatype("COUNT"),
+    Rows(),
+    Pha(),
+    StatError(),
+    SysError(),
+    Quality(),
+    Group(),
+    Exposure(),
+    AreaScaling(),
+    BackScaling(),
+    pInfile(0),
+    NextRow(1),
+    PhaCol(0),
+    StatErrorCol(0),
+    SysErrorCol(0),
+    QualityCol(0),
+    GroupCol(0),
+    ExposureCol(0),
+    AreaScalingCol(0),
+    BackScalingCol(0),
+    StatErrorRepeat(0),
+    SysErrorRepeat(0),
+    QualityRepeat(0),
+    GroupRepeat(0),
+    AreaScalingRepeat(1),
+    BackScalingRepeat(1),
+    ExposureKey(0.0),
+    AreaScalingKey(1.0),
+    BackScalingKey(1.0)
+{
+}
+
+
+// Destructor
+
+phaIIreader::~phaIIreader()
+{
+  close();
+
+  // clear vectors with guaranteed reallocation
+  vector<Integer>().swap(Rows);
+  vector<Real>().swap(Pha);
+  vector<Real>().swap(StatError);
+  vector<Real>().swap(SysError);
+  vector<Integer>().swap(Quality);
+  vector<Integer>().swap(Group);
+  vector<Real>().swap(Exposure);
+  vector<Real>().swap(AreaScaling);
+  vector<Real>().swap(BackScaling);
+}
+
+// open the first SPECTRUM extension
+
+Integer phaIIreader::open(string filename)
+{
+  return(this->open(filename, 1));
+}
+
+// open the SPECTRUM extension with EXTVER=PHAnumber
+
+Integer phaIIreader::open(string filename, Integer inPHAnumber)
+{
+  this->clear();
+
+  const string hduName("SPECTRUM");
+  const vector<string> hduKeys;
+  const vector<string> primaryKey;
+
+  try {
+    pInfile = new FITS(filename,Read,hduName,false,hduKeys,primaryKey,(int)inPHAnumber);
+  } catch(...) {
+    pInfile = 0;
+    string msg = "Failed to read "+hduName+" in "+filename;
+    SPreportError(NoSuchFile, msg);
+    return(NoSuchFile);
+  }
+
+  Filename = filename;
+  PHAnumber = inPHAnumber;
+
+  ExtHDU& spectrum = pInfile->extension(hduName, (int)PHAnumber);
+  spectrum.makeThisCurrent();
+  fitsfile* fptr = pInfile->fitsPointer();
+
+  NumberSpectra = spectrum.rows();
+
+  // find the data columns
+
+  long repeat;
+  Datatype = "COUNT";
+  PhaCol = phaIIreaderColumn(fptr, "COUNTS", repeat);
+  if ( PhaCol == 0 ) {
+    Datatype = "RATE";
+    PhaCol = phaIIreaderColumn(fptr, "RATE", repeat);
+  }
+  if ( PhaCol <= 0 ) {
+    this->close();
+    string msg = "No fixed length COUNTS or RATE column in "+filename;
+    SPreportError(NoData, msg);
+    return(NoData);
+  }
+  NumberChannels = repeat;
+
+  // the columns with a value for each channel can also have a single value for
+  // each spectrum which applies to all channels
+
+  StatErrorCol = phaIIreaderColumn(fptr, "STAT_ERR", StatErrorRepeat);
+  bool bad = ( StatErrorCol != 0 && StatErrorRepeat != 1 && StatErrorRepeat != NumberChannels );
+  SysErrorCol = phaIIreaderColumn(fptr, "SYS_ERR", SysErrorRepeat);
+  bad = bad || ( SysErrorCol != 0 && SysErrorRepeat != 1 && SysErrorRepeat != NumberChannels );
+  QualityCol = phaIIreaderColumn(fptr, "QUALITY", QualityRepeat);
+  bad = bad || ( QualityCol != 0 && QualityRepeat != 1 && QualityRepeat != NumberChannels );
+  GroupCol = phaIIreaderColumn(fptr, "GROUPING", GroupRepeat);
+  bad = bad || ( GroupCol != 0 && GroupRepeat != 1 && GroupRepeat != NumberChannels );
+  ExposureCol = phaIIreaderColumn(fptr, "EXPOSURE", repeat);
+  bad = bad || ( ExposureCol != 0 && repeat != 1 );
+  AreaScalingCol = phaIIreaderColumn(fptr, "AREASCAL", AreaScalingRepeat);
+  bad = bad || ( AreaScalingCol != 0 && AreaScalingRepeat != 1 && AreaScalingRepeat != NumberChannels );
+  BackScalingCol = phaIIreaderColumn(fptr, "BACKSCAL", BackScalingRepeat);
+  bad = bad || ( BackScalingCol != 0 && BackScalingRepeat != 1 && BackScalingRepeat != NumberChannels );
+
+  if ( bad || StatErrorCol < 0 || SysErrorCol < 0 || QualityCol < 0 || GroupCol < 0 ||
+       ExposureCol < 0 || AreaScalingCol < 0 || BackScalingCol < 0 ) {
+    this->close();
+    string msg = "Data columns in "+filename+" do not have one value per channel or per spectrum";
+    SPreportError(InconsistentChannels, msg);
+    return(InconsistentChannels);
+  }
+
+  if ( AreaScalingCol == 0 ) AreaScalingRepeat = 1;
+  if ( BackScalingCol == 0 ) BackScalingRepeat = 1;
+
+  // and the keyword values to use if there is no column
+
+  ExposureKey = SPreadKey(spectrum, "EXPOSURE", (Real)0.0);
+  AreaScalingKey = SPreadKey(spectrum, "AREASCAL", (Real)1.0);
+  BackScalingKey = SPreadKey(spectrum, "BACKSCAL", (Real)1.0);
+
+  NextRow = 1;
+
+  return(OK);
+}
+
+// read the next block of spectra
+
+Integer phaIIreader::next()
+{
+  if ( pInfile == 0 ) {
+    SPreportError(NoData, "phaIIreader::next called with no file open");
+    return(NoData);
+  }
+
+  if ( NextRow > NumberSpectra ) {
+    Rows.clear();
+    return(NoData);
+  }
+
+  long nRows = BlockRows;
+  if ( nRows <= 0 ) {
+    int status(0);
+    pInfile->extension("SPECTRUM", (int)PHAnumber).makeThisCurrent();
+    fits_get_rowsize(pInfile->fitsPointer(), &nRows, &status);
+    if ( status != 0 || nRows <= 0 ) nRows = 1;
+  }
+  if ( nRows > NumberSpectra - NextRow + 1 ) nRows = NumberSpectra - NextRow + 1;
+
+  Rows.resize(nRows);
+  for (size_t i=0; i<(size_t)nRows; i++) Rows[i] = NextRow + i;
+
+  Integer Status = this->readBlock(NextRow, nRows, 0);
+  NextRow += nRows;
+
+  return(Status);
+}
+
+// start again from the first spectrum
+
+void phaIIreader::reset()
+{
+  NextRow = 1;
+  Rows.clear();
+  return;
+}
+
+// read the listed spectra into the block, using one read for each run of
+// consecutive spectra
+
+Integer phaIIreader::readRows(const vector<Integer>& SpectrumNumber)
+{
+  if ( pInfile == 0 ) {
+    SPreportError(NoData, "phaIIreader::readRows called with no file open");
+    return(NoData);
+  }
+
+  for (size_t i=0; i<SpectrumNumber.size(); i++) {
+    if ( SpectrumNumber[i] < 1 || SpectrumNumber[i] > NumberSpectra ) {
+      ostringstream msg;
+      msg << "Spectrum " << SpectrumNumber[i] << " is not in " << Filename;
+      SPreportError(NoData, msg.str());
+      return(NoData);
+    }
+  }
+
+  Rows = SpectrumNumber;
+
+  size_t first(0);
+  while ( first < Rows.size() ) {
+    size_t last(first);
+    while ( last+1 < Rows.size() && Rows[last+1] == Rows[last]+1 ) last++;
+    Integer Status = this->readBlock(Rows[first], last-first+1, first);
+    if ( Status != OK ) return(Status);
+    first = last + 1;
+  }
+
+  return(OK);
+}
+
+// read a set of consecutive spectra into the block starting at block index k.
+// the arrays are sized for the number of spectra in Rows.
+
+Integer phaIIreader::readBlock(const Integer FirstRow, const Integer nRows, const size_t k)
+{
+  const size_t n = Rows.size();
+  const long nChan = NumberChannels;
+
+  Pha.resize(n*nChan);
+  StatError.resize(StatErrorCol > 0 ? n*nChan : 0);
+  SysError.resize(SysErrorCol > 0 ? n*nChan : 0);
+  Quality.resize(QualityCol > 0 ? n*nChan : 0);
+  Group.resize(GroupCol > 0 ? n*nChan : 0);
+  Exposure.resize(n);
+  AreaScaling.resize(n*AreaScalingRepeat);
+  BackScaling.resize(n*BackScalingRepeat);
+
+  pInfile->extension("SPECTRUM", (int)PHAnumber).makeThisCurrent();
+  fitsfile* fptr = pInfile->fitsPointer();
+  int status(0);
+
+  phaIIreaderRead(fptr, TDOUBLE, PhaCol, nChan, nChan, FirstRow, nRows, &Pha[k*nChan], status);
+  if ( StatErrorCol > 0 ) {
+    phaIIreaderRead(fptr, TDOUBLE, StatErrorCol, StatErrorRepeat, nChan, FirstRow, nRows, &StatError[k*nChan], status);
+  }
+  if ( SysErrorCol > 0 ) {
+    phaIIreaderRead(fptr, TDOUBLE, SysErrorCol, SysErrorRepeat, nChan, FirstRow, nRows, &SysError[k*nChan], status);
+  }
+  if ( QualityCol > 0 ) {
+    phaIIreaderRead(fptr, TINT, QualityCol, QualityRepeat, nChan, FirstRow, nRows, &Quality[k*nChan], status);
+  }
+  if ( GroupCol > 0 ) {
+    phaIIreaderRead(fptr, TINT, GroupCol, GroupRepeat, nChan, FirstRow, nRows, &Group[k*nChan], status);
+  }
+
+  if ( ExposureCol > 0 ) {
+    phaIIreaderRead(fptr, TDOUBLE, ExposureCol, 1, 1, FirstRow, nRows, &Exposure[k], status);
+  } else {
+    for (size_t i=0; i<(size_t)nRows; i++) Exposure[k+i] = ExposureKey;
+  }
+  if ( AreaScalingCol > 0 ) {
+    phaIIreaderRead(fptr, TDOUBLE, AreaScalingCol, AreaScalingRepeat, AreaScalingRepeat,
+		    FirstRow, nRows, &AreaScaling[k*AreaScalingRepeat], status);
+  } else {
+    for (size_t i=0; i<(size_t)nRows; i++) AreaScaling[k+i] = AreaScalingKey;
+  }
+  if ( BackScalingCol > 0 ) {
+    phaIIreaderRead(fptr, TDOUBLE, BackScalingCol, BackScalingRepeat, BackScalingRepeat,
+		    FirstRow, nRows, &BackScaling[k*BackScalingRepeat], status);
+  } else {
+    for (size_t i=0; i<(size_t)nRows; i++) BackScaling[k+i] = BackScalingKey;
+  }
+
+  if ( status != 0 ) {
+    ostringstream msg;
+    msg << "Failed to read spectra " << FirstRow << " to " << FirstRow+nRows-1
+	<< " from " << Filename;
+    SPreportError(NoData, msg.str());
+    return(NoData);
+  }
+
+  return(OK);
+}
+
+// make the full pha object for spectrum k of the block. This reads the
+// keywords and columns for that spectrum from the open extension.
+
+Integer phaIIreader::getPha(const Integer k, pha& spectrum)
+{
+  if ( pInfile == 0 || k < 0 || k >= (Integer)Rows.size() ) {
+    SPreportError(NoData, "phaIIreader::getPha called for a spectrum not in the block");
+    return(NoData);
+  }
+
+  spectrum.clear();
+  ExtHDU& ext = pInfile->extension("SPECTRUM", (int)PHAnumber);
+  return(spectrum.read(ext, Rows[k]));
+}
+
+// Return information
+
+Integer phaIIreader::NumberRows()                 // Number of spectra in the block
+{
+  return Rows.size();
+}
+
+Integer phaIIreader::AreaScalingSize()            // Number of AreaScaling values per spectrum
+{
+  return AreaScalingRepeat;
+}
+
+Integer phaIIreader::BackScalingSize()            // Number of BackScaling values per spectrum
+{
+  return BackScalingRepeat;
+}
+
+// close the file
+
+void phaIIreader::close()
+{
+  delete pInfile;
+  pInfile = 0;
+  return;
+}
+
+// Display information about the object - return as a string
+
+string phaIIreader::disp()
+{
+  ostringstream outstr;
+
+  outstr << "Type II spectrum reader information : " << endl;
+
+  outstr << "   Filename            = " << Filename << endl;
+  outstr << "   PHAnumber           = " << PHAnumber << endl;
+  outstr << "   NumberSpectra       = " << NumberSpectra << endl;
+  outstr << "   NumberChannels      = " << NumberChannels << endl;
+  outstr << "   BlockRows           = " << BlockRows << endl;
+  outstr << "   Datatype            = " << Datatype << endl;
+  outstr << "   NumberRows          = " << NumberRows() << endl;
+
+  if ( Pha.size() > 1 ) outstr << "   Pha array of size " << Pha.size() << endl;
+  if ( StatError.size() > 1 ) outstr << "   StatError array of size " << StatError.size() << endl;
+  if ( SysError.size() > 1 ) outstr << "   SysError array of size " << SysError.size() << endl;
+  if ( Quality.size() > 1 ) outstr << "   Quality array of size " << Quality.size() << endl;
+  if ( Group.size() > 1 ) outstr << "   Group array of size " << Group.size() << endl;
+  if ( Exposure.size() > 1 ) outstr << "   Exposure array of size " << Exposure.size() << endl;
+  if ( AreaScaling.size() > 1 ) outstr << "   AreaScaling array of size " << AreaScaling.size() << endl;
+  if ( BackScaling.size() > 1 ) outstr << "   BackScaling array of size " << BackScaling.size() << endl;
+
+  return outstr.str();
+}
+
+// Clear information from the object
+
+void phaIIreader::clear()
+{
+  this->close();
+
+  Filename = " ";
+  PHAnumber = 1;
+  NumberSpectra = 0;
+  NumberChannels = 0;
+  Datatype = "COUNT";
+
+  Rows.clear();
+  Pha.clear();
+  StatError.clear();
+  SysError.clear();
+  Quality.clear();
+  Group.clear();
+  Exposure.clear();
+  AreaScaling.clear();
+  BackScaling.clear();
+
+  NextRow = 1;
+  PhaCol = StatErrorCol = SysErrorCol = QualityCol = GroupCol = 0;
+  ExposureCol = AreaScalingCol = BackScalingCol = 0;
+  StatErrorRepeat = SysErrorRepeat = QualityRepeat = GroupRepeat = 0;
+  AreaScalingRepeat = BackScalingRepeat = 1;
+  ExposureKey = 0.0;
+  AreaScalingKey = BackScalingKey = 1.0;
+
+  return;
+}
@@ -0,0 +1,123 @@
+// Class definitions for phaIIreader object - reads the spectra of a type II
+// PHA extension a block of rows at a time
+
+#ifndef HAVE_HEASP
+#include "heasp.h"
+#endif
+
+#ifndef HAVE_pha
+#include "pha.h"
+#endif
+
+#define HAVE_phaIIreader 1
+
+// The phaIIreader keeps the SPECTRUM extension open and reads the data columns
+// for a block of spectra with one cfitsio call per column, either stepping
+// through the extension with next() or for a list of spectra with readRows().
+// The data for the current block are held in arrays with the values for each
+// spectrum following on from those of the previous one so for a column with
+// n elements per spectrum, element i of spectrum k of the block is element
+// k*n+i. Array columns which are not in the extension (because the value is
+// given by a keyword or defaulted) are left empty apart from Exposure,
+// AreaScaling and BackScaling which are filled from the keyword. A full pha
+// object can be made for any spectrum in the block using getPha().
+
+class phaIIreader{
+ public:
+
+  string Filename;                      // File being read
+  Integer PHAnumber;                    // EXTVER of the SPECTRUM extension
+  Integer NumberSpectra;                // Number of spectra in the extension
+  Integer NumberChannels;               // Number of channels in each spectrum
+  Integer BlockRows;                    // Maximum number of spectra to read at
+                                        // once, 0 to use the cfitsio buffer size
+  string Datatype;                      // "COUNT" or "RATE"
+
+  // the current block
+
+  vector<Integer> Rows;                 // Spectrum numbers (counting from 1)
+  vector<Real> Pha;                     // COUNTS or RATE
+  vector<Real> StatError;               // Statistical error
+  vector<Real> SysError;                // Systematic error
+  vector<Integer> Quality;              // Data quality
+  vector<Integer> Group;                // Data grouping
+  vector<Real> Exposure;                // Exposure time, one per spectrum
+  vector<Real> AreaScaling;             // Area scaling factor, one per spectrum
+                                        // or NumberChannels per spectrum
+  vector<Real> BackScaling;             // Background scaling factor, as AreaScaling
+
+  // constructor
+
+  phaIIreader();
+
+  // destructor
+
+  ~phaIIreader();
+
+  // open the SPECTRUM extension with EXTVER=PHAnumber (1 if not given)
+
+  Integer open(string filename);
+  Integer open(string filename, Integer PHAnumber);
+
+  // read the next block of spectra. Returns OK if any were read and NoData
+  // when there are none left.
+
+  Integer next();
+
+  // start again from the first spectrum
+
+  void reset();
+
+  // read the listed spectra (counting from 1) into the block
+
+  Integer readRows(const vector<Integer>& SpectrumNumber);
+
+  // make the full pha object for spectrum k (counting from 0) of the block
+
+  Integer getPha(const Integer k, pha& spectrum);
+
+  // Return information
+
+  Integer NumberRows();                 // Number of spectra in the block
+  Integer AreaScalingSize();            // Number of AreaScaling values per spectrum
+  Integer BackScalingSize();            // Number of BackScaling values per spectrum
+
+  // close the file
+
+  void close();
+
+  // Display information about the object - return as a string
+
+  string disp();
+
+  // Clear information from the object
+
+  void clear();
+
+ private:
+
+  FITS* pInfile;                        // The open file
+  Integer NextRow;                      // First spectrum to be read by next()
+
+  // column numbers and number of elements per row for the data columns, 0 if
+  // the column is not in the extension
+
+  int PhaCol, StatErrorCol, SysErrorCol, QualityCol, GroupCol;
+  int ExposureCol, AreaScalingCol, BackScalingCol;
+  long StatErrorRepeat, SysErrorRepeat, QualityRepeat, GroupRepeat;
+  long AreaScalingRepeat, BackScalingRepeat;
+
+  // the keyword values for Exposure, AreaScaling and BackScaling
+
+  Real ExposureKey, AreaScalingKey, BackScalingKey;
+
+  // read a set of consecutive spectra into the block starting at block index k
+
+  Integer readBlock(const Integer FirstRow, const Integer nRows, const size_t k);
+
+  // not copyable
+
+  phaIIreader(const phaIIreader&);
+  phaIIreader& operator=(const phaIIreader&);
+
+};
@@ -24,6 +24,156 @@
 #include "SPutils.h"
 #endif
 
+// read an integer column of a MATRIX extension, which may be a scalar, fixed
+// length vector or variable length array column, into a single array with the
+// values for each row following on from those of the previous row. RowStart
+// gives the position of the first value for each row and has a final element
+// for the total. Returns false if there is no such column or it cannot be read.
+
+static bool rmfReadIntegerColumn(fitsfile* fptr, string name, long Nrows,
+				 vector<Integer>& values, vector<long>& RowStart,
+				 int& status)
+{
+  int colnum(0), typecode(0), tstatus(0);
+  long repeat, width;
+
+  if ( fits_get_colnum(fptr, CASEINSEN, const_cast<char*>(name.c_str()), &colnum, &tstatus) ) {
+    fits_clear_errmsg();
+    return false;
+  }
+  fits_get_coltype(fptr, colnum, &typecode, &repeat, &width, &status);
+
+  RowStart.resize(Nrows+1);
+  RowStart[0] = 0;
+
+  if ( typecode < 0 ) {
+    vector<long> lengths(Nrows), offsets(Nrows);
+    if ( Nrows > 0 ) fits_read_descripts(fptr, colnum, 1, Nrows, &lengths[0], &offsets[0], &status);
+    for (size_t i=0; i<(size_t)Nrows; i++) RowStart[i+1] = RowStart[i] + lengths[i];
+    values.resize(RowStart[Nrows]);
+    for (size_t i=0; i<(size_t)Nrows; i++) {
+      if ( lengths[i] > 0 ) {
+	fits_read_col(fptr, TINT, colnum, i+1, 1, lengths[i], NULL, &values[RowStart[i]], NULL, &status);
+      }
+    }
+  } else {
+    for (size_t i=0; i<(size_t)Nrows; i++) RowStart[i+1] = RowStart[i] + repeat;
+    values.resize(RowStart[Nrows]);
+    if ( values.size() > 0 ) {
+      fits_read_col(fptr, TINT, colnum, 1, 1, values.size(), NULL, &values[0], NULL, &status);
+    }
+  }
+
+  return ( status == 0 );
+}
+
+// write a column of a MATRIX extension with Number[i] values for row i taken
+// from values starting at First[i].
+
+template <class T> static void rmfWriteColumn(fitsfile* fptr, int datatype, int colnum,
+					     const vector<Integer>& First,
+					     const vector<Integer>& Number,
+					     vector<T>& values, int& status)
+{
+  for (size_t i=0; i<Number.size(); i++) {
+    if ( Number[i] > 0 && (size_t)(First[i]+Number[i]) <= values.size() ) {
+      fits_write_col(fptr, datatype, colnum, i+1, 1, Number[i], &values[First[i]], &status);
+    }
+  }
+  return;
+}
+
+// calculate the response for some energy given a gaussian width over the
+// range of channels for which it is above threshold. Values[k] is the response
+// in channel First+k and the response is zero in all other channels.
+
+static void calcGaussRespWindow(const Real sigma, const Real energy, const Real threshold, 
+				const vector<Real>& ChannelLowEnergy, 
+				const vector<Real>& ChannelHighEnergy, 
+				size_t& First, vector<Real>& Values)
+{
+
+  Real winv = 1.0/sigma/sqrt(2.0);
+  int N = ChannelLowEnergy.size();
+  Values.clear();
+
+  // find the channel containing the energy
+
+  int icen = binarySearch(energy, ChannelLowEnergy, ChannelHighEnergy);
+
+  // first do the case of zero line width
+
+  if ( sigma <= 0.0 ) {
+    First = icen;
+    Values.push_back(1.0);
+    return;
+  }
+
+  // if the line center is below the first bin then don't calculate the lower
+  // part of the line. If the line center is above the last bin then just calculate
+  // the part of the line within the energy range
+
+  if ( energy < ChannelLowEnergy[0] ) {
+    icen = 0;
+  } else if ( energy > ChannelHighEnergy[N-1] ) {
+    icen = N-1;
+  }
+
+  // Do the low energy part of the line. The values are stored going down in
+  // channel and reversed afterwards.
+
+  int ielow(icen);
+  Real alow(0.0);
+  Real ahi;
+
+  while ( ielow >= 0 ) {
+    ahi = erf(winv*(fabs(ChannelLowEnergy[ielow]-energy)));
+    Real fract = (ahi-alow)/2;
+    if ( fract >= threshold || ielow == icen ) {
+      Values.push_back(fract);
+    } else {
+      ielow = 0;
+    }
+    alow = ahi;
+    ielow -= 1;
+  }
+  First = icen + 1 - Values.size();
+  reverse(Values.begin(), Values.end());
+
+  // If the line center is above the last bin then don't calculate the upper
+  // part of the line. If line center is below the first bin then just calculate
+  // the part of the line within energy range
+
+  if ( energy < ChannelLowEnergy[0] ) {
+    icen = 1;
+  } else if ( energy > ChannelHighEnergy[N-1] ) {
+    icen = N + 1;
+  }
+
+  // Do the high energy part of the line. The line center channel is the last
+  // one of the low energy part so the two are added there.
+
+  ielow = icen;
+  alow = 0.0;
+  while ( ielow <= N-1 ) {
+    ahi = erf(winv*(fabs(ChannelHighEnergy[ielow]-energy)));
+    Real fract = (ahi-alow)/2;
+    if ( fract >= threshold || ielow == icen ) {
+      if ( (size_t)ielow < First + Values.size() ) {
+	Values[ielow-First] += fract;
+      } else {
+	Values.push_back(fract);
+      }
+    } else {
+      ielow = N;
+    }
+    alow = ahi;
+    ielow += 1;
+  }
+
+  return;
+}
+
 // Class rmf
 
 // default constructor
@@ -313,35 +463,39 @@ Integer rmf::readMatrix(string filename, Integer RMFnumber)
   }
   NtotGroups = Ntest;
 
-  // Read the first channel and number of channels for each group - grab the whole data 
-  // into temporary arrays then place in object. Also set the FirstElement array.
+  // Read the first channel and number of channels for each group straight from
+  // the file into flat arrays, fchanStart giving the position of the first
+  // value for each row. Then place them in the object and set the FirstElement
+  // array.
+
+  rmf.makeThisCurrent();
+  fitsfile* fptr = pInfile->fitsPointer();
+  int status(0);
 
-  vector<vector<Integer> > fchan, nchan;
+  vector<Integer> fchan, nchan;
+  vector<long> fchanStart, nchanStart;
 
-  SPreadVectorCol(rmf, "F_CHAN", fchan);
-  SPreadVectorCol(rmf, "N_CHAN", nchan);
-  if ( fchan.size() == 0 ) {
+  if ( !rmfReadIntegerColumn(fptr, "F_CHAN", Nrows, fchan, fchanStart, status) ) {
     string msg = "Failed to read any entries from the F_CHAN column";
     SPreportError(NoFchan, msg);
     return(NoFchan);
   }
-  if ( nchan.size() == 0 ) {
+  if ( !rmfReadIntegerColumn(fptr, "N_CHAN", Nrows, nchan, nchanStart, status) ) {
     string msg = "Failed to read any entries from the N_CHAN column";
     SPreportError(NoNchan, msg);
     return(NoNchan);
   }
 
-
   FirstChannelGroup.resize(NtotGroups);
   NumberChannelsGroup.resize(NtotGroups);
   FirstElement.resize(NtotGroups);
   size_t ipt = 0;
   size_t ielt = 0;
   for (size_t i=0; i<(size_t)Nrows; i++) {
-    for (size_t j=0; j<(size_t)fchan[i].size(); j++) {
-      if ( nchan[i][j] > 0 ) {
-	FirstChannelGroup[ipt] = fchan[i][j];
-	NumberChannelsGroup[ipt] = nchan[i][j];
+    for (long j=fchanStart[i], k=nchanStart[i]; j<fchanStart[i+1]; j++, k++) {
+      if ( nchan[k] > 0 && ipt < (size_t)NtotGroups ) {
+	FirstChannelGroup[ipt] = fchan[j];
+	NumberChannelsGroup[ipt] = nchan[k];
 	FirstElement[ipt] = ielt;
 	ielt += NumberChannelsGroup[ipt];
 	ipt++;
@@ -377,54 +531,58 @@ Integer rmf::readMatrix(string filename, Integer RMFnumber)
   }
   NtotElts = Ntest;
 
-  // Read the matrix column into a temporary array then set the Matrix array
-  // We have to be a bit careful here in case the file was created using fixed
-  // length vectors. In this case the total size of the elements matrix read
-  // will be larger than NtotElts with zero padding to the right in each row.
-  // Use nchan to ensure we only load the required elements into Matrix.
+  // Read the matrix column straight into the Matrix array, one call for each
+  // row. We have to be a bit careful here in case the file was created using
+  // fixed length vectors. In this case each row will be longer than the number
+  // of elements with zero padding to the right. Use nchan to ensure we only
+  // load the required elements into Matrix.
 
-  vector<vector<Real> > elements;
-  SPreadVectorCol(rmf, "MATRIX", elements);
-  if ( elements.size() == 0 ) {
+  int matrixCol(0);
+  char matrixName[] = "MATRIX";
+  if ( fits_get_colnum(fptr, CASEINSEN, matrixName, &matrixCol, &status) ) {
     string msg = "Failed to read any entries from the MATRIX column";
     SPreportError(NoMatrix, msg);
     return(NoMatrix);
   }
-  
+
   Matrix.resize(NtotElts);
   ipt = 0;
   for (size_t i=0; i<(size_t)Nrows; i++) {
-    Integer NtoRead(0);
-    for (size_t j=0; j<nchan[i].size(); j++) NtoRead += nchan[i][j];
-    for (size_t j=0; j<(size_t)NtoRead; j++) {
-      Matrix[ipt++] = elements[i][j];
+    long NtoRead(0);
+    for (long k=nchanStart[i]; k<nchanStart[i+1]; k++) NtoRead += nchan[k];
+    if ( NtoRead > (long)(NtotElts - ipt) ) NtoRead = NtotElts - ipt;
+    if ( NtoRead > 0 ) {
+      fits_read_col(fptr, TDOUBLE, matrixCol, i+1, 1, NtoRead, NULL, &Matrix[ipt], NULL, &status);
+      ipt += NtoRead;
     }
   }
+  if ( status != 0 ) {
+    string msg = "Failed to read the MATRIX column";
+    SPreportError(NoMatrix, msg);
+    return(NoMatrix);
+  }
 
   SPreadColUnits(rmf, "MATRIX", RMFUnits);
 
-  // Read the optional order information
-
-  vector<vector<Integer> > order;
-  try {
-    FITS::setVerboseMode(false);
-    SPreadVectorCol(rmf, "ORDER", order);
-  } catch (...) {
-  }
-
-  FITS::clearErrors();
-  FITS::setVerboseMode(verbosity);
+  // Read the optional order information, taking the values for the same groups
+  // as for F_CHAN and N_CHAN
 
-  if ( order.size() > 0 ) {
+  vector<Integer> order;
+  vector<long> orderStart;
+  if ( rmfReadIntegerColumn(fptr, "ORDER", Nrows, order, orderStart, status) &&
+       status == 0 ) {
     OrderGroup.resize(NtotGroups);
     ipt = 0;
     for (size_t i=0; i<(size_t)Nrows; i++) {
-      for (size_t j=0; j<(size_t)NumberGroups[i]; j++) {
-	OrderGroup[ipt++] = order[j][i];
+      for (long j=orderStart[i], k=nchanStart[i]; j<orderStart[i+1] && k<nchanStart[i+1]; j++, k++) {
+	if ( nchan[k] > 0 && ipt < (size_t)NtotGroups ) OrderGroup[ipt++] = order[j];
       }
     }
   }
 
+  FITS::clearErrors();
+  FITS::setVerboseMode(verbosity);
+
   return(OK);
 }
 
@@ -680,6 +838,12 @@ vector<Integer> rmf::RandomChannels(const vector<Real>& energy, const vector<Int
   Real Emin = LowEnergy[0];
   Real Emax = HighEnergy[HighEnergy.size()-1];
 
+  // seed the random numbers once for all the energies so they are not
+  // repeated for each energy. use rmfsampler for reproducible sequences.
+
+  unsigned long int seed = (unsigned long int)time(NULL);
+  HDmtInit(seed);
+
   for (size_t i=0; i<energy.size(); i++) {
 
     // trap the case of the energy being outside the response range
@@ -719,10 +883,7 @@ vector<Integer> rmf::RandomChannels(const vector<Real>& energy, const vector<Int
       // generate random numbers between 0 and 1
 
       vector<Real> RandomNumber(NumberPhotons[i]);
-      unsigned long int seed = (unsigned long int)time(NULL);
-      HDmtInit(seed);
       for (size_t j=0; j<(size_t)RandomNumber.size(); j++) RandomNumber[j] = (Real) HDmtDrand();
-      HDmtFree();
 
       // loop round the photons
 
@@ -774,6 +935,8 @@ vector<Integer> rmf::RandomChannels(const vector<Real>& energy, const vector<Int
 
   }
 
+  HDmtFree();
+
   return channel;
 }
 
@@ -1624,42 +1787,24 @@ Integer rmf::writeMatrix(string filename)
     if ( NumElts > MaxElts ) MaxElts = NumElts;
   }
 
-  // set up the fchan and nchan vector arrays
-
-  vector<vector<Integer> > fchan(Nrows), nchan(Nrows);
-  for (size_t i=0; i<(size_t)Nrows; i++) {
-    fchan[i].resize(NumberGroups[i]);
-    nchan[i].resize(NumberGroups[i]);
-    for (size_t j=0; j<(size_t)NumberGroups[i]; j++) {
-      fchan[i][j] = FirstChannelGroup[j+FirstGroup[i]];
-      nchan[i][j] = NumberChannelsGroup[j+FirstGroup[i]];
-    }
-  }
-
-  // set up the array of matrix elements
+  // F_CHAN, N_CHAN and ORDER need to be vector columns unless every row has one
+  // group and MATRIX unless every row has one element. The ORDER is only needed
+  // as a column if it varies, otherwise it is written as a keyword.
 
-  vector<vector<Real> > elements(Nrows);
+  bool groupVector(false), eltVector(false);
   for (size_t i=0; i<(size_t)Nrows; i++) {
+    if ( NumberGroups[i] != 1 ) groupVector = true;
     Integer NumElts=0;
     for (size_t j=0; j<(size_t)NumberGroups[i]; j++) {
       NumElts += NumberChannelsGroup[j+FirstGroup[i]];
     }
-    elements[i].resize(NumElts);
-    for (size_t j=0; j<(size_t)NumElts; j++) {
-      elements[i][j] = Matrix[j+FirstElement[FirstGroup[i]]];
-    }
+    if ( NumElts != 1 ) eltVector = true;
   }
 
-  // if required set up the order vector array
-
-  vector<vector<Integer> > order;
-  if ( OrderGroup.size() > 0 ) {
-    order.resize(Nrows);
-    for (size_t i=0; i<(size_t)Nrows; i++) { 
-      order[i].resize(NumberGroups[i]);
-      for (size_t j=0; j<(size_t)NumberGroups[i]; j++) {
-	order[i][j] = OrderGroup[j+FirstGroup[i]];
-      }
+  bool orderCol(groupVector);
+  if ( OrderGroup.size() > 0 && !orderCol ) {
+    for (size_t i=1; i<(size_t)Nrows; i++) {
+      if ( OrderGroup[FirstGroup[i]] != OrderGroup[FirstGroup[0]] ) orderCol = true;
     }
   }
 
@@ -1682,11 +1827,8 @@ Integer rmf::writeMatrix(string filename)
   RepeatStream << MaxGroups;
   string Repeat(RepeatStream.str());
 
-  bool isvector, needCol;
-
   ttype.push_back("F_CHAN");
-  needCol = SPneedCol(fchan, isvector);
-  if ( isvector ) {
+  if ( groupVector ) {
     tform.push_back("PJ("+Repeat+")");
   } else {
     tform.push_back("J");
@@ -1694,17 +1836,16 @@ Integer rmf::writeMatrix(string filename)
   tunit.push_back(" ");
 
   ttype.push_back("N_CHAN");
-  needCol = SPneedCol(nchan, isvector);
-  if ( isvector ) {
+  if ( groupVector ) {
     tform.push_back("PJ("+Repeat+")");
   } else {
     tform.push_back("J");
   }
   tunit.push_back(" ");
      
-  if ( SPneedCol(order, isvector) ) {
+  if ( OrderGroup.size() > 0 && orderCol ) {
     ttype.push_back("ORDER");
-    if ( isvector ) {
+    if ( groupVector ) {
       tform.push_back("PJ("+Repeat+")");
     } else {
       tform.push_back("J");
@@ -1717,8 +1858,7 @@ Integer rmf::writeMatrix(string filename)
   Repeat = RepeatStream.str();
 
   ttype.push_back("MATRIX");
-  needCol = SPneedCol(elements, isvector);
-  if ( isvector ) {
+  if ( eltVector ) {
     tform.push_back("PE("+Repeat+")");
   } else {
     tform.push_back("E");
@@ -1783,13 +1923,41 @@ Integer rmf::writeMatrix(string filename)
 
   SPwriteCol(rmf, "N_GRP", NumberGroups, true);
 
-  SPwriteVectorCol(rmf, "F_CHAN", fchan, true);
-  SPwriteVectorCol(rmf, "N_CHAN", nchan, true);
+  if ( OrderGroup.size() > 0 && !orderCol && Nrows > 0 ) {
+    SPwriteKey(rmf, "ORDER", OrderGroup[FirstGroup[0]], Blank);
+  }
 
-  SPwriteVectorCol(rmf, "MATRIX", elements, true);
+  // F_CHAN, N_CHAN, ORDER and MATRIX are written for each row straight from
+  // the arrays in the object
 
-  if ( OrderGroup.size() > 0 ) {
-    SPwriteVectorCol(rmf, "ORDER", order);
+  rmf.makeThisCurrent();
+  fitsfile* fptr = pFits->fitsPointer();
+  int status(0);
+
+  rmfWriteColumn(fptr, TINT, rmf.column("F_CHAN").index(), FirstGroup, NumberGroups,
+		 FirstChannelGroup, status);
+  rmfWriteColumn(fptr, TINT, rmf.column("N_CHAN").index(), FirstGroup, NumberGroups,
+		 NumberChannelsGroup, status);
+  if ( OrderGroup.size() > 0 && orderCol ) {
+    rmfWriteColumn(fptr, TINT, rmf.column("ORDER").index(), FirstGroup, NumberGroups,
+		   OrderGroup, status);
+  }
+
+  vector<Integer> FirstElementRow(Nrows), NumberElementsRow(Nrows);
+  for (size_t i=0; i<(size_t)Nrows; i++) {
+    FirstElementRow[i] = NumberGroups[i] > 0 ? FirstElement[FirstGroup[i]] : 0;
+    NumberElementsRow[i] = 0;
+    for (size_t j=0; j<(size_t)NumberGroups[i]; j++) {
+      NumberElementsRow[i] += NumberChannelsGroup[j+FirstGroup[i]];
+    }
+  }
+  rmfWriteColumn(fptr, TDOUBLE, rmf.column("MATRIX").index(), FirstElementRow,
+		 NumberElementsRow, Matrix, status);
+
+  if ( status != 0 ) {
+    string msg = "Failed to write the response matrix to "+filename;
+    SPreportError(CannotCreateMatrixExt, msg);
+    return(CannotCreateMatrixExt);
   }
   
   return(OK);
@@ -1938,7 +2106,7 @@ rmf& rmf::operator*=(const arf& a)
   // check that the arf and rmf are compatible
   // if not just return the current rmf
 
-  if ( !checkCompatibility(a) ) return *this;
+  if ( checkCompatibility(a) != OK ) return *this;
 
   // loop round energy bins multiplying appropriate elements of the rmf by
   // the effective area for this energy from the ARF
@@ -1981,7 +2149,7 @@ rmf& rmf::operator+=(const rmf& r)
  // check that the two rmfs are compatible
  // if not just return the current rmf
 
-  if ( !checkCompatibility(r) ) return *this;
+  if ( checkCompatibility(r) != OK ) return *this;
 
   // temporary arrays for the response for each energy
 
@@ -2320,6 +2488,166 @@ void rmf::addRow(const vector<vector<Real> > Response, const Real eLow, const Re
 
 }
 
+// the rows being made by addGaussRows. Each thread makes the compressed form
+// of a contiguous range of rows in its own arrays, which are then appended to
+// the response in thread order.
+
+struct rmfGaussRows {
+  const vector<Real>* eLow;
+  const vector<Real>* eHigh;
+  const vector<Real>* sigma;
+  Real threshold;
+  Real ResponseThreshold;
+  Integer FirstChannel;
+  const vector<Real>* ChannelLowEnergy;
+  const vector<Real>* ChannelHighEnergy;
+  vector<vector<Integer> > NumberGroups;
+  vector<vector<Integer> > FirstChannelGroup;
+  vector<vector<Integer> > NumberChannelsGroup;
+  vector<vector<Real> > Matrix;
+};
+
+static void rmfGaussRowsWork(size_t first, size_t last, Integer thread, void* data)
+{
+  rmfGaussRows* rows = static_cast<rmfGaussRows*>(data);
+  vector<Integer>& NumberGroups = rows->NumberGroups[thread];
+  vector<Integer>& FirstChannelGroup = rows->FirstChannelGroup[thread];
+  vector<Integer>& NumberChannelsGroup = rows->NumberChannelsGroup[thread];
+  vector<Real>& Matrix = rows->Matrix[thread];
+  size_t NumberChannels = rows->ChannelLowEnergy->size();
+
+  size_t First;
+  vector<Real> Values;
+
+  for (size_t i=first; i<=last; i++) {
+
+    Real sigma = rows->sigma->size() > 1 ? (*rows->sigma)[i] : (*rows->sigma)[0];
+    Real energy = 0.5*((*rows->eLow)[i]+(*rows->eHigh)[i]);
+    calcGaussRespWindow(sigma, energy, rows->threshold, *rows->ChannelLowEnergy,
+			*rows->ChannelHighEnergy, First, Values);
+
+    // if the response threshold does not exclude zeros then all channels are
+    // kept, as in addRow
+
+    if ( rows->ResponseThreshold <= 0.0 ) {
+      Values.insert(Values.begin(), First, 0.0);
+      Values.resize(NumberChannels, 0.0);
+      First = 0;
+    }
+
+    // construct the response groups for this row
+
+    Integer NGroups(0);
+    bool inGroup(false);
+    for (size_t j=0; j<Values.size(); j++) {
+      if ( Values[j] >= rows->ResponseThreshold ) {
+	if ( !inGroup ) {
+	  NGroups++;
+	  FirstChannelGroup.push_back(First+j+rows->FirstChannel);
+	  NumberChannelsGroup.push_back(1);
+	  inGroup = true;
+	} else {
+	  NumberChannelsGroup[NumberChannelsGroup.size()-1]++;
+	}
+	Matrix.push_back(Values[j]);
+      } else {
+	inGroup = false;
+      }
+    }
+    NumberGroups.push_back(NGroups);
+
+  }
+
+  return;
+}
+
+Integer rmf::addGaussRows(const vector<Real>& eLow, const vector<Real>& eHigh,
+			  const vector<Real>& sigma, const Real threshold)
+{
+  return this->addGaussRows(eLow, eHigh, sigma, threshold, 1);
+}
+
+Integer rmf::addGaussRows(const vector<Real>& eLow, const vector<Real>& eHigh,
+			  const vector<Real>& sigma, const Real threshold,
+			  const Integer NumberThreads)
+{
+
+  if ( eLow.size() != eHigh.size() || 
+       (sigma.size() != 1 && sigma.size() != eLow.size()) ) {
+    stringstream msg;
+    msg << "Number of energies (" << eLow.size() << "," << eHigh.size()
+	<< ") and of widths (" << sigma.size() << ") do not match" << endl;
+    SPreportError(InconsistentEnergies, msg.str());
+    return(InconsistentEnergies);
+  }
+
+  if ( ChannelLowEnergy.size() < 2 || ChannelLowEnergy.size() != ChannelHighEnergy.size() ) {
+    string msg = "Channel energies have not been set";
+    SPreportError(InconsistentChannels, msg);
+    return(InconsistentChannels);
+  }
+
+  if ( eLow.size() == 0 ) return(OK);
+
+  size_t nthreads = NumberThreads > 1 ? (size_t)NumberThreads : 1;
+  if ( nthreads > eLow.size() ) nthreads = eLow.size();
+
+  rmfGaussRows rows;
+  rows.eLow = &eLow;
+  rows.eHigh = &eHigh;
+  rows.sigma = &sigma;
+  rows.threshold = threshold;
+  rows.ResponseThreshold = ResponseThreshold;
+  rows.FirstChannel = FirstChannel;
+  rows.ChannelLowEnergy = &ChannelLowEnergy;
+  rows.ChannelHighEnergy = &ChannelHighEnergy;
+  rows.NumberGroups.resize(nthreads);
+  rows.FirstChannelGroup.resize(nthreads);
+  rows.NumberChannelsGroup.resize(nthreads);
+  rows.Matrix.resize(nthreads);
+
+  SPparallelFor(eLow.size(), nthreads, rmfGaussRowsWork, &rows);
+
+  // append the rows to the response arrays, sizing them once
+
+  size_t nGroups(FirstChannelGroup.size()), nElements(Matrix.size());
+  for (size_t t=0; t<nthreads; t++) {
+    nGroups += rows.FirstChannelGroup[t].size();
+    nElements += rows.Matrix[t].size();
+  }
+  NumberGroups.reserve(NumberGroups.size()+eLow.size());
+  FirstGroup.reserve(FirstGroup.size()+eLow.size());
+  LowEnergy.reserve(LowEnergy.size()+eLow.size());
+  HighEnergy.reserve(HighEnergy.size()+eLow.size());
+  FirstChannelGroup.reserve(nGroups);
+  NumberChannelsGroup.reserve(nGroups);
+  FirstElement.reserve(nGroups);
+  Matrix.reserve(nElements);
+
+  for (size_t t=0; t<nthreads; t++) {
+    size_t iGroup(FirstChannelGroup.size());
+    for (size_t i=0; i<rows.NumberGroups[t].size(); i++) {
+      FirstGroup.push_back(iGroup);
+      NumberGroups.push_back(rows.NumberGroups[t][i]);
+      iGroup += rows.NumberGroups[t][i];
+    }
+    size_t iElement(Matrix.size());
+    for (size_t i=0; i<rows.NumberChannelsGroup[t].size(); i++) {
+      FirstElement.push_back(iElement);
+      iElement += rows.NumberChannelsGroup[t][i];
+    }
+    FirstChannelGroup.insert(FirstChannelGroup.end(), rows.FirstChannelGroup[t].begin(),
+			     rows.FirstChannelGroup[t].end());
+    NumberChannelsGroup.insert(NumberChannelsGroup.end(), rows.NumberChannelsGroup[t].begin(),
+			       rows.NumberChannelsGroup[t].end());
+    Matrix.insert(Matrix.end(), rows.Matrix[t].begin(), rows.Matrix[t].end());
+  }
+  LowEnergy.insert(LowEnergy.end(), eLow.begin(), eLow.end());
+  HighEnergy.insert(HighEnergy.end(), eHigh.begin(), eHigh.end());
+
+  return(OK);
+}
+
 void rmf::substituteRow(const Integer RowNumber, const vector<Real> Response) 
 {
 
@@ -2534,7 +2862,7 @@ void rmf::substituteRow(const Integer RowNumber, const vector<vector<Real> > Res
 
 vector<Real> rmf::multiplyByModel(const vector<Real>& model)
 {
-  vector<Real> outPhaValues(0.0,this->NumberChannels());
+  vector<Real> outPhaValues(this->NumberChannels(),0.0);
 
   // loop over energies
   size_t nE = (size_t)(this->NumberEnergyBins());
@@ -2542,12 +2870,12 @@ vector<Real> rmf::multiplyByModel(const vector<Real>& model)
 
     // loop over response groups for this energy
     for (size_t ig=(size_t)FirstGroup[ie]; 
-	 ig<(size_t)(FirstGroup[ie]+NumberGroups[ie]-1); ig++) {
+	 ig<(size_t)(FirstGroup[ie]+NumberGroups[ie]); ig++) {
 
       // loop over the channels in this group
       size_t ir = FirstElement[ig];
-      for (size_t ich=(size_t)FirstChannelGroup[ig]; 
-	   ich<(size_t)(FirstChannelGroup[ig]+NumberChannelsGroup[ig]-1); ich++) {
+      for (size_t ich=(size_t)(FirstChannelGroup[ig]-FirstChannel); 
+	   ich<(size_t)(FirstChannelGroup[ig]-FirstChannel+NumberChannelsGroup[ig]); ich++) {
 	outPhaValues[ich] += model[ie] * Matrix[ir];
 	ir++;
       }
@@ -2648,78 +2976,15 @@ void calcGaussResp(const Real sigma, const Real energy, const Real threshold,
 		   vector<Real>& ResponseVector)
 {
 
-  Real winv = 1.0/sigma/sqrt(2.0);
   size_t N = ChannelLowEnergy.size();
   ResponseVector.resize(N);
   for (size_t i=0; i<N; i++) ResponseVector[i] = 0.0;
 
-  // find the channel containing the energy
-
-  size_t icen = binarySearch(energy, ChannelLowEnergy, ChannelHighEnergy);
-
-  // first do the case of zero line width
-
-  if ( sigma <= 0.0 ) {
-    ResponseVector[icen] = 1.0;
-    return;
-  }
-
-  // if the line center is below the first bin then don't calculate the lower
-  // part of the line. If the line center is above the last bin then just calculate
-  // the part of the line within the energy range
-
-  if ( energy < ChannelLowEnergy[0] ) {
-    icen = 0;
-  } else if ( energy > ChannelHighEnergy[N-1] ) {
-    icen = N-1;
-  }
-
-  // Do the low energy part of the line
-
-  int ielow(icen);
-  Real alow(0.0);
-  Real lineSum(0.0);
-  Real ahi;
-
-  while ( ielow >= 0 ) {
-    ahi = erf(winv*(fabs(ChannelLowEnergy[ielow]-energy)));
-    Real fract = (ahi-alow)/2;
-    if ( fract >= threshold || ielow == icen ) {
-      ResponseVector[ielow] += fract;
-      lineSum += fract;
-    } else {
-      ielow = 0;
-    }
-    alow = ahi;
-    ielow -= 1;
-  }
-
-  // If the line center is above the last bin then don't calculate the upper
-  // part of the line. If line center is below the first bin then just calculate
-  // the part of the line within energy range
-
-  if ( energy < ChannelLowEnergy[0] ) {
-    icen = 1;
-  } else if ( energy > ChannelHighEnergy[N-1] ) {
-    icen = N + 1;
-  }
-
-  // Do the high energy part of the line
-
-  ielow = icen;
-  alow = 0.0;
-  while ( ielow <= N-1 ) {
-    ahi = erf(winv*(fabs(ChannelHighEnergy[ielow]-energy)));
-    Real fract = (ahi-alow)/2;
-    if ( fract >= threshold || ielow == icen ) {
-      ResponseVector[ielow] += fract;
-      lineSum += fract;
-    } else {
-      ielow = N;
-    }
-    alow = ahi;
-    ielow += 1;
-  }
+  size_t First;
+  vector<Real> Values;
+  calcGaussRespWindow(sigma, energy, threshold, ChannelLowEnergy, ChannelHighEnergy,
+		      First, Values);
+  for (size_t i=0; i<Values.size(); i++) ResponseVector[First+i] = Values[i];
 
   return;
 }
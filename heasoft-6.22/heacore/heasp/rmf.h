@@ -107,7 +107,9 @@ class rmf{
   vector<Real> RowValues(Integer, Integer); // ... and grating order
 
   // Use the response matrix to generate random channel numbers for a photon 
-  // of given energy or set of energies (and grating order).
+  // of given energy or set of energies (and grating order). The random numbers
+  // are seeded from the time; for many photons or reproducible channels use
+  // an rmfsampler.
 
   vector<Integer> RandomChannels(const Real energy, const Integer NumberPhotons);
   vector<Integer> RandomChannels(const vector<Real>& energy, const vector<Integer>& NumberPhotons);
@@ -208,13 +210,26 @@ class rmf{
   void addRow(const vector<Real> Response, const Real eLow, const Real eHigh);
   void addRow(const vector<vector<Real> > Response, const Real eLow, const Real eHigh, const vector<Integer> GratingOrder);
 
+  // add rows for the energy bins eLow to eHigh with gaussian responses centered
+  // on each bin. sigma has one width per bin or a single width for all. The result
+  // is the same as calling calcGaussResp then addRow for each bin but only the
+  // channels above threshold are calculated and the rows are made in parallel
+  // using NumberThreads threads.
+
+  Integer addGaussRows(const vector<Real>& eLow, const vector<Real>& eHigh,
+		       const vector<Real>& sigma, const Real threshold);
+  Integer addGaussRows(const vector<Real>& eLow, const vector<Real>& eHigh,
+		       const vector<Real>& sigma, const Real threshold,
+		       const Integer NumberThreads);
+
   // substitute a row into the response using an input response vector and energy range.
 
   void substituteRow(const Integer RowNumber, const vector<Real> Response);
   void substituteRow(const Integer RowNumber, const vector<vector<Real> > Response, const vector<Integer> GratingOrder);
 
   // multiply a response by a vector and output a vector of pha values. The input
-  // vector is assumed to be on the energy binning
+  // vector is assumed to be on the energy binning. To fold many times, or many
+  // models at once, use an rmfsparse
 
   vector<Real> multiplyByModel(const vector<Real>& model);
 
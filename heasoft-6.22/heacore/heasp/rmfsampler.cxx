@@ -0,0 +1,284 @@
+// rmfsampler object code. Definitions in rmfsampler.h
+
+#ifndef HAVE_rmfsampler
+#include "rmfsampler.h"
+#endif
+
+#ifndef HAVE_rmf
+#include "rmf.h"
+#endif
+
+#ifndef HAVE_SPutils
+#include "SPutils.h"
+#endif
+
+// Class rmfsampler
+
+// default constructor
+
+rmfsampler::rmfsampler()
+  : FirstChannel(0),
+    LowEnergy(),
+    HighEnergy(),
+    FirstEntry(),
+    NumberEntries(),
+    Cumulative(),
+    Channel()
+{
+}
+
+
+// Destructor
+
+rmfsampler::~rmfsampler()
+{
+  // clear vectors with guaranteed reallocation
+  vector<Real>().swap(LowEnergy);
+  vector<Real>().swap(HighEnergy);
+  vector<Integer>().swap(FirstEntry);
+  vector<Integer>().swap(NumberEntries);
+  vector<Real>().swap(Cumulative);
+  vector<Integer>().swap(Channel);
+}
+
+// load object from a response for all grating orders
+
+void rmfsampler::load(rmf& inRMF)
+{
+  Integer GratingOrder(-999);
+
+  this->load(inRMF, GratingOrder);
+}
+
+// load object from a response for a grating order. Use GratingOrder = -999 as
+// special case to ignore grating information
+
+void rmfsampler::load(rmf& inRMF, const Integer GratingOrder)
+{
+  FirstChannel = inRMF.FirstChannel;
+  LowEnergy = inRMF.LowEnergy;
+  HighEnergy = inRMF.HighEnergy;
+
+  size_t NumberEnergyBins(LowEnergy.size());
+  FirstEntry.resize(NumberEnergyBins);
+  NumberEntries.resize(NumberEnergyBins);
+
+  // count the non-zero elements so the arrays are only allocated once
+
+  size_t NumberNonZero(0);
+  for (size_t i=0; i<inRMF.Matrix.size(); i++) {
+    if ( inRMF.Matrix[i] > 0.0 ) NumberNonZero++;
+  }
+  Cumulative.resize(NumberNonZero);
+  Channel.resize(NumberNonZero);
+
+  // loop round the energies accumulating the response over the groups in use.
+  // the order of the entries does not matter for the sampling so the groups
+  // are taken in the order they are stored.
+
+  size_t ientry(0);
+  for (size_t i=0; i<NumberEnergyBins; i++) {
+
+    FirstEntry[i] = ientry;
+    Real sum(0.0);
+
+    for (size_t k=0; k<(size_t)inRMF.NumberGroups[i]; k++) {
+
+      size_t igroup = k + inRMF.FirstGroup[i];
+
+      if ( ( inRMF.OrderGroup.size() > 0 && inRMF.OrderGroup[igroup] == GratingOrder )
+	   || GratingOrder == -999 ) {
+
+	size_t ielt = inRMF.FirstElement[igroup];
+	for (size_t j=0; j<(size_t)inRMF.NumberChannelsGroup[igroup]; j++) {
+	  Real value = inRMF.Matrix[ielt+j];
+	  if ( value > 0.0 ) {
+	    sum += value;
+	    Cumulative[ientry] = sum;
+	    Channel[ientry] = inRMF.FirstChannelGroup[igroup] + j;
+	    ientry++;
+	  }
+	}
+
+      }
+
+    }
+
+    NumberEntries[i] = ientry - FirstEntry[i];
+
+  }
+
+  Cumulative.resize(ientry);
+  Channel.resize(ientry);
+
+  return;
+}
+
+// Return information
+
+Integer rmfsampler::NumberEnergyBins()             // Number of response energies
+{
+  return LowEnergy.size();
+}
+
+Integer rmfsampler::NumberTotalEntries()           // Total number of non-zero entries
+{
+  return Cumulative.size();
+}
+
+// Return the energy bin containing an energy, -1 if outside the response. The
+// search is that used by rmf::RandomChannels and assumes the energies are in
+// increasing order
+
+Integer rmfsampler::EnergyBin(const Real energy)
+{
+  if ( LowEnergy.size() == 0 ) return -1;
+  if ( energy < LowEnergy[0] || energy > HighEnergy[HighEnergy.size()-1] ) return -1;
+
+  size_t lower = 0;
+  size_t upper = HighEnergy.size()-1;
+  while ( upper - lower > 1 ) {
+    size_t middle = (upper + lower)/2;
+    if ( energy < HighEnergy[middle] ) {
+      upper = middle;
+    } else {
+      lower = middle;
+    }
+  }
+  if ( energy > HighEnergy[lower] ) return upper;
+  return lower;
+}
+
+// Return a random channel for a photon in an energy bin. As in rmf::RandomChannels
+// the channel is the first one at which the cumulative response reaches the
+// random number, and -1 if the random number exceeds the total response.
+
+Integer rmfsampler::RandomChannel(const Integer EnergyBin, HDmt_state* state)
+{
+  Real RandomNumber = (Real) HDmt_drand(state);
+
+  if ( EnergyBin < 0 || NumberEntries[EnergyBin] == 0 ) return -1;
+
+  vector<Real>::const_iterator first = Cumulative.begin() + FirstEntry[EnergyBin];
+  vector<Real>::const_iterator last = first + NumberEntries[EnergyBin];
+  if ( RandomNumber > *(last-1) ) return -1;
+
+  return Channel[lower_bound(first, last, RandomNumber) - Cumulative.begin()];
+}
+
+// Return vector of randomly generated channel numbers for a particular energy
+
+vector<Integer> rmfsampler::RandomChannels(const Real energy, const Integer NumberPhotons,
+					   HDmt_state* state)
+{
+  vector<Real> energyArray(1,energy);
+  vector<Integer> NPhotArray(1,NumberPhotons);
+
+  return this->RandomChannels(energyArray, NPhotArray, state);
+}
+
+// Return vector of randomly generated channel numbers for a set of energies
+
+vector<Integer> rmfsampler::RandomChannels(const vector<Real>& energy,
+					   const vector<Integer>& NumberPhotons,
+					   HDmt_state* state)
+{
+  Integer NumberOut(0);
+  for (size_t i=0; i<NumberPhotons.size(); i++) NumberOut += NumberPhotons[i];
+  vector<Integer> channel(NumberOut, -1);
+
+  size_t iout(0);
+  for (size_t i=0; i<energy.size(); i++) {
+    Integer ibin = this->EnergyBin(energy[i]);
+    if ( ibin >= 0 ) {
+      for (size_t j=0; j<(size_t)NumberPhotons[i]; j++) {
+	channel[iout++] = this->RandomChannel(ibin, state);
+      }
+    } else {
+      iout += NumberPhotons[i];
+    }
+  }
+
+  return channel;
+}
+
+// Generate a channel for each of a set of photon energies using one thread
+// per random number generator state
+
+struct rmfsamplerBatch {
+  rmfsampler* sampler;
+  const vector<Real>* energy;
+  vector<Integer>* channel;
+  const vector<HDmt_state*>* states;
+};
+
+static void rmfsamplerBatchWork(size_t first, size_t last, Integer thread, void* data)
+{
+  rmfsamplerBatch* batch = static_cast<rmfsamplerBatch*>(data);
+  HDmt_state* state = (*batch->states)[thread];
+  for (size_t i=first; i<=last; i++) {
+    Integer ibin = batch->sampler->EnergyBin((*batch->energy)[i]);
+    (*batch->channel)[i] = ibin >= 0 ? batch->sampler->RandomChannel(ibin, state) : -1;
+  }
+  return;
+}
+
+void rmfsampler::RandomChannels(const vector<Real>& energy, vector<Integer>& channel,
+				const vector<HDmt_state*>& states)
+{
+  channel.resize(energy.size());
+  if ( states.size() == 0 ) {
+    for (size_t i=0; i<channel.size(); i++) channel[i] = -1;
+    return;
+  }
+
+  rmfsamplerBatch batch;
+  batch.sampler = this;
+  batch.energy = &energy;
+  batch.channel = &channel;
+  batch.states = &states;
+
+  SPparallelFor(energy.size(), states.size(), rmfsamplerBatchWork, &batch);
+
+  return;
+}
+
+// Display information about the object - return as a string
+
+string rmfsampler::disp()
+{
+  ostringstream outstr;
+
+  outstr << "Response sampler information : " << endl;
+
+  outstr << "   FirstChannel        = " << FirstChannel << endl;
+  outstr << "   NumberEnergyBins    = " << NumberEnergyBins() << endl;
+  outstr << "   NumberTotalEntries  = " << NumberTotalEntries() << endl;
+
+  if ( LowEnergy.size() > 1 ) outstr << "   LowEnergy array of size " << LowEnergy.size() << endl;
+  if ( HighEnergy.size() > 1 ) outstr << "   HighEnergy array of size " << HighEnergy.size() << endl;
+
+  if ( FirstEntry.size() > 1 ) outstr << "   FirstEntry array of size " << FirstEntry.size() << endl;
+  if ( NumberEntries.size() > 1 ) outstr << "   NumberEntries array of size " << NumberEntries.size() << endl;
+
+  if ( Cumulative.size() > 1 ) outstr << "   Cumulative array of size " << Cumulative.size() << endl;
+  if ( Channel.size() > 1 ) outstr << "   Channel array of size " << Channel.size() << endl;
+
+  return outstr.str();
+}
+
+// Clear information from the object
+
+void rmfsampler::clear()
+{
+  FirstChannel = 0;
+
+  LowEnergy.clear();
+  HighEnergy.clear();
+  FirstEntry.clear();
+  NumberEntries.clear();
+  Cumulative.clear();
+  Channel.clear();
+
+  return;
+}
@@ -0,0 +1,94 @@
+// Class definitions for rmfsampler object - prepared sampling of channels
+// from a response
+
+#ifndef HAVE_HEASP
+#include "heasp.h"
+#endif
+
+#ifndef HAVE_rmf
+#include "rmf.h"
+#endif
+
+#include "headas_rand.h"
+
+#define HAVE_rmfsampler 1
+
+// The rmfsampler holds, for each energy bin of a response, the cumulative
+// response over only the non-zero response elements. It is made once from
+// an rmf with load() and is then used to generate random channels for any
+// number of photons, taking O(log N) time per photon where N is the number
+// of non-zero elements for the energy. The random numbers are drawn from
+// random number generator states supplied by the caller (see headas_rand.h),
+// so that the channels can be reproduced by using the same seeds.
+
+class rmfsampler{
+ public:
+
+  Integer FirstChannel;              // First channel number
+
+  vector<Real> LowEnergy;              // Start energy of bin
+  vector<Real> HighEnergy;             // End energy of bin
+
+  vector<Integer> FirstEntry;          // First entry for this energy bin (counts from 0)
+  vector<Integer> NumberEntries;       // Number of entries for this energy bin
+
+  vector<Real> Cumulative;             // Response summed up to and including this entry
+  vector<Integer> Channel;             // Channel number for this entry
+
+  // constructor
+
+  rmfsampler();
+
+  // destructor
+
+  ~rmfsampler();
+
+  // load object from a standard rmf, either for all grating orders or just
+  // one. Use GratingOrder = -999 as special case to ignore grating information
+
+  void load(rmf&);
+  void load(rmf&, const Integer GratingOrder);
+
+  // Return information
+
+  Integer NumberEnergyBins();             // Number of response energies
+  Integer NumberTotalEntries();           // Total number of non-zero entries
+
+  // Return the energy bin containing an energy, -1 if the energy is outside
+  // the response range
+
+  Integer EnergyBin(const Real energy);
+
+  // Return a random channel for a photon in an energy bin. If the response
+  // for the energy does not sum to unity the photon may fall off the end of the
+  // channels in which case -1 is returned.
+
+  Integer RandomChannel(const Integer EnergyBin, HDmt_state* state);
+
+  // Return vector of randomly generated channel numbers for a particular energy
+  // or set of energies, as rmf::RandomChannels. Photons whose energy is outside
+  // the response range are given channel -1.
+
+  vector<Integer> RandomChannels(const Real energy, const Integer NumberPhotons,
+				 HDmt_state* state);
+  vector<Integer> RandomChannels(const vector<Real>& energy,
+				 const vector<Integer>& NumberPhotons,
+				 HDmt_state* state);
+
+  // Generate a channel for each of a set of photon energies, splitting the
+  // photons into states.size() contiguous blocks each done in its own thread
+  // with its own random number generator state. For a given set of states the
+  // channels do not depend on the thread scheduling.
+
+  void RandomChannels(const vector<Real>& energy, vector<Integer>& channel,
+		      const vector<HDmt_state*>& states);
+
+  // Display information about the object - return as a string
+
+  string disp();
+
+  // Clear information from the object
+
+  void clear();
+
+};
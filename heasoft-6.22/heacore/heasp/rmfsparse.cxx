@@ -0,0 +1,428 @@
+// rmfsparse object code. Definitions in rmfsparse.h
+
+#ifndef HAVE_rmfsparse
+#include "rmfsparse.h"
+#endif
+
+#ifndef HAVE_SPutils
+#include "SPutils.h"
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Class rmfsparse
+
+// default constructor
+
+rmfsparse::rmfsparse()
+  : FirstChannel(0),
+    EnergyStart(),
+    EnergyChannel(),
+    EnergyValue(),
+    ChannelStart(),
+    ChannelEnergy(),
+    ChannelValue(),
+    NumberThreads(1)
+{
+}
+
+
+// Destructor
+
+rmfsparse::~rmfsparse()
+{
+  // clear vectors with guaranteed reallocation
+  vector<Integer>().swap(EnergyStart);
+  vector<Integer>().swap(EnergyChannel);
+  vector<Real>().swap(EnergyValue);
+  vector<Integer>().swap(ChannelStart);
+  vector<Integer>().swap(ChannelEnergy);
+  vector<Real>().swap(ChannelValue);
+}
+
+// load object from a response for all grating orders
+
+void rmfsparse::load(rmf& inRMF)
+{
+  Integer GratingOrder(-999);
+
+  this->load(inRMF, GratingOrder);
+}
+
+// load object from a response for a grating order. Use GratingOrder = -999 as
+// special case to ignore grating information
+
+void rmfsparse::load(rmf& inRMF, const Integer GratingOrder)
+{
+  FirstChannel = inRMF.FirstChannel;
+
+  size_t nE = (size_t)inRMF.NumberEnergyBins();
+  Integer nChan = inRMF.NumberChannels();
+
+  // count the non-zero elements for each energy
+
+  EnergyStart.resize(nE+1);
+  EnergyStart[0] = 0;
+  for (size_t ie=0; ie<nE; ie++) {
+    Integer count(0);
+    for (size_t ig=(size_t)inRMF.FirstGroup[ie];
+	 ig<(size_t)(inRMF.FirstGroup[ie]+inRMF.NumberGroups[ie]); ig++) {
+      if ( ( inRMF.OrderGroup.size() > 0 && inRMF.OrderGroup[ig] == GratingOrder )
+	   || GratingOrder == -999 ) {
+	size_t ir = inRMF.FirstElement[ig];
+	for (size_t j=0; j<(size_t)inRMF.NumberChannelsGroup[ig]; j++) {
+	  if ( inRMF.Matrix[ir+j] != 0.0 ) count++;
+	}
+	Integer lastChannel = inRMF.FirstChannelGroup[ig] - FirstChannel
+	                      + inRMF.NumberChannelsGroup[ig];
+	if ( lastChannel > nChan ) nChan = lastChannel;
+      }
+    }
+    EnergyStart[ie+1] = EnergyStart[ie] + count;
+  }
+
+  // and copy them in
+
+  EnergyChannel.resize(EnergyStart[nE]);
+  EnergyValue.resize(EnergyStart[nE]);
+  size_t ientry(0);
+  for (size_t ie=0; ie<nE; ie++) {
+    for (size_t ig=(size_t)inRMF.FirstGroup[ie];
+	 ig<(size_t)(inRMF.FirstGroup[ie]+inRMF.NumberGroups[ie]); ig++) {
+      if ( ( inRMF.OrderGroup.size() > 0 && inRMF.OrderGroup[ig] == GratingOrder )
+	   || GratingOrder == -999 ) {
+	size_t ir = inRMF.FirstElement[ig];
+	Integer ich = inRMF.FirstChannelGroup[ig] - FirstChannel;
+	for (size_t j=0; j<(size_t)inRMF.NumberChannelsGroup[ig]; j++) {
+	  if ( inRMF.Matrix[ir+j] != 0.0 ) {
+	    EnergyChannel[ientry] = ich + j;
+	    EnergyValue[ientry] = inRMF.Matrix[ir+j];
+	    ientry++;
+	  }
+	}
+      }
+    }
+  }
+
+  ChannelStart.assign(nChan+1, 0);
+  this->makeChannelLayout();
+
+  return;
+}
+
+// load object from a transposed response
+
+void rmfsparse::load(rmft& inRMFT)
+{
+  FirstChannel = inRMFT.FirstChannel;
+
+  size_t nChan = inRMFT.NumberGroups.size();
+  Integer nE = inRMFT.NumberEnergyBins();
+
+  // count the non-zero elements for each channel
+
+  ChannelStart.resize(nChan+1);
+  ChannelStart[0] = 0;
+  for (size_t ich=0; ich<nChan; ich++) {
+    Integer count(0);
+    for (size_t ig=(size_t)inRMFT.FirstGroup[ich];
+	 ig<(size_t)(inRMFT.FirstGroup[ich]+inRMFT.NumberGroups[ich]); ig++) {
+      size_t ir = inRMFT.FirstElement[ig];
+      for (size_t j=0; j<(size_t)inRMFT.NumberEnergiesGroup[ig]; j++) {
+	if ( inRMFT.Matrix[ir+j] != 0.0 ) count++;
+      }
+      Integer lastEnergy = inRMFT.FirstEnergyGroup[ig] + inRMFT.NumberEnergiesGroup[ig];
+      if ( lastEnergy > nE ) nE = lastEnergy;
+    }
+    ChannelStart[ich+1] = ChannelStart[ich] + count;
+  }
+
+  // and copy them in
+
+  ChannelEnergy.resize(ChannelStart[nChan]);
+  ChannelValue.resize(ChannelStart[nChan]);
+  size_t ientry(0);
+  for (size_t ich=0; ich<nChan; ich++) {
+    for (size_t ig=(size_t)inRMFT.FirstGroup[ich];
+	 ig<(size_t)(inRMFT.FirstGroup[ich]+inRMFT.NumberGroups[ich]); ig++) {
+      size_t ir = inRMFT.FirstElement[ig];
+      for (size_t j=0; j<(size_t)inRMFT.NumberEnergiesGroup[ig]; j++) {
+	if ( inRMFT.Matrix[ir+j] != 0.0 ) {
+	  ChannelEnergy[ientry] = inRMFT.FirstEnergyGroup[ig] + j;
+	  ChannelValue[ientry] = inRMFT.Matrix[ir+j];
+	  ientry++;
+	}
+      }
+    }
+  }
+
+  EnergyStart.assign(nE+1, 0);
+  this->makeEnergyLayout();
+
+  return;
+}
+
+// make the CSC arrays from the CSR arrays. ChannelStart must already have the
+// right size. The entries for each channel end up in order of energy.
+
+void rmfsparse::makeChannelLayout()
+{
+  size_t nE = EnergyStart.size() - 1;
+  size_t nChan = ChannelStart.size() - 1;
+
+  for (size_t i=0; i<=nChan; i++) ChannelStart[i] = 0;
+  for (size_t i=0; i<EnergyChannel.size(); i++) ChannelStart[EnergyChannel[i]+1]++;
+  for (size_t i=0; i<nChan; i++) ChannelStart[i+1] += ChannelStart[i];
+
+  ChannelEnergy.resize(EnergyChannel.size());
+  ChannelValue.resize(EnergyValue.size());
+  vector<Integer> next(ChannelStart.begin(), ChannelStart.end()-1);
+  for (size_t ie=0; ie<nE; ie++) {
+    for (Integer j=EnergyStart[ie]; j<EnergyStart[ie+1]; j++) {
+      Integer k = next[EnergyChannel[j]]++;
+      ChannelEnergy[k] = ie;
+      ChannelValue[k] = EnergyValue[j];
+    }
+  }
+
+  return;
+}
+
+// make the CSR arrays from the CSC arrays. EnergyStart must already have the
+// right size. The entries for each energy end up in order of channel.
+
+void rmfsparse::makeEnergyLayout()
+{
+  size_t nE = EnergyStart.size() - 1;
+  size_t nChan = ChannelStart.size() - 1;
+
+  for (size_t i=0; i<=nE; i++) EnergyStart[i] = 0;
+  for (size_t i=0; i<ChannelEnergy.size(); i++) EnergyStart[ChannelEnergy[i]+1]++;
+  for (size_t i=0; i<nE; i++) EnergyStart[i+1] += EnergyStart[i];
+
+  EnergyChannel.resize(ChannelEnergy.size());
+  EnergyValue.resize(ChannelValue.size());
+  vector<Integer> next(EnergyStart.begin(), EnergyStart.end()-1);
+  for (size_t ich=0; ich<nChan; ich++) {
+    for (Integer j=ChannelStart[ich]; j<ChannelStart[ich+1]; j++) {
+      Integer k = next[ChannelEnergy[j]]++;
+      EnergyChannel[k] = ich;
+      EnergyValue[k] = ChannelValue[j];
+    }
+  }
+
+  return;
+}
+
+// Return information
+
+Integer rmfsparse::NumberChannels()               // Number of spectrum channels
+{
+  return ChannelStart.size() > 0 ? ChannelStart.size() - 1 : 0;
+}
+
+Integer rmfsparse::NumberEnergyBins()             // Number of response energies
+{
+  return EnergyStart.size() > 0 ? EnergyStart.size() - 1 : 0;
+}
+
+Integer rmfsparse::NumberTotalElements()          // Total number of non-zero elements
+{
+  return ChannelValue.size();
+}
+
+// the product of one of the compressed layouts with a set of K vectors. Each
+// output row is the sum over its entries of the entry value times the input
+// row for the entry index, accumulated in the order of the entries.
+
+struct rmfsparseProduct {
+  const Integer* start;
+  const Integer* index;
+  const Real* value;
+  const Real* in;
+  Real* out;
+  size_t K;
+};
+
+static void rmfsparseProductWork(size_t first, size_t last, Integer /*thread*/, void* data)
+{
+  rmfsparseProduct* p = static_cast<rmfsparseProduct*>(data);
+  const size_t K = p->K;
+
+  if ( K == 1 ) {
+    for (size_t i=first; i<=last; i++) {
+      Real sum(0.0);
+      for (Integer j=p->start[i]; j<p->start[i+1]; j++) {
+	sum += p->in[p->index[j]] * p->value[j];
+      }
+      p->out[i] = sum;
+    }
+    return;
+  }
+
+  for (size_t i=first; i<=last; i++) {
+    Real* out = p->out + i*K;
+    for (size_t k=0; k<K; k++) out[k] = 0.0;
+    for (Integer j=p->start[i]; j<p->start[i+1]; j++) {
+      const Real* in = p->in + p->index[j]*K;
+      const Real value = p->value[j];
+      size_t k(0);
+#ifdef __SSE2__
+      __m128d v = _mm_set1_pd(value);
+      for (; k+4<=K; k+=4) {
+	_mm_storeu_pd(out+k, _mm_add_pd(_mm_loadu_pd(out+k),
+					_mm_mul_pd(_mm_loadu_pd(in+k), v)));
+	_mm_storeu_pd(out+k+2, _mm_add_pd(_mm_loadu_pd(out+k+2),
+					  _mm_mul_pd(_mm_loadu_pd(in+k+2), v)));
+      }
+#endif
+      for (; k<K; k++) out[k] += in[k] * value;
+    }
+  }
+
+  return;
+}
+
+// the product of the transpose of one of the compressed layouts with a single
+// vector, scattering each input row into the output. For the CSR layout the
+// sums are made in the same order as the gather from the CSC layout but the
+// additions to different output elements do not wait on each other, which is
+// faster when there is only one thread.
+
+static void rmfsparseScatter(const vector<Integer>& start, const vector<Integer>& index,
+			     const vector<Real>& value, const vector<Real>& in,
+			     vector<Real>& out)
+{
+  for (size_t i=0; i<out.size(); i++) out[i] = 0.0;
+  for (size_t i=0; i+1<start.size(); i++) {
+    const Real x = in[i];
+    for (Integer j=start[i]; j<start[i+1]; j++) out[index[j]] += x * value[j];
+  }
+  return;
+}
+
+// fold a model through the response
+
+void rmfsparse::fold(const vector<Real>& model, vector<Real>& counts)
+{
+  if ( NumberThreads > 1 || model.size() < (size_t)NumberEnergyBins() ) {
+    this->fold(model, 1, counts);
+    return;
+  }
+  counts.resize(NumberChannels());
+  rmfsparseScatter(EnergyStart, EnergyChannel, EnergyValue, model, counts);
+  return;
+}
+
+// fold a batch of models through the response, sharing the channels between
+// the threads
+
+void rmfsparse::fold(const vector<Real>& models, const Integer NumberModels, vector<Real>& counts)
+{
+  size_t K = NumberModels > 0 ? NumberModels : 0;
+  size_t nChan = NumberChannels();
+  counts.resize(nChan*K);
+  if ( counts.size() == 0 ) return;
+  if ( models.size() < NumberEnergyBins()*K ) {
+    SPreportError(InconsistentEnergies, "model array is smaller than the number of energies in the response");
+    for (size_t i=0; i<counts.size(); i++) counts[i] = 0.0;
+    return;
+  }
+
+  rmfsparseProduct product;
+  product.start = &ChannelStart[0];
+  product.index = ChannelEnergy.size() > 0 ? &ChannelEnergy[0] : 0;
+  product.value = ChannelValue.size() > 0 ? &ChannelValue[0] : 0;
+  product.in = &models[0];
+  product.out = &counts[0];
+  product.K = K;
+
+  SPparallelFor(nChan, NumberThreads, rmfsparseProductWork, &product);
+
+  return;
+}
+
+// multiply by the transpose of the response
+
+void rmfsparse::foldTranspose(const vector<Real>& counts, vector<Real>& values)
+{
+  if ( NumberThreads > 1 || counts.size() < (size_t)NumberChannels() ) {
+    this->foldTranspose(counts, 1, values);
+    return;
+  }
+  values.resize(NumberEnergyBins());
+  rmfsparseScatter(ChannelStart, ChannelEnergy, ChannelValue, counts, values);
+  return;
+}
+
+// multiply a batch of vectors by the transpose of the response, sharing the
+// energies between the threads
+
+void rmfsparse::foldTranspose(const vector<Real>& counts, const Integer NumberVectors,
+			      vector<Real>& values)
+{
+  size_t K = NumberVectors > 0 ? NumberVectors : 0;
+  size_t nE = NumberEnergyBins();
+  values.resize(nE*K);
+  if ( values.size() == 0 ) return;
+  if ( counts.size() < NumberChannels()*K ) {
+    SPreportError(InconsistentChannels, "input array is smaller than the number of channels in the response");
+    for (size_t i=0; i<values.size(); i++) values[i] = 0.0;
+    return;
+  }
+
+  rmfsparseProduct product;
+  product.start = &EnergyStart[0];
+  product.index = EnergyChannel.size() > 0 ? &EnergyChannel[0] : 0;
+  product.value = EnergyValue.size() > 0 ? &EnergyValue[0] : 0;
+  product.in = &counts[0];
+  product.out = &values[0];
+  product.K = K;
+
+  SPparallelFor(nE, NumberThreads, rmfsparseProductWork, &product);
+
+  return;
+}
+
+// Display information about the object - return as a string
+
+string rmfsparse::disp()
+{
+  ostringstream outstr;
+
+  outstr << "Sparse response information : " << endl;
+
+  outstr << "   FirstChannel        = " << FirstChannel << endl;
+  outstr << "   NumberChannels      = " << NumberChannels() << endl;
+  outstr << "   NumberEnergyBins    = " << NumberEnergyBins() << endl;
+  outstr << "   NumberTotalElements = " << NumberTotalElements() << endl;
+  outstr << "   NumberThreads       = " << NumberThreads << endl;
+
+  if ( EnergyStart.size() > 1 ) outstr << "   EnergyStart array of size " << EnergyStart.size() << endl;
+  if ( EnergyChannel.size() > 1 ) outstr << "   EnergyChannel array of size " << EnergyChannel.size() << endl;
+  if ( EnergyValue.size() > 1 ) outstr << "   EnergyValue array of size " << EnergyValue.size() << endl;
+
+  if ( ChannelStart.size() > 1 ) outstr << "   ChannelStart array of size " << ChannelStart.size() << endl;
+  if ( ChannelEnergy.size() > 1 ) outstr << "   ChannelEnergy array of size " << ChannelEnergy.size() << endl;
+  if ( ChannelValue.size() > 1 ) outstr << "   ChannelValue array of size " << ChannelValue.size() << endl;
+
+  return outstr.str();
+}
+
+// Clear information from the object
+
+void rmfsparse::clear()
+{
+  FirstChannel = 0;
+
+  EnergyStart.clear();
+  EnergyChannel.clear();
+  EnergyValue.clear();
+  ChannelStart.clear();
+  ChannelEnergy.clear();
+  ChannelValue.clear();
+
+  return;
+}
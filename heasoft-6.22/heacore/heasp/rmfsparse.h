@@ -0,0 +1,103 @@
+// Class definitions for rmfsparse object - compressed sparse layouts of a
+// response for folding models
+
+#ifndef HAVE_HEASP
+#include "heasp.h"
+#endif
+
+#ifndef HAVE_rmf
+#include "rmf.h"
+#endif
+
+#ifndef HAVE_rmft
+#include "rmft.h"
+#endif
+
+#define HAVE_rmfsparse 1
+
+// The rmfsparse holds the non-zero elements of a response twice: ordered by
+// energy (compressed sparse row, CSR) and ordered by channel (compressed sparse
+// column, CSC). Folding a model through the response gathers, for each channel,
+// the elements of the CSC layout, so channels can be shared between threads
+// without any locking and the sums are made in the same order as in
+// rmf::multiplyByModel. The CSR layout is used for the transposed product,
+// taking a vector on the channels back to the energies.
+//
+// Models are stored with the energy varying slowest: for a batch of K models
+// model k for energy bin i is element i*K+k of the array, and the counts are
+// returned the same way, counts for model k in channel j (counting from 0)
+// being element j*K+k.
+
+class rmfsparse{
+ public:
+
+  Integer FirstChannel;              // First channel number
+
+  vector<Integer> EnergyStart;       // First entry for each energy, with a final
+                                     // element giving the total number of entries
+  vector<Integer> EnergyChannel;     // Channel (counts from 0) of each entry
+  vector<Real> EnergyValue;          // Response for each entry
+
+  vector<Integer> ChannelStart;      // First entry for each channel, with a final
+                                     // element giving the total number of entries
+  vector<Integer> ChannelEnergy;     // Energy bin (counts from 0) of each entry
+  vector<Real> ChannelValue;         // Response for each entry
+
+  Integer NumberThreads;             // Number of threads to use for folding
+
+  // constructor
+
+  rmfsparse();
+
+  // destructor
+
+  ~rmfsparse();
+
+  // load object from a standard rmf, either for all grating orders or just
+  // one. Use GratingOrder = -999 as special case to ignore grating information
+
+  void load(rmf&);
+  void load(rmf&, const Integer GratingOrder);
+
+  // load object from a transposed rmf
+
+  void load(rmft&);
+
+  // Return information
+
+  Integer NumberChannels();               // Number of spectrum channels
+  Integer NumberEnergyBins();             // Number of response energies
+  Integer NumberTotalElements();          // Total number of non-zero elements
+
+  // fold a model on the response energies through the response giving the
+  // counts in each channel
+
+  void fold(const vector<Real>& model, vector<Real>& counts);
+
+  // fold a batch of NumberModels models
+
+  void fold(const vector<Real>& models, const Integer NumberModels, vector<Real>& counts);
+
+  // multiply a vector on the channels by the transpose of the response giving
+  // a vector on the energies, eg to find the derivatives of a fit statistic with
+  // respect to the model values
+
+  void foldTranspose(const vector<Real>& counts, vector<Real>& values);
+  void foldTranspose(const vector<Real>& counts, const Integer NumberVectors, vector<Real>& values);
+
+  // Display information about the object - return as a string
+
+  string disp();
+
+  // Clear information from the object
+
+  void clear();
+
+ private:
+
+  // make the CSC arrays from the CSR arrays or vice versa
+
+  void makeChannelLayout();
+  void makeEnergyLayout();
+
+};
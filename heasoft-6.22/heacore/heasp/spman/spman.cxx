@@ -274,7 +274,7 @@ int main(int argc, char* argv[])
 	    }
 	  }
 	  if ( haveARF ) {
-	    if ( !inRMF.checkCompatibility(inARF) ) {
+	    if ( inRMF.checkCompatibility(inARF) != OK ) {
 	      cout << "ARF and RMF are incompatible" << endl;
 	    } else
 	      inRMF *= inARF;
@@ -11,6 +11,10 @@
 #include "SPutils.h"
 #endif
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 //-------------------------------------------------------------------------------
 // Class table
 
@@ -30,7 +34,24 @@ table::table()
     EnergyUnits("keV"),
     LowEnergyLimit(0.0),
     HighEnergyLimit(0.0),
-    Filename(" ")
+    Filename(" "),
+    SpectrumCacheSize(0),
+    NumberThreads(1),
+    CacheOrder(),
+    CacheLastUse(),
+    CacheClock(0),
+    SpectrumFile(),
+    BracketValue(),
+    BracketSet(),
+    BracketExact(),
+    BracketIndex(),
+    BracketFraction(),
+    WorkRecords(),
+    WorkWeights(),
+    WorkSources(),
+    WorkSourceWeights(),
+    WorkSpectrum(),
+    WorkVariances()
 {
 }
 
@@ -42,6 +63,9 @@ table::~table()
   vector<tableParameter>().swap(Parameters);
   vector<tableSpectrum>().swap(Spectra);
   vector<Real>().swap(Energies);
+  vector<unsigned long>().swap(CacheLastUse);
+  vector<Real>().swap(WorkSpectrum);
+  vector<vector<Real> >().swap(WorkVariances);
 }
 
 // Read the table from a FITS file
@@ -75,6 +99,7 @@ Integer table::read(string infilename, bool loadAll)
   }
 
   Filename = infilename;
+  clearCache();
 
   PHDU& primary = pInfile->pHDU();
 
@@ -252,42 +277,38 @@ Integer table::read(string infilename, bool loadAll)
 template <class T> Integer table::readSpectra(T& spectrumList)
 {
 
-  // first check whether we have not already loaded the required spectra
+  // first check whether we have not already loaded the required spectra,
+  // marking those read on demand as just used
+
+  if ( CacheLastUse.size() != Spectra.size() ) CacheLastUse.resize(Spectra.size(), 0);
 
   bool done = true;
   for (size_t iList=0; iList<spectrumList.size(); iList++) {
-    if ( Spectra[spectrumList[iList]].Flux.size() == 0 ) {
+    size_t iSpec = spectrumList[iList];
+    if ( Spectra[iSpec].Flux.size() == 0 ) {
       done = false;
-      break;
+    } else if ( CacheLastUse[iSpec] != 0 ) {
+      CacheOrder.erase(CacheLastUse[iSpec]);
+      CacheLastUse[iSpec] = ++CacheClock;
+      CacheOrder[CacheClock] = iSpec;
     }
   }
   if ( done ) return(OK);
 
-  // open the FITS file using the name which has been recorded in the table object 
-
-  auto_ptr<FITS> pInfile(0);
+  // open the FITS file using the name which has been recorded in the table
+  // object. it is left open for later calls.
 
-  try {
-    pInfile.reset(new FITS(Filename, Read, false));
-  } catch(...) {
-    string msg = "Failed to read "+Filename;
-    SPreportError(NoSuchFile, msg);
-    return(NoSuchFile);
+  if ( SpectrumFile.fptr == NULL ) {
+    Integer status = SpectrumFile.open(Filename, NumAddParams);
+    if ( status != OK ) return(status);
   }
 
-  // move to the SPECTRA extension
+  fitsfile* fptr = SpectrumFile.fptr;
+  int paramCol = SpectrumFile.ParamCol;
+  int intpCol = SpectrumFile.IntpCol;
+  const vector<int>& addCol = SpectrumFile.AddCol;
 
-  string hduName = "SPECTRA";
-  ExtHDU& spec = pInfile->extension(hduName);
-
-  // construct the names of any columns with additive parameter spectra
-
-  vector<string> addColName(NumAddParams);
-  for (size_t iaF=0; iaF<(size_t)NumAddParams; iaF++) {
-    ostringstream sname;
-    sname << "ADDSP" << setfill('0') << setw(3) << iaF+1;
-    addColName[iaF] = sname.str();
-  }
+  size_t Nbins = Energies.size()-1;
 
   // Loop round reading each row required
 
@@ -299,39 +320,53 @@ template <class T> Integer table::readSpectra(T& spectrumList)
 
     if (in.Flux.size() == 0 ) {
 
-      vector<Real> paramval;
-      SPreadVectorColRow(spec, "PARAMVAL", iSpec+1, paramval);
+      int status(0);
 
       in.ParameterValues.resize(NumIntParams);
-      for (size_t i=0; i<(size_t)NumIntParams; i++) {
-	in.ParameterValues[i] = paramval[i];
+      if ( NumIntParams > 0 ) {
+	fits_read_col(fptr, TDOUBLE, paramCol, iSpec+1, 1, NumIntParams, NULL,
+		      &in.ParameterValues[0], NULL, &status);
       }
 
-      size_t Nbins = Energies.size()-1;
-
-      vector<Real> intpspec;
-      SPreadVectorColRow(spec, "INTPSPEC", iSpec+1, intpspec);
       in.Flux.resize(Nbins);
-      for (size_t i=0; i<Nbins; i++) {
-	in.Flux[i] = intpspec[i];
-      }
+      fits_read_col(fptr, TDOUBLE, intpCol, iSpec+1, 1, Nbins, NULL,
+		    &in.Flux[0], NULL, &status);
       // not reading flux errors yet
       in.FluxError.resize(0);
 
+      in.addFlux.resize(NumAddParams);
       for (size_t iaF=0; iaF<(size_t)NumAddParams; iaF++) {
+	in.addFlux[iaF].resize(Nbins);
+	fits_read_col(fptr, TDOUBLE, addCol[iaF], iSpec+1, 1, Nbins, NULL,
+		      &in.addFlux[iaF][0], NULL, &status);
+      }
+      // not reading flux errors yet
+      in.addFluxError.resize(0);
 
-	vector<Real> addpspec;
-	SPreadVectorColRow(spec, addColName[iaF], iSpec+1, addpspec);
-	in.addFlux.push_back(addpspec);
-	// not reading flux errors yet
-	in.addFluxError.resize(0);
-
+      if ( status != 0 ) {
+	releaseSpectrum(iSpec);
+	ostringstream msg;
+	msg << "Failed to read spectrum " << iSpec+1 << " from " << Filename;
+	SPreportError(NoData, msg.str());
+	return(NoData);
       }
 
+      CacheLastUse[iSpec] = ++CacheClock;
+      CacheOrder[CacheClock] = iSpec;
+
     }
 
   }
 
+  // release the least recently used spectra if there are too many. Those just
+  // requested were used most recently so are not released even if there are
+  // more of them than SpectrumCacheSize.
+
+  if ( SpectrumCacheSize > 0 ) {
+    size_t keep = max(SpectrumCacheSize, (size_t)spectrumList.size());
+    while ( CacheOrder.size() > keep ) releaseSpectrum(CacheOrder.begin()->second);
+  }
+
   return(OK);
 }
 
@@ -341,11 +376,50 @@ template Integer table::readSpectra(valarray<Integer>& spectrumList);
 template Integer table::readSpectra(valarray<size_t>& spectrumList);
 template Integer table::readSpectra(vector<size_t>& spectrumList);
 
+// release a spectrum read on demand
+
+void table::releaseSpectrum(const Integer number)
+{
+  tableSpectrum& sp = Spectra[number];
+  vector<Real>().swap(sp.Flux);
+  vector<Real>().swap(sp.FluxError);
+  vector<Real>().swap(sp.ParameterValues);
+  vector<vector<Real> >().swap(sp.addFlux);
+  vector<vector<Real> >().swap(sp.addFluxError);
+
+  if ( (size_t)number < CacheLastUse.size() && CacheLastUse[number] != 0 ) {
+    CacheOrder.erase(CacheLastUse[number]);
+    CacheLastUse[number] = 0;
+  }
+
+  return;
+}
+
+// release the Spectra read on demand and the saved parameter bracketing
+
+void table::clearCache()
+{
+  while ( CacheOrder.size() > 0 ) releaseSpectrum(CacheOrder.begin()->second);
+  CacheLastUse.clear();
+  SpectrumFile.close();
+  BracketSet.clear();
+
+  return;
+}
+
+// return the number of Spectra read on demand currently held in memory
+
+Integer table::NumberCachedSpectra()
+{
+  return CacheOrder.size();
+}
+
 // Push table Parameter object
 
 void table::pushParameter(const tableParameter& paramObject)
 {
   Parameters.push_back(paramObject);
+  BracketSet.clear();
   return;
 }
 
@@ -434,6 +508,10 @@ void table::clear()
   LowEnergyLimit = -1.0;
   HighEnergyLimit = -1.0;
   Filename = " ";
+  CacheOrder.clear();
+  CacheLastUse.clear();
+  SpectrumFile.close();
+  BracketSet.clear();
   return;
 }
 
@@ -915,6 +993,166 @@ Integer table::write(string outfilename)
 
 }
 
+// find the tabulated values bracketing a value of interpolation parameter iPar.
+// If the value matches a tabulated value to within FUZZY (or is beyond the
+// tabulated values by no more than that) then exact is set and index gives the
+// tabulated value, otherwise the value lies between index and index+1 and
+// fraction is the interpolation fraction. The result for the last value of each
+// parameter is saved since in a fit most parameters do not change between calls.
+
+Integer table::bracketParameter(const size_t iPar, const Real value, bool& exact,
+				Integer& index, Real& fraction)
+{
+  if ( BracketSet.size() != Parameters.size() ) {
+    BracketValue.resize(Parameters.size());
+    BracketSet.assign(Parameters.size(), false);
+    BracketExact.resize(Parameters.size());
+    BracketIndex.resize(Parameters.size());
+    BracketFraction.resize(Parameters.size());
+  }
+
+  if ( BracketSet[iPar] && BracketValue[iPar] == value ) {
+    exact = BracketExact[iPar];
+    index = BracketIndex[iPar];
+    fraction = BracketFraction[iPar];
+    return(OK);
+  }
+
+  const tableParameter& tabParam = Parameters[iPar];
+  const vector<Real>& tabValue = tabParam.TabulatedValues;
+  size_t N = tabValue.size();
+
+  exact = false;
+  index = 0;
+  fraction = 0.0;
+
+  if ( N > 1 ) {
+    // Condition for out-of-bounds test must be consistent with
+    // the test for exactness below.  Note that tabValue's original
+    // input comes from floats in a FITS file, not doubles.
+    const Real fuzz = (value == 0.0) ? 0.0 : FUZZY;
+    const Real magnitude = (value == 0.0) ? 1.0 : std::abs(value);
+    if ((tabValue[0] - value)/magnitude > fuzz || 
+	(value - tabValue[N-1])/magnitude > fuzz ) {
+      return(TableParamValueOutsideRange);
+    }
+    for (; index < (Integer)N-1; ++index) {
+      if ( (exact = (std::abs((value - tabValue[index])/magnitude) <= fuzz)) ) break;
+    }       
+  } else {
+    exact = true;
+  }
+
+  if ( !exact ) {
+    // index is the arraypoint in TabulatedValues below the target value,
+    // which is therefore straddled by (index,index+1). if the range is
+    // exceeded, perform constant extrapolation.
+    SPfind(tabValue,value,index);
+    if ( index >= static_cast<int>(N - 1)) {
+      exact = true;
+      index = N - 1;
+    } else if ( index < 0 ) {
+      exact = true;
+      index = 0;
+    } else {
+      Real x1 = tabValue[index];
+      Real x2 = tabValue[index+1];
+      if (tabParam.InterpolationMethod == 0) {
+	fraction = (value - x1)/(x2 - x1);
+      } else {
+	// we know x1 < parVal < x2.
+	// now, we ought to check that x1,x2 > 0 earlier
+	// than this point!
+	fraction = log(value/x1)/log(x2/x1);           
+      }
+    }
+  }
+
+  BracketValue[iPar] = value;
+  BracketSet[iPar] = true;
+  BracketExact[iPar] = exact;
+  BracketIndex[iPar] = index;
+  BracketFraction[iPar] = fraction;
+
+  return(OK);
+}
+
+// the interpolation kernel. Sets out to the sum of the source arrays each
+// multiplied by its weight, working through the energies in blocks small enough
+// that the output block stays in cache while the sources are added to it four
+// at a time. The blocks are shared between NumberThreads threads.
+
+static const size_t tableBlockSize(1024);
+
+struct tableInterpolation {
+  const Real* const* source;
+  const Real* weight;
+  size_t NumberSources;
+  size_t NumberEnergies;
+  Real* out;
+};
+
+static void tableInterpolationWork(size_t first, size_t last, Integer /*thread*/, void* data)
+{
+  tableInterpolation* p = static_cast<tableInterpolation*>(data);
+  const size_t NS = p->NumberSources;
+  Real* out = p->out;
+
+  for (size_t iblock=first; iblock<=last; iblock++) {
+    const size_t start = iblock*tableBlockSize;
+    const size_t end = min(start+tableBlockSize, p->NumberEnergies);
+
+    for (size_t ie=start; ie<end; ie++) out[ie] = 0.0;
+
+    size_t r(0);
+    for (; r+4<=NS; r+=4) {
+      const Real* s0 = p->source[r];
+      const Real* s1 = p->source[r+1];
+      const Real* s2 = p->source[r+2];
+      const Real* s3 = p->source[r+3];
+      const Real w0(p->weight[r]), w1(p->weight[r+1]), w2(p->weight[r+2]), w3(p->weight[r+3]);
+      size_t ie(start);
+#ifdef __SSE2__
+      __m128d v0 = _mm_set1_pd(w0);
+      __m128d v1 = _mm_set1_pd(w1);
+      __m128d v2 = _mm_set1_pd(w2);
+      __m128d v3 = _mm_set1_pd(w3);
+      for (; ie+2<=end; ie+=2) {
+	__m128d sum01 = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(s0+ie), v0),
+				   _mm_mul_pd(_mm_loadu_pd(s1+ie), v1));
+	__m128d sum23 = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(s2+ie), v2),
+				   _mm_mul_pd(_mm_loadu_pd(s3+ie), v3));
+	_mm_storeu_pd(out+ie, _mm_add_pd(_mm_loadu_pd(out+ie), _mm_add_pd(sum01, sum23)));
+      }
+#endif
+      for (; ie<end; ie++) out[ie] += (w0*s0[ie] + w1*s1[ie]) + (w2*s2[ie] + w3*s3[ie]);
+    }
+    for (; r<NS; r++) {
+      const Real* s0 = p->source[r];
+      const Real w0(p->weight[r]);
+      for (size_t ie=start; ie<end; ie++) out[ie] += w0*s0[ie];
+    }
+  }
+
+  return;
+}
+
+static void tableInterpolate(const vector<const Real*>& sources, const vector<Real>& weights,
+			     const size_t NumberEnergies, const Integer NumberThreads, Real* out)
+{
+  tableInterpolation p;
+  p.source = sources.size() > 0 ? &sources[0] : NULL;
+  p.weight = weights.size() > 0 ? &weights[0] : NULL;
+  p.NumberSources = sources.size();
+  p.NumberEnergies = NumberEnergies;
+  p.out = out;
+
+  size_t NumberBlocks = (NumberEnergies + tableBlockSize - 1)/tableBlockSize;
+  SPparallelFor(NumberBlocks, NumberThreads, tableInterpolationWork, &p);
+
+  return;
+}
+
 // get values from table for input parameters using interpolation.
 
 template <class T> Integer table::getValues(const T& parameterValues, const Real minEnergy, 
@@ -953,144 +1191,49 @@ template <class T> Integer table::getValues(const T& parameterValues, const Real
     return(InconsistentNumTableParams);
   }
 
-  // now, test for limits.
-  size_t totalBlockSize(1);
-  vector<IntegerArray> prepRecordNumbers(Ninter);
+  // find the bracketing tabulated values for each interpolation parameter and
+  // the fractions for each interpolation
   vector<bool> exactMatch(Ninter);
-  for (size_t j= 0; j < Ninter; ++j) {
-    Real value = interParamValues[j];
-    const tableParameter& tabParam = Parameters[interParamIndex[j]];
-    const vector<Real>& tabValue = tabParam.TabulatedValues;
-    size_t N = tabValue.size();
-    // accumulate product of numbers of parameter values,
-    // will be used to calculate table offsets below.
-    totalBlockSize *= N;
-    size_t kExact (0);
-    if ( N > 1 ) {
-      // Condition for out-of-bounds test must be consistent with
-      // the test for exactness below.  Note that tabValue's original
-      // input comes from floats in a FITS file, not doubles.
-      const Real fuzz = (value == 0.0) ? 0.0 : FUZZY;
-      const Real magnitude = (value == 0.0) ? 1.0 : std::abs(value);
-      if ((tabValue[0] - value)/magnitude > fuzz || 
-	  (value - tabValue[N-1])/magnitude > fuzz ) {
- 	return(TableParamValueOutsideRange);
-      } else {
-	for (; kExact < N-1; ++kExact) {
-	  if ( (exactMatch[j] 
-		= (std::abs((value - tabValue[kExact])/magnitude) <= fuzz)) )
-	    break;
-	}       
-      }
-    } else {
-      exactMatch[j] = true;
-    }
-
-    if (exactMatch[j]) {
-      // just store this here for now, will resize
-      // correctly later.
-      prepRecordNumbers[j].resize(1,kExact);
-    } else {
-      size_t n (1);
-      // 2^(j+1) records needed.
-      for (size_t l = 0; l <= j ; ++l ) if (!exactMatch[l]) n *= 2; 
-      prepRecordNumbers[j].resize(n,0);
-    }
-  }
-  
-  IntegerArray blockOffset(Ninter,1);
-  blockOffset[0] = totalBlockSize;
-
-  size_t jj(0);
-  do {
-    totalBlockSize /= Parameters[interParamIndex[jj]].TabulatedValues.size(); 
-    blockOffset[jj] = totalBlockSize;    
-    ++jj;  
-  } while ( jj < Ninter - 1);
-  
   IntegerArray bracket(Ninter);
-  for (size_t j = 0; j < Ninter; ++ j) {
-    Real value = interParamValues[j];
-    const tableParameter& tabParam = Parameters[interParamIndex[j]];
-    const vector<Real>& tabValue = tabParam.TabulatedValues;
-    if ( !exactMatch[j] ) {
-      // bracket[j] is the arraypoint in TabulatedValues below the target
-      // value, which is therefore straddled by (bracket[j],bracket[j]+1).
-      // if the range is exceed, perform constant extrapolation.
-      SPfind(tabValue,value,bracket[j]);
-      if ( bracket[j] >= static_cast<int>(tabValue.size() - 1)) {
-	exactMatch[j] = true;
-	prepRecordNumbers[j][0] = tabValue.size() - 1;   
-	for ( size_t l  = j ;  l < Ninter; ++l) {
-	  prepRecordNumbers[l].resize(prepRecordNumbers[l].size()/2,0);   
-	}
-      } else if ( bracket[j] < 0) {
-	exactMatch[j] = true;
-	prepRecordNumbers[j][0] = 0;   
-	for ( size_t l  = j ;  l < Ninter; ++l) {
-	  prepRecordNumbers[l].resize(prepRecordNumbers[l].size()/2,0);   
-	}      
-      } else {
-	if ( j == 0 ) {
-	  prepRecordNumbers[0][0] = blockOffset[0]*(bracket[0]);   
-	  prepRecordNumbers[0][1] = blockOffset[0]*(bracket[0] + 1);  
-	} else {
-	  IntegerArray& previous = prepRecordNumbers[j-1];
-	  size_t MP = previous.size();
-	  for (size_t k = 0; k < MP; ++k) {
-	    prepRecordNumbers[j][2*k] = previous[k]  + blockOffset[j]*(bracket[j]);
-	    prepRecordNumbers[j][2*k + 1] 
-	      = previous[k]  + blockOffset[j]*(bracket[j] + 1);
-	  }
-	}
-	
-      }
-    }  
-    
-    if (exactMatch[j]) {
-      int kExact = prepRecordNumbers[j][0];
-      if ( j == 0 ) {
-	// this will evaluate correctly to the #of blocks
-	// before the one containing the record of interest
-	// because kExact is 0 based. 
-	prepRecordNumbers[j][0] = blockOffset[0]*kExact;
-      } else {
-	IntegerArray& previous = prepRecordNumbers[j-1];
-	prepRecordNumbers[j].resize(previous.size());
-	size_t MP = previous.size();
-	for (size_t k = 0; k < MP; ++k) {
-	  prepRecordNumbers[j][k] = previous[k] + 
-	    blockOffset[j]*kExact;
-	}
-      }
-    }     
+  vector<Real> fraction(Ninter);
+  for (size_t j=0; j<Ninter; ++j) {
+    bool exact;
+    Integer status = bracketParameter(interParamIndex[j], interParamValues[j], exact,
+				      bracket[j], fraction[j]);
+    if ( status != OK ) return(status);
+    exactMatch[j] = exact;
   }
-  IntegerArray recordNumbers(prepRecordNumbers[Ninter-1]); 
-
-  // now for each interpolation parameter i the input values lies between the
-  // bracket[i] and bracket[i+1] entries in TabulatedValues. recordNumbers points
-  // to the entries in Spectra which will be required.
-
-  // calculate the fractions for each interpolation
-  RealArray fraction(0.0, interParamValues.size());
-  for (size_t j=0; j<fraction.size(); ++j) {
-    if (!exactMatch[j]) {
-      Real parValue = interParamValues[j];
-      const tableParameter& tabParam = Parameters[interParamIndex[j]];
-      const vector<Real>& tParValues = tabParam.TabulatedValues;
-      Real x1 = tParValues[bracket[j]];
-      Real x2 = tParValues[bracket[j]+1];
-      if (tabParam.InterpolationMethod == 0) {
-	fraction[j] = (parValue - x1)/(x2 - x1);
-      } else {
-	// we know x1 < parVal < x2.
-	// now, we ought to check that x1,x2 > 0 earlier
-	// than this point!
-	fraction[j] = log(parValue/x1)/log(x2/x1);           
+
+  // the record numbers of the Spectra required and their interpolation weights.
+  // The records for parameter j are blockOffset apart where blockOffset is the
+  // product of the numbers of tabulated values of the later parameters. Each
+  // inexact parameter doubles the number of records with those for bracket[j]
+  // and bracket[j]+1 adjacent, with weights 1-fraction[j] and fraction[j].
+  vector<size_t>& recordNumbers = WorkRecords;
+  vector<Real>& weights = WorkWeights;
+  recordNumbers.assign(1, 0);
+  weights.assign(1, 1.0);
+  size_t blockOffset(1);
+  for (size_t j=0; j<Ninter; ++j) {
+    blockOffset *= Parameters[interParamIndex[j]].TabulatedValues.size();
+  }
+  for (size_t j=0; j<Ninter; ++j) {
+    blockOffset /= Parameters[interParamIndex[j]].TabulatedValues.size();
+    size_t MP = recordNumbers.size();
+    if ( exactMatch[j] ) {
+      for (size_t k=0; k<MP; ++k) recordNumbers[k] += blockOffset*bracket[j];
+    } else {
+      recordNumbers.resize(2*MP);
+      weights.resize(2*MP);
+      for (size_t k=MP; k>0; --k) {
+	recordNumbers[2*k-1] = recordNumbers[k-1] + blockOffset*(bracket[j] + 1);
+	recordNumbers[2*k-2] = recordNumbers[k-1] + blockOffset*bracket[j];
+	weights[2*k-1] = weights[k-1]*fraction[j];
+	weights[2*k-2] = weights[k-1]*(1.0-fraction[j]);
       }
     }
   }
-  
+
   // find the range of tabulated energies between minEnergy and maxEnergy.
   // minEindex should be the last entry in Energies below minEnergy and
   // maxEindex should be the first entry in Energies above maxEnergy.
@@ -1118,104 +1261,75 @@ template <class T> Integer table::getValues(const T& parameterValues, const Real
 
   // now set up to do the interpolation
 
-  const size_t NP(interParamValues.size());
   const size_t NR(recordNumbers.size());
   const size_t NA(NumAddParams);
 
-  // make sure that we have read in the Spectra objects which we will be using
-  readSpectra(recordNumbers);
-
-  // load all the spectra and variances into work arrays
-  vector<RealArray> spectrumEntries(NR);
-  vector<RealArray> varianceEntries(NR);
-
-  // this should have the option of loading individual tableSpectrum elements
-  // as necessary rather than holding the entire table model file in memory
-  // ie the xspec readStrategy
-
-  for (size_t i=0; i<NR; i++) {
-    const tableSpectrum& tabSpec = Spectra[recordNumbers[i]];
-    spectrumEntries[i].resize(NE);
-    for (size_t ie=0; ie<NE; ie++) spectrumEntries[i][ie] = tabSpec.Flux[ie+minEindex];
-    if ( isError ) {
-      varianceEntries[i].resize(NE);
-      for (size_t ie=0; ie<NE; ie++) {
-	varianceEntries[i][ie] = tabSpec.FluxError[ie+minEindex]*tabSpec.FluxError[ie+minEindex];
-      }
-    }
-  }
+  // make sure that we have read in the Spectra objects which we will be using.
+  // if they are being read on demand then at most SpectrumCacheSize (or NR if
+  // larger) are kept in memory.
+  Integer status = readSpectra(recordNumbers);
+  if ( status != OK ) return(status);
 
-  // accumulate additional parameter spectra for each recordNumber
+  // the interpolated spectrum is the weighted sum of the spectra for the records
+  // plus the weighted sums of their additional parameter spectra each multiplied
+  // by its parameter value, so list all these with their weights and sum them
+  // in one pass. Records with zero weight are skipped.
+  vector<const Real*>& sources = WorkSources;
+  vector<Real>& sourceWeights = WorkSourceWeights;
+  sources.clear();
+  sourceWeights.clear();
   for (size_t j=0; j<NR; j++) {
+    if ( weights[j] == 0.0 ) continue;
     const tableSpectrum& tabSpec = Spectra[recordNumbers[j]];
+    sources.push_back(&tabSpec.Flux[minEindex]);
+    sourceWeights.push_back(weights[j]);
     for (size_t k=0; k<NA; k++) {
-      Real parValue = addParamValues[k];
-      for (size_t ie=0; ie<NE; ie++) spectrumEntries[j][ie] += tabSpec.addFlux[k][ie+minEindex] * parValue;
-      if ( isError ) {
-	for (size_t ie=0; ie<NE; ie++) varianceEntries[j][ie] += pow(2.0,tabSpec.addFluxError[k][ie+minEindex] * parValue);
-      }
-    }
-  } 
-
-  // and the interpolation
-
-  if ( NR > 1 ) {
-
-    size_t nd = NR;
-    vector<RealArray> reducedSp(nd);
-    vector<RealArray> reducedVar(nd);
-    for (size_t i=0; i<nd; i++) reducedSp[i].resize(NE);
-    if ( isError ) {
-      for (size_t i=0; i<nd; i++) reducedVar[i].resize(NE);
+      sources.push_back(&tabSpec.addFlux[k][minEindex]);
+      sourceWeights.push_back(weights[j]*addParamValues[k]);
     }
-    for (int j=NP-1; j>=0; --j ) {
-      Real factor = fraction[j];
-      Real complfactor = 1.0-fraction[j];
-      if ( !exactMatch[j] ) {
-	nd /= 2;
-	for (size_t k=0; k<nd; ++k) {
-	  const size_t k2 = 2*k;
-	  reducedSp[k] = complfactor*spectrumEntries[k2] + factor*spectrumEntries[k2+1];
-	  if ( isError ) {
-	    reducedVar[k] = complfactor*varianceEntries[k2]
-		   + factor*varianceEntries[k2+1];       
-	  }  
-	}
-      } else {
-	for ( size_t k = 0; k < nd; ++k ) reducedSp[k] = spectrumEntries[k];
-	if ( isError ) {
-	  for (size_t k=0; k<nd; ++k) {
-	    reducedVar[k] = varianceEntries[k];
-	  }
-	}
-      }
-      for (size_t i=0; i<nd; ++i) spectrumEntries[i] = reducedSp[i];
-      if ( isError ) {
-	for (size_t i=0; i<nd; ++i) varianceEntries[i] = reducedVar[i];
-      }
-
-    }
-
-    if (nd != 1 ) {
-      // we should never end up here
-    }
-
   }
 
+  WorkSpectrum.resize(NE);
+  tableInterpolate(sources, sourceWeights, NE, NumberThreads, &WorkSpectrum[0]);
+
   // set the output arrays including time dilation factor if redshift is non-zero
 
   tableValues.resize(NE);
   if ( zfact == 1.0 ) {
-    for (size_t ie=0; ie<NE; ie++) tableValues[ie] = spectrumEntries[0][ie];
+    for (size_t ie=0; ie<NE; ie++) tableValues[ie] = WorkSpectrum[ie];
   } else {
-    for (size_t ie=0; ie<NE; ie++) tableValues[ie] = spectrumEntries[0][ie]/zfact;
+    for (size_t ie=0; ie<NE; ie++) tableValues[ie] = WorkSpectrum[ie]/zfact;
   }
+
+  // and the same for the variances, which are first found for each record
+
   if ( isError ) {
+    vector<vector<Real> >& varianceEntries = WorkVariances;
+    if ( varianceEntries.size() < NR ) varianceEntries.resize(NR);
+    sources.clear();
+    sourceWeights.clear();
+    for (size_t j=0; j<NR; j++) {
+      if ( weights[j] == 0.0 ) continue;
+      const tableSpectrum& tabSpec = Spectra[recordNumbers[j]];
+      varianceEntries[j].resize(NE);
+      for (size_t ie=0; ie<NE; ie++) {
+	varianceEntries[j][ie] = tabSpec.FluxError[ie+minEindex]*tabSpec.FluxError[ie+minEindex];
+      }
+      for (size_t k=0; k<NA; k++) {
+	Real parValue = addParamValues[k];
+	for (size_t ie=0; ie<NE; ie++) varianceEntries[j][ie] += pow(2.0,tabSpec.addFluxError[k][ie+minEindex] * parValue);
+      }
+      sources.push_back(&varianceEntries[j][0]);
+      sourceWeights.push_back(weights[j]);
+    }
+
+    tableInterpolate(sources, sourceWeights, NE, NumberThreads, &WorkSpectrum[0]);
+
     tableErrors.resize(NE);
     if ( zfact == 1.0 ) {
-      for (size_t ie=0; ie<NE; ie++) tableErrors[ie] = sqrt(varianceEntries[0][ie]);
+      for (size_t ie=0; ie<NE; ie++) tableErrors[ie] = sqrt(WorkSpectrum[ie]);
     } else {
-      for (size_t ie=0; ie<NE; ie++) tableErrors[ie] = sqrt(varianceEntries[0][ie])/zfact;
+      for (size_t ie=0; ie<NE; ie++) tableErrors[ie] = sqrt(WorkSpectrum[ie])/zfact;
     }
   }
 
@@ -1229,6 +1343,96 @@ template Integer table::getValues(const vector<Real>&, const Real, const Real,
 				  vector<Real>&, vector<Real>&, vector<Real>&);
 
 
+//-------------------------------------------------------------------------------
+// Class tableFile
+
+// default constructor
+
+tableFile::tableFile()
+  : fptr(NULL),
+    ParamCol(0),
+    IntpCol(0),
+    AddCol()
+{
+}
+
+// copy constructor - the copy does not share the open file
+
+tableFile::tableFile(const tableFile&)
+  : fptr(NULL),
+    ParamCol(0),
+    IntpCol(0),
+    AddCol()
+{
+}
+
+// destructor
+
+tableFile::~tableFile()
+{
+  close();
+}
+
+// assignment - the file is not shared
+
+tableFile& tableFile::operator=(const tableFile& rhs)
+{
+  if ( this != &rhs ) close();
+  return *this;
+}
+
+// open the SPECTRA extension of the file and find the columns
+
+Integer tableFile::open(const string& filename, const Integer NumAddParams)
+{
+  close();
+
+  int status(0);
+  fits_open_file(&fptr, filename.c_str(), READONLY, &status);
+  if ( status != 0 ) {
+    fptr = NULL;
+    string msg = "Failed to read "+filename;
+    SPreportError(NoSuchFile, msg);
+    return(NoSuchFile);
+  }
+
+  char hduName[] = "SPECTRA";
+  fits_movnam_hdu(fptr, BINARY_TBL, hduName, 0, &status);
+  char paramName[] = "PARAMVAL";
+  fits_get_colnum(fptr, CASEINSEN, paramName, &ParamCol, &status);
+  char intpName[] = "INTPSPEC";
+  fits_get_colnum(fptr, CASEINSEN, intpName, &IntpCol, &status);
+  AddCol.resize(NumAddParams);
+  for (size_t iaF=0; iaF<(size_t)NumAddParams; iaF++) {
+    ostringstream sname;
+    sname << "ADDSP" << setfill('0') << setw(3) << iaF+1;
+    string addName = sname.str();
+    fits_get_colnum(fptr, CASEINSEN, const_cast<char*>(addName.c_str()), &AddCol[iaF], &status);
+  }
+
+  if ( status != 0 ) {
+    close();
+    string msg = "Failed to find the spectrum columns in "+filename;
+    SPreportError(NoData, msg);
+    return(NoData);
+  }
+
+  return(OK);
+}
+
+// close the file
+
+void tableFile::close()
+{
+  if ( fptr != NULL ) {
+    int status(0);
+    fits_close_file(fptr, &status);
+    fptr = NULL;
+  }
+  AddCol.clear();
+  return;
+}
+
 //-------------------------------------------------------------------------------
 // Class tableParameter
 
@@ -76,6 +76,39 @@ class tableSpectrum{
 
 };
 
+// class definition for the SPECTRA extension of a table file held open between
+// reads of spectra on demand. A copy does not share the open file but will open
+// it again when needed.
+
+class tableFile{
+ public:
+
+  fitsfile* fptr;
+  int ParamCol;                 // column numbers of PARAMVAL, INTPSPEC and ADDSPnnn
+  int IntpCol;
+  vector<int> AddCol;
+
+  //constructors
+
+  tableFile();
+  tableFile(const tableFile&);
+
+  // destructor
+
+  ~tableFile();
+
+  tableFile& operator=(const tableFile&);
+
+  // open the SPECTRA extension of the file and find the columns
+
+  Integer open(const string& filename, const Integer NumAddParams);
+
+  // close the file
+
+  void close();
+
+};
+
 // class definition for table
 
 class table{
@@ -95,6 +128,9 @@ class table{
   Real LowEnergyLimit;
   Real HighEnergyLimit;
   string Filename;
+  size_t SpectrumCacheSize;     // Maximum number of spectra read on demand to keep
+                                // in memory, 0 for no limit
+  Integer NumberThreads;        // Number of threads to use for interpolation
   
   // constructor
 
@@ -110,10 +146,21 @@ class table{
   Integer read(string infilename);
   Integer read(string infilename, bool loadAll);
 
-  // read the listed Spectra
+  // read the listed Spectra. When the table was read without loading the
+  // Spectra they are read as needed and, if SpectrumCacheSize is non-zero, the
+  // least recently used are released to keep at most SpectrumCacheSize in memory.
 
   template <class T> Integer readSpectra(T& spectrumList); 
 
+  // release the Spectra read on demand and the saved parameter bracketing used
+  // by getValues. Should be called if Parameters or Spectra are changed directly.
+
+  void clearCache();
+
+  // return the number of Spectra read on demand currently held in memory
+
+  Integer NumberCachedSpectra();
+
   // Push table Parameter object
 
   void pushParameter(const tableParameter& paramObject);
@@ -162,4 +209,43 @@ class table{
 				       const Real maxEnergy, T& tableEnergyBins, 
 				       T& tableValues, T& tableErrors);
 
+ private:
+
+  // the Spectra read on demand, indexed by the time of their last use, and for
+  // each spectrum its time of last use (0 if not read on demand)
+
+  map<unsigned long, Integer> CacheOrder;
+  vector<unsigned long> CacheLastUse;
+  unsigned long CacheClock;
+
+  // the table file while spectra are being read on demand
+
+  tableFile SpectrumFile;
+
+  // the bracketing of the last value of each interpolation parameter
+
+  vector<Real> BracketValue;
+  vector<bool> BracketSet;
+  vector<bool> BracketExact;
+  vector<Integer> BracketIndex;
+  vector<Real> BracketFraction;
+
+  // work arrays for getValues, kept between calls
+
+  vector<size_t> WorkRecords;
+  vector<Real> WorkWeights;
+  vector<const Real*> WorkSources;
+  vector<Real> WorkSourceWeights;
+  vector<Real> WorkSpectrum;
+  vector<vector<Real> > WorkVariances;
+
+  // find the tabulated values bracketing a value of an interpolation parameter
+
+  Integer bracketParameter(const size_t iPar, const Real value, bool& exact,
+			   Integer& index, Real& fraction);
+
+  // release a spectrum read on demand
+
+  void releaseSpectrum(const Integer number);
+
 };
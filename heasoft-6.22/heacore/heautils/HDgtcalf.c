@@ -1,6 +1,11 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "fitsio.h"
 #include "hdcal.h"
 #include "HDgtcalf_internal.h"
@@ -29,6 +34,45 @@ static int gtcalidx (char* mode, char* missn, char* inst, char* ciffil,
       char* instdir, int* status);
 static int rdcnfgl (FILE * fptr, char * missn, char * inst, char* cifdev,
       char* cifdir, char* cif, char* datadev, char* datadir, int * status);
+static int rdcnfg (const char *config, int *status);
+
+/* CIF index structures */
+
+enum { CIF_TEL, CIF_INS, CIF_DET, CIF_FILT, CIF_CNAM, CIF_DIR, CIF_FILE,
+       CIF_DEV, CIF_NSTR };
+
+typedef struct cifbucket {
+     char *key;                   /* TELESCOP/INSTRUME[/CAL_CNAM] in upper case */
+     long nrows;
+     long size;
+     long *rows;                  /* row numbers (counting from 0) in order */
+     struct cifbucket *next;
+} CIFBUCKET;
+
+typedef struct cifindex {
+     char path[FILENAME_MAX+1];   /* CIF filename */
+     long long mtime;             /* CIF modification time, size and inode */
+     long long mtimensec;         /* nanoseconds part of mtime, if known */
+     long long size;
+     long long inode;
+     long nrows;
+     int width[CIF_NSTR];         /* string column widths */
+     char *str[CIF_NSTR];         /* string columns, width+1 characters per row */
+     double *reftime;             /* REF_TIME */
+     double *qual;                /* CAL_QUAL */
+     long *xno;                   /* CAL_XNO */
+     int cbdnelem;                /* number of CAL_CBD values per row */
+     CBDLIST **cbd;               /* parsed CAL_CBD values, cbdnelem per row */
+     long nbucket;
+     CIFBUCKET **bucket;          /* hash table of row numbers */
+     struct cifindex *next;
+} CIFINDEX;
+
+static int cifindex_get(char *cif, CIFINDEX **index, int *cached, int *status);
+static void cifindex_free(CIFINDEX *cifidx);
+static CIFBUCKET* cifbucket_find(CIFINDEX *cifidx, const char *tele,
+      const char *instr, const char *codenam);
+static char* cifvalue(CIFINDEX *cifidx, int col, long i);
 
 
 /*---------------------------------------------------------------------*/
@@ -156,33 +200,24 @@ static int gtcalf_work(char* cif, const char* tele, const char* instr,
 	 int* nret, int* nfound, int* status)
 {
 
-    fitsfile* fptr=NULL;
-    long nax2val=0;
-    int telcol=0, inscol=0, detcol=0,codcol=0;
-    int filtcol=0, cbdcol=0, refcol=0, qulcol=0;
-    int devcol=0, dircol=0, filcol=0, extcol=0;
-
-    int dw=0;
-    int cbdnelem = 9;
-    char *telval=NULL, *insval=NULL, *filtval=NULL, *cbdval=NULL;
-    char *codval=NULL, *detval=NULL;
-    char *dirval=NULL;
-    double *refval=NULL,qulval=0,maxrefval=0;
-    int anynull =1;
+    CIFINDEX *cifidx=NULL;
+    int cached=0;
+    CIFBUCKET *bucket1=NULL, *bucket2=NULL;
+    long nrows=0, n1=0, n2=0, i1=0, i2=0;
+    long *rows=NULL;
+    int *index=NULL;
+    double refval=0,maxrefval=0;
     char *tmpfile=NULL;
 
     CBDLIST *list1 =NULL;
-    CBDLIST *list2 =NULL;
 
     char * caldbvar ="CALDB"; 
 
-    int *index=NULL;
     char msg[256];
 
-    int i;
-    int k;
-    int typecode;
-    long repeat=1, width=1;
+    long i;
+    long k;
+    int j;
 
 
     if(*status) return *status;
@@ -197,106 +232,363 @@ static int gtcalf_work(char* cif, const char* tele, const char* instr,
     }
 
 
-    if (fits_open_table(&fptr, cif, READONLY, status)) {
-        sprintf(msg,"Unable to open CALDB index file");
-        HD_ERROR_THROW(msg,*status); 
-        goto cleanup;
-     }
+    if (cifindex_get(cif,&cifidx,&cached,status)) goto cleanup;
 
-    if (ffgkyj(fptr,"NAXIS2",&nax2val,NULL,status)) {
-        sprintf(msg,"Problem reading NAXIS2 of CIF");
-        HD_ERROR_THROW(msg,*status); 
-        goto cleanup;
-    }
-
-    if( nax2val == 0 ) {
+    if( cifidx->nrows == 0 ) {
          *status = CIF_ERR_EMPTY_TABLE;
          sprintf(msg,"CIF table is empty");
          HD_ERROR_THROW(msg,*status);
          goto cleanup;
     }
 
-    index = (int*) malloc(nax2val*sizeof(int)); 
-    refval = (double*) calloc(nax2val,sizeof(double));
+    /* the rows with this telescope and instrument which have the requested
+       codename or a codename of NONE, in row order */
 
-    for( i=0; i<nax2val; i++) {
-	index[i]=0;
-    }
-
-    
-    if( ffgcno(fptr,1,"TELESCOP",&telcol,status)) {
-         sprintf(msg,"Unable to find TELESCOP column");
-         HD_ERROR_THROW(msg,*status); 
-         goto cleanup;
-    }
-
-    if(ffgcdw(fptr,telcol,&dw,status)) {
-         sprintf(msg,"Unable to find TELESCOP column display width");
-         HD_ERROR_THROW(msg,*status); 
-         goto cleanup;
+    if(strcasecmp(codenam,"NONE") == 0) {
+         bucket1 = cifbucket_find(cifidx,tele,instr,NULL);
     }
     else {
-         telval=(char*) calloc(dw+1,sizeof(char));
+         bucket1 = cifbucket_find(cifidx,tele,instr,codenam);
+         bucket2 = cifbucket_find(cifidx,tele,instr,"NONE");
     }
 
-   
-    if( ffgcno(fptr,1,"INSTRUME",&inscol,status)) {
-         sprintf(msg,"Unable to find INSTRUME column");
-         HD_ERROR_THROW(msg,*status); 
-         goto cleanup;
-    }
+    if(bucket1) n1 = bucket1->nrows;
+    if(bucket2) n2 = bucket2->nrows;
 
-    if(ffgcdw(fptr,inscol,&dw,status)) {
-         sprintf(msg,"Unable to find INSTRUME column display width");
-         HD_ERROR_THROW(msg,*status);
-         goto cleanup;
-    }
-    else {
-         insval=(char*) calloc(dw+1,sizeof(char));
-    }
+    rows = (long*) malloc((n1+n2+1)*sizeof(long));
+    index = (int*) malloc((n1+n2+1)*sizeof(int));
 
-    if( ffgcno(fptr,1,"DETNAM",&detcol,status)) {
-         sprintf(msg,"Unable to find DETNAM column");
-         HD_ERROR_THROW(msg,*status); 
-         goto cleanup;
+    while( i1 < n1 || i2 < n2 ) {
+         if( i2 == n2 || (i1 < n1 && bucket1->rows[i1] < bucket2->rows[i2]) ) {
+              rows[nrows++] = bucket1->rows[i1++];
+         }
+         else {
+              rows[nrows++] = bucket2->rows[i2++];
+         }
     }
 
-    if(ffgcdw(fptr,detcol,&dw,status)) {
-         sprintf(msg,"Unable to find DETNAM column display width");
-         HD_ERROR_THROW(msg,*status);
-         goto cleanup;
-    }
-    else {
-         detval=(char*) calloc(dw+1,sizeof(char));
-    }
+    for ( k =0; k < nrows; k++ ) {
 
-    if( ffgcno(fptr,1,"FILTER",&filtcol,status)) {
-         sprintf(msg,"Unable to find FILTER column");
-         HD_ERROR_THROW(msg,*status); 
-         goto cleanup;
-    }
+        i = rows[k];
+        refval = cifidx->reftime[i];
 
-    if(ffgcdw(fptr,filtcol,&dw,status)) {
-         sprintf(msg,"Unable to find FILTER column display width");
-         HD_ERROR_THROW(msg,*status);
-         goto cleanup;
-    }
-    else {
-         filtval=(char*) calloc(dw+1,sizeof(char));
-    }
+        if((detnam[0] == '-' ||
+            strcasecmp(cifvalue(cifidx,CIF_DET,i),detnam) == 0 ||
+            strcasecmp(cifvalue(cifidx,CIF_DET,i),"NONE") == 0 ||
+            strcasecmp(detnam,"NONE") == 0 ) &&
+           (strcmp(filt,"-") == 0 ||
+            strcasecmp(cifvalue(cifidx,CIF_FILT,i),filt) == 0 ||
+            strcasecmp(cifvalue(cifidx,CIF_FILT,i),"NONE") == 0 ||
+            strcasecmp(filt,"NONE") == 0) &&
+           cifidx->qual[i] == 0 ) index[k] =1;
+        else index[k] =0;
 
-    if( ffgcno(fptr,1,"CAL_CNAM",&codcol,status)) {
-         sprintf(msg,"Unable to find CAL_CNAM column");
-         HD_ERROR_THROW(msg,*status); 
-         goto cleanup;
-    }
-    if(ffgcdw(fptr,codcol,&dw,status)) {
-         sprintf(msg,"Unable to find CAL_CNAM column display width");
-         HD_ERROR_THROW(msg,*status);
-         goto cleanup;
+        for( j=0; j<cifidx->cbdnelem && index[k]; j++) {
+             index[k] = cmpCBD(list1,cifidx->cbd[i*cifidx->cbdnelem+j]);
+        }
+
+
+        if( startreftime != -99) {
+	        if( startreftime >= refval ) {
+                     if(refval > maxrefval && index[k]) maxrefval =refval;
+       		}
+        	else {
+	             index[k] =0;
+        	}
+        }
+        if( stopreftime != -99) {
+	        if( refval > stopreftime ) {
+	             index[k] =0;
+        	}
+        }
+
+     }
+     
+     for( k=0; k<nrows ; k++) {
+         
+         if( cifidx->reftime[rows[k]] < maxrefval ) index[k] =0;
+     }
+
+
+     *nfound =0;
+     *nret =0;
+     for( k=0; k<nrows ; k++) {
+        
+       if(index[k] >0 ) {
+         i = rows[k];
+         if( *nret < maxret ) {
+
+         strcpy(tmpfile,cifvalue(cifidx,CIF_FILE,i));
+         if(cpthnm(caldbvar,cifvalue(cifidx,CIF_DIR,i),tmpfile,status)) {
+                sprintf(msg,"Fail to get path name");
+                HD_ERROR_THROW(msg,*status); 
+		goto cleanup;
+         }
+
+
+         strncpy(file[*nret],tmpfile,fnamesize - 1);
+         file[*nret][fnamesize - 1] = 0;
+
+         extno[*nret] = cifidx->xno[i];
+         strcpy(online[*nret],cifvalue(cifidx,CIF_DEV,i));
+
+         *nret =*nret+1;
+         }
+         *nfound =*nfound+1;
+       }
+      }
+
+
+
+cleanup:
+    if(cifidx && !cached) cifindex_free(cifidx);
+    if(list1) freecbd(list1);
+    if(rows) free(rows);
+    if(index) free(index);
+    if(tmpfile) free(tmpfile);
+     
+    return *status;
+
+}
+
+
+/*------------------------------------------------------------------------*/
+
+/*
+  CIF index
+
+  The rows of a calibration index file are read once per process and kept,
+  with the CAL_CBD boundaries already parsed and the row numbers hashed on
+  TELESCOP/INSTRUME/CAL_CNAM, so that a query only looks at the rows which
+  can match it. The index is rebuilt if the CIF changes on disk, judged by
+  its modification time (to the nanosecond where the system keeps it), size
+  and inode. If the HDGTCALF_CACHE_DIR environment variable is set the index
+  is also saved in that directory and read from there by later processes,
+  until the CIF changes. The index of a CIF modified in the last few seconds
+  is not saved, since an edit which keeps its size might not yet show in
+  its modification time.
+*/
+
+static const char *cifstrcols[CIF_NSTR] = {"TELESCOP", "INSTRUME", "DETNAM",
+     "FILTER", "CAL_CNAM", "CAL_DIR", "CAL_FILE", "CAL_DEV"};
+
+static CIFINDEX *ciflist = NULL;
+
+/* return the value of string column col in row i (counting from 0) */
+
+static char* cifvalue(CIFINDEX *cifidx, int col, long i)
+{
+     return cifidx->str[col] + i*(cifidx->width[col]+1);
+}
+
+/* make the hash key for the telescope, instrument and codename (if not NULL) */
+
+static char* cifkey(const char *tele, const char *instr, const char *codenam)
+{
+     char *key;
+     long n = strlen(tele) + strlen(instr) + (codenam ? strlen(codenam) : 0) + 3;
+     long i;
+
+     key = (char*) malloc(n);
+     if(codenam) sprintf(key,"%s\n%s\n%s",tele,instr,codenam);
+     else sprintf(key,"%s\n%s",tele,instr);
+     for( i=0; key[i]; i++) key[i] = toupper((unsigned char)key[i]);
+
+     return key;
+}
+
+static unsigned long cifhash(const char *key)
+{
+     unsigned long h = 2166136261UL;
+     while(*key) {
+          h ^= (unsigned char)*key++;
+          h *= 16777619UL;
+     }
+     return h;
+}
+
+/* find the rows with this telescope, instrument and codename (or any codename
+   if codenam is NULL). Returns NULL if there are none. */
+
+static CIFBUCKET* cifbucket_find(CIFINDEX *cifidx, const char *tele,
+      const char *instr, const char *codenam)
+{
+     CIFBUCKET *bucket;
+     char *key = cifkey(tele,instr,codenam);
+
+     bucket = cifidx->bucket[cifhash(key) % cifidx->nbucket];
+     while( bucket && strcmp(bucket->key,key) != 0 ) bucket = bucket->next;
+
+     free(key);
+     return bucket;
+}
+
+static void cifbucket_add(CIFINDEX *cifidx, char *key, long row)
+{
+     CIFBUCKET *bucket;
+     unsigned long h = cifhash(key) % cifidx->nbucket;
+
+     bucket = cifidx->bucket[h];
+     while( bucket && strcmp(bucket->key,key) != 0 ) bucket = bucket->next;
+
+     if( bucket == NULL ) {
+          bucket = (CIFBUCKET*) calloc(1,sizeof(CIFBUCKET));
+          bucket->key = key;
+          bucket->next = cifidx->bucket[h];
+          cifidx->bucket[h] = bucket;
+     }
+     else {
+          free(key);
+     }
+
+     if( bucket->nrows == bucket->size ) {
+          bucket->size = bucket->size ? 2*bucket->size : 4;
+          bucket->rows = (long*) realloc(bucket->rows,bucket->size*sizeof(long));
+     }
+     bucket->rows[bucket->nrows++] = row;
+}
+
+/* hash the row numbers on TELESCOP/INSTRUME and TELESCOP/INSTRUME/CAL_CNAM */
+
+static void cifindex_hash(CIFINDEX *cifidx)
+{
+     long i;
+
+     cifidx->nbucket = cifidx->nrows/2 + 1;
+     cifidx->bucket = (CIFBUCKET**) calloc(cifidx->nbucket,sizeof(CIFBUCKET*));
+
+     for( i=0; i<cifidx->nrows; i++) {
+          cifbucket_add(cifidx, cifkey(cifvalue(cifidx,CIF_TEL,i),
+                cifvalue(cifidx,CIF_INS,i),NULL), i);
+          cifbucket_add(cifidx, cifkey(cifvalue(cifidx,CIF_TEL,i),
+                cifvalue(cifidx,CIF_INS,i),cifvalue(cifidx,CIF_CNAM,i)), i);
+     }
+}
+
+static void cifindex_free(CIFINDEX *cifidx)
+{
+     CIFBUCKET *bucket, *next;
+     long i;
+
+     if( cifidx == NULL ) return;
+
+     for( i=0; i<CIF_NSTR; i++) if(cifidx->str[i]) free(cifidx->str[i]);
+     if(cifidx->reftime) free(cifidx->reftime);
+     if(cifidx->qual) free(cifidx->qual);
+     if(cifidx->xno) free(cifidx->xno);
+     if(cifidx->cbd) {
+          for( i=0; i<cifidx->nrows*cifidx->cbdnelem; i++) {
+               if(cifidx->cbd[i]) freecbd(cifidx->cbd[i]);
+          }
+          free(cifidx->cbd);
+     }
+     if(cifidx->bucket) {
+          for( i=0; i<cifidx->nbucket; i++) {
+               for( bucket=cifidx->bucket[i]; bucket; bucket=next) {
+                    next = bucket->next;
+                    free(bucket->key);
+                    free(bucket->rows);
+                    free(bucket);
+               }
+          }
+          free(cifidx->bucket);
+     }
+     free(cifidx);
+}
+
+/* read nelem string values of width w from each row of a column into buf,
+   reading the whole column at once if each row has nelem values */
+
+static int cifread_strings(fitsfile *fptr, int col, long nrows, long nelem,
+      int w, char *buf, int *status)
+{
+     char **values;
+     long i;
+     long repeat=1, width=1;
+     int typecode, anynull;
+
+     if(fits_get_coltype(fptr,col,&typecode,&repeat,&width,status)) return *status;
+
+     values = (char**) malloc(nrows*nelem*sizeof(char*));
+     for( i=0; i<nrows*nelem; i++) values[i] = buf + i*(w+1);
+
+     if( repeat/width == nelem ) {
+          ffgcvs(fptr,col,1,1,nrows*nelem," ",values,&anynull,status);
+     }
+     else {
+          for( i=0; i<nrows && !*status; i++) {
+               ffgcvs(fptr,col,i+1,1,nelem," ",values+i*nelem,&anynull,status);
+          }
+     }
+
+     free(values);
+     return *status;
+}
+
+/* read the first value from each row of a numeric column */
+
+static int cifread_numbers(fitsfile *fptr, int col, int datatype, long nrows,
+      void *buf, int *status)
+{
+     long i;
+     long repeat=1, width=1;
+     int typecode, anynull;
+     size_t size = (datatype == TDOUBLE) ? sizeof(double) : sizeof(long);
+
+     if(fits_get_coltype(fptr,col,&typecode,&repeat,&width,status)) return *status;
+
+     if( repeat == 1 ) {
+          fits_read_col(fptr,datatype,col,1,1,nrows,NULL,buf,&anynull,status);
+     }
+     else {
+          for( i=0; i<nrows && !*status; i++) {
+               fits_read_col(fptr,datatype,col,i+1,1,1,NULL,(char*)buf+i*size,
+                     &anynull,status);
+          }
+     }
+
+     return *status;
+}
+
+/* read the CIF and parse the CAL_CBD values */
+
+static int cifindex_read(char *cif, CIFINDEX *cifidx, int *status)
+{
+    fitsfile* fptr=NULL;
+    int strcol[CIF_NSTR];
+    int refcol=0, qulcol=0, extcol=0, cbdcol=0;
+    int cbdw=0;
+    char *cbdval=NULL;
+    CBDLIST *list2=NULL;
+    long repeat=1, width=1;
+    int typecode;
+    char msg[256];
+    long i;
+    int k;
+
+    if (fits_open_table(&fptr, cif, READONLY, status)) {
+        sprintf(msg,"Unable to open CALDB index file");
+        HD_ERROR_THROW(msg,*status); 
+        goto cleanup;
+     }
+
+    if (ffgkyj(fptr,"NAXIS2",&cifidx->nrows,NULL,status)) {
+        sprintf(msg,"Problem reading NAXIS2 of CIF");
+        HD_ERROR_THROW(msg,*status); 
+        goto cleanup;
     }
-    else {
-        codval=(char*) calloc(dw+1,sizeof(char));
+
+    for( k=0; k<CIF_NSTR; k++) {
+         if( ffgcno(fptr,1,(char*)cifstrcols[k],&strcol[k],status)) {
+              sprintf(msg,"Unable to find %s column",cifstrcols[k]);
+              HD_ERROR_THROW(msg,*status); 
+              goto cleanup;
+         }
+         if(ffgcdw(fptr,strcol[k],&cifidx->width[k],status)) {
+              sprintf(msg,"Unable to find %s column display width",cifstrcols[k]);
+              HD_ERROR_THROW(msg,*status);
+              goto cleanup;
+         }
     }
 
     if( ffgcno(fptr,1,"REF_TIME",&refcol,status)) {
@@ -311,256 +603,420 @@ static int gtcalf_work(char* cif, const char* tele, const char* instr,
          goto cleanup;
     }
 
-    if( ffgcno(fptr,1,"CAL_DEV",&devcol,status)) {
-         sprintf(msg,"Unable to find CAL_DEV column");
+    if( ffgcno(fptr,1,"CAL_XNO",&extcol,status)) {
+         sprintf(msg,"Unable to find CAL_XNO column");
          HD_ERROR_THROW(msg,*status); 
          goto cleanup;
     }
 
-
-    if( ffgcno(fptr,1,"CAL_DIR",&dircol,status)) {
-         sprintf(msg,"Unable to find CAL_DIR column");
+    if( ffgcno(fptr,1,"CAL_CBD",&cbdcol,status)) {
+         sprintf(msg,"Unable to find CAL_CBD column");
          HD_ERROR_THROW(msg,*status); 
          goto cleanup;
     }
 
-    if(ffgcdw(fptr,dircol,&dw,status)) {
-         sprintf(msg,"Unable to find CAL_DIR column display width");
+    if(ffgcdw(fptr,cbdcol,&cbdw,status)) {
+         sprintf(msg,"Unable to find CAL_CBD column display width");
          HD_ERROR_THROW(msg,*status);
          goto cleanup;
     }
-    else {
-         dirval=(char*) calloc(dw+1,sizeof(char));
+
+    if(fits_get_coltype(fptr,cbdcol, &typecode,&repeat,&width,status)) {
+         sprintf(msg,"Error reading CBDCOL column type");
+         HD_ERROR_THROW(msg,*status); 
+         goto cleanup;
     }
 
+    cifidx->cbdnelem = (int) (repeat/width);
+
+    if( cifidx->nrows == 0 ) goto cleanup;
+
+    /* read the whole of each column */
 
-    if( ffgcno(fptr,1,"CAL_FILE",&filcol,status)) {
-         sprintf(msg,"Unable to find CAL_FILE column");
+    for( k=0; k<CIF_NSTR; k++) {
+         cifidx->str[k] = (char*) calloc(cifidx->nrows*(cifidx->width[k]+1),sizeof(char));
+         if(cifread_strings(fptr,strcol[k],cifidx->nrows,1,cifidx->width[k],
+                cifidx->str[k],status)) {
+              sprintf(msg,"Error reading %s column",cifstrcols[k]);
+              HD_ERROR_THROW(msg,*status); 
+              goto cleanup;
+         }
+    }
+
+    cifidx->reftime = (double*) calloc(cifidx->nrows,sizeof(double));
+    if(cifread_numbers(fptr,refcol,TDOUBLE,cifidx->nrows,cifidx->reftime,status)) {
+         sprintf(msg,"Error reading REFCOL column");
          HD_ERROR_THROW(msg,*status); 
          goto cleanup;
     }
 
-    if( ffgcno(fptr,1,"CAL_XNO",&extcol,status)) {
-         sprintf(msg,"Unable to find CAL_XNO column");
+    cifidx->qual = (double*) calloc(cifidx->nrows,sizeof(double));
+    if(cifread_numbers(fptr,qulcol,TDOUBLE,cifidx->nrows,cifidx->qual,status)) {
+         sprintf(msg,"Error reading QULCOL column");
          HD_ERROR_THROW(msg,*status); 
          goto cleanup;
     }
 
-    if( ffgcno(fptr,1,"CAL_CBD",&cbdcol,status)) {
-         sprintf(msg,"Unable to find CAL_CBD column");
+    cifidx->xno = (long*) calloc(cifidx->nrows,sizeof(long));
+    if(cifread_numbers(fptr,extcol,TLONG,cifidx->nrows,cifidx->xno,status)) {
+         sprintf(msg,"Error reading EXTLCOL column");
          HD_ERROR_THROW(msg,*status); 
          goto cleanup;
     }
 
-    if(ffgcdw(fptr,cbdcol,&dw,status)) {
-         sprintf(msg,"Unable to find CAL_CBD column display width");
-         HD_ERROR_THROW(msg,*status);
+    /* parse the calibration boundaries of every row */
+
+    cbdval = (char*) calloc(cifidx->nrows*cifidx->cbdnelem*(cbdw+1),sizeof(char));
+    if(cifread_strings(fptr,cbdcol,cifidx->nrows,cifidx->cbdnelem,cbdw,cbdval,status)) {
+         sprintf(msg,"Error reading CBDCOL column");
+         HD_ERROR_THROW(msg,*status); 
          goto cleanup;
     }
-    else {
-          cbdval=(char*) calloc(dw+1,sizeof(char));
+
+    cifidx->cbd = (CBDLIST**) calloc(cifidx->nrows*cifidx->cbdnelem,sizeof(CBDLIST*));
+    for( i=0; i<cifidx->nrows*cifidx->cbdnelem; i++) {
+         list2 = NULL;
+         if(parseCBD(i/cifidx->cbdnelem,cbdval+i*(cbdw+1),&list2,status) ) {
+	      if(list2) freecbd(list2);
+	      sprintf(msg,"Parse CDBnXXX error");
+              HD_ERROR_THROW(msg,*status); 
+              goto cleanup;
+         }
+         cifidx->cbd[i] = list2;
     }
 
-    for ( i =0; i < nax2val; i++ ) {
+cleanup:
+    if(fptr) {
+         int tstatus = 0;
+         fits_close_file(fptr,&tstatus);
+    }
+    if(cbdval) free(cbdval);
 
-         if( ffgcvs(fptr,telcol,i+1,1,1," ",&telval,&anynull,status) ) {
-                sprintf(msg,"Error reading TELCOL column");
-                HD_ERROR_THROW(msg,*status); 
-                goto cleanup;
-         }
-         
-         if( ffgcvs(fptr,inscol,i+1,1,1," ",&insval,&anynull,status) ) {
-                sprintf(msg,"Error reading INSCOL column");
-                HD_ERROR_THROW(msg,*status); 
-                goto cleanup;
-         }
+    return *status;
+}
 
-         if(detnam[0] == '-' ) {
-		strcpy(detval,"NONE");
-	 }
-	 else {
-		if(ffgcvs(fptr,detcol,i+1,1,1," ",&detval,
-                     &anynull,status) ) {
-                        sprintf(msg,"Error reading DETCOL column");
-                        HD_ERROR_THROW(msg,*status); 
-                        goto cleanup;
-		}
-	 }
-
-         if(strcmp(filt,"-") == 0 ) {
-		strcpy(filtval,"NONE");
-	 }
-	 else {
-		if(ffgcvs(fptr,filtcol,i+1,1,1," ",&filtval,
-                     &anynull,status)) {
-                        sprintf(msg,"Error reading FILCOL column");
-                        HD_ERROR_THROW(msg,*status); 
-                        goto cleanup;
-		}
-	 }
+/* the name of the file holding the saved index for a CIF. Returns 0 if the
+   index is not to be saved. */
 
+static int cifindex_cachefile(const char *cif, char *cachefile)
+{
+     char *dir = getenv("HDGTCALF_CACHE_DIR");
 
-         if( ffgcvs(fptr,codcol,i+1,1,1," ",&codval,&anynull,status) ) {
-                sprintf(msg,"Error reading CODCOL column");
-                HD_ERROR_THROW(msg,*status); 
-                goto cleanup;
-         }
+     if( dir == NULL || dir[0] == '\0' ) return 0;
+     if( strlen(dir) + 32 > FILENAME_MAX ) return 0;
 
-         if( ffgcvd(fptr,refcol,i+1,1,1,0.0,&(refval[i]),&anynull,status) ) {
-                sprintf(msg,"Error reading REFCOL column");
-                HD_ERROR_THROW(msg,*status); 
-                goto cleanup;
-         }
+     sprintf(cachefile,"%s/hdgtcalf_%08lx.idx",dir,cifhash(cif) & 0xffffffffUL);
+     return 1;
+}
 
-         if( ffgcvd(fptr,qulcol,i+1,1,1,0,&qulval,&anynull,status) ) {
-                sprintf(msg,"Error reading QULCOL column");
-                HD_ERROR_THROW(msg,*status); 
-                goto cleanup;
-         }
+#define CIF_CACHE_MAGIC "HDgtcalf CIF index v2"
 
+/* save the index. The file is written under a temporary name and renamed so
+   other processes never see a partial file. */
 
-        if(strcasecmp(telval,tele) == 0 &&
-           strcasecmp(insval,instr) == 0 &&
-          (strcasecmp(detval,detnam) == 0 ||
-           strcasecmp(detval,"NONE") == 0 ||
-           strcasecmp(detnam,"NONE") == 0 ) &&
-          (strcasecmp(filtval,filt) == 0 ||
-           strcasecmp(filtval,"NONE") == 0 ||
-           strcasecmp(filt,"NONE") == 0) &&
-          (strcasecmp(codval,codenam) == 0 ||
-           strcasecmp(codval,"NONE") == 0 ||
-           strcasecmp(codenam,"NONE") ==0 ) &&
-           qulval == 0 ) index[i] =1;
-        else index[i] =0;
-
-        if(fits_get_coltype(fptr,cbdcol, &typecode,&repeat,&width,status)) {
-                sprintf(msg,"Error reading CBDCOL column type");
-                HD_ERROR_THROW(msg,*status); 
-                goto cleanup;
-        }
+static void cifindex_save(const char *cachefile, CIFINDEX *cifidx)
+{
+     char tmpfile[FILENAME_MAX+32];
+     char magic[32];
+     FILE *fptr;
+     CBDLIST *list;
+     int ok, ncbd, sizecbd = sizeof(CBD);
+     long i, n;
+
+     sprintf(tmpfile,"%s.%ld",cachefile,(long)getpid());
+     fptr = fopen(tmpfile,"wb");
+     if( fptr == NULL ) return;
+
+     memset(magic,0,sizeof(magic));
+     strcpy(magic,CIF_CACHE_MAGIC);
+     ok = fwrite(magic,sizeof(magic),1,fptr) == 1 &&
+          fwrite(&sizecbd,sizeof(int),1,fptr) == 1 &&
+          fwrite(cifidx->path,sizeof(cifidx->path),1,fptr) == 1 &&
+          fwrite(&cifidx->mtime,sizeof(cifidx->mtime),1,fptr) == 1 &&
+          fwrite(&cifidx->mtimensec,sizeof(cifidx->mtimensec),1,fptr) == 1 &&
+          fwrite(&cifidx->size,sizeof(cifidx->size),1,fptr) == 1 &&
+          fwrite(&cifidx->inode,sizeof(cifidx->inode),1,fptr) == 1 &&
+          fwrite(&cifidx->nrows,sizeof(long),1,fptr) == 1 &&
+          fwrite(&cifidx->cbdnelem,sizeof(int),1,fptr) == 1 &&
+          fwrite(cifidx->width,sizeof(int),CIF_NSTR,fptr) == CIF_NSTR;
+
+     n = cifidx->nrows;
+     for( i=0; ok && n > 0 && i<CIF_NSTR; i++) {
+          ok = fwrite(cifidx->str[i],cifidx->width[i]+1,n,fptr) == (size_t)n;
+     }
+     if( ok && n > 0 ) {
+          ok = fwrite(cifidx->reftime,sizeof(double),n,fptr) == (size_t)n &&
+               fwrite(cifidx->qual,sizeof(double),n,fptr) == (size_t)n &&
+               fwrite(cifidx->xno,sizeof(long),n,fptr) == (size_t)n;
+     }
+     for( i=0; ok && n > 0 && i<n*cifidx->cbdnelem; i++) {
+          ncbd = 0;
+          for( list=cifidx->cbd[i]; list; list=list->next) ncbd++;
+          ok = fwrite(&ncbd,sizeof(int),1,fptr) == 1;
+          for( list=cifidx->cbd[i]; ok && list; list=list->next) {
+               ok = fwrite(list->cbd,sizeof(CBD),1,fptr) == 1;
+          }
+     }
 
-        cbdnelem = (int) (repeat/width);
+     if( fclose(fptr) != 0 ) ok = 0;
+     if( !ok || rename(tmpfile,cachefile) != 0 ) remove(tmpfile);
+}
 
+/* read a saved index. Returns 0 if it is for the current version of the CIF. */
 
-        for( k=1; k<=cbdnelem; k++) {
-            if( ffgcvs(fptr,cbdcol,i+1,k,1," ",&cbdval,&anynull,status) ) {
-                cbdval ="none";
-                sprintf(msg,"Error reading CBDCOL column");
-                HD_ERROR_THROW(msg,*status); 
-                goto cleanup;
-            }
+static int cifindex_load(const char *cachefile, CIFINDEX *cifidx)
+{
+     char magic[32];
+     char path[FILENAME_MAX+1];
+     FILE *fptr;
+     CBDLIST *list, *last;
+     long long mtime, mtimensec, size, inode;
+     int ok, ncbd, sizecbd, j;
+     long i, n;
+
+     fptr = fopen(cachefile,"rb");
+     if( fptr == NULL ) return 1;
+
+     ok = fread(magic,sizeof(magic),1,fptr) == 1 &&
+          strncmp(magic,CIF_CACHE_MAGIC,sizeof(magic)) == 0 &&
+          fread(&sizecbd,sizeof(int),1,fptr) == 1 && sizecbd == sizeof(CBD) &&
+          fread(path,sizeof(path),1,fptr) == 1 &&
+          strncmp(path,cifidx->path,sizeof(path)) == 0 &&
+          fread(&mtime,sizeof(mtime),1,fptr) == 1 && mtime == cifidx->mtime &&
+          fread(&mtimensec,sizeof(mtimensec),1,fptr) == 1 &&
+          mtimensec == cifidx->mtimensec &&
+          fread(&size,sizeof(size),1,fptr) == 1 && size == cifidx->size &&
+          fread(&inode,sizeof(inode),1,fptr) == 1 && inode == cifidx->inode &&
+          fread(&cifidx->nrows,sizeof(long),1,fptr) == 1 && cifidx->nrows >= 0 &&
+          fread(&cifidx->cbdnelem,sizeof(int),1,fptr) == 1 && cifidx->cbdnelem >= 0 &&
+          fread(cifidx->width,sizeof(int),CIF_NSTR,fptr) == CIF_NSTR;
+
+     /* a damaged file must not lead to sizes which overflow, and every
+        allocation is checked before it is read into */
+
+     n = ok ? cifidx->nrows : 0;
+     if( ok && n > 0 ) {
+          ok = (size_t)n <= ((size_t)-1)/sizeof(double)/4 &&
+               (cifidx->cbdnelem == 0 ||
+                (size_t)n <= ((size_t)-1)/sizeof(CBDLIST*)/cifidx->cbdnelem - 1);
+     }
+     for( i=0; ok && n > 0 && i<CIF_NSTR; i++) {
+          ok = cifidx->width[i] >= 0 &&
+               (size_t)n <= ((size_t)-1)/((size_t)cifidx->width[i]+1);
+          if( ok ) {
+               cifidx->str[i] = (char*) malloc(n*(cifidx->width[i]+1));
+               ok = cifidx->str[i] != NULL &&
+                    fread(cifidx->str[i],cifidx->width[i]+1,n,fptr) == (size_t)n;
+          }
+     }
+     if( ok && n > 0 ) {
+          cifidx->reftime = (double*) malloc(n*sizeof(double));
+          cifidx->qual = (double*) malloc(n*sizeof(double));
+          cifidx->xno = (long*) malloc(n*sizeof(long));
+          cifidx->cbd = (CBDLIST**) calloc(n*cifidx->cbdnelem+1,sizeof(CBDLIST*));
+          ok = cifidx->reftime != NULL && cifidx->qual != NULL &&
+               cifidx->xno != NULL && cifidx->cbd != NULL &&
+               fread(cifidx->reftime,sizeof(double),n,fptr) == (size_t)n &&
+               fread(cifidx->qual,sizeof(double),n,fptr) == (size_t)n &&
+               fread(cifidx->xno,sizeof(long),n,fptr) == (size_t)n;
+     }
+     for( i=0; ok && n > 0 && i<n*cifidx->cbdnelem; i++) {
+          ok = fread(&ncbd,sizeof(int),1,fptr) == 1 && ncbd >= 0;
+          last = NULL;
+          for( j=0; ok && j<ncbd; j++) {
+               list = (CBDLIST*) calloc(1,sizeof(CBDLIST));
+               ok = list != NULL;
+               if( !ok ) break;
+               list->cbd = (CBD*) calloc(1,sizeof(CBD));
+               list->prev = last;
+               if( last ) last->next = list;
+               else cifidx->cbd[i] = list;
+               last = list;
+               ok = list->cbd != NULL &&
+                    fread(list->cbd,sizeof(CBD),1,fptr) == 1;
+          }
+     }
 
-	    if(list2) freecbd(list2);
-            list2 = NULL;
-            if(parseCBD(i,cbdval,&list2,status) ) {
-	       sprintf(msg,"Parse CDBnXXX error");
-               HD_ERROR_THROW(msg,*status); 
-               goto cleanup;
-             }
+     fclose(fptr);
+     return ok ? 0 : 1;
+}
 
-             index[i] =  index[i] && cmpCBD(list1,list2);
-        }
+/* the nanoseconds part of a file's modification time, or 0 where the system
+   does not keep it */
 
+static long long stat_mtimensec(const struct stat *info)
+{
+#if defined(__APPLE__)
+     return (long long)info->st_mtimespec.tv_nsec;
+#elif defined(st_mtime)
+     /* st_mtime is a macro for st_mtim.tv_sec where st_mtim exists */
+     return (long long)info->st_mtim.tv_nsec;
+#else
+     return 0;
+#endif
+}
 
-        if( startreftime != -99) {
-	        if( startreftime >= refval[i] ) {
-                     if(refval[i] > maxrefval && index[i]) maxrefval =refval[i];
-		     index[i] =index[i] && 1;
-       		}
-        	else {
-	             index[i] =0;
-        	}
-        }
-        if( stopreftime != -99) {
-	        if( refval[i] <= stopreftime ) {
+/* return the index for a CIF, reading the CIF if it has not already been read
+   or has changed since. cached is set to 1 if the index is kept for later
+   queries and 0 if the caller must free it. */
 
-		     index[i] =index[i] && 1;
-       		}
-        	else {
-	             index[i] =0;
-        	}
-        }
+static int cifindex_get(char *cif, CIFINDEX **index, int *cached, int *status)
+{
+     CIFINDEX *cifidx, *prev=NULL;
+     struct stat info;
+     char cachefile[FILENAME_MAX+1];
+     int usecache;
 
+     *index = NULL;
+     *cached = 0;
 
+     if(*status) return *status;
 
-         
+     /* if the file cannot be checked for changes the index is not kept */
+
+     if( strlen(cif) > FILENAME_MAX || stat(cif,&info) != 0 ) {
+          cifidx = (CIFINDEX*) calloc(1,sizeof(CIFINDEX));
+          if(cifindex_read(cif,cifidx,status)) {
+               cifindex_free(cifidx);
+               return *status;
+          }
+          cifindex_hash(cifidx);
+          *index = cifidx;
+          return *status;
      }
-     
-     for( i=0; i<nax2val ; i++) {
-         
-         if( refval[i] < maxrefval ) index[i] =0;
+
+     for( cifidx=ciflist; cifidx; prev=cifidx, cifidx=cifidx->next) {
+          if( strcmp(cifidx->path,cif) == 0 ) {
+               if( cifidx->mtime == (long long)info.st_mtime &&
+                   cifidx->mtimensec == stat_mtimensec(&info) &&
+                   cifidx->size == (long long)info.st_size &&
+                   cifidx->inode == (long long)info.st_ino ) {
+                    *index = cifidx;
+                    *cached = 1;
+                    return *status;
+               }
+               if( prev ) prev->next = cifidx->next;
+               else ciflist = cifidx->next;
+               cifindex_free(cifidx);
+               break;
+          }
      }
 
+     cifidx = (CIFINDEX*) calloc(1,sizeof(CIFINDEX));
+     strcpy(cifidx->path,cif);
+     cifidx->mtime = info.st_mtime;
+     cifidx->mtimensec = stat_mtimensec(&info);
+     cifidx->size = info.st_size;
+     cifidx->inode = info.st_ino;
+
+     usecache = cifindex_cachefile(cif,cachefile);
+
+     if( !usecache || cifindex_load(cachefile,cifidx) ) {
+
+          /* start again in case a saved index was partly read */
+
+          cifindex_free(cifidx);
+          cifidx = (CIFINDEX*) calloc(1,sizeof(CIFINDEX));
+          strcpy(cifidx->path,cif);
+          cifidx->mtime = info.st_mtime;
+          cifidx->mtimensec = stat_mtimensec(&info);
+          cifidx->size = info.st_size;
+          cifidx->inode = info.st_ino;
+
+          if(cifindex_read(cif,cifidx,status)) {
+               cifindex_free(cifidx);
+               return *status;
+          }
+          /* A CIF changed within the last couple of seconds may be changed
+             again without its modification time moving on, where the file
+             system keeps coarse times, so its index is not saved for other
+             processes until it has settled. */
+
+          if( usecache && (long long)time(NULL) > cifidx->mtime + 2 )
+               cifindex_save(cachefile,cifidx);
+     }
 
-     *nfound =0;
-     *nret =0;
-     for( i=0; i<nax2val ; i++) {
-        
-       if(index[i] >0 ) {
-         if( *nret < maxret ) {
-         if( ffgcvs(fptr,dircol,i+1,1,1," ",&dirval,&anynull,status) ) {
-                sprintf(msg,"Error reading DIRCOL column");
-                HD_ERROR_THROW(msg,*status); 
-		goto cleanup;
-         }
-         if( ffgcvs(fptr,filcol,i+1,1,1," ",&tmpfile,&anynull,status) ) {
-                sprintf(msg,"Error reading FILCOL column");
-                HD_ERROR_THROW(msg,*status); 
-		goto cleanup;
-         }
+     cifindex_hash(cifidx);
 
-         if(cpthnm(caldbvar,dirval,tmpfile,status)) {
-                sprintf(msg,"Fail to get path name");
-                HD_ERROR_THROW(msg,*status); 
-		goto cleanup;
-         }
+     cifidx->next = ciflist;
+     ciflist = cifidx;
+     *index = cifidx;
+     *cached = 1;
 
+     return *status;
+}
 
-         strncpy(file[*nret],tmpfile,fnamesize - 1);
-         file[*nret][fnamesize - 1] = 0;
 
-         if( ffgcvj(fptr,extcol,i+1,1,1,0,extno+*nret,&anynull,status) ) {
-                sprintf(msg,"Error reading EXTLCOL column");
-                HD_ERROR_THROW(msg,*status); 
-		goto cleanup;
-         }
-         if( ffgcvs(fptr,devcol,i+1,1,1," ",&online[*nret],&anynull,status) ) {
-                sprintf(msg,"Error reading DEVCOL column");
-                HD_ERROR_THROW(msg,*status); 
-		goto cleanup;
-         }
-         *nret =*nret+1;
-         }
-         *nfound =*nfound+1;
-       }
-      }
+/*
+  HDgtcalf utility routines 
+*/
 
+/*-----------------------------------------------------------*/
 
+/* The lines of the CALDB configuration file, which are read once and kept
+   until the file changes */
 
-cleanup:
-    if(fptr) fits_close_file(fptr,&status);
-    if(telval) free(telval);
-    if(insval) free(insval);
-    if(filtval) free(filtval);
-    if(cbdval) free(cbdval);
-    if(detval) free(detval);
-    if(codval) free(codval);
-    if(dirval) free(dirval);
-    if(refval) free(refval);
-    if(tmpfile) free(tmpfile);
-    if(index) free(index);
-     
-    return *status;
+typedef struct cnfgline {
+     char missn[160], inst[160];
+     char cifdev[160], cifdir[160], cif[FILENAME_MAX+1];
+     char datadev[160], datadir[160];
+} CNFGLINE;
 
-}
+static char cnfgpath[FILENAME_MAX+1] = "";
+static long long cnfgmtime = 0, cnfgsize = 0, cnfginode = 0;
+static long cnfgnlines = 0;
+static CNFGLINE *cnfglines = NULL;
 
+static int rdcnfg (const char *config, int *status)
+/* Read the config file if it has changed since it was last read */
+{
+     FILE *fptr = 0;
+     struct stat info;
+     CNFGLINE line;
+     long size = 0;
+     int lstatus = 0;
+     char msg[256];
 
+     if(*status) return *status;
 
-/*
-  HDgtcalf utility routines 
-*/
+     if( strlen(config) <= FILENAME_MAX && stat(config,&info) == 0 &&
+         strcmp(config,cnfgpath) == 0 &&
+         cnfgmtime == (long long)info.st_mtime &&
+         cnfgsize == (long long)info.st_size &&
+         cnfginode == (long long)info.st_ino ) return *status;
 
-/*-----------------------------------------------------------*/
+     cnfgpath[0] = '\0';
+     cnfgnlines = 0;
+
+     fptr = fopen(config,"r");
+
+     if( NULL == fptr ) {
+         *status = HD_ERR_NULL_POINTER;
+         sprintf(msg,"CALDBCONFIG environment variable not properly set");
+         HD_ERROR_THROW(msg,*status);
+         return *status;
+     }
+
+     while( rdcnfgl(fptr,line.missn,line.inst,line.cifdev,line.cifdir,line.cif,
+                    line.datadev,line.datadir,&lstatus) == HD_OK ) {
+          if( cnfgnlines == size ) {
+               size = size ? 2*size : 64;
+               cnfglines = (CNFGLINE*) realloc(cnfglines,size*sizeof(CNFGLINE));
+          }
+          cnfglines[cnfgnlines++] = line;
+     }
+
+     fclose(fptr);
+
+     if( strlen(config) <= FILENAME_MAX && stat(config,&info) == 0 ) {
+          strcpy(cnfgpath,config);
+          cnfgmtime = info.st_mtime;
+          cnfgsize = info.st_size;
+          cnfginode = info.st_ino;
+     }
+
+     return *status;
+}
 
 static int gtcalidx (char* mode, char* missn,
               char* inst, char* ciffil, 
@@ -574,11 +1030,7 @@ static int gtcalidx (char* mode, char* missn,
      char *caldb;
      char *config;
 
-     char missval[160], instval[160];
-     char cifdev[160], cifdir[160];
-     char insdev[160], insdir[160];
-
-     FILE *fptr = 0;
+     long i;
      char msg[256];
      
      if(*status) return *status;  
@@ -601,46 +1053,34 @@ static int gtcalidx (char* mode, char* missn,
          goto cleanup;
      }
 
-      fptr = fopen(config,"r");
+     if( rdcnfg(config,status) ) goto cleanup;
 
-      if( NULL == fptr ) {
-         *status = HD_ERR_NULL_POINTER;
-         sprintf(msg,"CALDBCONFIG environment variable not properly set");
-         HD_ERROR_THROW(msg,*status);
-         goto cleanup;
-      }
-
-      do {
-      		if( rdcnfgl(fptr,missval,instval,cifdev,cifdir,ciffil,
-       		     insdev,insdir,status) ) {
-                        sprintf(msg,"Problem reading CALDB config file");
-                        HD_ERROR_THROW(msg,*status); 
-			goto cleanup;
-                }
-	        if( strcasecmp(missn,missval) == 0 ) {
-		        if(strcasecmp(instval,inst) == 0 ) {
-             			if(cpthnm(cifdev,cifdir,ciffil,status)) {
+     for( i=0; i<cnfgnlines; i++) {
+	        if( strcasecmp(missn,cnfglines[i].missn) == 0 &&
+		    strcasecmp(cnfglines[i].inst,inst) == 0 ) {
+                                strcpy(ciffil,cnfglines[i].cif);
+             			if(cpthnm(cnfglines[i].cifdev,cnfglines[i].cifdir,ciffil,status)) {
                                        sprintf(msg,"Problem getting cif");
                                        HD_ERROR_THROW(msg,*status); 
 			               goto cleanup;
                                  }
                                 strcpy(instdir,"");
-             			if(cpthnm(insdev,insdir,instdir,status)) {
+             			if(cpthnm(cnfglines[i].datadev,cnfglines[i].datadir,instdir,status)) {
                                        sprintf(msg,"Problem getting instdir");
                                        HD_ERROR_THROW(msg,*status); 
 			               goto cleanup;
              			}
-				break;
-			}
+				goto cleanup;
 		}
+     }
 
-        } while(1);
-
-                
+     /* no line for this mission and instrument */
 
+     *status = CIF_ERR_READ_CONFIG;
+     sprintf(msg,"Problem reading CALDB config file");
+     HD_ERROR_THROW(msg,*status); 
 
 cleanup:
- if ( fptr ) fclose( fptr );
  return *status;
 
 }
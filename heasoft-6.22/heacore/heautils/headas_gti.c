@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <stdlib.h>
+#include <pthread.h>
 #include "fitsio.h"
 #include "headas_error.h"
 #include "headas_gti.h"
@@ -805,6 +807,131 @@ void HDgtimrg1(struct gti_struct *gti, double *times,
   return;
 }
 
+/* 
+ * Internal check for GTI ordering
+ *
+ * Returns 1 if the valid intervals (start < stop) of gti are in time
+ * order and do not overlap, i.e. each one starts at or after the stop
+ * of the previous one.  If strict is non-zero, then any invalid
+ * interval also causes 0 to be returned.
+ *
+ */
+static int HDgti_ordered(struct gti_struct *gti, int strict)
+{
+  double last = 0;
+  int first = 1;
+  int i;
+
+  for (i=0; i<gti->ngti; i++) {
+    if (!(gti->start[i] < gti->stop[i])) {
+      if (strict) return 0;
+      continue;
+    }
+    if (!first && (gti->start[i] < last)) return 0;
+    last = gti->stop[i];
+    first = 0;
+  }
+
+  return 1;
+}
+
+/* 
+ * Internal GTI search routines
+ *
+ * For an ordered GTI, return the index of the first interval which
+ * stops after time t, or which starts at or after time t.  If there is
+ * no such interval, gti->ngti is returned.
+ *
+ */
+static int HDgti_first_stop(struct gti_struct *gti, double t)
+{
+  int lo = 0, hi = gti->ngti, mid;
+
+  while (lo < hi) {
+    mid = lo + (hi-lo)/2;
+    if (gti->stop[mid] <= t) lo = mid+1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+static int HDgti_first_start(struct gti_struct *gti, double t)
+{
+  int lo = 0, hi = gti->ngti, mid;
+
+  while (lo < hi) {
+    mid = lo + (hi-lo)/2;
+    if (gti->start[mid] < t) lo = mid+1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+/* 
+ * Internal GTI sweep merging routine
+ *
+ * Merges two GTIs which have both passed HDgti_ordered() in a single
+ * pass over the two lists, in the manner of a merge sort, rather than
+ * sorting the combined list of boundaries.  Invalid intervals are
+ * skipped, and zero-length or contiguous output intervals are never
+ * produced, so the result is the same as HDgtimrg1() followed by the
+ * clean-up done in HDgti_merge().
+ *
+ * The output storage must already hold agti->ngti+bgti->ngti rows.
+ *
+ */
+static void HDgti_sweep(int mode, struct gti_struct *gti, 
+			struct gti_struct *agti, struct gti_struct *bgti)
+{
+  int anum = agti->ngti, bnum = bgti->ngti;
+  int i = 0, j = 0, n = 0;
+  double start, stop;
+
+  while (1) {
+    while ((i < anum) && !(agti->start[i] < agti->stop[i])) i++;
+    while ((j < bnum) && !(bgti->start[j] < bgti->stop[j])) j++;
+
+    if (mode == GTI_AND) {
+      /* Overlap of the current pair of intervals, then advance
+	 whichever interval ends first */
+      if ((i >= anum) || (j >= bnum)) break;
+      start = agti->start[i];
+      if (bgti->start[j] > start) start = bgti->start[j];
+      if (agti->stop[i] <= bgti->stop[j]) {
+	stop = agti->stop[i];
+	i++;
+      } else {
+	stop = bgti->stop[j];
+	j++;
+      }
+      if (start >= stop) continue;
+    } else {
+      /* Take whichever interval starts first */
+      if ((i >= anum) && (j >= bnum)) break;
+      if ((j >= bnum) || ((i < anum) && (agti->start[i] <= bgti->start[j]))) {
+	start = agti->start[i];
+	stop  = agti->stop[i];
+	i++;
+      } else {
+	start = bgti->start[j];
+	stop  = bgti->stop[j];
+	j++;
+      }
+    }
+
+    /* Extend the previous interval if this one overlaps or touches it */
+    if ((n > 0) && (start <= gti->stop[n-1])) {
+      if (stop > gti->stop[n-1]) gti->stop[n-1] = stop;
+    } else {
+      gti->start[n] = start;
+      gti->stop[n]  = stop;
+      n++;
+    }
+  }
+
+  gti->ngti = n;
+}
+
 /* 
  * HDgti_merge - merge two GTIs either using intersection or union
  *
@@ -816,6 +943,11 @@ void HDgtimrg1(struct gti_struct *gti, double *times,
  * This routine is based heavily on the fortran version, taken from
  * the HEASARC extractor (gtilib.f).
  *
+ * If each input GTI is already in time order with no overlapping
+ * intervals (as HDgti_clean() leaves it), the merge is done in a
+ * single linear pass.  Otherwise the combined list of boundaries is
+ * sorted as before.  The result is the same either way.
+ *
  * int mode - merging mode, either GTI_AND or GTI_OR
  * struct gti_struct *gti - pointer to existing GTI structure, result of merge
  * struct gti_struct *agti - pointer to existing GTI structure, 1st input GTI
@@ -844,6 +976,18 @@ int HDgti_merge(int mode, struct gti_struct *gti,
 
   HDgti_init(gti);
 
+  /* 
+   * If both lists are already in time order without overlaps, which
+   * is the usual case, they can be merged in one pass without sorting.
+   */
+  if (HDgti_ordered(agti, 0) && HDgti_ordered(bgti, 0)) {
+    if (anum+bnum == 0) return (*status);
+    HDgti_grow(gti, anum+bnum, status);
+    if (*status) return (*status);
+    HDgti_sweep(mode, gti, agti, bgti);
+    return (*status);
+  }
+
   /* Special cases - hmm, this defeats the whole purpose of HDgti_clean() */
 #if 0
   if ((anum == 0) && (bnum == 0)) return (*status);
@@ -964,7 +1108,8 @@ int HDgti_merge(int mode, struct gti_struct *gti,
  * HDgti_clean - clean a GTI by sorting, removing duplicates, overlaps
  *
  * HDgti_clean:  Sort a gti list and remove invalid and overlapping
- *   intervals by calling HDgti_merge to OR it with nothing.
+ *   intervals by calling HDgti_merge to OR it with nothing.  A list
+ *   which is already in order is cleaned in a single linear pass.
  * 
  * This routine is based heavily on the fortran version, taken from
  * the HEASARC extractor.
@@ -988,6 +1133,89 @@ int HDgti_clean(struct gti_struct *gti, struct gti_struct *ogti,
   return HDgti_merge(GTI_OR, gti, ogti, &null_gti, status);
 }
 
+/* 
+ * HDgti_merge_n - merge several GTIs either using intersection or union
+ *
+ * Merges a list of good time interval lists.  If the mode is GTI_AND,
+ * then the intersection of all the lists is determined.  If the mode
+ * is GTI_OR, then the union of all the lists is found.  The result is
+ * the same as a chain of calls to HDgti_merge(), but the lists are
+ * merged in pairs, and then the results in pairs, and so on, so each
+ * interval takes part in about log2(ngtis) merges rather than up to
+ * ngtis of them.
+ *
+ * If ngtis is 1, the result is the cleaned input GTI.  If ngtis is 0,
+ * the result is empty.
+ *
+ * int mode - merging mode, either GTI_AND or GTI_OR
+ * struct gti_struct *gti - pointer to existing GTI structure, result of merge
+ * int ngtis - number of input GTIs
+ * struct gti_struct **gtis - an ngtis-element array of pointers to
+ *                            existing GTI structures, the input GTIs
+ * int *status - pointer to status variable
+ *
+ * RETURNS: status code 
+ */
+int HDgti_merge_n(int mode, struct gti_struct *gti, 
+		  int ngtis, struct gti_struct **gtis, 
+		  int *status)
+{
+  struct gti_struct *work = 0;
+  struct gti_struct merged;
+  int nwork, i;
+
+  if (status == 0) return NULL_INPUT_PTR;
+  if (*status) return (*status);
+  if ((gti == 0) || ((ngtis > 0) && (gtis == 0)))
+    return (*status = NULL_INPUT_PTR);
+  for (i=0; i<ngtis; i++) {
+    if (gtis[i] == 0) return (*status = NULL_INPUT_PTR);
+  }
+  if ((mode != GTI_AND) && (mode != GTI_OR)) return (*status = -1);
+
+  HDgti_init(gti);
+  if (ngtis <= 0) return (*status);
+  if (ngtis == 1) return HDgti_clean(gti, gtis[0], status);
+
+  nwork = (ngtis+1)/2;
+  work = (struct gti_struct *) malloc(sizeof(struct gti_struct)*nwork);
+  if (work == 0) return (*status = MEMORY_ALLOCATION);
+  for (i=0; i<nwork; i++) HDgti_init(&work[i]);
+
+  /* First merge the input GTIs in pairs ... */
+  for (i=0; (i<ngtis/2) && (*status == 0); i++) {
+    HDgti_merge(mode, &work[i], gtis[2*i], gtis[2*i+1], status);
+  }
+  if ((ngtis % 2) && (*status == 0)) {
+    HDgti_clean(&work[nwork-1], gtis[ngtis-1], status);
+  }
+
+  /* ... and then the results in pairs, until only one is left */
+  while ((nwork > 1) && (*status == 0)) {
+    for (i=0; (i<nwork/2) && (*status == 0); i++) {
+      HDgti_merge(mode, &merged, &work[2*i], &work[2*i+1], status);
+      HDgti_free(&work[2*i]);
+      HDgti_free(&work[2*i+1]);
+      work[i] = merged;
+    }
+    if (*status) break;
+    if (nwork % 2) {
+      work[nwork/2] = work[nwork-1];
+      HDgti_init(&work[nwork-1]);
+    }
+    nwork = (nwork+1)/2;
+  }
+
+  if (*status == 0) {
+    *gti = work[0];
+  } else {
+    for (i=0; i<nwork; i++) HDgti_free(&work[i]);
+  }
+  free(work);
+
+  return (*status);
+}
+
 /*
  * HDgti_exp - compute overlap exposure of a time bin with GTI
  * 
@@ -1000,6 +1228,9 @@ int HDgti_clean(struct gti_struct *gti, struct gti_struct *ogti,
  *     also, we assume that t1, t2, and the gti list are all
  *     in the same units.
  *
+ * The intervals are examined in order from the first, until one starts
+ * after the time bin.  For many time bins, HDgti_exp_many() is faster.
+ *
  * One difference from the FORTRAN version is that if there are no
  * good time intervals (i.e. gti->ngti == 0), then zero is returned
  * here.  In the FORTRAN version, the whole exposure is returned.
@@ -1036,6 +1267,9 @@ double HDgti_exp(double t1, double t2, struct gti_struct *gti, int *status)
      higher level. */
   if (gti->ngti == 0) return 0;
   
+  /* The list is scanned from the start rather than searched, since
+     checking that it is ordered would cost as much as the scan.  Lists
+     which are not ordered so give the same result as they always have. */
   for (i=0; i<gti->ngti; i++) {
     /* There are 6 cases: */
     /*     1) g1 g2 t1 t2: cycle to next interval */
@@ -1073,42 +1307,105 @@ double HDgti_exp(double t1, double t2, struct gti_struct *gti, int *status)
 }
 
 /*
- * HDgti_where - which good time intervals a set of times falls into
- *
- * HDgti_where examines an array of times, and determines which good time
- * intervals the times fall into.  This routine is most highly
- * optimized for times which are sorted in time order.
+ * HDgti_exp_many - compute overlap exposure of many time bins with GTI
+ * 
+ * Computes the same exposure as HDgti_exp() for each of a set of time
+ * bins, such as the bins of a light curve.  A running sum of the
+ * interval lengths is tabulated once, and each bin is then found by
+ * binary search, so the cost is O(ngti + ntimes*log(ngti)) rather than
+ * O(ngti*ntimes).  The exposure of any intervals which lie wholly
+ * inside a bin is taken from the difference of running sums, so the
+ * result may differ from HDgti_exp() in the last few bits.
  *
- * An interval of -1 indicates a time that does not fall into a good
- * time interval.
+ * The time bins need not be sorted.  As for HDgti_exp(), the GTI list
+ * should be ordered and contain no overlaps.  If it is not, or it
+ * holds an interval which does not stop after it starts, HDgti_exp()
+ * is called for each bin instead, which scans the list linearly and so
+ * gives exactly the HDgti_exp() result for such lists.
  *
- * struct gti_struct *gti - pointer to existing GTI structure.
- * int ntimes - size of times array.
- * double *times - an ntimes-element array, times to be examined.
- * int *segs - an ntimes-element array.  Upon return, the values give 
- *   which good time interval the time falls into:
- *    (times[i] >= gti->start[segs[i]]) && (times[i] < gti->stop[segs[i]])
- *   or, if segs[i] is -1, the time does not fall into a GTI
+ * struct gti_struct *gti - pointer to existing GTI structure, whose
+ *        overlap with the time bins is to be computed.
+ * int ntimes - number of time bins.
+ * double *t1 - an ntimes-element array, start of each time bin.
+ * double *t2 - an ntimes-element array, stop of each time bin.
+ *        (note: t1[i] <= t2[i])
+ * double *exposure - an ntimes-element array.  Upon return, the 
+ *        overlap exposure of each time bin.
  * int *status - pointer to status variable
  * 
  * RETURNS: status code */
-int HDgti_where(struct gti_struct *gti, int ntimes, 
-	     double *times, int *segs, int *status)
+int HDgti_exp_many(struct gti_struct *gti, int ntimes, 
+		   double *t1, double *t2, double *exposure, int *status)
 {
-  int i, j;
-  int ngti;
-  double t, tmin, tmax;
-  int s, s1;
+  double *cum = 0;
+  double lo, hi;
+  int i, j, j1, j2;
 
   if (status == 0) return NULL_INPUT_PTR;
   if (*status) return (*status);
-  if ((gti == 0) || (times == 0) || (segs == 0)) 
+  if ((gti == 0) || (t1 == 0) || (t2 == 0) || (exposure == 0)) 
     return (*status = NULL_INPUT_PTR);
 
-  if (ntimes == 0) return 0;
-  ngti = gti->ngti;
-  for (i=0; i<ntimes; i++) segs[i] = -1;
-  if (ngti == 0) return 0;
+  /* Invalid input time bin */
+  for (i=0; i<ntimes; i++) {
+    exposure[i] = 0;
+    if (t1[i] > t2[i]) return (*status = -1);
+  }
+  if (gti->ngti == 0) return 0;
+
+  if (!HDgti_ordered(gti, 1)) {
+    for (i=0; i<ntimes; i++) {
+      exposure[i] = HDgti_exp(t1[i], t2[i], gti, status);
+      if (*status) return (*status);
+    }
+    return 0;
+  }
+
+  /* cum[j] is the total length of intervals 0 to j-1 */
+  cum = (double *) malloc(sizeof(double)*(gti->ngti+1));
+  if (cum == 0) return (*status = MEMORY_ALLOCATION);
+  cum[0] = 0;
+  for (j=0; j<gti->ngti; j++) {
+    cum[j+1] = cum[j] + (gti->stop[j] - gti->start[j]);
+  }
+
+  for (i=0; i<ntimes; i++) {
+    if (t1[i] == t2[i]) continue;
+
+    /* Intervals j1 to j2 overlap the time bin */
+    j1 = HDgti_first_stop(gti, t1[i]);
+    j2 = HDgti_first_start(gti, t2[i]) - 1;
+    if (j1 > j2) continue;
+
+    lo = (gti->start[j1] > t1[i]) ? gti->start[j1] : t1[i];
+    hi = (gti->stop[j2] < t2[i]) ? gti->stop[j2] : t2[i];
+    if (j1 == j2) {
+      exposure[i] = hi - lo;
+    } else {
+      exposure[i] = (gti->stop[j1] - lo) + (cum[j2] - cum[j1+1]) 
+	+ (hi - gti->start[j2]);
+    }
+  }
+
+  free(cum);
+  return 0;
+}
+
+/*
+ * Internal routine for HDgti_where on a GTI which is not in order
+ *
+ * This is the original HDgti_where algorithm, which follows runs of
+ * times within the same good or bad interval and otherwise searches
+ * linearly from the first interval.  segs[] must already be set to -1.
+ *
+ */
+static void HDgti_where_scan(struct gti_struct *gti, int ntimes, 
+			     double *times, int *segs)
+{
+  int i, j;
+  int ngti = gti->ngti;
+  double t, tmin, tmax;
+  int s, s1;
 
   tmin = gti->start[0];
   tmax = gti->stop[ngti-1];
@@ -1180,6 +1477,330 @@ int HDgti_where(struct gti_struct *gti, int ntimes,
        is no need for i++ here. */
   }
   
+  return;
+}
+
+/*
+ * Internal check that every interval of gti has start <= stop, and
+ * that each starts at or after the stop of the previous one, so that
+ * both the start[] and stop[] arrays are in order.
+ *
+ */
+static int HDgti_sorted(struct gti_struct *gti)
+{
+  int i;
+
+  for (i=0; i<gti->ngti; i++) {
+    if (!(gti->start[i] <= gti->stop[i])) return 0;
+    if ((i > 0) && !(gti->stop[i-1] <= gti->start[i])) return 0;
+  }
+  return 1;
+}
+
+/*
+ * Internal routine for HDgti_where on a GTI which is in order
+ *
+ * Each time is in interval j if j is the first interval which stops
+ * after it and it is not before the start of that interval.  While the
+ * times are ascending j is first looked for in the few intervals
+ * following that of the previous time, so a sorted block costs about
+ * O(ntimes+ngti).  Otherwise j is found by a binary search (over the
+ * rest of the GTI for an ascending time) written so the compiler can
+ * use conditional moves rather than branches, which do not predict
+ * well for random times.
+ *
+ * The GTI number is stored in segs[] and/or 1 or 0 in mask[], if
+ * they are non-null.
+ *
+ */
+static void HDgti_where_block(struct gti_struct *gti, int ntimes, 
+			      double *times, int *segs, char *mask)
+{
+  int ngti = gti->ngti;
+  double *start = gti->start, *stop = gti->stop;
+  double t, tlast = 0;
+  int i, j = 0, k, s, base, n, half, search;
+
+  for (i=0; i<ntimes; i++) {
+    t = times[i];
+
+    base = 0;
+    search = 1;
+    if ((i > 0) && (t >= tlast)) {
+      for (k=0; (k < 8) && (j < ngti) && (stop[j] <= t); k++) j++;
+      base = j;
+      search = (j < ngti) && (stop[j] <= t);
+    }
+    if (search) {
+      n = ngti - base;
+      while (n > 1) {
+	half = n/2;
+	base = (stop[base+half] <= t) ? base+half : base;
+	n -= half;
+      }
+      j = base + (stop[base] <= t);
+    }
+    tlast = t;
+
+    s = ((j < ngti) && (t >= start[j])) ? j : -1;
+    if (segs) segs[i] = s;
+    if (mask) mask[i] = (s >= 0);
+  }
+}
+
+/* Work for one thread of HDgti_where_run() */
+struct gti_where_work {
+  struct gti_struct *gti;
+  int ntimes;
+  double *times;
+  int *segs;
+  char *mask;
+};
+
+static void *HDgti_where_thread(void *arg)
+{
+  struct gti_where_work *w = (struct gti_where_work *) arg;
+
+  HDgti_where_block(w->gti, w->ntimes, w->times, w->segs, w->mask);
   return 0;
 }
 
+/*
+ * Internal driver for HDgti_where, HDgti_where_threads and HDgti_mask
+ *
+ * Fills segs[] and/or mask[] for the times.  If the GTI is in order,
+ * the times are split into nthreads contiguous blocks, each done by
+ * HDgti_where_block() in its own thread.  Otherwise the original
+ * algorithm is used in the calling thread.
+ *
+ */
+static int HDgti_where_run(struct gti_struct *gti, int ntimes, 
+			   double *times, int *segs, char *mask,
+			   int nthreads, int *status)
+{
+  struct gti_where_work *work = 0;
+  pthread_t *threads = 0;
+  int *tsegs = 0;
+  int i, k, first, nstarted;
+
+  if (ntimes <= 0) return 0;
+
+  if (gti->ngti == 0) {
+    for (i=0; i<ntimes; i++) {
+      if (segs) segs[i] = -1;
+      if (mask) mask[i] = 0;
+    }
+    return 0;
+  }
+
+  if (!HDgti_sorted(gti)) {
+    tsegs = segs;
+    if (tsegs == 0) {
+      tsegs = (int *) malloc(sizeof(int)*ntimes);
+      if (tsegs == 0) return (*status = MEMORY_ALLOCATION);
+    }
+    for (i=0; i<ntimes; i++) tsegs[i] = -1;
+    HDgti_where_scan(gti, ntimes, times, tsegs);
+    if (mask) {
+      for (i=0; i<ntimes; i++) mask[i] = (tsegs[i] >= 0);
+    }
+    if (tsegs != segs) free(tsegs);
+    return 0;
+  }
+
+  /* Not worth starting threads for less than this many times each */
+  if (nthreads > ntimes/4096) nthreads = ntimes/4096;
+  if (nthreads <= 1) {
+    HDgti_where_block(gti, ntimes, times, segs, mask);
+    return 0;
+  }
+
+  work = (struct gti_where_work *) malloc(sizeof(struct gti_where_work)*nthreads);
+  threads = (pthread_t *) malloc(sizeof(pthread_t)*nthreads);
+  if ((work == 0) || (threads == 0)) {
+    if (work) free(work);
+    if (threads) free(threads);
+    return (*status = MEMORY_ALLOCATION);
+  }
+
+  first = 0;
+  for (k=0; k<nthreads; k++) {
+    work[k].gti    = gti;
+    work[k].ntimes = ntimes/nthreads + ((k < ntimes%nthreads) ? 1 : 0);
+    work[k].times  = times + first;
+    work[k].segs   = segs ? segs + first : 0;
+    work[k].mask   = mask ? mask + first : 0;
+    first += work[k].ntimes;
+  }
+
+  /* Block 0 is done by the calling thread, as are any blocks whose
+     thread could not be started */
+  nstarted = 1;
+  for (k=1; k<nthreads; k++) {
+    if (pthread_create(&threads[k], 0, HDgti_where_thread, &work[k]) != 0) break;
+    nstarted++;
+  }
+  HDgti_where_thread(&work[0]);
+  for (k=nstarted; k<nthreads; k++) HDgti_where_thread(&work[k]);
+  for (k=1; k<nstarted; k++) pthread_join(threads[k], 0);
+
+  free(work);
+  free(threads);
+  return 0;
+}
+
+/*
+ * HDgti_where - which good time intervals a set of times falls into
+ *
+ * HDgti_where examines an array of times, and determines which good time
+ * intervals the times fall into.  This routine is fastest when the GTI
+ * is in order with no overlaps (as HDgti_clean() leaves it) and the
+ * times are sorted in time order, but any times are handled in
+ * O(log(ngti)) each for such a GTI.  See HDgti_where_threads() to
+ * divide a large array of times between several threads, and
+ * HDgti_mask() and HDgti_ranges() for other forms of output.
+ *
+ * An interval of -1 indicates a time that does not fall into a good
+ * time interval.
+ *
+ * struct gti_struct *gti - pointer to existing GTI structure.
+ * int ntimes - size of times array.
+ * double *times - an ntimes-element array, times to be examined.
+ * int *segs - an ntimes-element array.  Upon return, the values give 
+ *   which good time interval the time falls into:
+ *    (times[i] >= gti->start[segs[i]]) && (times[i] < gti->stop[segs[i]])
+ *   or, if segs[i] is -1, the time does not fall into a GTI
+ * int *status - pointer to status variable
+ * 
+ * RETURNS: status code */
+int HDgti_where(struct gti_struct *gti, int ntimes, 
+	     double *times, int *segs, int *status)
+{
+  return HDgti_where_threads(gti, ntimes, times, segs, 1, status);
+}
+
+/*
+ * HDgti_where_threads - HDgti_where using several threads
+ *
+ * The same as HDgti_where(), but the array of times is divided into
+ * nthreads contiguous blocks which are examined at the same time by
+ * separate threads.  Threads are only used if the GTI is in order
+ * with no overlaps, and for fairly large arrays of times.
+ *
+ * struct gti_struct *gti - pointer to existing GTI structure.
+ * int ntimes - size of times array.
+ * double *times - an ntimes-element array, times to be examined.
+ * int *segs - an ntimes-element array.  Upon return, the good time
+ *   interval each time falls into, or -1, as for HDgti_where().
+ * int nthreads - maximum number of threads to use
+ * int *status - pointer to status variable
+ * 
+ * RETURNS: status code */
+int HDgti_where_threads(struct gti_struct *gti, int ntimes, 
+			double *times, int *segs, int nthreads, 
+			int *status)
+{
+  if (status == 0) return NULL_INPUT_PTR;
+  if (*status) return (*status);
+  if ((gti == 0) || (times == 0) || (segs == 0)) 
+    return (*status = NULL_INPUT_PTR);
+
+  return HDgti_where_run(gti, ntimes, times, segs, 0, nthreads, status);
+}
+
+/*
+ * HDgti_mask - flag which of a set of times fall into good time intervals
+ *
+ * The same as HDgti_where_threads(), except that rather than the good
+ * time interval number, a row mask is returned with 1 for each time
+ * which is within a good time interval and 0 for each which is not.
+ * The mask can be passed directly to CFITSIO routines which select rows.
+ *
+ * struct gti_struct *gti - pointer to existing GTI structure.
+ * int ntimes - size of times array.
+ * double *times - an ntimes-element array, times to be examined.
+ * char *mask - an ntimes-element array.  Upon return, 1 if the time
+ *   falls into a good time interval and 0 otherwise.
+ * int nthreads - maximum number of threads to use
+ * int *status - pointer to status variable
+ * 
+ * RETURNS: status code */
+int HDgti_mask(struct gti_struct *gti, int ntimes, 
+	       double *times, char *mask, int nthreads, int *status)
+{
+  if (status == 0) return NULL_INPUT_PTR;
+  if (*status) return (*status);
+  if ((gti == 0) || (times == 0) || (mask == 0)) 
+    return (*status = NULL_INPUT_PTR);
+
+  return HDgti_where_run(gti, ntimes, times, 0, mask, nthreads, status);
+}
+
+/*
+ * HDgti_ranges - find the runs of times which fall into good time intervals
+ *
+ * The same as HDgti_mask(), except that the result is returned as a
+ * list of ranges of consecutive times which are all within good time
+ * intervals.  For sorted times, such as the rows of an event file,
+ * there is at most one range per good time interval, so this is much
+ * smaller than a mask.  Range k covers elements rfirst[k] to rlast[k]
+ * inclusive of the times array (counting from 0).
+ *
+ * At most maxranges ranges are stored.  *nranges returns the total
+ * number of ranges found, which may be larger than maxranges.
+ *
+ * struct gti_struct *gti - pointer to existing GTI structure.
+ * int ntimes - size of times array.
+ * double *times - an ntimes-element array, times to be examined.
+ * int nthreads - maximum number of threads to use
+ * int maxranges - size of the rfirst and rlast arrays
+ * int *rfirst - a maxranges-element array.  Upon return, the first
+ *   element of each range.
+ * int *rlast - a maxranges-element array.  Upon return, the last
+ *   element of each range.
+ * int *nranges - upon return, the number of ranges found
+ * int *status - pointer to status variable
+ * 
+ * RETURNS: status code */
+int HDgti_ranges(struct gti_struct *gti, int ntimes, double *times, 
+		 int nthreads, int maxranges, int *rfirst, int *rlast, 
+		 int *nranges, int *status)
+{
+  char *mask = 0;
+  int i, n;
+
+  if (status == 0) return NULL_INPUT_PTR;
+  if (*status) return (*status);
+  if ((gti == 0) || (times == 0) || (nranges == 0) ||
+      ((maxranges > 0) && ((rfirst == 0) || (rlast == 0)))) 
+    return (*status = NULL_INPUT_PTR);
+
+  *nranges = 0;
+  if (ntimes <= 0) return 0;
+
+  mask = (char *) malloc(sizeof(char)*ntimes);
+  if (mask == 0) return (*status = MEMORY_ALLOCATION);
+
+  HDgti_where_run(gti, ntimes, times, 0, mask, nthreads, status);
+  if (*status) {
+    free(mask);
+    return (*status);
+  }
+
+  n = 0;
+  i = 0;
+  while (i < ntimes) {
+    if (!mask[i]) {
+      i++;
+      continue;
+    }
+    if (n < maxranges) rfirst[n] = i;
+    while ((i < ntimes) && mask[i]) i++;
+    if (n < maxranges) rlast[n] = i-1;
+    n++;
+  }
+  *nranges = n;
+
+  free(mask);
+  return 0;
+}
@@ -30,10 +30,22 @@ extern int HDgti_merge(int mode, struct gti_struct *gti,
 	     int *status);
 extern int HDgti_clean(struct gti_struct *gti, struct gti_struct *ogti,
 	     int *status);
+extern int HDgti_merge_n(int mode, struct gti_struct *gti, 
+	     int ngtis, struct gti_struct **gtis, 
+	     int *status);
 extern double HDgti_exp(double t1, double t2, struct gti_struct *gti, 
 		     int *status);
+extern int HDgti_exp_many(struct gti_struct *gti, int ntimes, 
+	     double *t1, double *t2, double *exposure, int *status);
 extern int HDgti_where(struct gti_struct *gti, int ntimes, 
 	     double *times, int *segs, int *status);
+extern int HDgti_where_threads(struct gti_struct *gti, int ntimes, 
+	     double *times, int *segs, int nthreads, int *status);
+extern int HDgti_mask(struct gti_struct *gti, int ntimes, 
+	     double *times, char *mask, int nthreads, int *status);
+extern int HDgti_ranges(struct gti_struct *gti, int ntimes, double *times, 
+	     int nthreads, int maxranges, int *rfirst, int *rlast, 
+	     int *nranges, int *status);
 
 extern double HDget_frac_time(fitsfile *fileptr, char *key, double *keyi, 
 			  double *keyf, int *status);
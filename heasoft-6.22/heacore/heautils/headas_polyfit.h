@@ -6,6 +6,14 @@ void HDpoly_fit(double * x, double * y, double * c, int n, int degree);
 
 void HDsmooth(float * input, float * output, int num, int width);
 
+void HDsmooth_double(double * input, double * output, int num, int width);
+
+void HDsmooth_multi(float * input, float * output, int narray, int num,
+    int width);
+
+void HDsmooth_multi_double(double * input, double * output, int narray,
+    int num, int width);
+
 void HDsort(float * base, int * index, int n);
 
 void HDsvbksb( double **U, double *W, double **V, unsigned int M,
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <pthread.h>
 #include "headas_rand.h"
 #include "mt.h"
 
@@ -32,3 +33,195 @@ void HDmtInit (unsigned long int s) {
 void HDmtFree () {
 	free (mtstate);
 }
+
+/* Philox4x32-10 (Salmon et al. 2011, "Parallel random numbers: as easy
+ * as 1, 2, 3").  Block number b of a stream is the encryption of the
+ * counter (b, stream) with the seed as key, giving 4 values. */
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+
+/* Number of blocks made at once by HDphilox_fill, written as separate
+ * lanes so the compiler can use vector instructions */
+#define PHILOX_LANES 8
+
+static void philox_block (const HDphilox_state *state, unsigned long long block,
+			  unsigned int out[4]) {
+	unsigned int c0 = (unsigned int) block;
+	unsigned int c1 = (unsigned int) (block >> 32);
+	unsigned int c2 = state->stream[0], c3 = state->stream[1];
+	unsigned int k0 = state->key[0], k1 = state->key[1];
+	unsigned long long p0, p1;
+	int r;
+
+	for (r = 0; r < 10; r++) {
+		p0 = (unsigned long long) PHILOX_M0 * c0;
+		p1 = (unsigned long long) PHILOX_M1 * c2;
+		c0 = (unsigned int) (p1 >> 32) ^ c1 ^ k0;
+		c1 = (unsigned int) p1;
+		c2 = (unsigned int) (p0 >> 32) ^ c3 ^ k1;
+		c3 = (unsigned int) p0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+/* Two 32 bit values to a double in [0,1), as genrand_res53 */
+static double philox_double (unsigned int a, unsigned int b) {
+	return ((a >> 5) * 67108864.0 + (b >> 6)) * (1.0 / 9007199254740992.0);
+}
+
+/* Make the doubles for nblocks whole blocks from block onwards */
+static void philox_fill_blocks (const HDphilox_state *state,
+				unsigned long long block, long nblocks, double *x) {
+	unsigned int c0[PHILOX_LANES], c1[PHILOX_LANES];
+	unsigned int c2[PHILOX_LANES], c3[PHILOX_LANES];
+	unsigned int h0[PHILOX_LANES], h1[PHILOX_LANES];
+	unsigned int out[4];
+	unsigned int k0, k1;
+	unsigned long long p0, p1;
+	long b;
+	int l, r;
+
+	for (b = 0; b + PHILOX_LANES <= nblocks; b += PHILOX_LANES) {
+		for (l = 0; l < PHILOX_LANES; l++) {
+			c0[l] = (unsigned int) (block + b + l);
+			c1[l] = (unsigned int) ((block + b + l) >> 32);
+			c2[l] = state->stream[0];
+			c3[l] = state->stream[1];
+		}
+		k0 = state->key[0];
+		k1 = state->key[1];
+		for (r = 0; r < 10; r++) {
+			for (l = 0; l < PHILOX_LANES; l++) {
+				p0 = (unsigned long long) PHILOX_M0 * c0[l];
+				p1 = (unsigned long long) PHILOX_M1 * c2[l];
+				h0[l] = (unsigned int) (p0 >> 32);
+				h1[l] = (unsigned int) (p1 >> 32);
+				c0[l] = h1[l] ^ c1[l] ^ k0;
+				c1[l] = (unsigned int) p1;
+				c2[l] = h0[l] ^ c3[l] ^ k1;
+				c3[l] = (unsigned int) p0;
+			}
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+		for (l = 0; l < PHILOX_LANES; l++) {
+			x[2*(b+l)]   = philox_double(c0[l], c1[l]);
+			x[2*(b+l)+1] = philox_double(c2[l], c3[l]);
+		}
+	}
+	for (; b < nblocks; b++) {
+		philox_block(state, block + b, out);
+		x[2*b]   = philox_double(out[0], out[1]);
+		x[2*b+1] = philox_double(out[2], out[3]);
+	}
+}
+
+void HDphilox_init (HDphilox_state *state, unsigned long int s,
+		    unsigned long int stream) {
+	state->key[0] = (unsigned int) (s & 0xffffffffUL);
+	state->key[1] = (unsigned int) ((s >> 16) >> 16);
+	state->stream[0] = (unsigned int) (stream & 0xffffffffUL);
+	state->stream[1] = (unsigned int) ((stream >> 16) >> 16);
+	state->block = 0;
+	state->used = 4;
+}
+
+unsigned long int HDphilox_rand (HDphilox_state *state) {
+	if (state->used == 4) {
+		philox_block(state, state->block++, state->buf);
+		state->used = 0;
+	}
+	return state->buf[state->used++];
+}
+
+double HDphilox_drand (HDphilox_state *state) {
+	unsigned int a = (unsigned int) HDphilox_rand(state);
+	return philox_double(a, (unsigned int) HDphilox_rand(state));
+}
+
+void HDphilox_jump (HDphilox_state *state, unsigned long long n) {
+	/* position of the next value */
+	unsigned long long pos = 4 * state->block - 4 + state->used + n;
+
+	state->block = pos / 4;
+	state->used = (int) (pos % 4);
+	if (state->used == 0) {
+		state->used = 4;
+	} else {
+		philox_block(state, state->block++, state->buf);
+	}
+}
+
+void HDphilox_fill (HDphilox_state *state, long n, double *x) {
+	long i = 0, nblocks;
+
+	/* whole blocks can be made directly once the stream is at the
+	 * start of one, which is never the case after an odd number of
+	 * calls to HDphilox_rand */
+	if (state->used == 2 && n > 0) x[i++] = HDphilox_drand(state);
+	if (state->used == 4) {
+		nblocks = (n - i) / 2;
+		philox_fill_blocks(state, state->block, nblocks, x + i);
+		state->block += nblocks;
+		i += 2 * nblocks;
+	}
+	for (; i < n; i++) x[i] = HDphilox_drand(state);
+}
+
+/* Work for one thread of HDphilox_fill_threads */
+typedef struct {
+	HDphilox_state state;
+	long n;
+	double *x;
+} philox_work;
+
+static void *philox_fill_thread (void *arg) {
+	philox_work *w = (philox_work *) arg;
+	HDphilox_fill(&w->state, w->n, w->x);
+	return 0;
+}
+
+void HDphilox_fill_threads (HDphilox_state *state, long n, double *x,
+			    int nthreads) {
+	philox_work *work;
+	pthread_t *threads;
+	long first = 0;
+	int k, nstarted = 1;
+
+	/* Not worth starting threads for less than this many values each */
+	if (nthreads > n / 16384) nthreads = (int) (n / 16384);
+	work = (nthreads > 1) ? (philox_work *) malloc(sizeof(philox_work) * nthreads) : 0;
+	threads = (nthreads > 1) ? (pthread_t *) malloc(sizeof(pthread_t) * nthreads) : 0;
+	if (work == 0 || threads == 0) {
+		free(work);
+		free(threads);
+		HDphilox_fill(state, n, x);
+		return;
+	}
+
+	/* Each thread makes its own block of the stream, so the values
+	 * are the same whatever the number of threads */
+	for (k = 0; k < nthreads; k++) {
+		work[k].state = *state;
+		HDphilox_jump(&work[k].state, 2 * (unsigned long long) first);
+		work[k].n = n / nthreads + ((k < n % nthreads) ? 1 : 0);
+		work[k].x = x + first;
+		first += work[k].n;
+	}
+	for (k = 1; k < nthreads; k++) {
+		if (pthread_create(&threads[k], 0, philox_fill_thread, &work[k]) != 0) break;
+		nstarted++;
+	}
+	philox_fill_thread(&work[0]);
+	for (k = nstarted; k < nthreads; k++) philox_fill_thread(&work[k]);
+	for (k = 1; k < nstarted; k++) pthread_join(threads[k], 0);
+
+	HDphilox_jump(state, 2 * (unsigned long long) n);
+	free(work);
+	free(threads);
+}
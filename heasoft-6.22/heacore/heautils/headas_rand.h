@@ -35,6 +35,21 @@ extern "C" {
 	struct mt_state_t;
 	typedef struct mt_state_t HDmt_state;
 
+	/* State of one stream of the counter-based Philox4x32-10
+	 * generator.  Value n of a stream depends only on the seed, the
+	 * stream number and n, so a stream can jump to any position at
+	 * no cost, and separate streams (or separate blocks of one
+	 * stream) can be used by separate threads with results which do
+	 * not depend on the number of threads.  The members should be
+	 * treated as private. */
+	typedef struct {
+		unsigned int key[2];        /* from the seed */
+		unsigned int stream[2];     /* stream number */
+		unsigned long long block;   /* next block of 4 values */
+		unsigned int buf[4];        /* the current block */
+		int used;                   /* values of buf already used */
+	} HDphilox_state;
+
   /****************************************************************************/
 
   /****************************************************************************
@@ -60,6 +75,22 @@ extern "C" {
         void HDmtInit (unsigned long int s);
         void HDmtFree ();
 
+	/* Counter-based generator.  HDphilox_init starts stream number
+	 * "stream" for seed "s" at its first value.  HDphilox_rand returns
+	 * 32 random bits and HDphilox_drand a double in [0,1) with 53
+	 * random bits, using two values of the stream.  HDphilox_jump
+	 * skips over n values.  HDphilox_fill stores n doubles, the same
+	 * as n calls to HDphilox_drand, and HDphilox_fill_threads does
+	 * the same using up to nthreads threads. */
+	void HDphilox_init (HDphilox_state *state, unsigned long int s,
+			    unsigned long int stream);
+	unsigned long int HDphilox_rand (HDphilox_state *state);
+	double HDphilox_drand (HDphilox_state *state);
+	void HDphilox_jump (HDphilox_state *state, unsigned long long n);
+	void HDphilox_fill (HDphilox_state *state, long n, double *x);
+	void HDphilox_fill_threads (HDphilox_state *state, long n, double *x,
+				    int nthreads);
+
   /****************************************************************************/
 
 /* C/C++ compatibility. */
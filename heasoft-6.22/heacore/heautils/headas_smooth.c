@@ -7,41 +7,191 @@
     output - the smoothed array
     num    - the size of array
     width  - the width of the boxcar
- Modification History: 
+ Modification History:
     Writen by: Ziqin Pan, Novemeber,2004
 
+    Each output is the mean of the input points from i-width/2 to
+    i+width/2 which are within the array.  The sum over the boxcar is
+    now kept as a running sum, adding the point which enters and
+    subtracting the one which leaves, so the cost no longer depends on
+    the width.  The sum is kept in double precision with a
+    compensation term (Neumaier's form of Kahan summation) so it does
+    not drift along long arrays.  NaN and infinite inputs are counted
+    separately, so they only affect the outputs whose boxcar holds
+    them, as with a direct sum.  The input and output arrays may be
+    the same, or overlap.
+
+    HDsmooth_double does the same for double precision data, and
+    HDsmooth_multi and HDsmooth_multi_double smooth narray arrays of
+    num points each, stored one after the other.
+
 ************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
-void HDsmooth(float * input, float * output, int num, int width) {
-        int i,j,k,b;
-        float total;
-        float * tmp;
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+/* The boxcar sum.  NaN and infinite points are counted rather than added
+   to the compensated sum (sum, comp), so that the sum recovers once they
+   leave the boxcar. */
+typedef struct {
+        double sum, comp;
+        int nan, pinf, ninf;
+} HDsmooth_window;
+
+/* Add x to the window (sign 1) or take it out again (sign -1) */
+static void HDsmooth_update(HDsmooth_window * w, double x, int sign) {
+        double t;
+
+        if (x != x) {
+             w->nan += sign;
+        } else if (x > DBL_MAX) {
+             w->pinf += sign;
+        } else if (x < -DBL_MAX) {
+             w->ninf += sign;
+        } else {
+             x *= sign;
+             t = w->sum + x;
+             if (fabs(w->sum) >= fabs(x)) {
+                  w->comp += (w->sum - t) + x;
+             } else {
+                  w->comp += (x - t) + w->sum;
+             }
+             w->sum = t;
+        }
+}
+
+/* The mean of the n points in the window, NaN or infinite as a direct
+   sum of the points would be */
+static double HDsmooth_mean(const HDsmooth_window * w, int n) {
+        double zero = 0.0;
+
+        if (w->nan || (w->pinf && w->ninf)) return zero/zero;
+        if (w->pinf) return HUGE_VAL;
+        if (w->ninf) return -HUGE_VAL;
+        return (w->sum + w->comp)/n;
+}
+
+/* Return whether the n bytes at a and the n bytes at b overlap */
+static int HDsmooth_overlap(const void * a, const void * b, size_t n) {
+        const char * pa = (const char *) a;
+        const char * pb = (const char *) b;
+        return pa < pb + n && pb < pa + n;
+}
 
-        b = width/2;
-        tmp = (float *) calloc(num,sizeof(float));
-
-        for (i=0; i< num; i++) {
-                k=0;
-                total=0.0;
-		for ( j=i-b; j <=i+b; j++ ) {
-                     if (j >=0 && j <num) {
-                        k++;
-                        total +=*(input+j);
-                     }
-                }
-                tmp[i] = total/k;
-         }
-         for (i=0; i<num; i++) {
-             output[i]=tmp[i];
-         }
 /*
-         for (i=0; i<num; i++) {
-             fprintf(stderr,"%d,tmp[%d]=%f\n",num,i,tmp[i]);
-             output[i]=tmp[i];
-             fprintf(stderr,"output[%d]=%f\n",i,output[i]);
-         }
-*/
-         free(tmp);
+ * Smooth one array of floats.  If the smoothing is in place, the
+ * input value at each point is saved in ring (which has b+1 elements)
+ * before being overwritten, to be subtracted when it leaves the boxcar.
+ */
+static void HDsmooth_float_row(float * input, float * output, int num,
+                               int b, float * ring) {
+        int i, lo, hi;
+        HDsmooth_window w = { 0.0, 0.0, 0, 0, 0 };
+        float leave;
+
+        for (i=0; i<=b && i<num; i++) HDsmooth_update(&w, input[i], 1);
+
+        for (i=0; i<num; i++) {
+             if (i > 0 && i+b < num) HDsmooth_update(&w, input[i+b], 1);
+             if (i-b-1 >= 0) {
+                  leave = ring ? ring[(i-b-1) % (b+1)] : input[i-b-1];
+                  HDsmooth_update(&w, leave, -1);
+             }
+             lo = (i-b > 0) ? i-b : 0;
+             hi = (i+b < num-1) ? i+b : num-1;
+             if (ring) ring[i % (b+1)] = input[i];
+             output[i] = (float) HDsmooth_mean(&w, hi-lo+1);
+        }
+}
+
+static void HDsmooth_double_row(double * input, double * output, int num,
+                                int b, double * ring) {
+        int i, lo, hi;
+        HDsmooth_window w = { 0.0, 0.0, 0, 0, 0 };
+        double leave;
+
+        for (i=0; i<=b && i<num; i++) HDsmooth_update(&w, input[i], 1);
+
+        for (i=0; i<num; i++) {
+             if (i > 0 && i+b < num) HDsmooth_update(&w, input[i+b], 1);
+             if (i-b-1 >= 0) {
+                  leave = ring ? ring[(i-b-1) % (b+1)] : input[i-b-1];
+                  HDsmooth_update(&w, leave, -1);
+             }
+             lo = (i-b > 0) ? i-b : 0;
+             hi = (i+b < num-1) ? i+b : num-1;
+             if (ring) ring[i % (b+1)] = input[i];
+             output[i] = HDsmooth_mean(&w, hi-lo+1);
+        }
+}
+
+void HDsmooth_multi(float * input, float * output, int narray, int num,
+                    int width) {
+        int b, k;
+        float * ring = 0;
+        float * copy = 0;
+        size_t size = (size_t)narray*num*sizeof(float);
+
+        b = width/2;
+        if (b < 0) b = 0;
+
+        /* Smoothing in place only needs the last b+1 inputs of the row
+           kept aside.  Arrays which overlap otherwise are smoothed from
+           a copy of the input. */
+        if (input == output) {
+             ring = (float *) calloc(b+1,sizeof(float));
+        } else if (HDsmooth_overlap(input, output, size)) {
+             copy = (float *) malloc(size);
+             memcpy(copy, input, size);
+             input = copy;
+        }
+
+        for (k=0; k<narray; k++) {
+             HDsmooth_float_row(input + (size_t)k*num, output + (size_t)k*num,
+                                num, b, ring);
+        }
+
+        free(ring);
+        free(copy);
+}
+
+void HDsmooth_multi_double(double * input, double * output, int narray,
+                           int num, int width) {
+        int b, k;
+        double * ring = 0;
+        double * copy = 0;
+        size_t size = (size_t)narray*num*sizeof(double);
+
+        b = width/2;
+        if (b < 0) b = 0;
+
+        /* Smoothing in place only needs the last b+1 inputs of the row
+           kept aside.  Arrays which overlap otherwise are smoothed from
+           a copy of the input. */
+        if (input == output) {
+             ring = (double *) calloc(b+1,sizeof(double));
+        } else if (HDsmooth_overlap(input, output, size)) {
+             copy = (double *) malloc(size);
+             memcpy(copy, input, size);
+             input = copy;
+        }
+
+        for (k=0; k<narray; k++) {
+             HDsmooth_double_row(input + (size_t)k*num, output + (size_t)k*num,
+                                 num, b, ring);
+        }
+
+        free(ring);
+        free(copy);
+}
+
+void HDsmooth(float * input, float * output, int num, int width) {
+        HDsmooth_multi(input, output, 1, num, width);
+}
+
+void HDsmooth_double(double * input, double * output, int num, int width) {
+        HDsmooth_multi_double(input, output, 1, num, width);
 }
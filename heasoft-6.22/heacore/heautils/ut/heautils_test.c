@@ -13,8 +13,11 @@
 /******************************************************************************
  * Header files.                                                              *
  ******************************************************************************/
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef WIN32
 #else
@@ -23,6 +26,7 @@
 #endif
 
 #include "headas_utils.h"
+#include "headas_polyfit.h"
 /******************************************************************************/
 
 /* C/C++ compatibility. */
@@ -218,6 +222,153 @@ extern "C" {
     if (0 != passed_status) status = passed_status;
     return status;
   }
+
+  /* Boxcar average the slow way, by summing each boxcar in full. */
+  static void direct_smooth(const double * input, double * output, int num, int width) {
+    int half = width/2;
+    int ii, jj;
+    for (ii = 0; ii < num; ++ii) {
+      double total = 0.;
+      int count = 0;
+      for (jj = ii - half; jj <= ii + half; ++jj) {
+        if (jj >= 0 && jj < num) { total += input[jj]; ++count; }
+      }
+      output[ii] = total / count;
+    }
+  }
+
+  static int test_smooth(int status) {
+    /* Save inherited status value. */
+    int passed_status = status;
+
+    enum { num = 1000, narray = 3 };
+    static const int width[] = { 0, 1, 2, 5, 50, 999, 5000 };
+    double dinput[narray*num], doutput[narray*num], expected[narray*num];
+    float finput[narray*num], foutput[narray*num];
+    double nonfinite[12], zero = 0.;
+    float fnonfinite[12];
+    int iw, ii, kk;
+
+    /* Values with a large offset, to show up any drift of the running sum. */
+    for (ii = 0; ii < narray*num; ++ii) {
+      finput[ii] = (float) (1.e4 + (ii * 7919 % 1000) / 10.);
+      dinput[ii] = finput[ii];
+    }
+
+    for (iw = 0; iw < (int) (sizeof(width)/sizeof(width[0])); ++iw) {
+      for (kk = 0; kk < narray; ++kk) direct_smooth(dinput + kk*num, expected + kk*num, num, width[iw]);
+
+      HDsmooth_multi_double(dinput, doutput, narray, num, width[iw]);
+      for (ii = 0; ii < narray*num; ++ii) {
+        if (fabs(doutput[ii] - expected[ii]) > 1.e-9 * fabs(expected[ii])) {
+          status = 1;
+          fprintf(stderr, "test_smooth: HDsmooth_multi_double width %d element %d is %.12g, not %.12g.\n",
+            width[iw], ii, doutput[ii], expected[ii]);
+          break;
+        }
+      }
+
+      HDsmooth_multi(finput, foutput, narray, num, width[iw]);
+      for (ii = 0; ii < narray*num; ++ii) {
+        if (foutput[ii] != (float) expected[ii]) {
+          status = 1;
+          fprintf(stderr, "test_smooth: HDsmooth_multi width %d element %d is %.9g, not %.9g.\n",
+            width[iw], ii, foutput[ii], (float) expected[ii]);
+          break;
+        }
+      }
+
+      /* Smoothing in place must give the same result. */
+      memcpy(foutput, finput, sizeof(finput));
+      HDsmooth(foutput, foutput, num, width[iw]);
+      for (ii = 0; ii < num; ++ii) {
+        if (foutput[ii] != (float) expected[ii]) {
+          status = 1;
+          fprintf(stderr, "test_smooth: HDsmooth in place width %d element %d is %.9g, not %.9g.\n",
+            width[iw], ii, foutput[ii], (float) expected[ii]);
+          break;
+        }
+      }
+
+      /* So must smoothing into an overlapping range, shifted either way. */
+      for (kk = -1; kk <= 1; kk += 2) {
+        double * in = doutput + (kk < 0 ? 1 : 0);
+        double * out = doutput + (kk < 0 ? 0 : 1);
+        memcpy(in, dinput, num * sizeof(double));
+        HDsmooth_double(in, out, num, width[iw]);
+        for (ii = 0; ii < num; ++ii) {
+          if (fabs(out[ii] - expected[ii]) > 1.e-9 * fabs(expected[ii])) {
+            status = 1;
+            fprintf(stderr, "test_smooth: HDsmooth_double shifted by %d width %d element %d is %.12g, not %.12g.\n",
+              kk, width[iw], ii, out[ii], expected[ii]);
+            break;
+          }
+        }
+      }
+    }
+
+    /* A NaN or infinite point only affects the outputs whose boxcar holds it,
+       as in the direct sum. */
+    for (ii = 0; ii < 12; ++ii) nonfinite[ii] = 1.;
+    nonfinite[3] = zero / zero;
+    nonfinite[7] = HUGE_VAL;
+    nonfinite[8] = -HUGE_VAL;
+    for (ii = 0; ii < 12; ++ii) fnonfinite[ii] = (float) nonfinite[ii];
+    direct_smooth(nonfinite, expected, 12, 3);
+    HDsmooth_double(nonfinite, doutput, 12, 3);
+    HDsmooth(fnonfinite, foutput, 12, 3);
+    for (ii = 0; ii < 12; ++ii) {
+      if (!(doutput[ii] == expected[ii] || (doutput[ii] != doutput[ii] && expected[ii] != expected[ii]))) {
+        status = 1;
+        fprintf(stderr, "test_smooth: HDsmooth_double with NaN/Inf element %d is %g, not %g.\n",
+          ii, doutput[ii], expected[ii]);
+      }
+      if (!(foutput[ii] == (float) expected[ii] || (foutput[ii] != foutput[ii] && expected[ii] != expected[ii]))) {
+        status = 1;
+        fprintf(stderr, "test_smooth: HDsmooth with NaN/Inf element %d is %g, not %g.\n",
+          ii, foutput[ii], expected[ii]);
+      }
+    }
+
+    /* Use inherited status if it was non-0. */
+    if (0 != passed_status) status = passed_status;
+    return status;
+  }
+
+  /* Time HDsmooth against the direct boxcar sum for some typical widths. */
+  static void bench_smooth(void) {
+    static const int width[] = { 5, 21, 101, 1001 };
+    int num = 1000000;
+    double * input = (double *) malloc(num * sizeof(double));
+    double * output = (double *) malloc(num * sizeof(double));
+    float * finput = (float *) malloc(num * sizeof(float));
+    float * foutput = (float *) malloc(num * sizeof(float));
+    int iw, ii;
+    clock_t start;
+    double direct, smooth;
+
+    if (0 == input || 0 == output || 0 == finput || 0 == foutput) return;
+    for (ii = 0; ii < num; ++ii) {
+      finput[ii] = (float) (ii % 1000);
+      input[ii] = finput[ii];
+    }
+
+    printf("HDsmooth on %d points:\n", num);
+    for (iw = 0; iw < (int) (sizeof(width)/sizeof(width[0])); ++iw) {
+      start = clock();
+      direct_smooth(input, output, num, width[iw]);
+      direct = (double) (clock() - start) / CLOCKS_PER_SEC;
+      start = clock();
+      HDsmooth(finput, foutput, num, width[iw]);
+      smooth = (double) (clock() - start) / CLOCKS_PER_SEC;
+      printf("  width %5d: direct sum %8.4f s, HDsmooth %8.4f s\n", width[iw], direct, smooth);
+    }
+
+    free(input);
+    free(output);
+    free(finput);
+    free(foutput);
+  }
   /****************************************************************************/
 
   /****************************************************************************
@@ -230,12 +381,18 @@ extern "C" {
 }
 #endif
 
-int main() {
+int main(int argc, char ** argv) {
   int status = 0;
 
+  /* "heautils_test bench" also times HDsmooth. */
+  if (1 < argc && 0 == strcmp(argv[1], "bench")) bench_smooth();
+
   /* Test HDfile_check function. */
   status = test_file_check(status);
 
+  /* Test HDsmooth functions. */
+  status = test_smooth(status);
+
   return status;
 }
 /******************************************************************************